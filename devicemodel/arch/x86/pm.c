@@ -34,6 +34,7 @@
 #include <stdbool.h>
 #include <pthread.h>
 
+#include "dm.h"
 #include "vmmapi.h"
 #include "acpi.h"
 #include "inout.h"
@@ -66,12 +67,13 @@ reset_handler(struct vmctx *ctx, int vcpu, int in, int port, int bytes,
 	else {
 		reset_control = *eax;
 
-		if (*eax & 0x8) {
+		if ((*eax & 0x8) && !warm_reset) {
 			pr_notice("full reset\r\n");
 			vm_suspend(ctx, VM_SUSPEND_FULL_RESET);
 			mevent_notify();
 			reset_control = 0;
-		} else if (*eax & 0x4) {
+		} else if (*eax & 0xc) {
+			/* a full reset is done in place as well with --warm_reset */
 			pr_notice("system reset\r\n");
 			vm_suspend(ctx, VM_SUSPEND_SYSTEM_RESET);
 			mevent_notify();
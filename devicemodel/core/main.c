@@ -93,10 +93,13 @@ uint8_t trusty_enabled;
 bool stdio_in_use;
 bool lapic_pt;
 bool is_rtvm;
+bool vpmu;
+bool viommu;
 bool pt_tpm2;
 bool ssram;
 bool vtpm2;
 bool is_winvm;
+bool warm_reset;
 bool skip_pci_mem64bar_workaround = false;
 
 static int guest_ncpus;
@@ -104,6 +107,8 @@ static int virtio_msix = 1;
 static bool debugexit_enabled;
 static int pm_notify_channel;
 static bool cmd_monitor;
+static bool warm_reset_clear_mem;
+static int mptgen;
 
 static char *progname;
 static const int BSP;
@@ -147,9 +152,9 @@ usage(int code)
 		"       %*s [--enable_trusty] [--intr_monitor param_setting]\n"
 		"       %*s [--acpidev_pt HID] [--mmiodev_pt MMIO_Regions]\n"
 		"       %*s [--vtpm2 sock_path] [--virtio_poll interval]\n"
-		"       %*s [--cpu_affinity lapic_id] [--lapic_pt] [--rtvm] [--windows]\n"
+		"       %*s [--cpu_affinity lapic_id] [--lapic_pt] [--rtvm] [--vpmu] [--windows]\n"
 		"       %*s [--debugexit] [--logger_setting param_setting]\n"
-		"       %*s [--ssram] <vm>\n"
+		"       %*s [--ssram] [--warm_reset[=clear_mem]] [--viommu] <vm>\n"
 		"       -B: bootargs for kernel\n"
 		"       -E: elf image path\n"
 		"       -h: help\n"
@@ -175,10 +180,17 @@ usage(int code)
 		"       --vtpm2: Virtual TPM2 args: sock_path=$PATH_OF_SWTPM_SOCKET\n"
 		"       --lapic_pt: enable local apic passthrough\n"
 		"       --rtvm: indicate that the guest is rtvm\n"
+		"       --vpmu: enable the architectural PMU for the guest, a VM with local apic\n"
+		"            passthrough gets the physical PMU exclusively\n"
 		"       --logger_setting: params like console,level=4;kmsg,level=3\n"
 		"       --windows: support Oracle virtio-blk, virtio-net and virtio-input devices\n"
 		"            for windows guest with secure boot\n"
-		"       --virtio_msi: force virtio to use single-vector MSI\n",
+		"       --virtio_msi: force virtio to use single-vector MSI\n"
+		"       --warm_reset: reset the VM in place on a guest reboot, keeping its memory\n"
+		"            mapped instead of re-creating the VM; clear_mem also clears the\n"
+		"            guest memory, in the background of the device reset\n"
+		"       --viommu: expose a virtual VT-d to the guest, so that user space drivers\n"
+		"            can use the passthrough devices\n",
 		progname, (int)strnlen(progname, PATH_MAX), "", (int)strnlen(progname, PATH_MAX), "",
 		(int)strnlen(progname, PATH_MAX), "", (int)strnlen(progname, PATH_MAX), "",
 		(int)strnlen(progname, PATH_MAX), "", (int)strnlen(progname, PATH_MAX), "",
@@ -560,26 +572,17 @@ vm_deinit_vdevs(struct vmctx *ctx)
 	deinit_vtpm2(ctx);
 }
 
+/*
+ * The current virtual devices doesn't define virtual
+ * device reset function. So we call vdev deinit/init
+ * pairing to emulate the device reset operation.
+ *
+ * pci/ioapic deinit/init is needed because of dependency
+ * of pci irq allocation/free.
+ */
 static void
-vm_reset_vdevs(struct vmctx *ctx)
+vm_reset_vdevs_deinit(struct vmctx *ctx)
 {
-	/*
-	 * Write ovmf NV storage back to the original file from guest
-	 * memory before deinit operations.
-	 */
-	acrn_writeback_ovmf_nvstorage(ctx);
-
-	/*
-	 * The current virtual devices doesn't define virtual
-	 * device reset function. So we call vdev deinit/init
-	 * pairing to emulate the device reset operation.
-	 *
-	 * pci/ioapic deinit/init is needed because of dependency
-	 * of pci irq allocation/free.
-	 *
-	 * acpi build is necessary because irq for each vdev
-	 * could be assigned with different number after reset.
-	 */
 	atkbdc_deinit(ctx);
 
 	if (debugexit_enabled)
@@ -595,7 +598,11 @@ vm_reset_vdevs(struct vmctx *ctx)
 	deinit_pci(ctx);
 	pci_irq_deinit(ctx);
 	ioapic_deinit();
+}
 
+static void
+vm_reset_vdevs_init(struct vmctx *ctx)
+{
 	pci_irq_init(ctx);
 	atkbdc_init(ctx);
 	vrtc_init(ctx);
@@ -610,8 +617,16 @@ vm_reset_vdevs(struct vmctx *ctx)
 
 	ioapic_init(ctx);
 	init_pci(ctx);
+}
 
-	acpi_build(ctx, guest_ncpus);
+static long
+elapsed_us(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	timespecsub(&now, start);
+	return (long)now.tv_sec * 1000000L + now.tv_nsec / 1000L;
 }
 
 static void
@@ -626,8 +641,13 @@ vm_system_reset(struct vmctx *ctx)
 	 *   4. load software for User VM
 	 *   5. hypercall reset vm
 	 *   6. reset suspend mode to VM_SUSPEND_NONE
+	 *
+	 * The VM isn't destroyed: its EPT and memory mappings in the
+	 * hypervisor are kept.
 	 */
+	struct timespec start;
 
+	clock_gettime(CLOCK_MONOTONIC, &start);
 	vm_pause(ctx);
 
 	/*
@@ -647,7 +667,37 @@ vm_system_reset(struct vmctx *ctx)
 	 */
 	vm_clear_ioreq(ctx);
 
-	vm_reset_vdevs(ctx);
+	/*
+	 * Write ovmf NV storage back to the original file from guest
+	 * memory before deinit operations.
+	 */
+	acrn_writeback_ovmf_nvstorage(ctx);
+
+	/*
+	 * The device backends may still DMA into or read the guest memory
+	 * until they are deinitialized, so the clearing starts after that and
+	 * overlaps with bringing the devices up again.
+	 */
+	vm_reset_vdevs_deinit(ctx);
+
+	if (warm_reset_clear_mem)
+		vm_clear_memory_start(ctx);
+
+	vm_reset_vdevs_init(ctx);
+
+	/* The tables below live in the guest memory */
+	if (warm_reset_clear_mem) {
+		vm_clear_memory_wait(ctx);
+		if (mptgen)
+			mptable_build(ctx, guest_ncpus);
+	}
+
+	/*
+	 * acpi build is necessary because irq for each vdev
+	 * could be assigned with different number after reset.
+	 */
+	acpi_build(ctx, guest_ncpus);
+
 	vm_reset(ctx);
 	pr_info("%s: setting VM state to %s\n", __func__, vm_state_to_str(VM_SUSPEND_NONE));
 	vm_set_suspend_mode(VM_SUSPEND_NONE);
@@ -656,6 +706,8 @@ vm_system_reset(struct vmctx *ctx)
 	acrn_sw_load(ctx);
 	vm_set_vcpu_regs(ctx, &ctx->bsp_regs);
 	vm_run(ctx);
+
+	pr_notice("%s: VM reset in %ld us\n", __func__, elapsed_us(&start));
 }
 
 static void
@@ -770,12 +822,15 @@ enum {
 	CMD_OPT_VTPM2,
 	CMD_OPT_LAPIC_PT,
 	CMD_OPT_RTVM,
+	CMD_OPT_VPMU,
 	CMD_OPT_SOFTWARE_SRAM,
 	CMD_OPT_LOGGER_SETTING,
 	CMD_OPT_PM_NOTIFY_CHANNEL,
 	CMD_OPT_PM_BY_VUART,
 	CMD_OPT_WINDOWS,
 	CMD_OPT_FORCE_VIRTIO_MSI,
+	CMD_OPT_WARM_RESET,
+	CMD_OPT_VIOMMU,
 };
 
 static struct option long_options[] = {
@@ -810,12 +865,15 @@ static struct option long_options[] = {
 	{"vtpm2",		required_argument,	0, CMD_OPT_VTPM2},
 	{"lapic_pt",		no_argument,		0, CMD_OPT_LAPIC_PT},
 	{"rtvm",		no_argument,		0, CMD_OPT_RTVM},
+	{"vpmu",		no_argument,		0, CMD_OPT_VPMU},
 	{"ssram",		required_argument,	0, CMD_OPT_SOFTWARE_SRAM},
 	{"logger_setting",	required_argument,	0, CMD_OPT_LOGGER_SETTING},
 	{"pm_notify_channel",	required_argument,	0, CMD_OPT_PM_NOTIFY_CHANNEL},
 	{"pm_by_vuart",	required_argument,	0, CMD_OPT_PM_BY_VUART},
 	{"windows",		no_argument,		0, CMD_OPT_WINDOWS},
 	{"virtio_msi",		no_argument,		0, CMD_OPT_FORCE_VIRTIO_MSI},
+	{"warm_reset",		optional_argument,	0, CMD_OPT_WARM_RESET},
+	{"viommu",		no_argument,		0, CMD_OPT_VIOMMU},
 	{0,			0,			0,  0  },
 };
 
@@ -825,10 +883,12 @@ int
 main(int argc, char *argv[])
 {
 	int c, error, ret=1;
-	int max_vcpus, mptgen;
+	int max_vcpus;
 	struct vmctx *ctx;
 	size_t memsize;
 	int option_idx = 0;
+	struct timespec reset_start;
+	bool full_reset = false;
 
 	progname = basename(argv[0]);
 	memsize = 256 * MB;
@@ -946,6 +1006,12 @@ main(int argc, char *argv[])
 			is_rtvm = true;
 			lapic_pt = true;
 			break;
+		case CMD_OPT_VPMU:
+			vpmu = true;
+			break;
+		case CMD_OPT_VIOMMU:
+			viommu = true;
+			break;
 		case CMD_OPT_SOFTWARE_SRAM:
 			if (parse_vssram_buf_params(optarg) != 0)
 				errx(EX_USAGE, "invalid vSSRAM buffer size param %s", optarg);
@@ -1003,6 +1069,15 @@ main(int argc, char *argv[])
 		case CMD_OPT_FORCE_VIRTIO_MSI:
 			virtio_msix = 0;
 			break;
+		case CMD_OPT_WARM_RESET:
+			warm_reset = true;
+			if (optarg != NULL) {
+				if (strncmp("clear_mem", optarg, sizeof("clear_mem")) == 0)
+					warm_reset_clear_mem = true;
+				else
+					errx(EX_USAGE, "invalid warm_reset param: %s", optarg);
+			}
+			break;
 		case 'h':
 			usage(0);
 		default:
@@ -1021,6 +1096,12 @@ main(int argc, char *argv[])
 		lapic_pt = false;
 		pr_warn("Only a Realtime VM can use local APIC pass through, '--lapic_pt' is invalid here.\n");
 	}
+
+	if (warm_reset == true && is_rtvm == true) {
+		warm_reset = false;
+		warm_reset_clear_mem = false;
+		pr_warn("A Realtime VM can't be reset in place, '--warm_reset' is invalid here.\n");
+	}
 	vmname = argv[0];
 
 	if (strnlen(vmname, MAX_VM_NAME_LEN) >= MAX_VM_NAME_LEN) {
@@ -1113,11 +1194,17 @@ main(int argc, char *argv[])
 		/* Make a copy for ctx */
 		_ctx = ctx;
 
+		if (full_reset) {
+			pr_notice("VM full reset in %ld us\n", elapsed_us(&reset_start));
+			full_reset = false;
+		}
+
 		/*
 		 * Head off to the main event dispatch loop
 		 */
 		mevent_dispatch();
 
+		clock_gettime(CLOCK_MONOTONIC, &reset_start);
 		vm_pause(ctx);
 		delete_cpu(ctx, BSP);
 
@@ -1126,6 +1213,8 @@ main(int argc, char *argv[])
 			break;
 		}
 
+		full_reset = true;
+
 		vm_deinit_vdevs(ctx);
 		mevent_deinit();
 		vm_unsetup_memory(ctx);
@@ -38,6 +38,7 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <pthread.h>
 
 
 #include "vmmapi.h"
@@ -191,6 +192,17 @@ vm_create(const char *name, uint64_t req_buf, int *vcpu_num)
 		create_vm.vm_flag &= (~GUEST_FLAG_IO_COMPLETION_POLLING);
 	}
 
+	/* the PMI of a passed through PMU goes straight to the passed through local APIC */
+	if (vpmu) {
+		if (lapic_pt)
+			create_vm.vm_flag |= GUEST_FLAG_PMU_PASSTHROUGH;
+		else
+			create_vm.vm_flag |= GUEST_FLAG_VPMU;
+	}
+
+	if (viommu)
+		create_vm.vm_flag |= GUEST_FLAG_VIOMMU;
+
 	/* command line arguments specified CPU affinity could overwrite HV's static configuration */
 	create_vm.cpu_affinity = cpu_affinity_bitmap;
 	strncpy((char *)create_vm.name, name, strnlen(name, MAX_VM_NAME_LEN));
@@ -405,6 +417,72 @@ vm_unsetup_memory(struct vmctx *ctx)
 	hugetlb_unsetup_memory(ctx);
 }
 
+#define CLEAR_MEM_THREADS	4
+
+struct clear_mem_job {
+	pthread_t	tid;
+	char		*addr;
+	size_t		len;
+	bool		started;
+};
+
+static struct clear_mem_job clear_mem_jobs[CLEAR_MEM_THREADS * 2];
+
+static void *
+clear_mem_thread(void *arg)
+{
+	struct clear_mem_job *job = arg;
+
+	bzero(job->addr, job->len);
+	return NULL;
+}
+
+static void
+clear_mem_region(struct clear_mem_job *jobs, char *addr, size_t len)
+{
+	size_t chunk = roundup2((len + CLEAR_MEM_THREADS - 1) / CLEAR_MEM_THREADS, 4 * KB);
+	size_t off;
+	int i;
+
+	for (i = 0, off = 0; (i < CLEAR_MEM_THREADS) && (off < len); i++, off += chunk) {
+		jobs[i].addr = addr + off;
+		jobs[i].len = (len - off < chunk) ? (len - off) : chunk;
+		if (pthread_create(&jobs[i].tid, NULL, clear_mem_thread, &jobs[i]) == 0) {
+			jobs[i].started = true;
+		} else {
+			/* no thread left, clear it right here */
+			bzero(jobs[i].addr, jobs[i].len);
+		}
+	}
+}
+
+/*
+ * Clear the guest memory in the background, to mitigate reset attacks on a
+ * reset which keeps the memory mapped. Nothing may be loaded into the guest
+ * memory before vm_clear_memory_wait() returns.
+ */
+void
+vm_clear_memory_start(struct vmctx *ctx)
+{
+	memset(clear_mem_jobs, 0, sizeof(clear_mem_jobs));
+	clear_mem_region(&clear_mem_jobs[0], (char *)ctx->baseaddr, ctx->lowmem);
+	clear_mem_region(&clear_mem_jobs[CLEAR_MEM_THREADS],
+			(char *)ctx->baseaddr + ctx->highmem_gpa_base, ctx->highmem);
+}
+
+void
+vm_clear_memory_wait(struct vmctx *ctx)
+{
+	int i;
+
+	for (i = 0; i < CLEAR_MEM_THREADS * 2; i++) {
+		if (clear_mem_jobs[i].started) {
+			pthread_join(clear_mem_jobs[i].tid, NULL);
+			clear_mem_jobs[i].started = false;
+		}
+	}
+}
+
 /*
  * Returns a non-NULL pointer if [gaddr, gaddr+len) is entirely contained in
  * the lowmem or highmem regions.
@@ -645,6 +723,13 @@ vm_remove_hv_vdev(struct vmctx *ctx, struct acrn_vdev *dev)
 	return error;
 }
 
+int
+vm_set_pci_cfg_shadow(struct vmctx *ctx, struct acrn_pci_cfg_shadow *shadow)
+{
+	/* The shadow is an optimization, let the caller decide how to report a failure */
+	return ioctl(ctx->fd, ACRN_IOCTL_SET_PCI_CFG_SHADOW, shadow);
+}
+
 int
 vm_set_ptdev_intx_info(struct vmctx *ctx, uint16_t virt_bdf, uint16_t phys_bdf,
 		       int virt_pin, int phys_pin, bool pic_pin)
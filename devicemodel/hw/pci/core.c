@@ -1033,6 +1033,82 @@ pci_emul_init(struct vmctx *ctx, struct pci_vdev_ops *ops, int bus, int slot,
 	return err;
 }
 
+/*
+ * The dwords of the vendor/device ID, revision/class code, subsystem ID and
+ * capability pointer registers.
+ */
+static bool
+pci_emul_is_id_reg(int coff)
+{
+	int dword = coff & ~0x3;
+
+	return (dword == PCIR_VENDOR) || (dword == PCIR_REVID) ||
+		(dword == PCIR_SUBVEND_0) || (dword == PCIR_CAP_PTR);
+}
+
+/*
+ * Let the hypervisor answer guest reads of the config space registers whose
+ * value only changes through guest writes that pci_cfgrw() emulates as plain
+ * masked stores: the identification registers and, for devices without their
+ * own cfgwrite handler, the BARs and the interrupt line register.
+ * Reads of any other register are still forwarded to the DM.
+ */
+static void
+pci_emul_set_cfg_shadow(struct vmctx *ctx, struct pci_vdev *dev, bool enable)
+{
+	struct acrn_pci_cfg_shadow shadow;
+	struct pci_vdev_ops *ops = dev->dev_ops;
+	uint64_t mask;
+	int i, idx;
+
+	if (is_pt_pci(dev) || (ops->vdev_cfgread != NULL))
+		return;
+
+	bzero(&shadow, sizeof(shadow));
+	shadow.vbdf = PCI_BDF(dev->bus, dev->slot, dev->func);
+	if (enable) {
+		shadow.cached_map |= 1UL << (PCIR_VENDOR >> 2);
+		shadow.cached_map |= 1UL << (PCIR_REVID >> 2);
+		shadow.cached_map |= 1UL << (PCIR_SUBVEND_0 >> 2);
+		shadow.cached_map |= 1UL << (PCIR_CAP_PTR >> 2);
+
+		if (ops->vdev_cfgwrite == NULL) {
+			for (i = 0; i <= PCI_BARMAX; i++) {
+				idx = PCIR_BAR(i) >> 2;
+				switch (dev->bar[i].type) {
+				case PCIBAR_IO:
+					mask = ~(dev->bar[i].size - 1) & 0xffff;
+					break;
+				case PCIBAR_MEM32:
+				case PCIBAR_MEM64:
+					mask = ~(dev->bar[i].size - 1) & 0xffffffff;
+					break;
+				case PCIBAR_MEMHI64:
+					mask = ~(dev->bar[i - 1].size - 1) >> 32;
+					break;
+				default:
+					mask = 0;
+					break;
+				}
+				shadow.wmask[idx] = (uint32_t)mask;
+				shadow.cached_map |= 1UL << idx;
+			}
+
+			shadow.wmask[PCIR_INTLINE >> 2] = 0xffffffff;
+			shadow.cached_map |= 1UL << (PCIR_INTLINE >> 2);
+		}
+
+		for (i = 0; i < ACRN_PCI_CFG_SHADOW_DWORDS; i++) {
+			if (shadow.cached_map & (1UL << i))
+				shadow.data[i] = pci_get_cfgdata32(dev, i << 2);
+		}
+	}
+
+	if (vm_set_pci_cfg_shadow(ctx, &shadow) != 0)
+		pr_dbg("%s: no config space shadow for %s: %s\n", __func__,
+			dev->name, errormsg(errno));
+}
+
 static void
 pci_emul_deinit(struct vmctx *ctx, struct pci_vdev_ops *ops, int bus, int slot,
 		int func, struct funcinfo *fi)
@@ -1043,6 +1119,7 @@ pci_emul_deinit(struct vmctx *ctx, struct pci_vdev_ops *ops, int bus, int slot,
 		free(fi->fi_param);
 
 	if (fi->fi_devi) {
+		pci_emul_set_cfg_shadow(ctx, fi->fi_devi, false);
 		pci_lintr_release(fi->fi_devi);
 		pci_emul_free_bars(fi->fi_devi);
 		pci_emul_free_msixcap(fi->fi_devi);
@@ -1505,6 +1582,7 @@ init_pci(struct vmctx *ctx)
 				if (fi->fi_devi == NULL)
 					continue;
 				pci_lintr_route(fi->fi_devi);
+				pci_emul_set_cfg_shadow(ctx, fi->fi_devi, true);
 				ops = fi->fi_devi->dev_ops;
 				if (ops && ops->vdev_phys_access)
 					ops->vdev_phys_access(ctx,
@@ -2334,6 +2412,14 @@ pci_cfgrw(struct vmctx *ctx, int vcpu, int in, int bus, int slot, int func,
 
 		pci_emul_hdrtype_fixup(bus, slot, coff, bytes, eax);
 	} else {
+		/*
+		 * The identification registers are read-only. The hypervisor
+		 * answers their reads from the shadow set up by
+		 * pci_emul_set_cfg_shadow(), keep the DM's copy the same.
+		 */
+		if (!is_pt_pci(dev) && pci_emul_is_id_reg(coff))
+			return;
+
 		/* Let the device emulation override the default handler */
 		if (ops->vdev_cfgwrite != NULL &&
 		    (*ops->vdev_cfgwrite)(ctx, vcpu, dev,
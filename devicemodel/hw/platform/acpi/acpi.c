@@ -90,6 +90,7 @@
 #define FACS_OFFSET		0x3C0
 #define NHLT_OFFSET		0x400
 #define TPM2_OFFSET		0xC00
+#define DMAR_OFFSET		0xE00
 #define RTCT_OFFSET		0xF00
 #define DSDT_OFFSET		0x1100
 
@@ -194,6 +195,10 @@ basl_fwrite_rsdt(FILE *fp, struct vmctx *ctx)
 			    basl_acpi_base + RTCT_OFFSET);
 	}
 
+	if (viommu)
+		EFPRINTF(fp, "[0004]\t\tACPI Table Address %u : %08X\n", num++,
+		    basl_acpi_base + DMAR_OFFSET);
+
 	EFFLUSH(fp);
 
 	return 0;
@@ -241,6 +246,10 @@ basl_fwrite_xsdt(FILE *fp, struct vmctx *ctx)
 			    basl_acpi_base + RTCT_OFFSET);
 	}
 
+	if (viommu)
+		EFPRINTF(fp, "[0004]\t\tACPI Table Address %u : 00000000%08X\n", num++,
+		    basl_acpi_base + DMAR_OFFSET);
+
 	EFFLUSH(fp);
 
 	return 0;
@@ -679,6 +688,48 @@ basl_fwrite_mcfg(FILE *fp, struct vmctx *ctx)
 	return 0;
 }
 
+/*
+ * One DMA remapping unit for all PCI devices, emulated by the hypervisor.
+ * Interrupt remapping is not supported, so the table doesn't list the
+ * IOAPIC.
+ */
+static int
+basl_fwrite_dmar(FILE *fp, struct vmctx *ctx)
+{
+	EFPRINTF(fp, "/*\n");
+	EFPRINTF(fp, " * dm DMAR template\n");
+	EFPRINTF(fp, " */\n");
+	EFPRINTF(fp, "[0004]\t\tSignature : \"DMAR\"\n");
+	EFPRINTF(fp, "[0004]\t\tTable Length : 00000000\n");
+	EFPRINTF(fp, "[0001]\t\tRevision : 01\n");
+	EFPRINTF(fp, "[0001]\t\tChecksum : 00\n");
+	EFPRINTF(fp, "[0006]\t\tOem ID : \"DM \"\n");
+	EFPRINTF(fp, "[0008]\t\tOem Table ID : \"DMDMAR  \"\n");
+	EFPRINTF(fp, "[0004]\t\tOem Revision : 00000001\n");
+
+	/* iasl will fill in the compiler ID/revision fields */
+	EFPRINTF(fp, "[0004]\t\tAsl Compiler ID : \"xxxx\"\n");
+	EFPRINTF(fp, "[0004]\t\tAsl Compiler Revision : 00000000\n");
+	EFPRINTF(fp, "\n");
+
+	/* 48-bit DMA addresses, no interrupt remapping */
+	EFPRINTF(fp, "[0001]\t\tHost Address Width : 2F\n");
+	EFPRINTF(fp, "[0001]\t\tFlags : 00\n");
+	EFPRINTF(fp, "[0010]\t\tReserved : 00 00 00 00 00 00 00 00 00 00\n");
+	EFPRINTF(fp, "\n");
+
+	EFPRINTF(fp, "[0002]\t\tSubtable Type : 0000 [Hardware Unit Definition]\n");
+	EFPRINTF(fp, "[0002]\t\tLength : 0010\n");
+	EFPRINTF(fp, "[0001]\t\tFlags : 01\n");
+	EFPRINTF(fp, "[0001]\t\tReserved : 00\n");
+	EFPRINTF(fp, "[0002]\t\tPCI Segment Number : 0000\n");
+	EFPRINTF(fp, "[0008]\t\tRegister Base Address : %016lX\n", VIOMMU_BASE);
+
+	EFFLUSH(fp);
+
+	return 0;
+}
+
 static int
 basl_fwrite_nhlt(FILE *fp, struct vmctx *ctx)
 {
@@ -1078,6 +1129,7 @@ static struct {
 	{ basl_fwrite_facs, FACS_OFFSET, true  },
 	{ basl_fwrite_nhlt, NHLT_OFFSET, false }, /*valid with audio ptdev*/
 	{ basl_fwrite_tpm2, TPM2_OFFSET, false },
+	{ basl_fwrite_dmar, DMAR_OFFSET, false }, /*valid with viommu*/
 	{ basl_fwrite_dsdt, DSDT_OFFSET, true  }
 };
 
@@ -1148,6 +1200,9 @@ acpi_build(struct vmctx *ctx, int ncpu)
 				basl_ftables[i].valid = true;
 		}
 
+		if ((basl_ftables[i].offset == DMAR_OFFSET) && viommu)
+			basl_ftables[i].valid = true;
+
 		if (acpi_table_is_valid(i))
 			err = basl_compile(ctx, basl_ftables[i].wsect,
 					basl_ftables[i].offset);
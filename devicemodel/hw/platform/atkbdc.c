@@ -40,6 +40,7 @@
 #include "atkbdc.h"
 #include "ps2kbd.h"
 #include "ps2mouse.h"
+#include "dm.h"
 #include "vmmapi.h"
 #include "mevent.h"
 #include "log.h"
@@ -361,7 +362,7 @@ atkbdc_sts_ctl_handler(struct vmctx *ctx, int vcpu, int in, int port,
 					KBDS_KBD_BUFFER_FULL;
 		break;
 	case KBDC_RESET:		/* Pulse "cold reset" line */
-		vm_suspend(ctx, VM_SUSPEND_FULL_RESET);
+		vm_suspend(ctx, warm_reset ? VM_SUSPEND_SYSTEM_RESET : VM_SUSPEND_FULL_RESET);
 		mevent_notify();
 		break;
 	default:
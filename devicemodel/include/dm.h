@@ -47,10 +47,13 @@ extern bool stdio_in_use;
 extern char *mac_seed;
 extern bool lapic_pt;
 extern bool is_rtvm;
+extern bool vpmu;
+extern bool viommu;
 extern bool pt_tpm2;
 extern bool ssram;
 extern bool vtpm2;
 extern bool is_winvm;
+extern bool warm_reset;
 
 /**
  * @brief Convert guest physical address to host virtual address
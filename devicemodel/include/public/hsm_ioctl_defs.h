@@ -81,6 +81,10 @@
 	_IO(ACRN_IOCTL_TYPE, 0x15)
 #define ACRN_IOCTL_SET_VCPU_REGS	\
 	_IOW(ACRN_IOCTL_TYPE, 0x16, struct acrn_vcpu_regs)
+#define ACRN_IOCTL_GET_VCPU_EXIT_STATS	\
+	_IOWR(ACRN_IOCTL_TYPE, 0x17, struct acrn_vcpu_exit_stats)
+#define ACRN_IOCTL_GET_VM_IO_STATS	\
+	_IOWR(ACRN_IOCTL_TYPE, 0x18, struct acrn_vm_io_stats)
 
 /* IRQ and Interrupts */
 #define ACRN_IOCTL_INJECT_MSI		\
@@ -125,17 +129,31 @@
 	_IOW(ACRN_IOCTL_TYPE, 0x59, struct acrn_vdev)
 #define ACRN_IOCTL_DESTROY_VDEV	\
 	_IOW(ACRN_IOCTL_TYPE, 0x5A, struct acrn_vdev)
+#define ACRN_IOCTL_SET_PCI_CFG_SHADOW	\
+	_IOW(ACRN_IOCTL_TYPE, 0x5B, struct acrn_pci_cfg_shadow)
 
 /* Power management */
 #define ACRN_IOCTL_PM_GET_CPU_STATE	\
 	_IOWR(ACRN_IOCTL_TYPE, 0x60, __u64)
 
+/* Resource Director Technology */
+#define ACRN_IOCTL_GET_RDT_MON		\
+	_IOR(ACRN_IOCTL_TYPE, 0x64, struct acrn_rdt_mon)
+#define ACRN_IOCTL_SET_RDT_CTRL		\
+	_IOW(ACRN_IOCTL_TYPE, 0x65, struct acrn_rdt_ctrl)
+
 /* HSM eventfd */
 #define ACRN_IOCTL_IOEVENTFD		\
 	_IOW(ACRN_IOCTL_TYPE, 0x70, struct acrn_ioeventfd)
 #define ACRN_IOCTL_IRQFD		\
 	_IOW(ACRN_IOCTL_TYPE, 0x71, struct acrn_irqfd)
 
+/* Trace */
+#define ACRN_IOCTL_SET_TRACE_FILTER	\
+	_IOW(ACRN_IOCTL_TYPE, 0x90, struct acrn_trace_filter)
+#define ACRN_IOCTL_SET_TRACE_FORMAT	\
+	_IOW(ACRN_IOCTL_TYPE, 0x91, struct acrn_trace_format)
+
 
 #define	ACRN_MEM_ACCESS_RIGHT_MASK	0x00000007U
 #define	ACRN_MEM_ACCESS_READ		0x00000001U
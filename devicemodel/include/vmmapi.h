@@ -112,6 +112,8 @@ int	vm_map_memseg_vma(struct vmctx *ctx, size_t len, vm_paddr_t gpa,
 	uint64_t vma, int prot);
 int	vm_setup_memory(struct vmctx *ctx, size_t len);
 void	vm_unsetup_memory(struct vmctx *ctx);
+void	vm_clear_memory_start(struct vmctx *ctx);
+void	vm_clear_memory_wait(struct vmctx *ctx);
 bool	init_hugetlb(void);
 void	uninit_hugetlb(void);
 int	hugetlb_setup_memory(struct vmctx *ctx);
@@ -138,6 +140,7 @@ int	vm_reset_ptdev_intx_info(struct vmctx *ctx, uint16_t virt_bdf,
 	uint16_t phys_bdf, int virt_pin, bool pic_pin);
 int	vm_add_hv_vdev(struct vmctx *ctx, struct acrn_vdev *dev);
 int	vm_remove_hv_vdev(struct vmctx *ctx, struct acrn_vdev *dev);
+int	vm_set_pci_cfg_shadow(struct vmctx *ctx, struct acrn_pci_cfg_shadow *shadow);
 
 int	acrn_parse_cpu_affinity(char *arg);
 uint64_t vm_get_cpu_affinity_dm(void);
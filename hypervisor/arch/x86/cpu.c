@@ -11,6 +11,7 @@
 #include <asm/mmu.h>
 #include <asm/guest/ept.h>
 #include <asm/guest/vept.h>
+#include <asm/guest/vpmu.h>
 #include <asm/vtd.h>
 #include <asm/lapic.h>
 #include <asm/irq.h>
@@ -36,6 +37,7 @@
 #include <asm/tsc.h>
 #include <ticks.h>
 #include <delay.h>
+#include <boot_work.h>
 
 #define CPU_UP_TIMEOUT		100U /* millisecond */
 #define CPU_DOWN_TIMEOUT	100U /* millisecond */
@@ -156,6 +158,8 @@ void init_pcpu_pre(bool is_bsp)
 
 		load_pcpu_state_data();
 
+		init_idle_states();
+
 		init_e820();
 
 		/* reserve ppt buffer from e820 */
@@ -276,6 +280,7 @@ void init_pcpu_post(uint16_t pcpu_id)
 #endif
 		init_pci_pdev_list(); /* init_iommu must come before this */
 		ptdev_init();
+		init_pci_vuart_rx_bufs();
 
 		if (init_sgx() != 0) {
 			panic("failed to initialize sgx!");
@@ -286,14 +291,19 @@ void init_pcpu_post(uint16_t pcpu_id)
 		 */
 		reserve_buffer_for_ept_pages();
 
+		reserve_buffer_for_viommu_pages();
+
 		init_vept();
 
+		init_vpmu_caps();
+
 		pcpu_sync = ALL_CPUS_MASK;
 		/* Start all secondary cores */
 		startup_paddr = prepare_trampoline();
 		if (!start_pcpus(AP_MASK)) {
 			panic("Failed to start all secondary cores!");
 		}
+		boot_phase("APs started", ACRN_INVALID_VMID);
 
 		ASSERT(get_pcpu_id() == BSP_CPU_ID, "");
 	} else {
@@ -454,11 +464,6 @@ void stop_pcpus(void)
 	wait_pcpus_offline(mask);
 }
 
-void cpu_do_idle(void)
-{
-	asm_pause();
-}
-
 /**
  * only run on current pcpu
  */
@@ -506,18 +511,6 @@ static void print_hv_banner(void)
 	printf(boot_msg);
 }
 
-static
-inline void asm_monitor(volatile const uint64_t *addr, uint64_t ecx, uint64_t edx)
-{
-	asm volatile("monitor\n" : : "a" (addr), "c" (ecx), "d" (edx));
-}
-
-static
-inline void asm_mwait(uint64_t eax, uint64_t ecx)
-{
-	asm volatile("mwait\n" : : "a" (eax), "c" (ecx));
-}
-
 /* wait until *sync == wake_sync */
 void wait_sync_change(volatile const uint64_t *sync, uint64_t wake_sync)
 {
@@ -76,6 +76,11 @@ static struct page ept_dummy_pages[CONFIG_MAX_VM_NUM];
 /* ept: extended page pool*/
 static struct page_pool ept_page_pool[CONFIG_MAX_VM_NUM];
 
+uint64_t get_ept_used_page_num(uint16_t vm_id)
+{
+	return get_used_page_num(&ept_page_pool[vm_id]);
+}
+
 static void reserve_ept_bitmap(void)
 {
 	uint32_t i;
@@ -334,6 +339,8 @@ void ept_add_mr(struct acrn_vm *vm, uint64_t *pml4_page,
 	spinlock_release(&vm->ept_lock);
 
 	ept_flush_guest(vm);
+	/* the guest may have IOVAs mapped to these GPAs already */
+	viommu_ept_changed(vm, gpa, size);
 }
 
 void ept_modify_mr(struct acrn_vm *vm, uint64_t *pml4_page,
@@ -351,6 +358,10 @@ void ept_modify_mr(struct acrn_vm *vm, uint64_t *pml4_page,
 	spinlock_release(&vm->ept_lock);
 
 	ept_flush_guest(vm);
+	/* the shadow entries of a vIOMMU only take the access rights */
+	if (((prot_set | prot_clr) & (EPT_RD | EPT_WR)) != 0UL) {
+		viommu_ept_changed(vm, gpa, size);
+	}
 }
 /**
  * @pre [gpa,gpa+size) has been mapped into host physical memory region
@@ -366,6 +377,8 @@ void ept_del_mr(struct acrn_vm *vm, uint64_t *pml4_page, uint64_t gpa, uint64_t
 	spinlock_release(&vm->ept_lock);
 
 	ept_flush_guest(vm);
+	/* the shadow entries of a vIOMMU may still point to the old HPAs */
+	viommu_ept_changed(vm, gpa, size);
 }
 
 /**
@@ -14,6 +14,8 @@
 #include <asm/guest/vmcs.h>
 #include <asm/guest/nested.h>
 #include <asm/guest/vept.h>
+#include <asm/guest/vmexit.h>
+#include <ticks.h>
 
 /* Cache the content of MSR_IA32_VMX_BASIC */
 static uint32_t vmx_basic;
@@ -713,13 +715,14 @@ static void reset_vvmcs(struct acrn_vcpu *vcpu)
 	uint32_t idx;
 
 	vcpu->arch.nested.current_vvmcs = NULL;
+	vcpu->arch.nested.lru_clock = 0UL;
 
 	for (idx = 0U; idx < MAX_ACTIVE_VVMCS_NUM; idx++) {
 		vvmcs = &vcpu->arch.nested.vvmcs[idx];
 		vvmcs->host_state_dirty = false;
-		vvmcs->control_fields_dirty = false;
+		vvmcs->control_fields_dirty = 0U;
 		vvmcs->vmcs12_gpa = INVALID_GPA;
-		vvmcs->ref_cnt = 0;
+		vvmcs->last_used = 0UL;
 
 		(void)memset(vvmcs->vmcs02, 0U, PAGE_SIZE);
 		(void)memset(&vvmcs->vmcs12, 0U, sizeof(struct acrn_vmcs12));
@@ -850,7 +853,8 @@ static struct acrn_vvmcs *get_or_replace_vvmcs_entry(struct acrn_vcpu *vcpu)
 {
 	struct acrn_nested *nested = &vcpu->arch.nested;
 	struct acrn_vvmcs *vvmcs = NULL;
-	uint32_t idx, min_cnt = ~0U;
+	uint64_t oldest = ~0UL;
+	uint32_t idx;
 
 	/* look for an inactive entry first */
 	for (idx = 0U; idx < MAX_ACTIVE_VVMCS_NUM; idx++) {
@@ -864,9 +868,9 @@ static struct acrn_vvmcs *get_or_replace_vvmcs_entry(struct acrn_vcpu *vcpu)
 	/* In case we have to release an active entry to make room for the new VMCS12 */
 	if (vvmcs == NULL) {
 		for (idx = 0U; idx < MAX_ACTIVE_VVMCS_NUM; idx++) {
-			/* look for the entry with least reference count */
-			if (nested->vvmcs[idx].ref_cnt < min_cnt) {
-				min_cnt = nested->vvmcs[idx].ref_cnt;
+			/* evict the least recently VMPTRLDed entry */
+			if (nested->vvmcs[idx].last_used < oldest) {
+				oldest = nested->vvmcs[idx].last_used;
 				vvmcs = &nested->vvmcs[idx];
 			}
 		}
@@ -874,11 +878,6 @@ static struct acrn_vvmcs *get_or_replace_vvmcs_entry(struct acrn_vcpu *vcpu)
 		clear_vvmcs(vcpu, vvmcs);
 	}
 
-	/* reset ref_cnt for all entries */
-	for (idx = 0U; idx < MAX_ACTIVE_VVMCS_NUM; idx++) {
-		nested->vvmcs[idx].ref_cnt = 0U;
-	}
-
 	return vvmcs;
 }
 
@@ -917,6 +916,36 @@ int32_t vmread_vmexit_handler(struct acrn_vcpu *vcpu)
 	return 0;
 }
 
+/*
+ * @return the VMCS12_DIRTY_xxx group the non-shadowed control field belongs
+ *	   to, 0 if the field isn't merged into VMCS02 at L2 VM entry
+ */
+static uint32_t get_control_field_group(uint32_t vmcs_field)
+{
+	uint32_t group;
+
+	switch (vmcs_field) {
+	case VMX_MSR_BITMAP_FULL:
+		group = VMCS12_DIRTY_MSR_BITMAP;
+		break;
+	case VMX_EPT_POINTER_FULL:
+		group = VMCS12_DIRTY_EPTP;
+		break;
+	case VMX_ENTRY_CONTROLS:
+	case VMX_EXIT_CONTROLS:
+		group = VMCS12_DIRTY_ENTRY_EXIT_CTLS;
+		break;
+	case VMX_VPID:
+		group = VMCS12_DIRTY_VPID;
+		break;
+	default:
+		group = 0U;
+		break;
+	}
+
+	return group;
+}
+
 /*
  * @brief emulate VMWRITE instruction from L1
  * @pre vcpu != NULL
@@ -951,18 +980,11 @@ int32_t vmwrite_vmexit_handler(struct acrn_vcpu *vcpu)
 					cur_vvmcs->host_state_dirty = true;
 				}
 
-				if ((vmcs_field == VMX_MSR_BITMAP_FULL)
-					|| (vmcs_field == VMX_EPT_POINTER_FULL)
-					|| (vmcs_field == VMX_VPID)
-					|| (vmcs_field == VMX_ENTRY_CONTROLS)
-					|| (vmcs_field == VMX_EXIT_CONTROLS)) {
-					cur_vvmcs->control_fields_dirty = true;
-
-					if (vmcs_field == VMX_EPT_POINTER_FULL) {
-						if (cur_vvmcs->vmcs12.ept_pointer != vmcs_value) {
-							put_vept_desc(cur_vvmcs->vmcs12.ept_pointer);
-							get_vept_desc(vmcs_value);
-						}
+				cur_vvmcs->control_fields_dirty |= get_control_field_group(vmcs_field);
+				if (vmcs_field == VMX_EPT_POINTER_FULL) {
+					if (cur_vvmcs->vmcs12.ept_pointer != vmcs_value) {
+						put_vept_desc(cur_vvmcs->vmcs12.ept_pointer);
+						get_vept_desc(vmcs_value);
 					}
 				}
 
@@ -994,36 +1016,48 @@ static void sync_vmcs02_to_vmcs12(struct acrn_vmcs12 *vmcs12)
 }
 
 /*
+ * Only the VMCS12_DIRTY_xxx groups in @dirty are rewritten, the other merged
+ * fields of VMCS02 are still up to date.
+ *
  * @pre vcpu != NULL
  * @pre VMCS02 (as an ordinary VMCS) is current
  */
-static void merge_and_sync_control_fields(struct acrn_vcpu *vcpu, struct acrn_vmcs12 *vmcs12)
+static void merge_and_sync_control_fields(struct acrn_vcpu *vcpu, struct acrn_vmcs12 *vmcs12, uint32_t dirty)
 {
 	uint64_t value64;
 
 	/* Sync VMCS fields that are not shadowing. Don't need to sync these fields back to VMCS12. */
 
-	exec_vmwrite(VMX_MSR_BITMAP_FULL, gpa2hpa(vcpu->vm, vmcs12->msr_bitmap));
-	exec_vmwrite(VMX_EPT_POINTER_FULL, get_shadow_eptp(vmcs12->ept_pointer));
+	if ((dirty & VMCS12_DIRTY_MSR_BITMAP) != 0U) {
+		exec_vmwrite(VMX_MSR_BITMAP_FULL, gpa2hpa(vcpu->vm, vmcs12->msr_bitmap));
+	}
 
-	/* For VM-execution, entry and exit controls */
-	value64 = vmcs12->vm_entry_controls;
-	if ((value64 & VMX_ENTRY_CTLS_LOAD_EFER) != VMX_ENTRY_CTLS_LOAD_EFER) {
-		/*
-		 * L1 hypervisor wishes to use its IA32_EFER for L2 guest so we turn on the
-		 * VMX_ENTRY_CTLS_LOAD_EFER on VMCS02.
-		 */
-		value64 |= VMX_ENTRY_CTLS_LOAD_EFER;
-		exec_vmwrite(VMX_GUEST_IA32_EFER_FULL, vcpu_get_efer(vcpu));
+	if ((dirty & VMCS12_DIRTY_EPTP) != 0U) {
+		exec_vmwrite(VMX_EPT_POINTER_FULL, get_shadow_eptp(vmcs12->ept_pointer));
 	}
 
-	exec_vmwrite(VMX_ENTRY_CONTROLS, value64);
+	/* For VM-execution, entry and exit controls */
+	if ((dirty & VMCS12_DIRTY_ENTRY_EXIT_CTLS) != 0U) {
+		value64 = vmcs12->vm_entry_controls;
+		if ((value64 & VMX_ENTRY_CTLS_LOAD_EFER) != VMX_ENTRY_CTLS_LOAD_EFER) {
+			/*
+			 * L1 hypervisor wishes to use its IA32_EFER for L2 guest so we turn on the
+			 * VMX_ENTRY_CTLS_LOAD_EFER on VMCS02.
+			 */
+			value64 |= VMX_ENTRY_CTLS_LOAD_EFER;
+			exec_vmwrite(VMX_GUEST_IA32_EFER_FULL, vcpu_get_efer(vcpu));
+		}
 
-	/* Host is alway runing in 64-bit mode */
-	value64 = vmcs12->vm_exit_controls | VMX_EXIT_CTLS_HOST_ADDR64;
-	exec_vmwrite(VMX_EXIT_CONTROLS, value64);
+		exec_vmwrite(VMX_ENTRY_CONTROLS, value64);
 
-	exec_vmwrite(VMX_VPID, vmcs12->vpid);
+		/* Host is alway runing in 64-bit mode */
+		value64 = vmcs12->vm_exit_controls | VMX_EXIT_CTLS_HOST_ADDR64;
+		exec_vmwrite(VMX_EXIT_CONTROLS, value64);
+	}
+
+	if ((dirty & VMCS12_DIRTY_VPID) != 0U) {
+		exec_vmwrite(VMX_VPID, vmcs12->vpid);
+	}
 }
 
 /**
@@ -1042,7 +1076,7 @@ static void sync_vmcs12_to_vmcs02(struct acrn_vcpu *vcpu, struct acrn_vmcs12 *vm
 		exec_vmwrite(vmcs_shadowing_fields[idx], val64);
 	}
 
-	merge_and_sync_control_fields(vcpu, vmcs12);
+	merge_and_sync_control_fields(vcpu, vmcs12, VMCS12_DIRTY_ALL);
 }
 
 /*
@@ -1111,6 +1145,8 @@ static void disable_vmcs_shadowing(void)
  */
 static void clear_vvmcs(struct acrn_vcpu *vcpu, struct acrn_vvmcs *vvmcs)
 {
+	uint64_t start = cpu_ticks();
+
 	/*
 	 * Now VMCS02 is active and being used as a shadow VMCS.
 	 * Disable VMCS shadowing to avoid VMCS02 will be loaded by VMPTRLD
@@ -1143,7 +1179,9 @@ static void clear_vvmcs(struct acrn_vcpu *vcpu, struct acrn_vvmcs *vvmcs)
 
 	/* Cleanup per VVMCS dirty flags */
 	vvmcs->host_state_dirty = false;
-	vvmcs->control_fields_dirty = false;
+	vvmcs->control_fields_dirty = 0U;
+
+	account_exit_stat(&vcpu->arch.nested.stats[NESTED_STAT_VMCS12_FLUSH], cpu_ticks() - start);
 }
 
 /*
@@ -1153,7 +1191,7 @@ int32_t vmptrld_vmexit_handler(struct acrn_vcpu *vcpu)
 {
 	struct acrn_nested *nested = &vcpu->arch.nested;
 	struct acrn_vvmcs *vvmcs;
-	uint64_t vmcs12_gpa;
+	uint64_t vmcs12_gpa, start;
 
 	if (check_vmx_permission(vcpu)) {
 		vmcs12_gpa = get_vmptr_gpa(vcpu);
@@ -1170,6 +1208,7 @@ int32_t vmptrld_vmexit_handler(struct acrn_vcpu *vcpu)
 		} else {
 			vvmcs = lookup_vvmcs(vcpu, vmcs12_gpa);
 			if (vvmcs == NULL) {
+				start = cpu_ticks();
 				vvmcs = get_or_replace_vvmcs_entry(vcpu);
 
 				/* Create the VMCS02 based on this new VMCS12 */
@@ -1193,10 +1232,12 @@ int32_t vmptrld_vmexit_handler(struct acrn_vcpu *vcpu)
 
 				/* Need to load shadow fields from this new VMCS12 to VMCS02 */
 				sync_vmcs12_to_vmcs02(vcpu, &vvmcs->vmcs12);
-			} else {
-				vvmcs->ref_cnt += 1U;
+
+				account_exit_stat(&nested->stats[NESTED_STAT_VMPTRLD_MISS], cpu_ticks() - start);
 			}
 
+			vvmcs->last_used = ++nested->lru_clock;
+
 			/* Before VMCS02 is being used as a shadow VMCS, VMCLEAR it */
 			clear_va_vmcs(vvmcs->vmcs02);
 
@@ -1424,10 +1465,14 @@ static void sanitize_l2_vpid(struct acrn_vmcs12 *vmcs12)
 int32_t nested_vmexit_handler(struct acrn_vcpu *vcpu)
 {
 	struct acrn_vvmcs *cur_vvmcs = vcpu->arch.nested.current_vvmcs;
+	uint64_t start = cpu_ticks();
 	bool is_l1_vmexit = true;
 
 	if ((vcpu->arch.exit_reason & 0xFFFFU) == VMX_EXIT_REASON_EPT_VIOLATION) {
 		is_l1_vmexit = handle_l2_ept_violation(vcpu);
+		if (!is_l1_vmexit) {
+			account_exit_stat(&vcpu->arch.nested.stats[NESTED_STAT_EPT], cpu_ticks() - start);
+		}
 	}
 
 	if (is_l1_vmexit) {
@@ -1448,6 +1493,8 @@ int32_t nested_vmexit_handler(struct acrn_vcpu *vcpu)
 
 		/* vCPU is NOT in guest mode from this point */
 		vcpu->arch.nested.in_l2_guest = false;
+
+		account_exit_stat(&vcpu->arch.nested.stats[NESTED_STAT_EXIT], cpu_ticks() - start);
 	}
 
 	/*
@@ -1472,6 +1519,7 @@ static void nested_vmentry(struct acrn_vcpu *vcpu, bool is_launch)
 {
 	struct acrn_vvmcs *cur_vvmcs = vcpu->arch.nested.current_vvmcs;
 	struct acrn_vmcs12 *vmcs12 = &cur_vvmcs->vmcs12;
+	uint64_t start = cpu_ticks();
 
 	if ((cur_vvmcs == NULL) || (cur_vvmcs->vmcs12_gpa == INVALID_GPA)) {
 		nested_vmx_result(VMfailInvalid, 0);
@@ -1496,9 +1544,9 @@ static void nested_vmentry(struct acrn_vcpu *vcpu, bool is_launch)
 		/* as an ordinary VMCS, VMCS02 is active and currernt when L2 guest is running */
 		load_va_vmcs(cur_vvmcs->vmcs02);
 
-		if (cur_vvmcs->control_fields_dirty) {
-			cur_vvmcs->control_fields_dirty = false;
-			merge_and_sync_control_fields(vcpu, vmcs12);
+		if (cur_vvmcs->control_fields_dirty != 0U) {
+			merge_and_sync_control_fields(vcpu, vmcs12, cur_vvmcs->control_fields_dirty);
+			cur_vvmcs->control_fields_dirty = 0U;
 		}
 
 		/* vCPU is in guest mode from this point */
@@ -1515,6 +1563,8 @@ static void nested_vmentry(struct acrn_vcpu *vcpu, bool is_launch)
 		 * clear at this moment, even for VMRESUME
 		 */
 		vcpu->launched = false;
+
+		account_exit_stat(&vcpu->arch.nested.stats[NESTED_STAT_ENTRY], cpu_ticks() - start);
 	}
 }
 
@@ -0,0 +1,571 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <types.h>
+#include <errno.h>
+#include <logmsg.h>
+#include <asm/lib/bits.h>
+#include <asm/lib/spinlock.h>
+#include <asm/cpu.h>
+#include <asm/per_cpu.h>
+#include <asm/rdt.h>
+#include <asm/board.h>
+#include <asm/vm_config.h>
+#include <asm/guest/vm.h>
+#include <asm/guest/rdt_ctrl.h>
+#include <timer.h>
+#include <ticks.h>
+
+#ifdef CONFIG_RDT_ENABLED
+#define RDT_LINE_SIZE		64UL
+#define RDT_MBA_STEP		10U
+#define RDT_MAX_PERIOD_MS	10000U
+
+struct rdt_vm_mon {
+	bool started;
+	uint64_t last_total;	/* raw MBM counters at the last sample */
+	uint64_t last_local;
+	uint64_t mbm_total;	/* bytes since the first sample */
+	uint64_t mbm_local;
+	uint64_t occupancy;
+};
+
+static struct rdt_ctrl {
+	spinlock_t lock;
+	struct hv_timer timer;
+	uint16_t timer_pcpu;	/* the pCPU the timer stays on, INVALID_CPU_ID until it's armed */
+	bool enabled;
+
+	uint16_t rt_vm_id;
+	uint64_t be_vms;	/* bitmap of absolute VM ids */
+	uint64_t period;	/* in TSC ticks */
+	uint64_t target;	/* lines per ms */
+	uint16_t min_ways;
+	uint16_t max_mba_delay;
+
+	/* current throttling of each best effort VM */
+	uint16_t ways_cut;
+	uint16_t mba_extra;
+
+	uint64_t last_tsc;
+	uint64_t last_rt_total;
+	uint64_t rt_miss_rate;
+	uint64_t nr_throttle;
+	uint64_t nr_relax;
+
+	/* the CLOS configuration before the loop took over */
+	uint32_t saved_l3[MAX_CACHE_CLOS_NUM_ENTRIES];
+	uint16_t saved_mba[MAX_MBA_CLOS_NUM_ENTRIES];
+
+	struct rdt_vm_mon vms[CONFIG_MAX_VM_NUM];
+} rdt_ctrl = {
+	.lock = { .head = 0U, .tail = 0U, },
+	.timer_pcpu = INVALID_CPU_ID,
+};
+
+void get_cache_shift(uint32_t *l2_shift, uint32_t *l3_shift);
+/*
+ * The counters and the CLOS MSRs are per L3 domain, they are read and
+ * written on whichever pCPU the hypercall or the timer runs. That's only
+ * meaningful if all pCPUs share one L3.
+ */
+static bool is_single_l3_domain(void)
+{
+	uint32_t l2_shift, l3_shift;
+	uint16_t pcpu_id;
+	bool ret = true;
+
+	get_cache_shift(&l2_shift, &l3_shift);
+	for (pcpu_id = 1U; pcpu_id < get_pcpu_nums(); pcpu_id++) {
+		if ((per_cpu(lapic_id, pcpu_id) >> l3_shift) != (per_cpu(lapic_id, BSP_CPU_ID) >> l3_shift)) {
+			ret = false;
+			break;
+		}
+	}
+
+	return ret;
+}
+
+static bool is_rdt_mon_usable(void)
+{
+	return is_rdt_mon_capable() && is_single_l3_domain();
+}
+
+static uint16_t vm_clos(uint16_t vm_id)
+{
+	const struct acrn_vm_config *cfg = get_vm_config(vm_id);
+
+	return (cfg->pclosids != NULL) ? cfg->pclosids[0] : hv_clos;
+}
+
+/*
+ * Only VMs which switch MSR_IA32_PQR_ASSOC carry their RMID, see prepare_auto_msr_area()
+ */
+static uint32_t monitored_rmid(const struct acrn_vm *vm)
+{
+	uint32_t rmid = 0U;
+
+	if (is_vcat_configured(vm) || (vm_clos(vm->vm_id) != hv_clos)) {
+		rmid = vm_rmid(vm->vm_id);
+	}
+
+	return rmid;
+}
+
+/* @return the bytes counted by a MBM counter between two samples, the counter wraps */
+static uint64_t mbm_delta(uint64_t cur, uint64_t last)
+{
+	const struct rdt_mon_info *info = get_rdt_mon_info();
+
+	return ((cur - last) & ((1UL << info->mbm_width) - 1UL)) * info->upscale;
+}
+
+static void accumulate_mbm(uint64_t cur, uint64_t *last, uint64_t *sum, bool started)
+{
+	if (cur != RDT_MON_INVALID) {
+		if (started && (*last != RDT_MON_INVALID)) {
+			*sum += mbm_delta(cur, *last);
+		}
+		*last = cur;
+	}
+}
+
+/*
+ * MBM counters wrap after 2^mbm_width units, so the totals are only exact if
+ * they are sampled often enough; the control loop does it every period.
+ *
+ * @pre rdt_ctrl.lock is held
+ */
+static void sample_vms(void)
+{
+	const struct rdt_mon_info *info = get_rdt_mon_info();
+	struct rdt_vm_mon *mon;
+	struct acrn_vm *vm;
+	uint32_t rmid;
+	uint64_t occ;
+	uint16_t vm_id;
+
+	for (vm_id = 0U; vm_id < CONFIG_MAX_VM_NUM; vm_id++) {
+		vm = get_vm_from_vmid(vm_id);
+		rmid = monitored_rmid(vm);
+		if (!is_poweroff_vm(vm) && (rmid != 0U)) {
+			mon = &rdt_ctrl.vms[vm_id];
+			occ = rdt_read_mon_counter(rmid, RDT_MON_EVT_OCCUPANCY);
+			mon->occupancy = (occ != RDT_MON_INVALID) ? (occ * info->upscale) : 0UL;
+			accumulate_mbm(rdt_read_mon_counter(rmid, RDT_MON_EVT_MBM_TOTAL),
+				&mon->last_total, &mon->mbm_total, mon->started);
+			accumulate_mbm(rdt_read_mon_counter(rmid, RDT_MON_EVT_MBM_LOCAL),
+				&mon->last_local, &mon->mbm_local, mon->started);
+			mon->started = true;
+		}
+	}
+}
+
+/*
+ * Take 'cut' ways off a contiguous CBM, at most down to min_ways, from the
+ * side facing the RT VM's CBM.
+ */
+static uint32_t shrink_cbm(uint32_t cbm, uint32_t rt_cbm, uint16_t cut, uint16_t min_ways)
+{
+	uint16_t ways = bitmap_weight((uint64_t)cbm);
+	uint16_t keep = ways;
+	uint32_t ret = cbm;
+
+	if (ways > min_ways) {
+		keep = (ways > (min_ways + cut)) ? (ways - cut) : min_ways;
+	}
+
+	if (keep < ways) {
+		if (ffs64((uint64_t)rt_cbm) > ffs64((uint64_t)cbm)) {
+			/* the RT VM sits above, give up the high ways */
+			ret = ((1U << keep) - 1U) << ffs64((uint64_t)cbm);
+		} else {
+			ret = ((1U << keep) - 1U) << ((fls32(cbm) + 1U) - keep);
+		}
+	}
+
+	return ret;
+}
+
+/* @pre rdt_ctrl.lock is held */
+static void apply_be_clos(void)
+{
+	const struct rdt_info *mba = get_rdt_res_cap_info(RDT_RESOURCE_MBA);
+	uint32_t rt_cbm = rdt_ctrl.saved_l3[vm_clos(rdt_ctrl.rt_vm_id)];
+	struct acrn_vm_config *cfg;
+	uint16_t vm_id, i, clos, delay;
+
+	for (vm_id = 0U; vm_id < CONFIG_MAX_VM_NUM; vm_id++) {
+		if (bitmap_test(vm_id, &rdt_ctrl.be_vms)) {
+			cfg = get_vm_config(vm_id);
+			for (i = 0U; i < cfg->num_pclosids; i++) {
+				clos = cfg->pclosids[i];
+				rdt_write_clos_msr(RDT_RESOURCE_L3, clos, shrink_cbm(rdt_ctrl.saved_l3[clos],
+					rt_cbm, rdt_ctrl.ways_cut, rdt_ctrl.min_ways));
+				if (mba->num_closids != 0U) {
+					delay = rdt_ctrl.saved_mba[clos];
+					if (delay < rdt_ctrl.max_mba_delay) {
+						delay = min(delay + rdt_ctrl.mba_extra, rdt_ctrl.max_mba_delay);
+					}
+					rdt_write_clos_msr(RDT_RESOURCE_MBA, clos, delay);
+				}
+			}
+		}
+	}
+}
+
+/* @pre rdt_ctrl.lock is held */
+static void restore_clos(void)
+{
+	const struct rdt_info *mba = get_rdt_res_cap_info(RDT_RESOURCE_MBA);
+	uint16_t clos;
+
+	for (clos = 0U; clos < get_rdt_num_closids(); clos++) {
+		rdt_write_clos_msr(RDT_RESOURCE_L3, clos, rdt_ctrl.saved_l3[clos]);
+		if (mba->num_closids != 0U) {
+			rdt_write_clos_msr(RDT_RESOURCE_MBA, clos, rdt_ctrl.saved_mba[clos]);
+		}
+	}
+}
+
+/* @pre rdt_ctrl.lock is held */
+static bool can_cut_way(void)
+{
+	struct acrn_vm_config *cfg;
+	uint16_t vm_id, i;
+	bool ret = false;
+
+	for (vm_id = 0U; (vm_id < CONFIG_MAX_VM_NUM) && !ret; vm_id++) {
+		if (bitmap_test(vm_id, &rdt_ctrl.be_vms)) {
+			cfg = get_vm_config(vm_id);
+			for (i = 0U; i < cfg->num_pclosids; i++) {
+				if (bitmap_weight(rdt_ctrl.saved_l3[cfg->pclosids[i]]) >
+						(rdt_ctrl.min_ways + rdt_ctrl.ways_cut)) {
+					ret = true;
+				}
+			}
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * Cache ways go first, since they act on the RT VM's misses directly; memory
+ * bandwidth throttling only helps once the best effort VMs can't be squeezed
+ * any further. Relaxing is done in the reverse order.
+ *
+ * @pre rdt_ctrl.lock is held
+ * @return true if the CLOS settings have been changed
+ */
+static bool throttle_be_vms(void)
+{
+	bool ret = true;
+
+	if (can_cut_way()) {
+		rdt_ctrl.ways_cut++;
+	} else if (rdt_ctrl.mba_extra < rdt_ctrl.max_mba_delay) {
+		rdt_ctrl.mba_extra = min(rdt_ctrl.mba_extra + RDT_MBA_STEP, rdt_ctrl.max_mba_delay);
+	} else {
+		ret = false;
+	}
+
+	return ret;
+}
+
+/* @pre rdt_ctrl.lock is held */
+static bool relax_be_vms(void)
+{
+	bool ret = true;
+
+	if (rdt_ctrl.mba_extra > 0U) {
+		rdt_ctrl.mba_extra = (rdt_ctrl.mba_extra > RDT_MBA_STEP) ? (rdt_ctrl.mba_extra - RDT_MBA_STEP) : 0U;
+	} else if (rdt_ctrl.ways_cut > 0U) {
+		rdt_ctrl.ways_cut--;
+	} else {
+		ret = false;
+	}
+
+	return ret;
+}
+
+/*
+ * There is no per RMID miss counter, the RT VM's memory traffic is the best
+ * proxy for its LLC misses: every line it reads from or writes back to
+ * memory missed or was evicted from the L3.
+ *
+ * @pre rdt_ctrl.lock is held
+ */
+static void run_ctrl_loop(void)
+{
+	uint64_t now = cpu_ticks();
+	uint64_t ms = (now - rdt_ctrl.last_tsc) / TICKS_PER_MS;
+	uint64_t total;
+	bool changed = false;
+
+	sample_vms();
+	if (ms != 0UL) {
+		total = rdt_ctrl.vms[rdt_ctrl.rt_vm_id].mbm_total;
+		rdt_ctrl.rt_miss_rate = ((total - rdt_ctrl.last_rt_total) / RDT_LINE_SIZE) / ms;
+		rdt_ctrl.last_rt_total = total;
+		rdt_ctrl.last_tsc = now;
+
+		if (rdt_ctrl.rt_miss_rate > rdt_ctrl.target) {
+			if (throttle_be_vms()) {
+				rdt_ctrl.nr_throttle++;
+				changed = true;
+			}
+		} else if ((rdt_ctrl.rt_miss_rate * 4UL) < (rdt_ctrl.target * 3UL)) {
+			/* hysteresis, give back only when well below the target */
+			if (relax_be_vms()) {
+				rdt_ctrl.nr_relax++;
+				changed = true;
+			}
+		} else {
+			/* within the target band */
+		}
+
+		if (changed) {
+			apply_be_clos();
+		}
+	}
+}
+
+/* @pre rdt_ctrl.lock is held */
+static void stop_ctrl_loop(void)
+{
+	if (rdt_ctrl.enabled) {
+		restore_clos();
+		rdt_ctrl.enabled = false;
+	}
+}
+
+/*
+ * Timer lists are per pCPU and the hypercall may come in on any of them, so
+ * the timer is armed once, on the pCPU of the first enable, and stays
+ * periodic. Only this callback changes it afterwards, on its own pCPU.
+ * While disabled it just polls every RDT_MAX_PERIOD_MS; a new period is
+ * picked up at the next expiry.
+ */
+static void rdt_ctrl_timer_fn(__unused void *data)
+{
+	uint64_t rflags;
+
+	spinlock_irqsave_obtain(&rdt_ctrl.lock, &rflags);
+	if (rdt_ctrl.enabled && is_poweroff_vm(get_vm_from_vmid(rdt_ctrl.rt_vm_id))) {
+		pr_acrnlog("rdt: RT VM%hu is gone, stop the control loop", rdt_ctrl.rt_vm_id);
+		stop_ctrl_loop();
+	}
+
+	if (rdt_ctrl.enabled) {
+		update_timer(&rdt_ctrl.timer, rdt_ctrl.timer.timeout, rdt_ctrl.period);
+		run_ctrl_loop();
+	} else {
+		update_timer(&rdt_ctrl.timer, rdt_ctrl.timer.timeout, (uint64_t)RDT_MAX_PERIOD_MS * TICKS_PER_MS);
+	}
+	spinlock_irqrestore_release(&rdt_ctrl.lock, rflags);
+}
+
+static bool is_be_vm_valid(uint16_t vm_id, uint16_t rt_vm_id, uint16_t num_closids)
+{
+	const struct acrn_vm_config *cfg = get_vm_config(vm_id);
+	const struct acrn_vm_config *rt_cfg = get_vm_config(rt_vm_id);
+	uint16_t i, j;
+	bool ret = (vm_id != rt_vm_id) && (cfg->pclosids != NULL) && !is_vcat_configured(get_vm_from_vmid(vm_id));
+
+	/* the CLOS being resized must not be shared with the RT VM or the hypervisor */
+	for (i = 0U; ret && (i < cfg->num_pclosids); i++) {
+		ret = (cfg->pclosids[i] < num_closids) && (cfg->pclosids[i] != hv_clos);
+		for (j = 0U; ret && (j < rt_cfg->num_pclosids); j++) {
+			ret = (cfg->pclosids[i] != rt_cfg->pclosids[j]);
+		}
+	}
+
+	return ret;
+}
+
+/* @pre rdt_ctrl.lock is held */
+static int32_t check_ctrl(uint16_t rt_vm_id, uint64_t be_vms, const struct acrn_rdt_ctrl *ctrl)
+{
+	const struct rdt_info *l3 = get_rdt_res_cap_info(RDT_RESOURCE_L3);
+	const struct rdt_info *mba = get_rdt_res_cap_info(RDT_RESOURCE_MBA);
+	struct acrn_vm *rt_vm;
+	uint16_t vm_id;
+	int32_t ret = 0;
+
+	if ((l3->num_closids == 0U) || l3->res.cache.is_cdp_enabled ||
+			((get_rdt_mon_info()->events & (1U << RDT_MON_EVT_MBM_TOTAL)) == 0U)) {
+		ret = -ENODEV;
+	} else if ((rt_vm_id >= CONFIG_MAX_VM_NUM) || (be_vms == 0UL) || (ctrl->period_ms == 0U) ||
+			(ctrl->period_ms > RDT_MAX_PERIOD_MS) || (ctrl->min_ways == 0U) ||
+			(ctrl->max_mba_delay > ((mba->num_closids != 0U) ? mba->res.membw.mba_max : 0U))) {
+		ret = -EINVAL;
+	} else {
+		rt_vm = get_vm_from_vmid(rt_vm_id);
+		/* the RT VM's CBM is read from saved_l3[] */
+		if (is_poweroff_vm(rt_vm) || is_vcat_configured(rt_vm) || (monitored_rmid(rt_vm) == 0U) ||
+				(vm_clos(rt_vm_id) >= get_rdt_num_closids())) {
+			ret = -EINVAL;
+		}
+		for (vm_id = 0U; (ret == 0) && (vm_id < CONFIG_MAX_VM_NUM); vm_id++) {
+			if (bitmap_test(vm_id, &be_vms) && !is_be_vm_valid(vm_id, rt_vm_id, get_rdt_num_closids())) {
+				ret = -EINVAL;
+			}
+		}
+	}
+
+	return ret;
+}
+
+/* @pre rdt_ctrl.lock is held */
+static void start_ctrl_loop(uint16_t rt_vm_id, uint64_t be_vms, const struct acrn_rdt_ctrl *ctrl)
+{
+	const struct rdt_info *l3 = get_rdt_res_cap_info(RDT_RESOURCE_L3);
+	const struct rdt_info *mba = get_rdt_res_cap_info(RDT_RESOURCE_MBA);
+	uint16_t clos;
+
+	for (clos = 0U; clos < get_rdt_num_closids(); clos++) {
+		rdt_ctrl.saved_l3[clos] = l3->platform_clos_array[clos].value.clos_mask;
+		if (mba->num_closids != 0U) {
+			rdt_ctrl.saved_mba[clos] = mba->platform_clos_array[clos].value.mba_delay;
+		}
+	}
+
+	rdt_ctrl.rt_vm_id = rt_vm_id;
+	rdt_ctrl.be_vms = be_vms;
+	rdt_ctrl.period = (uint64_t)ctrl->period_ms * TICKS_PER_MS;
+	rdt_ctrl.target = ctrl->target_miss_rate;
+	rdt_ctrl.min_ways = ctrl->min_ways;
+	rdt_ctrl.max_mba_delay = ctrl->max_mba_delay;
+	rdt_ctrl.ways_cut = 0U;
+	rdt_ctrl.mba_extra = 0U;
+	rdt_ctrl.rt_miss_rate = 0UL;
+	rdt_ctrl.nr_throttle = 0UL;
+	rdt_ctrl.nr_relax = 0UL;
+
+	sample_vms();
+	rdt_ctrl.last_rt_total = rdt_ctrl.vms[rt_vm_id].mbm_total;
+	rdt_ctrl.last_tsc = cpu_ticks();
+	rdt_ctrl.enabled = true;
+
+	/* once armed, the timer carries on and picks the new period up itself */
+	if (rdt_ctrl.timer_pcpu == INVALID_CPU_ID) {
+		initialize_timer(&rdt_ctrl.timer, rdt_ctrl_timer_fn, NULL,
+			rdt_ctrl.last_tsc + rdt_ctrl.period, rdt_ctrl.period);
+		if (add_timer(&rdt_ctrl.timer) == 0) {
+			rdt_ctrl.timer_pcpu = get_pcpu_id();
+		}
+	}
+}
+
+int32_t rdt_ctrl_set(const struct acrn_vm *service_vm, const struct acrn_rdt_ctrl *ctrl)
+{
+	uint16_t rt_vm_id = rel_vmid_2_vmid(service_vm->vm_id, ctrl->rt_vmid);
+	uint64_t be_vms = 0UL, rflags;
+	uint16_t i, vm_id;
+	int32_t ret = 0;
+
+	for (i = 0U; i < 64U; i++) {
+		if ((ctrl->be_vm_bitmap & (1UL << i)) != 0UL) {
+			vm_id = rel_vmid_2_vmid(service_vm->vm_id, i);
+			if (vm_id < CONFIG_MAX_VM_NUM) {
+				bitmap_set_nolock(vm_id, &be_vms);
+			} else {
+				ret = -EINVAL;
+			}
+		}
+	}
+
+	if (!is_rdt_mon_usable()) {
+		ret = -ENODEV;
+	}
+
+	if (ret == 0) {
+		spinlock_irqsave_obtain(&rdt_ctrl.lock, &rflags);
+		/* an update starts over from the scenario configuration */
+		stop_ctrl_loop();
+		if (ctrl->enable != 0U) {
+			ret = check_ctrl(rt_vm_id, be_vms, ctrl);
+			if (ret == 0) {
+				start_ctrl_loop(rt_vm_id, be_vms, ctrl);
+				pr_acrnlog("rdt: control loop on for RT VM%hu, best effort VMs 0x%lx",
+					rt_vm_id, be_vms);
+			}
+		}
+		spinlock_irqrestore_release(&rdt_ctrl.lock, rflags);
+	}
+
+	return ret;
+}
+
+int32_t rdt_ctrl_get_mon(const struct acrn_vm *service_vm, struct acrn_rdt_mon *mon)
+{
+	const struct rdt_info *l3 = get_rdt_res_cap_info(RDT_RESOURCE_L3);
+	const struct rdt_info *mba = get_rdt_res_cap_info(RDT_RESOURCE_MBA);
+	struct acrn_rdt_vm_mon *entry;
+	struct acrn_vm *vm;
+	uint16_t vm_id, clos;
+	uint64_t rflags;
+	int32_t ret = -ENODEV;
+
+	(void)memset(mon, 0U, sizeof(*mon));
+	if (is_rdt_mon_usable()) {
+		spinlock_irqsave_obtain(&rdt_ctrl.lock, &rflags);
+		sample_vms();
+		mon->flags = ACRN_RDT_MON_CAPABLE | (rdt_ctrl.enabled ? ACRN_RDT_CTRL_ENABLED : 0U);
+		mon->rt_miss_rate = rdt_ctrl.rt_miss_rate;
+		mon->nr_throttle = rdt_ctrl.nr_throttle;
+		mon->nr_relax = rdt_ctrl.nr_relax;
+		mon->ways_cut = rdt_ctrl.ways_cut;
+		mon->mba_extra = rdt_ctrl.mba_extra;
+
+		for (vm_id = 0U; (vm_id < CONFIG_MAX_VM_NUM) && (mon->nr_vms < ACRN_RDT_MAX_VMS); vm_id++) {
+			vm = get_vm_from_vmid(vm_id);
+			if (!is_poweroff_vm(vm)) {
+				entry = &mon->vms[mon->nr_vms];
+				entry->vmid = vmid_2_rel_vmid(service_vm->vm_id, vm_id);
+				entry->rmid = monitored_rmid(vm);
+				clos = vm_clos(vm_id);
+				if ((clos < get_rdt_num_closids()) && (l3->num_closids != 0U)) {
+					entry->l3_mask = l3->platform_clos_array[clos].value.clos_mask;
+				}
+				if ((clos < get_rdt_num_closids()) && (mba->num_closids != 0U)) {
+					entry->mba_delay = mba->platform_clos_array[clos].value.mba_delay;
+				}
+				if (rdt_ctrl.enabled && (vm_id == rdt_ctrl.rt_vm_id)) {
+					entry->flags |= ACRN_RDT_VM_RT;
+				}
+				if (rdt_ctrl.enabled && bitmap_test(vm_id, &rdt_ctrl.be_vms)) {
+					entry->flags |= ACRN_RDT_VM_BE;
+				}
+				if (entry->rmid != 0U) {
+					entry->occupancy = rdt_ctrl.vms[vm_id].occupancy;
+					entry->mbm_total = rdt_ctrl.vms[vm_id].mbm_total;
+					entry->mbm_local = rdt_ctrl.vms[vm_id].mbm_local;
+				}
+				mon->nr_vms++;
+			}
+		}
+		spinlock_irqrestore_release(&rdt_ctrl.lock, rflags);
+
+		mon->tsc_khz = cpu_tickrate();
+		mon->tsc = cpu_ticks();
+		ret = 0;
+	}
+
+	return ret;
+}
+#else
+int32_t rdt_ctrl_set(__unused const struct acrn_vm *service_vm, __unused const struct acrn_rdt_ctrl *ctrl)
+{
+	return -ENODEV;
+}
+
+int32_t rdt_ctrl_get_mon(__unused const struct acrn_vm *service_vm, __unused struct acrn_rdt_mon *mon)
+{
+	return -ENODEV;
+}
+#endif
@@ -18,6 +18,8 @@
 #include <logmsg.h>
 #include <asm/seed.h>
 #include <asm/tsc.h>
+#include <asm/guest/vmexit.h>
+#include <ticks.h>
 
 #define TRUSTY_VERSION   1U
 #define TRUSTY_VERSION_2 2U
@@ -151,16 +153,24 @@ static void save_world_ctx(struct acrn_vcpu *vcpu, struct ext_context *ext_ctx)
 	ext_ctx->ia32_kernel_gs_base = msr_read(MSR_IA32_KERNEL_GS_BASE);
 	ext_ctx->tsc_aux = msr_read(MSR_IA32_TSC_AUX);
 
-	/* XSAVE area */
-	save_xsave_area(vcpu, ext_ctx);
-
 	/* For MSRs need isolation between worlds */
 	for (i = 0U; i < NUM_WORLD_MSRS; i++) {
 		vcpu->arch.contexts[vcpu->arch.cur_context].world_msrs[i] = vcpu->arch.guest_msrs[i];
 	}
 }
 
-static void load_world_ctx(struct acrn_vcpu *vcpu, const struct ext_context *ext_ctx)
+/* The MSR still holds the value of the previous world, a WRMSR costs far more than the compare */
+static inline void load_world_msr(uint32_t msr, uint64_t prev_val, uint64_t next_val)
+{
+	if (next_val != prev_val) {
+		msr_write(msr, next_val);
+	}
+}
+
+/*
+ * @pre the context of the previous world has just been saved to prev_ctx
+ */
+static void load_world_ctx(struct acrn_vcpu *vcpu, struct ext_context *prev_ctx, const struct ext_context *ext_ctx)
 {
 	uint32_t i;
 
@@ -198,14 +208,14 @@ static void load_world_ctx(struct acrn_vcpu *vcpu, const struct ext_context *ext
 	exec_vmwrite32(VMX_GUEST_GDTR_LIMIT, ext_ctx->gdtr.limit);
 
 	/* MSRs which not in the VMCS */
-	msr_write(MSR_IA32_STAR, ext_ctx->ia32_star);
-	msr_write(MSR_IA32_LSTAR, ext_ctx->ia32_lstar);
-	msr_write(MSR_IA32_FMASK, ext_ctx->ia32_fmask);
-	msr_write(MSR_IA32_KERNEL_GS_BASE, ext_ctx->ia32_kernel_gs_base);
-	msr_write(MSR_IA32_TSC_AUX, ext_ctx->tsc_aux);
+	load_world_msr(MSR_IA32_STAR, prev_ctx->ia32_star, ext_ctx->ia32_star);
+	load_world_msr(MSR_IA32_LSTAR, prev_ctx->ia32_lstar, ext_ctx->ia32_lstar);
+	load_world_msr(MSR_IA32_FMASK, prev_ctx->ia32_fmask, ext_ctx->ia32_fmask);
+	load_world_msr(MSR_IA32_KERNEL_GS_BASE, prev_ctx->ia32_kernel_gs_base, ext_ctx->ia32_kernel_gs_base);
+	load_world_msr(MSR_IA32_TSC_AUX, prev_ctx->tsc_aux, ext_ctx->tsc_aux);
 
-	/* XSAVE area */
-	rstore_xsave_area(vcpu, ext_ctx);
+	/* XSAVE area, the vCPU's state is loaded as it's running */
+	switch_world_xsave_area(prev_ctx, ext_ctx);
 
 	/* For MSRs need isolation between worlds */
 	for (i = 0U; i < NUM_WORLD_MSRS; i++) {
@@ -222,15 +232,28 @@ static void copy_smc_param(const struct run_context *prev_ctx,
 	next_ctx->cpu_regs.regs.rbx = prev_ctx->cpu_regs.regs.rbx;
 }
 
+static inline uint64_t world_eptp(const void *eptp)
+{
+	/* 4-level EPT, WB */
+	return hva2hpa(eptp) | (3UL << 3U) | 0x6UL;
+}
+
+/*
+ * The EPTP is switched by the VMWRITE, no INVEPT is needed as the TLB entries
+ * are tagged with the EPT root. VMFUNC EPTP switching is left disabled: it's
+ * a guest instruction which would let the Normal World map the Secure World
+ * memory without a world switch.
+ */
 void switch_world(struct acrn_vcpu *vcpu, int32_t next_world)
 {
 	struct acrn_vcpu_arch *arch = &vcpu->arch;
+	uint64_t start = cpu_ticks();
 
 	/* save previous world context */
 	save_world_ctx(vcpu, &arch->contexts[!next_world].ext_ctx);
 
 	/* load next world context */
-	load_world_ctx(vcpu, &arch->contexts[next_world].ext_ctx);
+	load_world_ctx(vcpu, &arch->contexts[!next_world].ext_ctx, &arch->contexts[next_world].ext_ctx);
 
 	/* Copy SMC parameters: RDI, RSI, RDX, RBX */
 	copy_smc_param(&arch->contexts[!next_world].run_ctx,
@@ -238,21 +261,19 @@ void switch_world(struct acrn_vcpu *vcpu, int32_t next_world)
 
 	if (next_world == NORMAL_WORLD) {
 		/* load EPTP for next world */
-		exec_vmwrite64(VMX_EPT_POINTER_FULL,
-			hva2hpa(vcpu->vm->arch_vm.nworld_eptp) |
-			(3UL << 3U) | 0x6UL);
+		exec_vmwrite64(VMX_EPT_POINTER_FULL, world_eptp(vcpu->vm->arch_vm.nworld_eptp));
 
 #ifndef CONFIG_L1D_FLUSH_VMENTRY_ENABLED
 		cpu_l1d_flush();
 #endif
 	} else {
-		exec_vmwrite64(VMX_EPT_POINTER_FULL,
-			hva2hpa(vcpu->vm->arch_vm.sworld_eptp) |
-			(3UL << 3U) | 0x6UL);
+		exec_vmwrite64(VMX_EPT_POINTER_FULL, world_eptp(vcpu->vm->arch_vm.sworld_eptp));
 	}
 
 	/* Update world index */
 	arch->cur_context = next_world;
+
+	account_exit_stat(&arch->world_switch_stats[next_world], cpu_ticks() - start);
 }
 
 /* Put key_info and trusty_startup_param in the first Page of Trusty
@@ -377,11 +398,11 @@ bool initialize_trusty(struct acrn_vcpu *vcpu, struct trusty_boot_param *boot_pa
 								TRUSTY_EPT_REBASE_GPA);
 			trusty_base_hpa = vm->sworld_control.sworld_memory.base_hpa;
 
-			exec_vmwrite64(VMX_EPT_POINTER_FULL,
-					hva2hpa(vm->arch_vm.sworld_eptp) | (3UL << 3U) | 0x6UL);
+			exec_vmwrite64(VMX_EPT_POINTER_FULL, world_eptp(vm->arch_vm.sworld_eptp));
 
 			/* save Normal World context */
 			save_world_ctx(vcpu, &vcpu->arch.contexts[NORMAL_WORLD].ext_ctx);
+			save_xsave_area(vcpu, &vcpu->arch.contexts[NORMAL_WORLD].ext_ctx);
 
 			/* init secure world environment */
 			if (init_secure_world_env(vcpu,
@@ -412,7 +412,8 @@ int32_t write_vclosid(struct acrn_vcpu *vcpu, uint64_t val)
 			 * Here we only need to update the vcpu->arch.msr_area.guest[MSR_AREA_IA32_PQR_ASSOC].value field,
 			 * all other vcpu->arch.msr_area fields remains unchanged at runtime.
 			 */
-			vcpu->arch.msr_area.guest[MSR_AREA_IA32_PQR_ASSOC].value = clos2pqr_msr(pclosid);
+			vcpu->arch.msr_area.guest[MSR_AREA_IA32_PQR_ASSOC].value =
+				clos2pqr_msr(pclosid) | vm_rmid(vcpu->vm->vm_id);
 
 			ret = 0;
 		}
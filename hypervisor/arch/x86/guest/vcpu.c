@@ -21,6 +21,8 @@
 #include <lib/sprintf.h>
 #include <asm/lapic.h>
 #include <asm/irq.h>
+#include <asm/guest/vmexit.h>
+#include <ticks.h>
 
 /* stack_frame is linked with the sequence of stack operation in arch_switch_to() */
 struct stack_frame {
@@ -234,6 +236,23 @@ void load_iwkey(struct acrn_vcpu *vcpu)
 	}
 }
 
+/*
+ * Forget the extended state loaded for the vCPU, its next switch in restores
+ * the state of its current world.
+ */
+static void drop_xsave_state(struct acrn_vcpu *vcpu)
+{
+	uint16_t pcpu_id = pcpuid_from_vcpu(vcpu);
+	uint64_t rflag;
+
+	/* serialized with context_switch_in() on that pCPU */
+	obtain_schedule_lock(pcpu_id, &rflag);
+	if (per_cpu(whose_xsave, pcpu_id) == vcpu) {
+		per_cpu(whose_xsave, pcpu_id) = NULL;
+	}
+	release_schedule_lock(pcpu_id, rflag);
+}
+
 /* As a vcpu reset internal API, DO NOT touch any vcpu state transition in this function. */
 static void vcpu_reset_internal(struct acrn_vcpu *vcpu, enum reset_mode mode)
 {
@@ -244,6 +263,10 @@ static void vcpu_reset_internal(struct acrn_vcpu *vcpu, enum reset_mode mode)
 	vcpu->arch.nr_sipi = 0U;
 
 	vcpu->arch.exception_info.exception = VECTOR_INVALID;
+	if (vcpu->arch.cur_context != NORMAL_WORLD) {
+		/* the loaded XSAVE state is the secure world's one */
+		drop_xsave_state(vcpu);
+	}
 	vcpu->arch.cur_context = NORMAL_WORLD;
 	vcpu->arch.lapic_pt_enabled = false;
 	vcpu->arch.irq_window_enabled = false;
@@ -778,6 +801,8 @@ int32_t run_vcpu(struct acrn_vcpu *vcpu)
 void offline_vcpu(struct acrn_vcpu *vcpu)
 {
 	vlapic_free(vcpu);
+	/* the pCPU must never save into, or skip the restore for, a reused acrn_vcpu */
+	drop_xsave_state(vcpu);
 	per_cpu(ever_run_vcpu, pcpuid_from_vcpu(vcpu)) = NULL;
 
 	/* This operation must be atomic to avoid contention with posted interrupt handler */
@@ -893,10 +918,85 @@ void rstore_xsave_area(const struct acrn_vcpu *vcpu, const struct ext_context *e
 	}
 }
 
+/*
+ * Switch the XSAVE state between the two worlds of the running vCPU, whose
+ * state is loaded. IA32_XSS isn't isolated between the worlds and stays as is,
+ * XCR0 is only written when the worlds need different values.
+ */
+void switch_world_xsave_area(struct ext_context *prev, const struct ext_context *next)
+{
+	uint64_t xcr0;
+
+	if (pcpu_has_cap(X86_FEATURE_XSAVES)) {
+		prev->xcr0 = read_xcr(0);
+		xcr0 = prev->xcr0 | XSAVE_SSE;
+		if (xcr0 != prev->xcr0) {
+			write_xcr(0, xcr0);
+		}
+		xsaves(&prev->xs_area, UINT64_MAX);
+
+		if ((next->xcr0 | XSAVE_SSE) != xcr0) {
+			xcr0 = next->xcr0 | XSAVE_SSE;
+			write_xcr(0, xcr0);
+		}
+		xrstors(&next->xs_area, UINT64_MAX);
+		if (next->xcr0 != xcr0) {
+			write_xcr(0, next->xcr0);
+		}
+	}
+}
+
+static inline struct ext_context *cur_ext_context(struct acrn_vcpu *vcpu)
+{
+	return &(vcpu->arch.contexts[vcpu->arch.cur_context].ext_ctx);
+}
+
+/*
+ * The XSAVE state is switched lazily: neither the hypervisor nor the idle
+ * thread touch the extended registers, so a vCPU's state stays loaded on its
+ * pCPU after it's switched out and is only saved when another vCPU is switched
+ * in there. Resuming the same vCPU, e.g. after HLT, costs nothing.
+ *
+ * @pre the schedule lock of the current pCPU is held
+ */
+static void switch_xsave_state(struct acrn_vcpu *next)
+{
+	uint16_t pcpu_id = get_pcpu_id();
+	struct acrn_vcpu *prev = per_cpu(whose_xsave, pcpu_id);
+	uint64_t start;
+
+	if (prev == next) {
+		per_cpu(xsave_switch_skipped, pcpu_id)++;
+	} else {
+		start = cpu_ticks();
+		if (prev != NULL) {
+			save_xsave_area(prev, cur_ext_context(prev));
+		}
+		rstore_xsave_area(next, cur_ext_context(next));
+		per_cpu(whose_xsave, pcpu_id) = next;
+		account_exit_stat(&per_cpu(xsave_switch, pcpu_id), cpu_ticks() - start);
+	}
+}
+
+void save_lazy_xsave_state(void)
+{
+	uint16_t pcpu_id = get_pcpu_id();
+	struct acrn_vcpu *vcpu;
+	uint64_t rflag;
+
+	obtain_schedule_lock(pcpu_id, &rflag);
+	vcpu = per_cpu(whose_xsave, pcpu_id);
+	if (vcpu != NULL) {
+		save_xsave_area(vcpu, cur_ext_context(vcpu));
+		per_cpu(whose_xsave, pcpu_id) = NULL;
+	}
+	release_schedule_lock(pcpu_id, rflag);
+}
+
 /* TODO:
  * Now we have switch_out and switch_in callbacks for each thread_object, and schedule
- * will call them every thread switch. We can implement lazy context swtich , which
- * only do context swtich when really need.
+ * will call them every thread switch. The XSAVE state is switched lazily, the
+ * MSRs below still are switched every time.
  */
 static void context_switch_out(struct thread_object *prev)
 {
@@ -911,7 +1011,9 @@ static void context_switch_out(struct thread_object *prev)
 	ectx->ia32_kernel_gs_base = msr_read(MSR_IA32_KERNEL_GS_BASE);
 	ectx->tsc_aux = msr_read(MSR_IA32_TSC_AUX);
 
-	save_xsave_area(vcpu, ectx);
+	vpmu_save(vcpu);
+
+	/* the XSAVE state is saved by the next vCPU switched in, if any */
 }
 
 static void context_switch_in(struct thread_object *next)
@@ -938,7 +1040,9 @@ static void context_switch_in(struct thread_object *next)
 
 	load_iwkey(vcpu);
 
-	rstore_xsave_area(vcpu, ectx);
+	vpmu_restore(vcpu);
+
+	switch_xsave_state(vcpu);
 }
 
 
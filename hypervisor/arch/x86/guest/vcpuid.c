@@ -556,11 +556,17 @@ int32_t set_vcpuid_entries(struct acrn_vm *vm)
 				result = set_vcpuid_sgx(vm);
 				break;
 			/* These features are disabled */
-			/* PMU is not supported except for core partition VM, like RTVM */
+			/* PMU is not supported except for core partition VM, like RTVM, and VMs with a vPMU */
 			case 0x0aU:
 				if (is_pmu_pt_configured(vm)) {
 					init_vcpuid_entry(i, 0U, 0U, &entry);
 					result = set_vcpuid_entry(vm, &entry);
+				} else if (is_vpmu_configured(vm)) {
+					init_vcpuid_entry(i, 0U, 0U, &entry);
+					vpmu_cpuid_leaf_0ah(&entry.eax, &entry.ebx, &entry.ecx, &entry.edx);
+					result = set_vcpuid_entry(vm, &entry);
+				} else {
+					/* leave the leaf zeroed */
 				}
 				break;
 
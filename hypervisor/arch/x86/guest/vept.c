@@ -13,10 +13,22 @@
 #include <asm/guest/ept.h>
 #include <asm/guest/vept.h>
 #include <asm/guest/nested.h>
+#include <hash.h>
+#include <slab.h>
 
 #define VETP_LOG_LEVEL			LOG_DEBUG
 #define CONFIG_MAX_GUEST_EPT_NUM	(MAX_ACTIVE_VVMCS_NUM * MAX_VCPUS_PER_VM)
+#define VEPT_DESC_HASHBITS		6U
+/* guest EPT leaves shadowed along with a faulting 4K one, a naturally aligned block */
+#define VEPT_PREFAULT_NUM		8UL
+/* EPT accessed and dirty flags, set by the processor in the shadow EPT */
+#define VEPT_AD_BITS			((1UL << 8U) | (1UL << 9U))
+
 static struct vept_desc vept_desc_bucket[CONFIG_MAX_GUEST_EPT_NUM];
+static uint32_t vept_desc_links[CONFIG_MAX_GUEST_EPT_NUM];
+static struct slab_cache vept_desc_cache;
+static struct hlist_head vept_desc_heads[1U << VEPT_DESC_HASHBITS];
+/* protects vept_desc_heads and the ref_count of the descriptors */
 static spinlock_t vept_desc_bucket_lock;
 
 /*
@@ -42,6 +54,12 @@ static uint64_t calc_sept_page_num(void)
 static struct page_pool sept_page_pool;
 static struct page *sept_pages;
 static uint64_t *sept_page_bitmap;
+/*
+ * What each shadow paging structure was built from: the GPA of the guest
+ * paging structure it mirrors, or the guest leaf entry if it splits a guest
+ * large page backed by smaller host pages.
+ */
+static uint64_t *sept_page_origin;
 
 /*
  * @brief Reserve space for SEPT pages from platform E820 table
@@ -57,6 +75,7 @@ static void init_vept_pool(void)
 
 	sept_pages = (struct page *)page_base;
 	sept_page_bitmap = (uint64_t*)e820_alloc_memory((calc_sept_page_num() / 64U), ~0UL);
+	sept_page_origin = (uint64_t *)e820_alloc_memory((calc_sept_page_num() * sizeof(uint64_t)), ~0UL);
 }
 
 static bool is_present_ept_entry(uint64_t ept_entry)
@@ -69,42 +88,107 @@ static bool is_leaf_ept_entry(uint64_t ept_entry, enum _page_table_level pt_leve
 	return (((ept_entry & PAGE_PSE) != 0U) || (pt_level == IA32E_PT));
 }
 
+/*
+ * @brief Allocate a shadow paging structure
+ * @return the HPA of the new page
+ */
+static uint64_t alloc_sept_page(uint64_t origin)
+{
+	struct page *page = alloc_page(&sept_page_pool);
+
+	sept_page_origin[page - sept_pages] = origin;
+	return hva2hpa((void *)page);
+}
+
+static uint64_t get_sept_page_origin(uint64_t sept_entry)
+{
+	return sept_page_origin[(struct page *)hpa2hva(sept_entry & EPT_ENTRY_PFN_MASK) - sept_pages];
+}
+
+static void free_sept_pd(uint64_t *shadow_pd)
+{
+	uint64_t k;
+
+	for (k = 0UL; k < PTRS_PER_PDE; k++) {
+		if (is_present_ept_entry(shadow_pd[k]) && !is_leaf_ept_entry(shadow_pd[k], IA32E_PD)) {
+			free_page(&sept_page_pool, (struct page *)(shadow_pd[k] & EPT_ENTRY_PFN_MASK));
+		}
+	}
+	free_page(&sept_page_pool, (struct page *)shadow_pd);
+}
+
+static void free_sept_pdpt(uint64_t *shadow_pdpt)
+{
+	uint64_t j;
+
+	for (j = 0UL; j < PTRS_PER_PDPTE; j++) {
+		if (is_present_ept_entry(shadow_pdpt[j]) && !is_leaf_ept_entry(shadow_pdpt[j], IA32E_PDPT)) {
+			free_sept_pd((uint64_t *)(shadow_pdpt[j] & EPT_ENTRY_PFN_MASK));
+		}
+	}
+	free_page(&sept_page_pool, (struct page *)shadow_pdpt);
+}
+
+/*
+ * @brief Release the pages referenced by a present shadow EPT entry
+ */
+static void free_sept_entry(uint64_t sept_entry, enum _page_table_level pt_level)
+{
+	uint64_t *table = (uint64_t *)(sept_entry & EPT_ENTRY_PFN_MASK);
+
+	if (!is_leaf_ept_entry(sept_entry, pt_level)) {
+		switch (pt_level) {
+		case IA32E_PML4:
+			free_sept_pdpt(table);
+			break;
+		case IA32E_PDPT:
+			free_sept_pd(table);
+			break;
+		case IA32E_PD:
+			free_page(&sept_page_pool, (struct page *)table);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
 /*
  * @brief Release all pages except the PML4E page of a shadow EPT
  */
 static void free_sept_table(uint64_t *shadow_eptp)
 {
-	uint64_t *shadow_pml4e, *shadow_pdpte, *shadow_pde;
-	uint64_t i, j, k;
+	uint64_t i;
 
 	if (shadow_eptp) {
 		for (i = 0UL; i < PTRS_PER_PML4E; i++) {
-			shadow_pml4e = pml4e_offset(shadow_eptp, i << PML4E_SHIFT);
-			if (!is_present_ept_entry(*shadow_pml4e)) {
-				continue;
+			if (is_present_ept_entry(shadow_eptp[i])) {
+				free_sept_entry(shadow_eptp[i], IA32E_PML4);
+				shadow_eptp[i] = 0UL;
 			}
-			for (j = 0UL; j < PTRS_PER_PDPTE; j++) {
-				shadow_pdpte = pdpte_offset(shadow_pml4e, j << PDPTE_SHIFT);
-				if (!is_present_ept_entry(*shadow_pdpte) ||
-				    is_leaf_ept_entry(*shadow_pdpte, IA32E_PDPT)) {
-					continue;
-				}
-				for (k = 0UL; k < PTRS_PER_PDE; k++) {
-					shadow_pde = pde_offset(shadow_pdpte, k << PDE_SHIFT);
-					if (!is_present_ept_entry(*shadow_pde) ||
-					    is_leaf_ept_entry(*shadow_pde, IA32E_PD)) {
-						continue;
-					}
-					free_page(&sept_page_pool, (struct page *)((*shadow_pde) & EPT_ENTRY_PFN_MASK));
-				}
-				free_page(&sept_page_pool, (struct page *)((*shadow_pdpte) & EPT_ENTRY_PFN_MASK));
-			}
-			free_page(&sept_page_pool, (struct page *)((*shadow_pml4e) & EPT_ENTRY_PFN_MASK));
-			*shadow_pml4e = 0UL;
 		}
 	}
 }
 
+/*
+ * @pre vept_desc_bucket_lock is held
+ */
+static struct vept_desc *find_vept_desc_nolock(uint64_t guest_eptp)
+{
+	struct hlist_node *n;
+	struct vept_desc *tmp, *desc = NULL;
+
+	hlist_for_each(n, &vept_desc_heads[hash64(guest_eptp, VEPT_DESC_HASHBITS)]) {
+		tmp = hlist_entry(n, struct vept_desc, link);
+		if (tmp->guest_eptp == guest_eptp) {
+			desc = tmp;
+			break;
+		}
+	}
+
+	return desc;
+}
+
 /*
  * @brief Convert a guest EPTP to the associated vept_desc.
  * @return struct vept_desc * if existed.
@@ -112,18 +196,11 @@ static void free_sept_table(uint64_t *shadow_eptp)
  */
 static struct vept_desc *find_vept_desc(uint64_t guest_eptp)
 {
-	uint32_t i;
 	struct vept_desc *desc = NULL;
 
 	if (guest_eptp) {
 		spinlock_obtain(&vept_desc_bucket_lock);
-		for (i = 0L; i < CONFIG_MAX_GUEST_EPT_NUM; i++) {
-			/* Find an existed vept_desc of the guest EPTP */
-			if (vept_desc_bucket[i].guest_eptp == guest_eptp) {
-				desc = &vept_desc_bucket[i];
-				break;
-			}
-		}
+		desc = find_vept_desc_nolock(guest_eptp);
 		spinlock_release(&vept_desc_bucket_lock);
 	}
 
@@ -153,35 +230,26 @@ uint64_t get_shadow_eptp(uint64_t guest_eptp)
  */
 struct vept_desc *get_vept_desc(uint64_t guest_eptp)
 {
-	uint32_t i;
 	struct vept_desc *desc = NULL;
 
 	if (guest_eptp != 0UL) {
 		spinlock_obtain(&vept_desc_bucket_lock);
-		for (i = 0L; i < CONFIG_MAX_GUEST_EPT_NUM; i++) {
-			/* Find an existed vept_desc of the guest EPTP address bits */
-			if (vept_desc_bucket[i].guest_eptp == guest_eptp) {
-				desc = &vept_desc_bucket[i];
-				desc->ref_count++;
-				break;
-			}
-			/* Get the first empty vept_desc for the guest EPTP */
-			if (!desc && (vept_desc_bucket[i].ref_count == 0UL)) {
-				desc = &vept_desc_bucket[i];
-			}
-		}
-		ASSERT(desc != NULL, "Get vept_desc failed!");
+		desc = find_vept_desc_nolock(guest_eptp);
+		if (desc != NULL) {
+			desc->ref_count++;
+		} else {
+			desc = (struct vept_desc *)slab_alloc(&vept_desc_cache);
+			ASSERT(desc != NULL, "Get vept_desc failed!");
 
-		/* A new vept_desc, initialize it */
-		if (desc->shadow_eptp == 0UL) {
-			desc->shadow_eptp = (uint64_t)alloc_page(&sept_page_pool) | (guest_eptp & ~PAGE_MASK);
+			/* A new vept_desc, initialize it */
+			desc->shadow_eptp = (uint64_t)hpa2hva(alloc_sept_page(guest_eptp & PAGE_MASK)) | (guest_eptp & ~PAGE_MASK);
 			desc->guest_eptp = guest_eptp;
 			desc->ref_count = 1UL;
+			hlist_add_head(&desc->link, &vept_desc_heads[hash64(guest_eptp, VEPT_DESC_HASHBITS)]);
 
 			dev_dbg(VETP_LOG_LEVEL, "[%s], vept_desc[%llx] ref[%d] shadow_eptp[%llx] guest_eptp[%llx]",
 					__func__, desc, desc->ref_count, desc->shadow_eptp, desc->guest_eptp);
 		}
-
 		spinlock_release(&vept_desc_bucket_lock);
 	}
 
@@ -198,19 +266,23 @@ void put_vept_desc(uint64_t guest_eptp)
 	struct vept_desc *desc = NULL;
 
 	if (guest_eptp != 0UL) {
-		desc = find_vept_desc(guest_eptp);
 		spinlock_obtain(&vept_desc_bucket_lock);
+		desc = find_vept_desc_nolock(guest_eptp);
 		if (desc) {
 			desc->ref_count--;
 			if (desc->ref_count == 0UL) {
 				dev_dbg(VETP_LOG_LEVEL, "[%s], vept_desc[%llx] ref[%d] shadow_eptp[%llx] guest_eptp[%llx]",
 						__func__, desc, desc->ref_count, desc->shadow_eptp, desc->guest_eptp);
+				hlist_del(&desc->link);
+				spinlock_obtain(&desc->lock);
 				free_sept_table((void *)(desc->shadow_eptp & PAGE_MASK));
 				free_page(&sept_page_pool, (struct page *)(desc->shadow_eptp & PAGE_MASK));
 				/* Flush the hardware TLB */
 				invept((void *)(desc->shadow_eptp & PAGE_MASK));
 				desc->shadow_eptp = 0UL;
 				desc->guest_eptp = 0UL;
+				spinlock_release(&desc->lock);
+				slab_free(&vept_desc_cache, desc);
 			}
 		}
 		spinlock_release(&vept_desc_bucket_lock);
@@ -246,29 +318,51 @@ static uint64_t get_leaf_entry(uint64_t gpa, uint64_t *eptp, enum _page_table_le
 	return ept_entry;
 }
 
+/*
+ * @brief Shadow entry of a guest EPT leaf at the given level, for a host page at least as large
+ */
+static uint64_t shadow_leaf_entry(struct acrn_vcpu *vcpu, uint64_t guest_ept_entry,
+				  enum _page_table_level pt_level, uint64_t l1_gpa)
+{
+	uint64_t page_mask = (1UL << PAGING_ENTRY_SHIFT(pt_level)) - 1UL;
+	uint64_t shadow_ept_entry = guest_ept_entry & ~(EPT_ENTRY_PFN_MASK | PAGE_PSE);
+
+	if (pt_level != IA32E_PT) {
+		shadow_ept_entry |= PAGE_PSE;
+	}
+
+	/*
+	 * Set the address.
+	 * gpa2hpa() should be successful as the host EPT entry has already been found.
+	 */
+	return shadow_ept_entry | gpa2hpa(vcpu->vm, l1_gpa & ~page_mask);
+}
+
 /**
  * @brief Shadow a guest EPT entry
  * @pre vcpu != NULL
  */
 static uint64_t generate_shadow_ept_entry(struct acrn_vcpu *vcpu, uint64_t guest_ept_entry,
-				    enum _page_table_level guest_ept_level)
+				    enum _page_table_level guest_ept_level, uint64_t l2_gpa)
 {
 	uint64_t shadow_ept_entry = 0UL;
-	uint64_t ept_entry;
+	uint64_t ept_entry, l1_gpa;
 	enum _page_table_level ept_level;
 
 	/*
 	 * Create a shadow EPT entry
-	 * We only support 4K page for guest EPT. So it's simple to create a shadow EPT entry
-	 * for it. The rules are:
+	 * The rules for a guest EPT leaf entry are:
 	 *   > Find the host EPT leaf entry of address in ept_entry[M-1:12], named as ept_entry
 	 *   > Minimize the attribute bits (according to ept_entry and guest_ept_entry) and
 	 *     set in shadow EPT entry shadow_ept_entry.
 	 *   > Set the HPA of guest_ept_entry[M-1:12] to shadow_ept_entry.
+	 * A guest large page is shadowed by a large page if the host page is at least as
+	 * large, otherwise by a paging structure which is filled down to the host page size.
 	 */
 	if (is_leaf_ept_entry(guest_ept_entry, guest_ept_level)) {
-		ASSERT(guest_ept_level == IA32E_PT, "Only support 4K page for guest EPT!");
-		ept_entry = get_leaf_entry((guest_ept_entry & EPT_ENTRY_PFN_MASK), get_eptp(vcpu->vm), &ept_level);
+		l1_gpa = (guest_ept_entry & EPT_ENTRY_PFN_MASK) |
+			(l2_gpa & ((1UL << PAGING_ENTRY_SHIFT(guest_ept_level)) - 1UL));
+		ept_entry = get_leaf_entry(l1_gpa, get_eptp(vcpu->vm), &ept_level);
 		if (ept_entry != 0UL) {
 			/*
 			 * TODO:
@@ -278,23 +372,61 @@ static uint64_t generate_shadow_ept_entry(struct acrn_vcpu *vcpu, uint64_t guest
 			 *
 			 * Just keep the code skeleton here for extend.
 			 */
-			shadow_ept_entry = guest_ept_entry & ~EPT_ENTRY_PFN_MASK;
-
-			/*
-			 * Set the address.
-			 * gpa2hpa() should be successful as ept_entry already be found.
-			 */
-			shadow_ept_entry |= gpa2hpa(vcpu->vm, (guest_ept_entry & EPT_ENTRY_PFN_MASK));
+			if (ept_level <= guest_ept_level) {
+				shadow_ept_entry = shadow_leaf_entry(vcpu, guest_ept_entry, guest_ept_level, l1_gpa);
+			} else {
+				shadow_ept_entry = (guest_ept_entry & EPT_RWX) | alloc_sept_page(guest_ept_entry);
+			}
 		}
 	} else {
 		/* Use a HPA of a new page in shadow EPT entry */
 		shadow_ept_entry = guest_ept_entry & ~EPT_ENTRY_PFN_MASK;
-		shadow_ept_entry |= hva2hpa((void *)alloc_page(&sept_page_pool)) & EPT_ENTRY_PFN_MASK;
+		shadow_ept_entry |= alloc_sept_page(guest_ept_entry & EPT_ENTRY_PFN_MASK) & EPT_ENTRY_PFN_MASK;
 	}
 
 	return shadow_ept_entry;
 }
 
+/*
+ * @brief Fill the shadow paging structures which split a guest large page
+ *
+ * @return the shadow leaf entry mapping l2_gpa, 0 if the GPA isn't backed by the host
+ */
+static uint64_t fill_split_shadow_ept(struct acrn_vcpu *vcpu, uint64_t shadow_ept_entry, uint64_t guest_ept_entry,
+				      enum _page_table_level guest_ept_level, uint64_t l2_gpa)
+{
+	enum _page_table_level pt_level = guest_ept_level;
+	enum _page_table_level ept_level = IA32E_PT;
+	uint64_t l1_gpa = (guest_ept_entry & EPT_ENTRY_PFN_MASK) |
+		(l2_gpa & ((1UL << PAGING_ENTRY_SHIFT(guest_ept_level)) - 1UL));
+	uint64_t *p_shadow_ept_page;
+	uint64_t sept_entry = shadow_ept_entry;
+	uint16_t offset;
+
+	if (get_leaf_entry(l1_gpa, get_eptp(vcpu->vm), &ept_level) == 0UL) {
+		sept_entry = 0UL;
+	}
+
+	while ((sept_entry != 0UL) && (pt_level < ept_level)) {
+		pt_level++;
+		p_shadow_ept_page = (uint64_t *)hpa2hva(sept_entry & EPT_ENTRY_PFN_MASK);
+		offset = PAGING_ENTRY_OFFSET(l2_gpa, pt_level);
+		sept_entry = p_shadow_ept_page[offset];
+		if (!is_present_ept_entry(sept_entry)) {
+			if (pt_level == ept_level) {
+				sept_entry = shadow_leaf_entry(vcpu, guest_ept_entry, pt_level, l1_gpa);
+			} else {
+				sept_entry = (guest_ept_entry & EPT_RWX) | alloc_sept_page(guest_ept_entry);
+			}
+		}
+		/* access bits added to the guest leaf without INVEPT, see handle_l2_ept_violation() */
+		sept_entry = (sept_entry & ~EPT_RWX) | (guest_ept_entry & EPT_RWX);
+		p_shadow_ept_page[offset] = sept_entry;
+	}
+
+	return sept_entry;
+}
+
 /*
  * @brief Check misconfigurations on EPT entries
  *
@@ -383,6 +515,43 @@ static bool is_access_violation(uint64_t ept_entry)
 	return access_violation;
 }
 
+/*
+ * @brief Shadow the present guest EPT leaves around a faulting 4K one
+ *
+ * L2 accesses tend to be local, so the naturally aligned block of
+ * VEPT_PREFAULT_NUM entries which holds the faulting one is shadowed at once.
+ * Entries which would cause an EPT misconfiguration or point to an invalid
+ * GPA are left to fault.
+ */
+static void prefault_shadow_ept(struct acrn_vcpu *vcpu, const uint64_t *p_guest_ept_page,
+				uint64_t *p_shadow_ept_page, uint16_t fault_offset)
+{
+	uint64_t guest_ept_entry;
+	uint16_t offset, first = (uint16_t)(fault_offset & ~(VEPT_PREFAULT_NUM - 1UL));
+
+	for (offset = first; offset < (first + VEPT_PREFAULT_NUM); offset++) {
+		guest_ept_entry = p_guest_ept_page[offset];
+		if ((offset != fault_offset) && is_present_ept_entry(guest_ept_entry) &&
+				!is_present_ept_entry(p_shadow_ept_page[offset]) &&
+				!is_ept_entry_misconfig(guest_ept_entry, IA32E_PT) &&
+				(gpa2hpa(vcpu->vm, guest_ept_entry & EPT_ENTRY_PFN_MASK) != INVALID_HPA)) {
+			p_shadow_ept_page[offset] = generate_shadow_ept_entry(vcpu, guest_ept_entry, IA32E_PT, 0UL);
+		}
+	}
+}
+
+/*
+ * gpa2hva() never fails, it turns INVALID_HPA into a bogus pointer as well.
+ * A guest EPT table at a GPA which is not mapped in the L1 EPT is NULL: the
+ * violation goes to L1, a sync reads the table as empty.
+ */
+static const uint64_t *get_guest_ept_table(struct acrn_vcpu *vcpu, uint64_t table_gpa)
+{
+	uint64_t hpa = local_gpa2hpa(vcpu->vm, table_gpa, NULL);
+
+	return (hpa != INVALID_HPA) ? (const uint64_t *)hpa2hva(hpa) : NULL;
+}
+
 /**
  * @brief L2 VM EPT violation handler
  * @pre vcpu != NULL
@@ -398,17 +567,18 @@ bool handle_l2_ept_violation(struct acrn_vcpu *vcpu)
 	uint64_t l2_ept_violation_gpa = exec_vmread(VMX_GUEST_PHYSICAL_ADDR_FULL);
 	enum _page_table_level pt_level;
 	uint64_t guest_ept_entry, shadow_ept_entry;
-	uint64_t *p_guest_ept_page, *p_shadow_ept_page;
+	const uint64_t *p_guest_ept_page;
+	uint64_t *p_shadow_ept_page;
 	uint16_t offset;
 	bool is_l1_vmexit = true;
 
 	ASSERT(desc != NULL, "Invalid shadow EPTP!");
 
-	spinlock_obtain(&vept_desc_bucket_lock);
+	spinlock_obtain(&desc->lock);
 	stac();
 
 	p_shadow_ept_page = (uint64_t *)(desc->shadow_eptp & PAGE_MASK);
-	p_guest_ept_page = gpa2hva(vcpu->vm, desc->guest_eptp & PAGE_MASK);
+	p_guest_ept_page = get_guest_ept_table(vcpu, desc->guest_eptp & PAGE_MASK);
 
 	for (pt_level = IA32E_PML4; (p_guest_ept_page != NULL) && (pt_level <= IA32E_PT); pt_level++) {
 		offset = PAGING_ENTRY_OFFSET(l2_ept_violation_gpa, pt_level);
@@ -435,7 +605,8 @@ bool handle_l2_ept_violation(struct acrn_vcpu *vcpu)
 		/* Shadow EPT entry is non-exist, create it */
 		if (!is_present_ept_entry(shadow_ept_entry)) {
 			/* Create a shadow EPT entry */
-			shadow_ept_entry = generate_shadow_ept_entry(vcpu, guest_ept_entry, pt_level);
+			shadow_ept_entry = generate_shadow_ept_entry(vcpu, guest_ept_entry, pt_level,
+					l2_ept_violation_gpa);
 			p_shadow_ept_page[offset] = shadow_ept_entry;
 			if (shadow_ept_entry == 0UL) {
 				/*
@@ -467,24 +638,110 @@ bool handle_l2_ept_violation(struct acrn_vcpu *vcpu)
 
 		/* Shadow EPT entry exists */
 		if (is_leaf_ept_entry(guest_ept_entry, pt_level)) {
+			if (!is_leaf_ept_entry(shadow_ept_entry, pt_level)) {
+				/* A guest large page backed by smaller host pages */
+				shadow_ept_entry = fill_split_shadow_ept(vcpu, shadow_ept_entry, guest_ept_entry,
+						pt_level, l2_ept_violation_gpa);
+			} else if (pt_level == IA32E_PT) {
+				prefault_shadow_ept(vcpu, p_guest_ept_page, p_shadow_ept_page, offset);
+			} else {
+				/* A guest large page shadowed by a large page */
+			}
+
 			/* Shadow EPT is set up, let L2 VM re-execute the instruction. */
-			if ((exec_vmread32(VMX_IDT_VEC_INFO_FIELD) & VMX_INT_INFO_VALID) == 0U) {
+			if ((shadow_ept_entry != 0UL) &&
+					((exec_vmread32(VMX_IDT_VEC_INFO_FIELD) & VMX_INT_INFO_VALID) == 0U)) {
 				is_l1_vmexit = false;
 			}
 			break;
 		} else {
 			/* Set up next level EPT entries. */
 			p_shadow_ept_page = hpa2hva(shadow_ept_entry & EPT_ENTRY_PFN_MASK);
-			p_guest_ept_page = gpa2hva(vcpu->vm, guest_ept_entry & EPT_ENTRY_PFN_MASK);
+			p_guest_ept_page = get_guest_ept_table(vcpu, guest_ept_entry & EPT_ENTRY_PFN_MASK);
 		}
 	}
 
 	clac();
-	spinlock_release(&vept_desc_bucket_lock);
+	spinlock_release(&desc->lock);
 
 	return is_l1_vmexit;
 }
 
+/*
+ * @brief Whether a shadow EPT entry doesn't match the guest EPT entry it was built from
+ */
+static bool is_shadow_ept_entry_stale(struct acrn_vcpu *vcpu, uint64_t shadow_ept_entry,
+				      uint64_t guest_ept_entry, enum _page_table_level pt_level)
+{
+	bool stale = true;
+
+	if (is_present_ept_entry(guest_ept_entry) && (((shadow_ept_entry ^ guest_ept_entry) & EPT_RWX) == 0UL)) {
+		if (is_leaf_ept_entry(shadow_ept_entry, pt_level)) {
+			stale = !is_leaf_ept_entry(guest_ept_entry, pt_level) ||
+				(((shadow_ept_entry ^ guest_ept_entry) & ~(EPT_ENTRY_PFN_MASK | VEPT_AD_BITS)) != 0UL) ||
+				(gpa2hpa(vcpu->vm, guest_ept_entry & EPT_ENTRY_PFN_MASK) !=
+					(shadow_ept_entry & EPT_ENTRY_PFN_MASK));
+		} else if (is_leaf_ept_entry(guest_ept_entry, pt_level)) {
+			/* it splits a guest large page */
+			stale = (get_sept_page_origin(shadow_ept_entry) != guest_ept_entry);
+		} else {
+			stale = (get_sept_page_origin(shadow_ept_entry) != (guest_ept_entry & EPT_ENTRY_PFN_MASK));
+		}
+	}
+
+	return stale;
+}
+
+/*
+ * @brief Drop the shadow EPT entries which don't match the guest EPT anymore
+ *
+ * Single-context INVEPT doesn't tell which guest EPT entries have changed.
+ * Instead of tearing down the whole shadow EPT, every present shadow entry is
+ * checked against the guest entry at the same place and only the stale ones
+ * are released, together with the paging structures below them.
+ *
+ * @pre desc->lock is held
+ */
+static void sync_shadow_ept(struct acrn_vcpu *vcpu, const struct vept_desc *desc)
+{
+	uint64_t *shadow_tables[IA32E_PT + 1];
+	const uint64_t *guest_tables[IA32E_PT + 1];
+	uint64_t index[IA32E_PT + 1];
+	enum _page_table_level pt_level = IA32E_PML4;
+	uint64_t shadow_ept_entry, guest_ept_entry;
+
+	shadow_tables[IA32E_PML4] = (uint64_t *)(desc->shadow_eptp & PAGE_MASK);
+	guest_tables[IA32E_PML4] = get_guest_ept_table(vcpu, desc->guest_eptp & PAGE_MASK);
+	index[IA32E_PML4] = 0UL;
+
+	while ((pt_level != IA32E_PML4) || (index[IA32E_PML4] < PTRS_PER_PML4E)) {
+		if (index[pt_level] == PTRS_PER_PTE) {
+			/* done with this table, back to its parent */
+			pt_level--;
+			index[pt_level]++;
+			continue;
+		}
+
+		shadow_ept_entry = shadow_tables[pt_level][index[pt_level]];
+		if (is_present_ept_entry(shadow_ept_entry)) {
+			guest_ept_entry = (guest_tables[pt_level] != NULL) ? guest_tables[pt_level][index[pt_level]] : 0UL;
+			if (is_shadow_ept_entry_stale(vcpu, shadow_ept_entry, guest_ept_entry, pt_level)) {
+				free_sept_entry(shadow_ept_entry, pt_level);
+				shadow_tables[pt_level][index[pt_level]] = 0UL;
+			} else if (!is_leaf_ept_entry(guest_ept_entry, pt_level)) {
+				shadow_tables[pt_level + 1] = hpa2hva(shadow_ept_entry & EPT_ENTRY_PFN_MASK);
+				guest_tables[pt_level + 1] = get_guest_ept_table(vcpu, guest_ept_entry & EPT_ENTRY_PFN_MASK);
+				pt_level++;
+				index[pt_level] = 0UL;
+				continue;
+			} else {
+				/* a valid leaf, or a valid split of a guest large page */
+			}
+		}
+		index[pt_level]++;
+	}
+}
+
 /**
  * @pre vcpu != NULL
  */
@@ -505,16 +762,14 @@ int32_t invept_vmexit_handler(struct acrn_vcpu *vcpu)
 			/* Find corresponding vept_desc of the invalidated EPTP */
 			desc = get_vept_desc(operand_gla_ept.eptp);
 			if (desc) {
-				spinlock_obtain(&vept_desc_bucket_lock);
+				spinlock_obtain(&desc->lock);
 				if (desc->shadow_eptp != 0UL) {
-					/*
-					 * Since ACRN does not know which paging entries are changed,
-					 * Remove all the shadow EPT entries that ACRN created for L2 VM
-					 */
-					free_sept_table((void *)(desc->shadow_eptp & PAGE_MASK));
+					stac();
+					sync_shadow_ept(vcpu, desc);
+					clac();
 					invept((void *)(desc->shadow_eptp & PAGE_MASK));
 				}
-				spinlock_release(&vept_desc_bucket_lock);
+				spinlock_release(&desc->lock);
 				put_vept_desc(operand_gla_ept.eptp);
 			}
 			nested_vmx_result(VMsucceed, 0);
@@ -528,8 +783,10 @@ int32_t invept_vmexit_handler(struct acrn_vcpu *vcpu)
 			for (i = 0L; i < CONFIG_MAX_GUEST_EPT_NUM; i++) {
 				if (vept_desc_bucket[i].guest_eptp != 0UL) {
 					desc = &vept_desc_bucket[i];
+					spinlock_obtain(&desc->lock);
 					free_sept_table((void *)(desc->shadow_eptp & PAGE_MASK));
 					invept((void *)(desc->shadow_eptp & PAGE_MASK));
+					spinlock_release(&desc->lock);
 				}
 			}
 			spinlock_release(&vept_desc_bucket_lock);
@@ -544,6 +801,8 @@ int32_t invept_vmexit_handler(struct acrn_vcpu *vcpu)
 
 void init_vept(void)
 {
+	uint32_t i;
+
 	init_vept_pool();
 	sept_page_pool.start_page = sept_pages;
 	sept_page_pool.bitmap_size = calc_sept_page_num() / 64U;
@@ -554,4 +813,9 @@ void init_vept(void)
 	sept_page_pool.last_hint_id = 0UL;
 
 	spinlock_init(&vept_desc_bucket_lock);
+	for (i = 0U; i < CONFIG_MAX_GUEST_EPT_NUM; i++) {
+		spinlock_init(&vept_desc_bucket[i].lock);
+	}
+	slab_init(&vept_desc_cache, "vept_desc", vept_desc_bucket, sizeof(struct vept_desc),
+		CONFIG_MAX_GUEST_EPT_NUM, vept_desc_links);
 }
@@ -342,7 +342,10 @@ int32_t external_interrupt_vmexit_handler(struct acrn_vcpu *vcpu)
 		ctx.rflags = vcpu_get_rflags(vcpu);
 		ctx.cs     = exec_vmread32(VMX_GUEST_CS_SEL);
 
-		dispatch_interrupt(&ctx);
+		/* a PMI during a vCPU with a vPMU is an overflow of its counters */
+		if ((ctx.vector != PMI_VECTOR) || !vpmu_handle_pmi(vcpu)) {
+			dispatch_interrupt(&ctx);
+		}
 		vcpu_retain_rip(vcpu);
 
 		TRACE_2L(TRACE_VMEXIT_EXTERNAL_INTERRUPT, ctx.vector, 0UL);
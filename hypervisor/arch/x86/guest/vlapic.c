@@ -446,21 +446,51 @@ vlapic_write_esr(struct acrn_vlapic *vlapic)
 	vlapic->esr_pending = 0U;
 }
 
+/*
+ * Only the vIOAPIC acts on a guest EOI. A level triggered vector is EOI
+ * exiting only if it belongs to a level triggered vIOAPIC pin, other ones
+ * (level MSIs and IPIs) are EOIed in the virtual APIC page.
+ */
 static void
 vlapic_set_tmr(struct acrn_vlapic *vlapic, uint32_t vector, bool level)
 {
 	struct lapic_reg *tmrptr = &(vlapic->apic_page.tmr[0]);
+	struct acrn_vcpu *vcpu = vlapic2vcpu(vlapic);
+
 	if (level) {
-		if (!bitmap32_test_and_set_lock((uint16_t)(vector & 0x1fU), &tmrptr[(vector & 0xffU) >> 5U].v)) {
-			vcpu_set_eoi_exit_bitmap(vlapic2vcpu(vlapic), vector);
+		(void)bitmap32_test_and_set_lock((uint16_t)(vector & 0x1fU), &tmrptr[(vector & 0xffU) >> 5U].v);
+		if (vioapic_need_eoi_exit(vcpu->vm, vector)) {
+			vcpu_set_eoi_exit_bitmap(vcpu, vector);
+		} else {
+			vcpu_clear_eoi_exit_bitmap(vcpu, vector);
+			if (is_apicv_advanced_feature_supported()) {
+				vlapic->eoi_exits_avoided++;
+			}
 		}
 	} else {
 		if (bitmap32_test_and_clear_lock((uint16_t)(vector & 0x1fU), &tmrptr[(vector & 0xffU) >> 5U].v)) {
-			vcpu_clear_eoi_exit_bitmap(vlapic2vcpu(vlapic), vector);
+			vcpu_clear_eoi_exit_bitmap(vcpu, vector);
 		}
 	}
 }
 
+/*
+ * Re-evaluate the EOI exiting of a vector after the vIOAPIC pins using it
+ * changed. The VMCS is updated on the next VM entry of the vCPU.
+ */
+void vlapic_update_eoi_exit(struct acrn_vlapic *vlapic, uint32_t vector)
+{
+	struct acrn_vcpu *vcpu = vlapic2vcpu(vlapic);
+	const struct lapic_reg *tmrptr = &(vlapic->apic_page.tmr[0]);
+
+	if (bitmap32_test((uint16_t)(vector & 0x1fU), &tmrptr[(vector & 0xffU) >> 5U].v) &&
+			vioapic_need_eoi_exit(vcpu->vm, vector)) {
+		vcpu_set_eoi_exit_bitmap(vcpu, vector);
+	} else {
+		vcpu_clear_eoi_exit_bitmap(vcpu, vector);
+	}
+}
+
 static void
 vlapic_reset_tmr(struct acrn_vlapic *vlapic)
 {
@@ -920,6 +950,12 @@ vlapic_trigger_lvt(struct acrn_vlapic *vlapic, uint32_t lvt_index)
 
 		if (ret == 0) {
 			vlapic_fire_lvt(vlapic, lvt);
+
+			/* The processor sets the LVT performance counter mask bit when it delivers a PMI */
+			if ((lvt_index == APIC_LVT_PMC) && ((lvt & APIC_LVT_M) == 0U)) {
+				vlapic->apic_page.lvt[APIC_LVT_PMC].v |= APIC_LVT_M;
+				vlapic->lvt_last[APIC_LVT_PMC] |= APIC_LVT_M;
+			}
 		}
 	}
 	return ret;
@@ -2462,6 +2498,7 @@ int32_t veoi_vmexit_handler(struct acrn_vcpu *vcpu)
 
 	tmrptr = &lapic->tmr[0];
 	idx = vector >> 5U;
+	vlapic->eoi_exits++;
 
 	if (bitmap32_test((uint16_t)(vector & 0x1fU), &tmrptr[idx].v)) {
 		/* hook to vIOAPIC */
@@ -44,6 +44,8 @@
 #endif
 #include <asm/boot/ld_sym.h>
 #include <asm/guest/optee.h>
+#include <boot_work.h>
+#include <hvprof.h>
 
 /* Local variables */
 
@@ -193,6 +195,16 @@ bool is_nvmx_configured(const struct acrn_vm *vm)
 	return ((vm_config->guest_flags & GUEST_FLAG_NVMX_ENABLED) != 0U);
 }
 
+/**
+ * @pre vm != NULL && vm_config != NULL && vm->vmid < CONFIG_MAX_VM_NUM
+ */
+bool is_viommu_configured(const struct acrn_vm *vm)
+{
+	struct acrn_vm_config *vm_config = get_vm_config(vm->vm_id);
+
+	return ((vm_config->guest_flags & GUEST_FLAG_VIOMMU) != 0U);
+}
+
 /**
  * @pre vm != NULL && vm_config != NULL && vm->vmid < CONFIG_MAX_VM_NUM
  */
@@ -441,6 +453,40 @@ static void deny_hv_owned_devices(struct acrn_vm *service_vm)
 	}
 }
 
+/*
+ * Identity map [0, max_ram) for the Service VM in a single pass, RAM as WB and
+ * everything in between as UC. Each range is added once with its final memory
+ * type, so pgtable_add_map() keeps 1G/2M pages wherever the range is aligned
+ * instead of mapping all of it UC and splitting it again at every RAM boundary.
+ *
+ * @pre vm->e820_entries are sorted by base address
+ */
+static void add_service_vm_identity_map(struct acrn_vm *vm, uint64_t *pml4_page, uint64_t max_ram)
+{
+	const struct e820_entry *entry;
+	uint64_t start, end, cur = 0UL;
+	uint32_t i;
+
+	for (i = 0U; i < vm->e820_entry_num; i++) {
+		entry = vm->e820_entries + i;
+		if (entry->type == E820_TYPE_RAM) {
+			start = max(round_page_up(entry->baseaddr), cur);
+			end = round_page_down(entry->baseaddr + entry->length);
+			if (start < end) {
+				if (cur < start) {
+					ept_add_mr(vm, pml4_page, cur, cur, start - cur, EPT_RWX | EPT_UNCACHED);
+				}
+				ept_add_mr(vm, pml4_page, start, start, end - start, EPT_RWX | EPT_WB);
+				cur = end;
+			}
+		}
+	}
+
+	if (cur < max_ram) {
+		ept_add_mr(vm, pml4_page, cur, cur, max_ram - cur, EPT_RWX | EPT_UNCACHED);
+	}
+}
+
 /**
  * @param[inout] vm pointer to a vm descriptor
  *
@@ -458,6 +504,7 @@ static void prepare_service_vm_memmap(struct acrn_vm *vm)
 	struct acrn_vm_config *vm_config;
 	uint64_t *pml4_page = (uint64_t *)vm->arch_vm.nworld_eptp;
 	struct epc_section* epc_secs;
+	uint64_t identity_map_pages;
 
 	const struct e820_entry *entry;
 	uint32_t entries_count = vm->e820_entry_num;
@@ -475,16 +522,9 @@ static void prepare_service_vm_memmap(struct acrn_vm *vm)
 		}
 	}
 
-	/* create real ept map for [0, service_vm_high64_max_ram) with UC */
-	ept_add_mr(vm, pml4_page, 0UL, 0UL, service_vm_high64_max_ram, EPT_RWX | EPT_UNCACHED);
-
-	/* update ram entries to WB attr */
-	for (i = 0U; i < entries_count; i++) {
-		entry = p_e820 + i;
-		if (entry->type == E820_TYPE_RAM) {
-			ept_modify_mr(vm, pml4_page, entry->baseaddr, entry->length, EPT_WB, EPT_MT_MASK);
-		}
-	}
+	boot_phase("Service VM EPT build", vm->vm_id);
+	add_service_vm_identity_map(vm, pml4_page, service_vm_high64_max_ram);
+	identity_map_pages = get_ept_used_page_num(vm->vm_id);
 
 	/* Unmap all platform EPC resource from Service VM.
 	 * This part has already been marked as reserved by BIOS in E820
@@ -519,6 +559,9 @@ static void prepare_service_vm_memmap(struct acrn_vm *vm)
 	 */
 	ept_del_mr(vm, pml4_page, get_trampoline_start16_paddr(), trampoline_memory_size);
 
+	/* unmap the boot modules which pre-launched VMs take over in place */
+	deny_zero_copy_modules(vm);
+
 	/* unmap PCIe MMCONFIG region since it's owned by hypervisor */
 	pci_mmcfg = get_mmcfg_region();
 	ept_del_mr(vm, (uint64_t *)vm->arch_vm.nworld_eptp, pci_mmcfg->address, get_pci_mmcfg_size(pci_mmcfg));
@@ -539,6 +582,9 @@ static void prepare_service_vm_memmap(struct acrn_vm *vm)
 		ept_del_mr(vm, pml4_page, plat_dmar_info.drhd_units[i].reg_base_addr, PAGE_SIZE);
 	}
 
+	boot_phase("Service VM EPT built", vm->vm_id);
+	pr_acrnlog("Service VM EPT: %lu pages used by the identity map, %lu after the unmaps",
+			identity_map_pages, get_ept_used_page_num(vm->vm_id));
 }
 
 /* Add EPT mapping of EPC reource for the VM */
@@ -608,11 +654,13 @@ int32_t create_vm(uint16_t vm_id, uint64_t pcpu_bitmap, struct acrn_vm_config *v
 	struct acrn_vm *vm = NULL;
 	int32_t status = 0;
 	uint16_t pcpu_id;
+	bool pmu_claimed = false;
 
 	/* Allocate memory for virtual machine */
 	vm = &vm_array[vm_id];
 	vm->vm_id = vm_id;
 	vm->hw.created_vcpus = 0U;
+	(void)memset(vm->io_stats, 0U, sizeof(vm->io_stats));
 
 	init_ept_pgtable(&vm->arch_vm.ept_pgtable, vm->vm_id);
 	vm->arch_vm.nworld_eptp = pgtable_create_root(&vm->arch_vm.ept_pgtable);
@@ -660,6 +708,12 @@ int32_t create_vm(uint16_t vm_id, uint64_t pcpu_bitmap, struct acrn_vm_config *v
 		}
 	}
 
+	if (status == 0) {
+		/* the guest can't share the PMU or the LVTPC with the hypervisor profiler */
+		status = hvprof_claim_vm(vm, pcpu_bitmap);
+		pmu_claimed = (status == 0);
+	}
+
 	if (status == 0) {
 		prepare_epc_vm_memmap(vm);
 		spinlock_init(&vm->vlapic_mode_lock);
@@ -670,7 +724,7 @@ int32_t create_vm(uint16_t vm_id, uint64_t pcpu_bitmap, struct acrn_vm_config *v
 		vm->arch_vm.vlapic_mode = VM_VLAPIC_XAPIC;
 		vm->arch_vm.vm_mwait_cap = has_monitor_cap();
 		vm->intr_inject_delay_delta = 0UL;
-		vm->nr_emul_mmio_regions = 0U;
+		init_emul_io(vm);
 		vm->vcpuid_entry_nr = 0U;
 
 		/* Set up IO bit-mask such that VM exit occurs on
@@ -719,6 +773,10 @@ int32_t create_vm(uint16_t vm_id, uint64_t pcpu_bitmap, struct acrn_vm_config *v
 			*/
 			vioapic_init(vm);
 
+			if (is_viommu_configured(vm)) {
+				viommu_init(vm);
+			}
+
 			/* Populate return VM handle */
 			*rtn_vm = vm;
 			vm->sw.io_shared_page = NULL;
@@ -768,6 +826,10 @@ int32_t create_vm(uint16_t vm_id, uint64_t pcpu_bitmap, struct acrn_vm_config *v
 		(void)memset(vm->arch_vm.nworld_eptp, 0U, PAGE_SIZE);
 	}
 
+	if ((status != 0) && pmu_claimed) {
+		hvprof_release_vm(vm, pcpu_bitmap);
+	}
+
 	return status;
 }
 
@@ -855,6 +917,8 @@ int32_t shutdown_vm(struct acrn_vm *vm)
 
 	deinit_vpci(vm);
 
+	deinit_viommu(vm);
+
 	deinit_emul_io(vm);
 
 	/* Free EPT allocated resources assigned to VM */
@@ -869,6 +933,8 @@ int32_t shutdown_vm(struct acrn_vm *vm)
 		offline_vcpu(vcpu);
 	}
 
+	hvprof_release_vm(vm, vm->hw.cpu_affinity);
+
 	/* after guest_flags not used, then clear it */
 	vm_config = get_vm_config(vm->vm_id);
 	vm_config->guest_flags &= ~DM_OWNED_GUEST_FLAG_MASK;
@@ -932,6 +998,11 @@ int32_t reset_vm(struct acrn_vm *vm)
 
 	reset_vm_ioreqs(vm);
 	reset_vioapics(vm);
+	reset_viommu(vm);
+	if (!is_lapic_pt_configured(vm)) {
+		reset_vpic(vm);
+	}
+	vm->wire_mode = VPIC_WIRE_INTR;
 	destroy_secure_world(vm, false);
 	vm->sworld_control.flag.active = 0UL;
 	vm->arch_vm.iwkey_backup_status = 0UL;
@@ -1001,7 +1072,7 @@ void resume_vm_from_s3(struct acrn_vm *vm, uint32_t wakeup_vec)
 	launch_vcpu(bsp);
 }
 
-static uint8_t loaded_pre_vm_nr = 0U;
+static int32_t loaded_pre_vm_nr = 0;
 /**
  * Prepare to create vm/vcpu for vm
  *
@@ -1024,6 +1095,7 @@ int32_t prepare_vm(uint16_t vm_id, struct acrn_vm_config *vm_config)
 	}
 
 	if (err == 0) {
+		boot_phase("VM created", vm_id);
 		if (is_prelaunched_vm(vm)) {
 			build_vrsdp(vm);
 		}
@@ -1035,23 +1107,27 @@ int32_t prepare_vm(uint16_t vm_id, struct acrn_vm_config *vm_config)
 			 * when KASLR enabled.
 			 * In case the pre-launched VMs aren't loaded successfuly that cause deadlock here,
 			 * use a 10000ms timer to break the waiting loop.
+			 * Meanwhile, help loading them.
 			 */
 			uint64_t start_tick = cpu_ticks();
 
-			while (loaded_pre_vm_nr != PRE_VM_NUM) {
+			while ((uint32_t)loaded_pre_vm_nr != PRE_VM_NUM) {
 				uint64_t timeout = ticks_to_ms(cpu_ticks() - start_tick);
 
 				if (timeout > 10000U) {
 					pr_err("Loading pre-launched VMs timeout!");
 					break;
 				}
+				boot_work_help();
 			}
 		}
 
 		err = prepare_os_image(vm);
+		boot_phase("VM image loaded", vm_id);
 
 		if (is_prelaunched_vm(vm)) {
-			loaded_pre_vm_nr++;
+			/* pre-launched VMs may be loaded by different pCPUs concurrently */
+			(void)atomic_inc_return(&loaded_pre_vm_nr);
 		}
 	}
 
@@ -1095,6 +1171,7 @@ void launch_vms(uint16_t pcpu_id)
 						/* Nothing need to do here, REE will start in TEE hypercall */
 					} else {
 						start_vm(get_vm_from_vmid(vm_id));
+						boot_phase("VM started", vm_id);
 						pr_acrnlog("Start VM id: %x name: %s", vm_id, vm_config->name);
 					}
 				}
@@ -52,6 +52,10 @@ static const struct hc_dispatch hc_dispatch_table[] = {
 		.handler = hcall_set_vcpu_regs},
 	[HC_IDX(HC_CREATE_VCPU)] = {
 		.handler = hcall_create_vcpu},
+	[HC_IDX(HC_GET_VCPU_EXIT_STATS)] = {
+		.handler = hcall_get_vcpu_exit_stats},
+	[HC_IDX(HC_GET_VM_IO_STATS)] = {
+		.handler = hcall_get_vm_io_stats},
 	[HC_IDX(HC_SET_IRQLINE)] = {
 		.handler = hcall_set_irqline},
 	[HC_IDX(HC_INJECT_MSI)] = {
@@ -78,6 +82,8 @@ static const struct hc_dispatch hc_dispatch_table[] = {
 		.handler = hcall_add_vdev},
 	[HC_IDX(HC_REMOVE_VDEV)] = {
 		.handler = hcall_remove_vdev},
+	[HC_IDX(HC_SET_PCI_CFG_SHADOW)] = {
+		.handler = hcall_set_pci_cfg_shadow},
 	[HC_IDX(HC_SET_PTDEV_INTR_INFO)] = {
 		.handler = hcall_set_ptdev_intr_info},
 	[HC_IDX(HC_RESET_PTDEV_INTR_INFO)] = {
@@ -94,6 +100,10 @@ static const struct hc_dispatch hc_dispatch_table[] = {
 		.handler = hcall_profiling_ops},
 	[HC_IDX(HC_GET_HW_INFO)] = {
 		.handler = hcall_get_hw_info},
+	[HC_IDX(HC_SET_TRACE_FILTER)] = {
+		.handler = hcall_set_trace_filter},
+	[HC_IDX(HC_SET_TRACE_FORMAT)] = {
+		.handler = hcall_set_trace_format},
 	[HC_IDX(HC_INITIALIZE_TRUSTY)] = {
 		.handler = hcall_initialize_trusty,
 		.permission_flags = GUEST_FLAG_SECURE_WORLD_ENABLED},
@@ -109,6 +119,10 @@ static const struct hc_dispatch hc_dispatch_table[] = {
 	[HC_IDX(HC_SWITCH_EE)] = {
 		.handler = hcall_switch_ee,
 		.permission_flags = (GUEST_FLAG_TEE | GUEST_FLAG_REE)},
+	[HC_IDX(HC_GET_RDT_MON)] = {
+		.handler = hcall_get_rdt_mon},
+	[HC_IDX(HC_SET_RDT_CTRL)] = {
+		.handler = hcall_set_rdt_ctrl},
 };
 
 uint16_t allocate_dynamical_vmid(struct acrn_vm_creation *cv)
@@ -185,6 +199,10 @@ struct acrn_vm *parse_target_vm(struct acrn_vm *service_vm, uint64_t hcall_id, u
 	case HC_SETUP_HV_NPK_LOG:
 	case HC_PROFILING_OPS:
 	case HC_GET_HW_INFO:
+	case HC_SET_TRACE_FILTER:
+	case HC_SET_TRACE_FORMAT:
+	case HC_GET_RDT_MON:
+	case HC_SET_RDT_CTRL:
 		target_vm = service_vm;
 		break;
 	default:
@@ -305,9 +305,10 @@ static void init_exec_ctrl(struct acrn_vcpu *vcpu)
 	value32 &= ~VMX_PROCBASED_CTLS_INVLPG;
 
 	/*
-	 * Enable VM_EXIT for rdpmc execution except core partition VM, like RTVM
+	 * Enable VM_EXIT for rdpmc execution except core partition VM, like RTVM,
+	 * and VMs with a vPMU, whose counters are loaded while they run
 	 */
-	if (!is_pmu_pt_configured(vcpu->vm)) {
+	if (!is_pmu_pt_configured(vcpu->vm) && !is_vpmu_configured(vcpu->vm)) {
 		value32 |= VMX_PROCBASED_CTLS_RDPMC;
 	}
 
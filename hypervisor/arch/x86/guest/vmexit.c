@@ -21,6 +21,7 @@
 #include <asm/cpuid.h>
 #include <asm/guest/vcpuid.h>
 #include <trace.h>
+#include <ticks.h>
 #include <asm/rtcm.h>
 #include <debug/console.h>
 
@@ -28,7 +29,7 @@
  * According to "SDM APPENDIX C VMX BASIC EXIT REASONS",
  * there are 65 Basic Exit Reasons.
  */
-#define NR_VMX_EXIT_REASONS	70U
+#define NR_VMX_EXIT_REASONS	ACRN_EXIT_REASON_NUM
 
 static int32_t triple_fault_vmexit_handler(struct acrn_vcpu *vcpu);
 static int32_t unhandled_vmexit_handler(struct acrn_vcpu *vcpu);
@@ -209,12 +210,57 @@ static const struct vm_exit_dispatch dispatch_table[NR_VMX_EXIT_REASONS] = {
 		.handler = loadiwkey_vmexit_handler}
 };
 
+static inline uint32_t exit_hist_bucket(uint64_t cycles)
+{
+	uint32_t bucket = 0U;
+
+	if (cycles >= (1UL << ACRN_EXIT_HIST_SHIFT)) {
+		bucket = min((uint32_t)fls64(cycles) - ACRN_EXIT_HIST_SHIFT + 1U, ACRN_EXIT_HIST_BUCKETS - 1U);
+	}
+
+	return bucket;
+}
+
+/* single writer statistics, e.g. of the vCPU itself */
+void account_exit_stat(struct acrn_exit_stat *stat, uint64_t cycles)
+{
+	stat->count++;
+	stat->cycles += cycles;
+	stat->hist[exit_hist_bucket(cycles)]++;
+}
+
+/*
+ * Always-on accounting of the exit just handled: per-vCPU statistics are
+ * only written by the vCPU itself, the per-VM I/O handler statistics are
+ * shared by all vCPUs of the VM and updated atomically.
+ */
+static void account_vmexit(struct acrn_vcpu *vcpu, uint64_t cycles)
+{
+	uint16_t reason = (uint16_t)(vcpu->arch.exit_reason & 0xFFFFU);
+	uint32_t bucket = exit_hist_bucket(cycles);
+	struct acrn_exit_stat *stat;
+
+	if (reason < ACRN_EXIT_REASON_NUM) {
+		account_exit_stat(&vcpu->exit_stats[reason], cycles);
+	}
+
+	if (vcpu->io_stat_slot < IO_STAT_SLOT_NUM) {
+		stat = &vcpu->vm->io_stats[vcpu->io_stat_slot];
+		atomic_inc64(&stat->count);
+		(void)atomic_xadd64((int64_t *)&stat->cycles, (int64_t)cycles);
+		atomic_inc32(&stat->hist[bucket]);
+	}
+}
+
 int32_t vmexit_handler(struct acrn_vcpu *vcpu)
 {
 	struct vm_exit_dispatch *dispatch = NULL;
+	uint64_t start = cpu_ticks();
 	uint16_t basic_exit_reason;
 	int32_t ret;
 
+	vcpu->io_stat_slot = IO_STAT_SLOT_NONE;
+
 	if (get_pcpu_id() != pcpuid_from_vcpu(vcpu)) {
 		pr_fatal("vcpu is not running on its pcpu!");
 		ret = -EINVAL;
@@ -282,6 +328,7 @@ int32_t vmexit_handler(struct acrn_vcpu *vcpu)
 		}
 	}
 
+	account_vmexit(vcpu, cpu_ticks() - start);
 	console_vmexit_callback(vcpu);
 
 	return ret;
@@ -23,6 +23,7 @@
 #include <trace.h>
 #include <logmsg.h>
 #include <asm/guest/vcat.h>
+#include <asm/guest/vpmu.h>
 
 #define INTERCEPT_DISABLE		(0U)
 #define INTERCEPT_READ			(1U << 0U)
@@ -130,6 +131,10 @@ static const uint32_t pmc_msrs[] = {
 	MSR_IA32_PERFEVTSEL1,
 	MSR_IA32_PERFEVTSEL2,
 	MSR_IA32_PERFEVTSEL3,
+	MSR_IA32_PERFEVTSEL4,
+	MSR_IA32_PERFEVTSEL5,
+	MSR_IA32_PERFEVTSEL6,
+	MSR_IA32_PERFEVTSEL7,
 	MSR_IA32_A_PMC0,
 	MSR_IA32_A_PMC1,
 	MSR_IA32_A_PMC2,
@@ -329,16 +334,9 @@ static void intercept_x2apic_msrs(uint8_t *msr_bitmap_arg, uint32_t mode)
  */
 static void prepare_auto_msr_area(struct acrn_vcpu *vcpu)
 {
-	vcpu->arch.msr_area.count = 0U;
+	uint32_t idx;
 
-	/* in HV, disable perf/PMC counting, just count in guest VM */
-	if (is_pmu_pt_configured(vcpu->vm)) {
-		vcpu->arch.msr_area.guest[MSR_AREA_PERF_CTRL].msr_index = MSR_IA32_PERF_GLOBAL_CTRL;
-		vcpu->arch.msr_area.guest[MSR_AREA_PERF_CTRL].value = 0;
-		vcpu->arch.msr_area.host[MSR_AREA_PERF_CTRL].msr_index = MSR_IA32_PERF_GLOBAL_CTRL;
-		vcpu->arch.msr_area.host[MSR_AREA_PERF_CTRL].value = 0;
-		vcpu->arch.msr_area.count++;
-	}
+	vcpu->arch.msr_area.count = 0U;
 
 	if (is_platform_rdt_capable()) {
 		struct acrn_vm_config *cfg = get_vm_config(vcpu->vm->vm_id);
@@ -348,12 +346,13 @@ static void prepare_auto_msr_area(struct acrn_vcpu *vcpu)
 
 		vcpu_clos = cfg->pclosids[vcpu->vcpu_id%cfg->num_pclosids];
 
-		/* RDT: only load/restore MSR_IA32_PQR_ASSOC when hv and guest have different settings
+		/* RDT: only load/restore MSR_IA32_PQR_ASSOC when hv and guest have different settings,
+		 * such VMs are monitored with their own RMID, all the others count towards RMID 0.
 		 * vCAT: always load/restore MSR_IA32_PQR_ASSOC
 		 */
 		if (is_vcat_configured(vcpu->vm) || (vcpu_clos != hv_clos)) {
 			vcpu->arch.msr_area.guest[MSR_AREA_IA32_PQR_ASSOC].msr_index = MSR_IA32_PQR_ASSOC;
-			vcpu->arch.msr_area.guest[MSR_AREA_IA32_PQR_ASSOC].value = clos2pqr_msr(vcpu_clos);
+			vcpu->arch.msr_area.guest[MSR_AREA_IA32_PQR_ASSOC].value = clos2pqr_msr(vcpu_clos) | vm_rmid(vcpu->vm->vm_id);
 			vcpu->arch.msr_area.host[MSR_AREA_IA32_PQR_ASSOC].msr_index = MSR_IA32_PQR_ASSOC;
 			vcpu->arch.msr_area.host[MSR_AREA_IA32_PQR_ASSOC].value = clos2pqr_msr(hv_clos);
 			vcpu->arch.msr_area.count++;
@@ -362,6 +361,19 @@ static void prepare_auto_msr_area(struct acrn_vcpu *vcpu)
 				vcpu->vm->vm_id, vcpu->vcpu_id, hv_clos, vcpu_clos);
 		}
 	}
+
+	/*
+	 * in HV, disable perf/PMC counting, just count in guest VM.
+	 * The area is loaded by count, so this entry follows MSR_IA32_PQR_ASSOC if that is present.
+	 */
+	if (is_pmu_pt_configured(vcpu->vm) || is_vpmu_configured(vcpu->vm)) {
+		idx = vcpu->arch.msr_area.count;
+		vcpu->arch.msr_area.guest[idx].msr_index = MSR_IA32_PERF_GLOBAL_CTRL;
+		vcpu->arch.msr_area.guest[idx].value = 0;
+		vcpu->arch.msr_area.host[idx].msr_index = MSR_IA32_PERF_GLOBAL_CTRL;
+		vcpu->arch.msr_area.host[idx].value = 0;
+		vcpu->arch.msr_area.count++;
+	}
 }
 
 /**
@@ -483,7 +495,12 @@ void init_msr_emulation(struct acrn_vcpu *vcpu)
 	/* for core partition VM (like RTVM), passthrou PMC MSRs for performance profiling/tuning; hide to other VMs */
 	if (!is_pmu_pt_configured(vcpu->vm)) {
 		for (i = 0U; i < ARRAY_SIZE(pmc_msrs); i++) {
-			enable_msr_interception(msr_bitmap, pmc_msrs[i], INTERCEPT_READ_WRITE);
+			/* with a vPMU the exposed counters are loaded while the vCPU runs, only the controls are emulated */
+			if (is_vpmu_configured(vcpu->vm) && is_vpmu_counter_msr(pmc_msrs[i])) {
+				enable_msr_interception(msr_bitmap, pmc_msrs[i], INTERCEPT_DISABLE);
+			} else {
+				enable_msr_interception(msr_bitmap, pmc_msrs[i], INTERCEPT_READ_WRITE);
+			}
 		}
 	}
 
@@ -510,6 +527,9 @@ void init_msr_emulation(struct acrn_vcpu *vcpu)
 	/* Initialize the MSR save/store area */
 	prepare_auto_msr_area(vcpu);
 
+	/* Reset the vPMU, its IA32_PERF_GLOBAL_CTRL is in the MSR area */
+	init_vpmu(vcpu);
+
 	/* Setup initial value for emulated MSRs */
 	init_emulated_msrs(vcpu);
 
@@ -727,6 +747,15 @@ int32_t rdmsr_vmexit_handler(struct acrn_vcpu *vcpu)
 		break;
 	}
 #endif
+	case MSR_IA32_PERFEVTSEL0 ... MSR_IA32_PERFEVTSEL7:
+	case MSR_IA32_FIXED_CTR_CTL:
+	case MSR_IA32_PERF_GLOBAL_STATUS:
+	case MSR_IA32_PERF_GLOBAL_CTRL:
+	case MSR_IA32_PERF_GLOBAL_OVF_CTRL:
+	{
+		err = vpmu_read_msr(vcpu, msr, &v);
+		break;
+	}
 	default:
 	{
 		if (is_x2apic_msr(msr)) {
@@ -739,7 +768,7 @@ int32_t rdmsr_vmexit_handler(struct acrn_vcpu *vcpu)
 			 */
 			err = read_vmx_msr(vcpu, msr, &v);
 		} else {
-			pr_warn("%s(): vm%d vcpu%d reading MSR %lx not supported",
+			pr_warn_ratelimited("%s(): vm%d vcpu%d reading MSR %lx not supported",
 				__func__, vcpu->vm->vm_id, vcpu->vcpu_id, msr);
 			err = -EACCES;
 			v = 0UL;
@@ -1109,7 +1138,7 @@ int32_t wrmsr_vmexit_handler(struct acrn_vcpu *vcpu)
 		 */
 		if (has_core_cap(CORE_CAP_SPLIT_LOCK) || has_core_cap(CORE_CAP_UC_LOCK)) {
 			vcpu_set_guest_msr(vcpu, MSR_TEST_CTL, v);
-			pr_warn("Ignore writting 0x%llx to MSR_TEST_CTL from VM%d", v, vcpu->vm->vm_id);
+			pr_warn_ratelimited("Ignore writting 0x%llx to MSR_TEST_CTL from VM%d", v, vcpu->vm->vm_id);
 		} else {
 			vcpu_inject_gp(vcpu, 0U);
 		}
@@ -1128,12 +1157,21 @@ int32_t wrmsr_vmexit_handler(struct acrn_vcpu *vcpu)
 		break;
 	}
 #endif
+	case MSR_IA32_PERFEVTSEL0 ... MSR_IA32_PERFEVTSEL7:
+	case MSR_IA32_FIXED_CTR_CTL:
+	case MSR_IA32_PERF_GLOBAL_STATUS:
+	case MSR_IA32_PERF_GLOBAL_CTRL:
+	case MSR_IA32_PERF_GLOBAL_OVF_CTRL:
+	{
+		err = vpmu_write_msr(vcpu, msr, v);
+		break;
+	}
 	default:
 	{
 		if (is_x2apic_msr(msr)) {
 			err = vlapic_x2apic_write(vcpu, msr, v);
 		} else {
-			pr_warn("%s(): vm%d vcpu%d writing MSR %lx not supported",
+			pr_warn_ratelimited("%s(): vm%d vcpu%d writing MSR %lx not supported",
 				__func__, vcpu->vm->vm_id, vcpu->vcpu_id, msr);
 			err = -EACCES;
 		}
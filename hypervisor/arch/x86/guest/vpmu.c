@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <types.h>
+#include <errno.h>
+#include <logmsg.h>
+#include <asm/cpu_caps.h>
+#include <asm/cpufeatures.h>
+#include <asm/cpuid.h>
+#include <asm/msr.h>
+#include <asm/irq.h>
+#include <asm/lapic.h>
+#include <asm/apicreg.h>
+#include <asm/vm_config.h>
+#include <asm/per_cpu.h>
+#include <asm/guest/vcpu.h>
+#include <asm/guest/vm.h>
+#include <asm/guest/vlapic.h>
+#include <asm/guest/vpmu.h>
+
+/* Version 2 brings IA32_PERF_GLOBAL_CTRL, _STATUS and _OVF_CTRL, which perf needs */
+#define VPMU_VERSION			2U
+
+#define PERF_CAP_FW_WRITE		(1UL << 13U)
+
+/* IA32_PERFEVTSELx bits above CMASK and AnyThread are reserved in version 2 */
+#define PERFEVTSEL_RESERVED		(0xffffffff00000000UL | (1UL << 21U))
+/* IA32_FIXED_CTR_CTRL: EN[1:0] and PMI for each counter, AnyThread is reserved */
+#define FIXED_CTR_CTRL_VALID		0xbUL
+/* IA32_PERF_GLOBAL_OVF_CTRL: ClrCondChgd and ClrOvfBuf are accepted and ignored */
+#define GLOBAL_OVF_CTRL_IGNORED		(3UL << 62U)
+
+#define LVT_PMI_MASKED			0x10000U
+
+static struct vpmu_caps {
+	uint32_t nr_gp;
+	uint32_t gp_width;
+	uint32_t nr_fixed;
+	uint32_t fixed_width;
+	/* CPUID.0AH.EAX[31:24] and EBX: architectural events not available */
+	uint32_t events_len;
+	uint32_t events_unavail;
+	/* IA32_A_PMCx take full width writes */
+	bool fw_write;
+} vpmu_caps;
+
+void init_vpmu_caps(void)
+{
+	uint32_t eax, ebx, ecx, edx;
+
+	if (get_pcpu_info()->cpuid_level >= 0xAU) {
+		cpuid_subleaf(0xAU, 0U, &eax, &ebx, &ecx, &edx);
+		if ((eax & 0xffU) >= VPMU_VERSION) {
+			vpmu_caps.nr_gp = min((eax >> 8U) & 0xffU, VPMU_MAX_GP_COUNTERS);
+			vpmu_caps.gp_width = (eax >> 16U) & 0xffU;
+			vpmu_caps.events_len = min(eax >> 24U, 31U);
+			vpmu_caps.events_unavail = ebx & ((1U << vpmu_caps.events_len) - 1U);
+			vpmu_caps.nr_fixed = min(edx & 0x1fU, VPMU_MAX_FIXED_COUNTERS);
+			vpmu_caps.fixed_width = (edx >> 5U) & 0xffU;
+
+			if (pcpu_has_cap(X86_FEATURE_PDCM)) {
+				vpmu_caps.fw_write = ((msr_read(MSR_IA32_PERF_CAPABILITIES) & PERF_CAP_FW_WRITE) != 0UL);
+			}
+
+			pr_info("vPMU: %u general purpose counters, %u fixed counters",
+				vpmu_caps.nr_gp, vpmu_caps.nr_fixed);
+		}
+	}
+}
+
+/**
+ * @pre vm != NULL && vm->vm_id < CONFIG_MAX_VM_NUM
+ */
+bool is_vpmu_configured(const struct acrn_vm *vm)
+{
+	struct acrn_vm_config *vm_config = get_vm_config(vm->vm_id);
+
+	return ((vm_config->guest_flags & GUEST_FLAG_VPMU) != 0UL) && !is_pmu_pt_configured(vm) &&
+		(vpmu_caps.nr_gp != 0U);
+}
+
+void vpmu_cpuid_leaf_0ah(uint32_t *eax, uint32_t *ebx, uint32_t *ecx, uint32_t *edx)
+{
+	*eax = VPMU_VERSION | (vpmu_caps.nr_gp << 8U) | (vpmu_caps.gp_width << 16U) |
+		(vpmu_caps.events_len << 24U);
+	*ebx = vpmu_caps.events_unavail;
+	*ecx = 0U;
+	*edx = vpmu_caps.nr_fixed | (vpmu_caps.fixed_width << 5U);
+}
+
+bool is_vpmu_counter_msr(uint32_t msr)
+{
+	return ((msr >= MSR_IA32_PMC0) && (msr < (MSR_IA32_PMC0 + vpmu_caps.nr_gp))) ||
+		((msr >= MSR_IA32_FIXED_CTR0) && (msr < (MSR_IA32_FIXED_CTR0 + vpmu_caps.nr_fixed)));
+}
+
+/* the counter bits of IA32_PERF_GLOBAL_CTRL, _STATUS and _OVF_CTRL */
+static inline uint64_t vpmu_global_mask(void)
+{
+	return ((1UL << vpmu_caps.nr_gp) - 1UL) | (((1UL << vpmu_caps.nr_fixed) - 1UL) << 32U);
+}
+
+static uint64_t fixed_ctr_ctrl_mask(void)
+{
+	uint64_t mask = 0UL;
+	uint32_t i;
+
+	for (i = 0U; i < vpmu_caps.nr_fixed; i++) {
+		mask |= FIXED_CTR_CTRL_VALID << (i * 4U);
+	}
+
+	return mask;
+}
+
+/*
+ * The guest IA32_PERF_GLOBAL_CTRL lives in the VM entry/exit MSR area, so that
+ * the counters stop on VM exit.
+ *
+ * @pre is_vpmu_configured(vcpu->vm)
+ */
+static struct msr_store_entry *vpmu_global_ctrl(struct acrn_vcpu *vcpu)
+{
+	struct msr_store_area *area = &vcpu->arch.msr_area;
+	struct msr_store_entry *entry = NULL;
+	uint32_t i;
+
+	for (i = 0U; i < area->count; i++) {
+		if (area->guest[i].msr_index == MSR_IA32_PERF_GLOBAL_CTRL) {
+			entry = &area->guest[i];
+			break;
+		}
+	}
+
+	return entry;
+}
+
+/**
+ * @pre vcpu != NULL && vcpu->vm != NULL
+ */
+void init_vpmu(struct acrn_vcpu *vcpu)
+{
+	if (is_vpmu_configured(vcpu->vm)) {
+		(void)memset(&vcpu->arch.vpmu, 0U, sizeof(struct acrn_vpmu));
+
+		/* VMCS initialization upon vCPU reset runs with the vPMU loaded */
+		if (get_running_vcpu(get_pcpu_id()) == vcpu) {
+			vpmu_restore(vcpu);
+		}
+	}
+}
+
+/**
+ * @pre vcpu != NULL && vcpu->vm != NULL && val != NULL
+ */
+int32_t vpmu_read_msr(struct acrn_vcpu *vcpu, uint32_t msr, uint64_t *val)
+{
+	struct acrn_vpmu *vpmu = &vcpu->arch.vpmu;
+	int32_t ret = -EACCES;
+
+	if (is_vpmu_configured(vcpu->vm)) {
+		ret = 0;
+		switch (msr) {
+		case MSR_IA32_PERF_GLOBAL_CTRL:
+			*val = vpmu_global_ctrl(vcpu)->value;
+			break;
+		case MSR_IA32_PERF_GLOBAL_STATUS:
+			/* overflows since the last PMI are still in the physical status */
+			*val = vpmu->global_status | (msr_read(MSR_IA32_PERF_GLOBAL_STATUS) & vpmu_global_mask());
+			break;
+		case MSR_IA32_PERF_GLOBAL_OVF_CTRL:
+			*val = 0UL;
+			break;
+		case MSR_IA32_FIXED_CTR_CTL:
+			if (vpmu_caps.nr_fixed != 0U) {
+				*val = vpmu->fixed_ctr_ctrl;
+			} else {
+				ret = -EACCES;
+			}
+			break;
+		default:
+			if ((msr >= MSR_IA32_PERFEVTSEL0) && (msr < (MSR_IA32_PERFEVTSEL0 + vpmu_caps.nr_gp))) {
+				*val = vpmu->evtsel[msr - MSR_IA32_PERFEVTSEL0];
+			} else {
+				ret = -EACCES;
+			}
+			break;
+		}
+	}
+
+	return ret;
+}
+
+/**
+ * @pre vcpu != NULL && vcpu->vm != NULL
+ */
+int32_t vpmu_write_msr(struct acrn_vcpu *vcpu, uint32_t msr, uint64_t val)
+{
+	struct acrn_vpmu *vpmu = &vcpu->arch.vpmu;
+	int32_t ret = -EACCES;
+
+	if (is_vpmu_configured(vcpu->vm)) {
+		switch (msr) {
+		case MSR_IA32_PERF_GLOBAL_CTRL:
+			if ((val & ~vpmu_global_mask()) == 0UL) {
+				/* takes effect on the next VM entry */
+				vpmu_global_ctrl(vcpu)->value = val;
+				ret = 0;
+			}
+			break;
+		case MSR_IA32_PERF_GLOBAL_OVF_CTRL:
+			if ((val & ~(vpmu_global_mask() | GLOBAL_OVF_CTRL_IGNORED)) == 0UL) {
+				vpmu->global_status &= ~val;
+				msr_write(MSR_IA32_PERF_GLOBAL_OVF_CTRL, val & vpmu_global_mask());
+				ret = 0;
+			}
+			break;
+		case MSR_IA32_FIXED_CTR_CTL:
+			if ((vpmu_caps.nr_fixed != 0U) && ((val & ~fixed_ctr_ctrl_mask()) == 0UL)) {
+				vpmu->fixed_ctr_ctrl = val;
+				msr_write(MSR_IA32_FIXED_CTR_CTL, val);
+				ret = 0;
+			}
+			break;
+		default:
+			if ((msr >= MSR_IA32_PERFEVTSEL0) && (msr < (MSR_IA32_PERFEVTSEL0 + vpmu_caps.nr_gp)) &&
+					((val & PERFEVTSEL_RESERVED) == 0UL)) {
+				vpmu->evtsel[msr - MSR_IA32_PERFEVTSEL0] = val;
+				msr_write(msr, val);
+				ret = 0;
+			}
+			break;
+		}
+	}
+
+	return ret;
+}
+
+static void vpmu_latch_overflow(struct acrn_vcpu *vcpu, uint64_t status)
+{
+	msr_write(MSR_IA32_PERF_GLOBAL_OVF_CTRL, status);
+	vcpu->arch.vpmu.global_status |= status;
+	(void)vlapic_set_local_intr(vcpu->vm, vcpu->vcpu_id, APIC_LVT_PMC);
+}
+
+/**
+ * @pre vcpu != NULL && vcpu->vm != NULL
+ */
+void vpmu_save(struct acrn_vcpu *vcpu)
+{
+	struct acrn_vpmu *vpmu = &vcpu->arch.vpmu;
+	uint64_t status;
+	uint32_t i;
+
+	if (is_vpmu_configured(vcpu->vm)) {
+		/* the counters stopped on VM exit with the host IA32_PERF_GLOBAL_CTRL of 0 */
+		for (i = 0U; i < vpmu_caps.nr_gp; i++) {
+			vpmu->pmc[i] = msr_read(MSR_IA32_PMC0 + i);
+		}
+		for (i = 0U; i < vpmu_caps.nr_fixed; i++) {
+			vpmu->fixed_ctr[i] = msr_read(MSR_IA32_FIXED_CTR0 + i);
+		}
+
+		/* an overflow right before the VM exit whose PMI is yet to come */
+		status = msr_read(MSR_IA32_PERF_GLOBAL_STATUS) & vpmu_global_mask();
+		if (status != 0UL) {
+			vpmu_latch_overflow(vcpu, status);
+		}
+
+		msr_write(MSR_IA32_EXT_APIC_LVT_PMI, PMI_VECTOR | LVT_PMI_MASKED);
+	}
+}
+
+/**
+ * @pre vcpu != NULL && vcpu->vm != NULL
+ */
+void vpmu_restore(struct acrn_vcpu *vcpu)
+{
+	const struct acrn_vpmu *vpmu = &vcpu->arch.vpmu;
+	uint32_t pmc_base = vpmu_caps.fw_write ? MSR_IA32_A_PMC0 : MSR_IA32_PMC0;
+	uint32_t i;
+
+	if (is_vpmu_configured(vcpu->vm)) {
+		for (i = 0U; i < vpmu_caps.nr_gp; i++) {
+			msr_write(MSR_IA32_PERFEVTSEL0 + i, vpmu->evtsel[i]);
+			msr_write(pmc_base + i, vpmu->pmc[i]);
+		}
+		if (vpmu_caps.nr_fixed != 0U) {
+			msr_write(MSR_IA32_FIXED_CTR_CTL, vpmu->fixed_ctr_ctrl);
+			for (i = 0U; i < vpmu_caps.nr_fixed; i++) {
+				msr_write(MSR_IA32_FIXED_CTR0 + i, vpmu->fixed_ctr[i]);
+			}
+		}
+
+		msr_write(MSR_IA32_EXT_APIC_LVT_PMI, PMI_VECTOR);
+	}
+}
+
+/**
+ * @pre vcpu != NULL && vcpu->vm != NULL
+ */
+bool vpmu_handle_pmi(struct acrn_vcpu *vcpu)
+{
+	uint64_t status;
+	bool handled = false;
+
+	if (is_vpmu_configured(vcpu->vm)) {
+		status = msr_read(MSR_IA32_PERF_GLOBAL_STATUS) & vpmu_global_mask();
+		if (status != 0UL) {
+			vpmu_latch_overflow(vcpu, status);
+		}
+
+		/* the LAPIC masked LVTPC when delivering the PMI */
+		msr_write(MSR_IA32_EXT_APIC_LVT_PMI, PMI_VECTOR);
+		send_lapic_eoi();
+		handled = true;
+	}
+
+	return handled;
+}
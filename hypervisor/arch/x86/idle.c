@@ -0,0 +1,282 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <types.h>
+#include <acrn_common.h>
+#include <asm/cpu.h>
+#include <asm/cpu_caps.h>
+#include <asm/cpuid.h>
+#include <asm/host_pm.h>
+#include <asm/per_cpu.h>
+#include <asm/idle.h>
+#include <asm/guest/vm.h>
+#include <schedule.h>
+#include <timer.h>
+#include <ticks.h>
+#include <logmsg.h>
+
+/* MWAIT ECX[0]: interrupts break MWAIT even if they are masked */
+#define MWAIT_ECX_INTERRUPT_BREAK	1UL
+/* longer intervals tell nothing about the next one, and would overflow the variance */
+#define IDLE_MAX_INTERVAL_US		1000000U
+
+static struct idle_state idle_states[IDLE_MAX_STATES];
+static uint32_t nr_idle_states = 1U;
+
+#ifndef CONFIG_KEEP_IRQ_DISABLED
+static bool is_mwait_hint_supported(uint32_t edx, uint32_t hint)
+{
+	/* CPUID.05H:EDX[4n+3:4n] is the number of sub C-states of MWAIT C-state n - 1 */
+	uint32_t cstate = ((hint >> 4U) & 0xfU) + 1U;
+	uint32_t nr_substates = (cstate < 8U) ? ((edx >> (cstate * 4U)) & 0xfU) : 0U;
+
+	return ((hint & 0xfU) < nr_substates);
+}
+
+static void add_idle_state(uint32_t hint, uint32_t latency)
+{
+	struct idle_state *state = &idle_states[nr_idle_states];
+
+	state->mwait_hint = hint;
+	state->exit_latency = latency;
+	state->target_residency = latency * 2U;
+	nr_idle_states++;
+}
+
+/*
+ * The hypervisor's timers run on the LAPIC timer, which may stop in C-states
+ * deeper than C1 unless it is always running (ARAT).
+ */
+static bool is_arat_supported(void)
+{
+	uint32_t eax = 0U, unused;
+
+	if (get_pcpu_info()->cpuid_level >= CPUID_THERMAL_POWER) {
+		cpuid_subleaf(CPUID_THERMAL_POWER, 0U, &eax, &unused, &unused, &unused);
+	}
+
+	return ((eax & CPUID_EAX_ARAT) != 0U);
+}
+
+/*
+ * Only the MWAIT (FFixedHW, Intel native) entries of the board's Cx data are
+ * used. The MWAIT has to be broken by interrupts while they are still masked,
+ * so that no wake up is lost between the last check and the MWAIT.
+ */
+static void probe_mwait_states(void)
+{
+	const struct cpu_state_info *pm = get_cpu_pm_state_info();
+	const struct acrn_cstate_data *cx;
+	uint32_t eax, ebx, ecx, edx, hint, last_hint = 0U;
+	uint8_t i, cx_cnt;
+
+	if (has_monitor_cap() && (get_pcpu_info()->cpuid_level >= CPUID_MONITOR_MWAIT)) {
+		cpuid_subleaf(CPUID_MONITOR_MWAIT, 0U, &eax, &ebx, &ecx, &edx);
+		/* ECX[0]: MWAIT extensions enumerated, ECX[1]: interrupt break-event supported */
+		if ((ecx & 0x3U) == 0x3U) {
+			add_idle_state(0U, 1U);
+			/* nothing deeper than C1 without ARAT */
+			cx_cnt = is_arat_supported() ? pm->cx_cnt : 0U;
+			for (i = 0U; i < cx_cnt; i++) {
+				cx = &pm->cx_data[i];
+				hint = (uint32_t)cx->cx_reg.address;
+				/*
+				 * bit_width 1: Intel, bit_offset 2: native C-state instruction.
+				 * Deeper states must not exit faster, see get_idle_state_limit().
+				 */
+				if ((cx->cx_reg.space_id == SPACE_FFixedHW) && (cx->cx_reg.bit_width == 1U) &&
+						(cx->cx_reg.bit_offset == 2U) && (hint > last_hint) &&
+						(cx->latency >= idle_states[nr_idle_states - 1U].exit_latency) &&
+						is_mwait_hint_supported(edx, hint) && (nr_idle_states < IDLE_MAX_STATES)) {
+					add_idle_state(hint, max(cx->latency, 1U));
+					last_hint = hint;
+				}
+			}
+		}
+	}
+}
+#endif
+
+/*
+ * Without a usable MWAIT the pCPU keeps polling, as it does when interrupts
+ * are kept disabled in root mode.
+ *
+ * @pre called on the BSP after load_pcpu_state_data()
+ */
+void init_idle_states(void)
+{
+	idle_states[IDLE_STATE_POLL].mwait_hint = 0U;
+	idle_states[IDLE_STATE_POLL].exit_latency = 0U;
+	idle_states[IDLE_STATE_POLL].target_residency = 0U;
+	nr_idle_states = 1U;
+
+#ifndef CONFIG_KEEP_IRQ_DISABLED
+	probe_mwait_states();
+#endif
+
+	pr_acrnlog("%u idle states", nr_idle_states);
+}
+
+const struct idle_state *get_idle_states(uint32_t *nr)
+{
+	*nr = nr_idle_states;
+	return idle_states;
+}
+
+/*
+ * RT vCPUs need a short and predictable wake up latency, the pCPUs they
+ * run on don't go deeper than C1. Other VMs may cap the exit latency of
+ * their pCPUs with max_idle_latency in their configuration.
+ *
+ * @return the deepest state the pCPU may enter
+ */
+uint32_t get_idle_state_limit(uint16_t pcpu_id)
+{
+	const struct acrn_vcpu *vcpu;
+	uint32_t limit = nr_idle_states - 1U, max_latency;
+	uint16_t vm_id;
+
+	for (vm_id = 0U; (vm_id < CONFIG_MAX_VM_NUM) && (limit > IDLE_STATE_C1); vm_id++) {
+		vcpu = per_cpu(vcpu_array, pcpu_id)[vm_id];
+		if (vcpu != NULL) {
+			max_latency = get_vm_config(vm_id)->max_idle_latency;
+			if (is_rt_vm(vcpu->vm)) {
+				limit = IDLE_STATE_C1;
+			} else if (max_latency != 0U) {
+				/* the states are ordered by exit latency, C1 takes 1us */
+				while ((limit > IDLE_STATE_C1) && (idle_states[limit].exit_latency > max_latency)) {
+					limit--;
+				}
+			} else {
+				/* no cap */
+			}
+		}
+	}
+
+	return limit;
+}
+
+/*
+ * If the recent idle intervals are close to each other, their average is a
+ * better guess than the next timer. The largest interval is dropped as an
+ * outlier up to three times, as long as half of the history remains.
+ *
+ * @return the typical interval in us, ~0U if there is no pattern
+ */
+static uint32_t typical_interval(const struct cpu_idle *ci)
+{
+	uint64_t sum, avg, variance, diff;
+	uint32_t i, v, nr, max_v, thresh = ~0U, ret = ~0U, tries;
+
+	for (tries = 0U; tries < 3U; tries++) {
+		sum = 0UL;
+		nr = 0U;
+		max_v = 0U;
+		for (i = 0U; i < IDLE_HISTORY_NUM; i++) {
+			v = ci->history[i];
+			if (v <= thresh) {
+				sum += v;
+				nr++;
+				max_v = max(max_v, v);
+			}
+		}
+		if ((nr * 2U) < IDLE_HISTORY_NUM) {
+			break;
+		}
+
+		avg = sum / nr;
+		variance = 0UL;
+		for (i = 0U; i < IDLE_HISTORY_NUM; i++) {
+			v = ci->history[i];
+			if (v <= thresh) {
+				diff = (v > avg) ? (v - avg) : (avg - v);
+				variance += diff * diff;
+			}
+		}
+		variance /= nr;
+
+		/* a standard deviation below 1/6 of the average */
+		if ((avg * avg) > (variance * 36UL)) {
+			ret = (uint32_t)avg;
+			break;
+		}
+		if (max_v == 0U) {
+			break;
+		}
+		thresh = max_v - 1U;
+	}
+
+	return ret;
+}
+
+static uint32_t select_idle_state(const struct cpu_idle *ci, uint32_t limit)
+{
+	uint64_t now = cpu_ticks(), deadline = get_next_timer_deadline();
+	uint32_t predicted = ~0U, idx = IDLE_STATE_POLL, i;
+
+	if (deadline != 0UL) {
+		predicted = (deadline > now) ? (uint32_t)min(ticks_to_us(deadline - now), (uint64_t)~0U) : 0U;
+	}
+	predicted = min(predicted, typical_interval(ci));
+
+	for (i = IDLE_STATE_C1; i <= limit; i++) {
+		if (idle_states[i].target_residency <= predicted) {
+			idx = i;
+		}
+	}
+
+	return idx;
+}
+
+/*
+ * Called by the idle thread with interrupts disabled, after it has checked
+ * that there is nothing to do. The MWAIT monitors the scheduling flags and
+ * is broken by masked interrupts, which are taken on the way out.
+ */
+void cpu_do_idle(uint16_t pcpu_id)
+{
+	struct cpu_idle *ci = &per_cpu(cpu_idle, pcpu_id);
+	struct idle_stat *stat;
+	uint64_t start, ticks;
+	uint32_t limit = get_idle_state_limit(pcpu_id), idx, us;
+
+	idx = select_idle_state(ci, limit);
+	start = cpu_ticks();
+	if (idx == IDLE_STATE_POLL) {
+		CPU_IRQ_ENABLE_ON_CONFIG();
+		asm_pause();
+		CPU_IRQ_DISABLE_ON_CONFIG();
+	} else {
+		asm_monitor(&per_cpu(sched_ctl, pcpu_id).flags, 0UL, 0UL);
+		if (!need_reschedule(pcpu_id)) {
+			asm_mwait((uint64_t)idle_states[idx].mwait_hint, MWAIT_ECX_INTERRUPT_BREAK);
+		}
+	}
+	ticks = cpu_ticks() - start;
+
+	stat = &ci->stats[idx];
+	stat->usage++;
+	stat->residency += ticks;
+	if (idx != IDLE_STATE_POLL) {
+		us = (uint32_t)min(ticks_to_us(ticks), (uint64_t)IDLE_MAX_INTERVAL_US);
+		if (us < idle_states[idx].target_residency) {
+			stat->above++;
+		} else if ((idx < limit) && (us >= idle_states[idx + 1U].target_residency)) {
+			stat->below++;
+		} else {
+			/* the right pick */
+		}
+
+		/* polls last a single PAUSE, they'd only hide the real idle intervals */
+		ci->history[ci->hist_idx] = us;
+		ci->hist_idx = (ci->hist_idx + 1U) % IDLE_HISTORY_NUM;
+
+		/* take the interrupt which ended the MWAIT */
+		CPU_IRQ_ENABLE_ON_CONFIG();
+		asm_pause();
+		CPU_IRQ_DISABLE_ON_CONFIG();
+	}
+}
@@ -15,6 +15,7 @@
 #include <asm/seed.h>
 #include <asm/boot/ld_sym.h>
 #include <boot.h>
+#include <boot_work.h>
 
 /* boot_regs store the multiboot info magic and address, defined in
    arch/x86/boot/cpu_primary.S.
@@ -59,6 +60,10 @@ static void init_guest_mode(uint16_t pcpu_id)
 	vmx_on();
 
 	launch_vms(pcpu_id);
+
+	/* help with what the pCPUs still preparing their VMs have queued, then schedule */
+	boot_work_done();
+	boot_work_help();
 }
 
 static void init_pcpu_comm_post(void)
@@ -68,6 +73,9 @@ static void init_pcpu_comm_post(void)
 	pcpu_id = get_pcpu_id();
 
 	init_pcpu_post(pcpu_id);
+	if (pcpu_id == BSP_CPU_ID) {
+		boot_phase("all pCPUs initialized", ACRN_INVALID_VMID);
+	}
 	init_debug_post(pcpu_id);
 	init_guest_mode(pcpu_id);
 	run_idle_thread();
@@ -104,6 +112,9 @@ void init_primary_pcpu(void)
 	init_seed();
 	init_misc();
 
+	boot_phase("BSP early init", ACRN_INVALID_VMID);
+	init_boot_work(ALL_CPUS_MASK);
+
 	/* Switch to run-time stack */
 	rsp = (uint64_t)(&get_cpu_var(stack)[CONFIG_STACK_SIZE - 1]);
 	rsp &= ~(CPU_STACK_ALIGN - 1UL);
@@ -9,8 +9,9 @@
 
 #include <asm/guest/vcpu.h>
 #include <asm/guest/virq.h>
+#include <hvprof.h>
 
-void handle_nmi(__unused struct intr_excp_ctx *ctx)
+void handle_nmi(struct intr_excp_ctx *ctx)
 {
 	uint16_t pcpu_id = get_pcpu_id();
 	struct acrn_vcpu *vcpu = get_running_vcpu(pcpu_id);
@@ -19,5 +20,7 @@ void handle_nmi(__unused struct intr_excp_ctx *ctx)
 	 * If NMI occurs, inject it into current vcpu. Now just PMI is verified.
 	 * For other kind of NMI, it may need to be checked further.
 	 */
-	vcpu_make_request(vcpu, ACRN_REQUEST_NMI);
+	if (!hvprof_handle_nmi(ctx)) {
+		vcpu_make_request(vcpu, ACRN_REQUEST_NMI);
+	}
 }
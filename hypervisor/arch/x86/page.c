@@ -57,3 +57,16 @@ void free_page(struct page_pool *pool, struct page *page)
 	bitmap_clear_nolock(bit, pool->bitmap + idx);
 	spinlock_release(&pool->lock);
 }
+
+uint64_t get_used_page_num(struct page_pool *pool)
+{
+	uint64_t idx, nr = 0UL;
+
+	spinlock_obtain(&pool->lock);
+	for (idx = 0UL; idx < pool->bitmap_size; idx++) {
+		nr += bitmap_weight(*(pool->bitmap + idx));
+	}
+	spinlock_release(&pool->lock);
+
+	return nr;
+}
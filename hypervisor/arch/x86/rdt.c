@@ -60,6 +60,8 @@ static struct rdt_info res_cap_info[RDT_NUM_RESOURCES] = {
 	},
 };
 
+static struct rdt_mon_info mon_cap_info;
+
 /*
  * @pre res == RDT_RESOURCE_L3 || res == RDT_RESOURCE_L2 || res == RDT_RESOURCE_MBA
  */
@@ -109,6 +111,27 @@ static void init_mba_capability(int res)
 	res_cap_info[res].num_closids = (uint16_t)(edx & 0xffffU) + 1U;
 }
 
+static void init_mon_capability(void)
+{
+	uint32_t eax = 0U, ebx = 0U, ecx = 0U, edx = 0U;
+
+	/* CPUID.(EAX=0xF,ECX=0):EDX[1] reports L3 monitoring */
+	cpuid_subleaf(CPUID_RDT_MONITORING, 0U, &eax, &ebx, &ecx, &edx);
+	if ((edx & 0x2U) != 0U) {
+		/* CPUID.(EAX=0xF,ECX=1):EAX[7:0] reports the MBM counter width offset from 24 bits
+		 * CPUID.(EAX=0xF,ECX=1):EBX reports the conversion factor from counter units to bytes
+		 * CPUID.(EAX=0xF,ECX=1):ECX reports the highest RMID of the L3
+		 * CPUID.(EAX=0xF,ECX=1):EDX[2:0] reports occupancy, total and local bandwidth monitoring
+		 */
+		cpuid_subleaf(CPUID_RDT_MONITORING, 1U, &eax, &ebx, &ecx, &edx);
+		/* bit 63 and 62 of IA32_QM_CTR are the error and unavailable flags */
+		mon_cap_info.mbm_width = min(24U + (eax & 0xffU), 62U);
+		mon_cap_info.upscale = ebx;
+		mon_cap_info.max_rmid = min(ecx, (uint32_t)RDT_RMID_MASK);
+		mon_cap_info.events = (edx & 0x7U) << 1U;
+	}
+}
+
 /*
  * @pre common_num_closids > 0U
  */
@@ -144,6 +167,10 @@ void init_rdt_info(void)
 			}
 		}
 	}
+
+	if ((get_pcpu_info()->cpuid_leaves[FEAT_7_0_EBX] & CPUID_EBX_PQM) != 0U) {
+		init_mon_capability();
+	}
 }
 
 /*
@@ -222,6 +249,77 @@ bool is_platform_rdt_capable(void)
 
 	return ret;
 }
+
+/*
+ * Program one CLOS of a resource on the current pCPU. The CAT and MBA MSRs
+ * are shared by all logical processors of the cache domain, and the value is
+ * kept for setup_clos() so that pCPUs coming online pick it up as well.
+ *
+ * @pre res < RDT_NUM_RESOURCES && clos < common_num_closids
+ * @pre res == RDT_RESOURCE_MBA || !res_cap_info[res].res.cache.is_cdp_enabled
+ */
+void rdt_write_clos_msr(int res, uint16_t clos, uint32_t val)
+{
+	if (res == RDT_RESOURCE_MBA) {
+		res_cap_info[res].platform_clos_array[clos].value.mba_delay = (uint16_t)val;
+	} else {
+		res_cap_info[res].platform_clos_array[clos].value.clos_mask = val;
+	}
+	msr_write(res_cap_info[res].msr_base + clos, (uint64_t)val);
+}
+
+/*
+ * @return the number of CLOS programmed for each supported resource, which
+ *	   also bounds the configured CLOS arrays
+ */
+uint16_t get_rdt_num_closids(void)
+{
+	return common_num_closids;
+}
+
+const struct rdt_mon_info *get_rdt_mon_info(void)
+{
+	return &mon_cap_info;
+}
+
+bool is_rdt_mon_capable(void)
+{
+	return (mon_cap_info.max_rmid != 0U);
+}
+
+/*
+ * RMID 0 is shared by the hypervisor and the VMs which aren't monitored.
+ *
+ * @return the RMID of a VM, 0 if there are not enough RMIDs
+ */
+uint32_t vm_rmid(uint16_t vm_id)
+{
+	uint32_t rmid = (uint32_t)vm_id + 1U;
+
+	return (rmid <= mon_cap_info.max_rmid) ? rmid : 0U;
+}
+
+/*
+ * Read a monitoring counter of the cache domain of the current pCPU
+ *
+ * @return the raw counter, in units of rdt_mon_info.upscale bytes, RDT_MON_INVALID
+ *	   if the RMID has no data
+ */
+uint64_t rdt_read_mon_counter(uint32_t rmid, uint32_t evt)
+{
+	uint64_t val = RDT_MON_INVALID;
+
+	if ((mon_cap_info.events & (1U << evt)) != 0U) {
+		msr_write(MSR_IA32_QM_EVTSEL, ((uint64_t)rmid << 32U) | evt);
+		val = msr_read(MSR_IA32_QM_CTR);
+		/* bit 63: error, bit 62: unavailable */
+		if ((val & (3UL << 62U)) != 0UL) {
+			val = RDT_MON_INVALID;
+		}
+	}
+
+	return val;
+}
 #else
 uint64_t clos2pqr_msr(__unused uint16_t clos)
 {
@@ -232,4 +330,14 @@ bool is_platform_rdt_capable(void)
 {
 	return false;
 }
+
+bool is_rdt_mon_capable(void)
+{
+	return false;
+}
+
+uint32_t vm_rmid(__unused uint16_t vm_id)
+{
+	return 0U;
+}
 #endif
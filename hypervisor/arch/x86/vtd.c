@@ -34,45 +34,12 @@
 #endif
 #define LEVEL_WIDTH 9U
 
-#define ROOT_ENTRY_LOWER_PRESENT_POS        (0U)
-#define ROOT_ENTRY_LOWER_PRESENT_MASK       (1UL << ROOT_ENTRY_LOWER_PRESENT_POS)
-#define ROOT_ENTRY_LOWER_CTP_POS            (12U)
-#define ROOT_ENTRY_LOWER_CTP_MASK           (0xFFFFFFFFFFFFFUL << ROOT_ENTRY_LOWER_CTP_POS)
-
 #define CONFIG_MAX_IOMMU_NUM		DRHD_COUNT
 
 /* 4 iommu fault register state */
 #define	IOMMU_FAULT_REGISTER_STATE_NUM	4U
 #define	IOMMU_FAULT_REGISTER_SIZE	4U
 
-#define CTX_ENTRY_UPPER_AW_POS          (0U)
-#define CTX_ENTRY_UPPER_AW_MASK         (0x7UL << CTX_ENTRY_UPPER_AW_POS)
-#define CTX_ENTRY_UPPER_DID_POS         (8U)
-#define CTX_ENTRY_UPPER_DID_MASK        (0xFFFFUL << CTX_ENTRY_UPPER_DID_POS)
-#define CTX_ENTRY_LOWER_P_POS           (0U)
-#define CTX_ENTRY_LOWER_P_MASK          (0x1UL << CTX_ENTRY_LOWER_P_POS)
-#define CTX_ENTRY_LOWER_FPD_POS         (1U)
-#define CTX_ENTRY_LOWER_FPD_MASK        (0x1UL << CTX_ENTRY_LOWER_FPD_POS)
-#define CTX_ENTRY_LOWER_TT_POS          (2U)
-#define CTX_ENTRY_LOWER_TT_MASK         (0x3UL << CTX_ENTRY_LOWER_TT_POS)
-#define CTX_ENTRY_LOWER_SLPTPTR_POS     (12U)
-#define CTX_ENTRY_LOWER_SLPTPTR_MASK    (0xFFFFFFFFFFFFFUL <<  CTX_ENTRY_LOWER_SLPTPTR_POS)
-
-static inline uint64_t dmar_get_bitslice(uint64_t var, uint64_t mask, uint32_t pos)
-{
-	return ((var & mask) >> pos);
-}
-
-static inline uint64_t dmar_set_bitslice(uint64_t var, uint64_t mask, uint32_t pos, uint64_t val)
-{
-	return ((var & ~mask) | ((val << pos) & mask));
-}
-
-/* translation type */
-#define DMAR_CTX_TT_UNTRANSLATED    0x0UL
-#define DMAR_CTX_TT_ALL             0x1UL
-#define DMAR_CTX_TT_PASSTHROUGH     0x2UL
-
 /* Fault event MSI data register */
 #define DMAR_MSI_DELIVERY_MODE_SHIFT     (8U)
 #define DMAR_MSI_DELIVERY_FIXED          (0U << DMAR_MSI_DELIVERY_MODE_SHIFT)
@@ -90,12 +57,6 @@ static inline uint64_t dmar_set_bitslice(uint64_t var, uint64_t mask, uint32_t p
 #define DMAR_QI_INV_ENTRY_SIZE		16U
 #define DMAR_NUM_IR_ENTRIES_PER_PAGE	256U
 
-#define DMAR_INV_STATUS_WRITE_SHIFT	5U
-#define DMAR_INV_CONTEXT_CACHE_DESC	0x01UL
-#define DMAR_INV_IOTLB_DESC		0x02UL
-#define DMAR_INV_IEC_DESC		0x04UL
-#define DMAR_INV_WAIT_DESC		0x05UL
-#define DMAR_INV_STATUS_WRITE		(1UL << DMAR_INV_STATUS_WRITE_SHIFT)
 #define DMAR_INV_STATUS_INCOMPLETE	0UL
 #define DMAR_INV_STATUS_COMPLETED	1UL
 #define DMAR_INV_STATUS_DATA_SHIFT	32U
@@ -188,6 +149,8 @@ static struct dmar_info *platform_dmar_info = NULL;
 
 /* Domain id 0 is reserved in some cases per VT-d */
 #define MAX_DOMAIN_NUM (CONFIG_MAX_VM_NUM + 1)
+/* the shadow domains of the vIOMMUs take the domain ids after the ones of the VMs */
+#define MAX_SHADOW_DOMAIN_NUM (CONFIG_MAX_VM_NUM * IOMMU_SHADOW_DOMAINS_PER_VM)
 
 static inline uint16_t vmid_to_domainid(uint16_t vm_id)
 {
@@ -1062,7 +1025,7 @@ static int32_t iommu_attach_device(const struct iommu_domain *domain, uint8_t bu
 			lo_64 = dmar_set_bitslice(lo_64, CTX_ENTRY_LOWER_TT_MASK, CTX_ENTRY_LOWER_TT_POS,
 					DMAR_CTX_TT_UNTRANSLATED);
 			hi_64 = dmar_set_bitslice(hi_64, CTX_ENTRY_UPPER_DID_MASK, CTX_ENTRY_UPPER_DID_POS,
-				(uint64_t)vmid_to_domainid(domain->vm_id));
+				(uint64_t)domain->domain_id);
 			lo_64 = dmar_set_bitslice(lo_64, CTX_ENTRY_LOWER_SLPTPTR_MASK, CTX_ENTRY_LOWER_SLPTPTR_POS,
 				domain->trans_table_ptr >> PAGE_SHIFT);
 			lo_64 = dmar_set_bitslice(lo_64, CTX_ENTRY_LOWER_P_MASK, CTX_ENTRY_LOWER_P_POS, 1UL);
@@ -1115,7 +1078,7 @@ static int32_t iommu_detach_device(const struct iommu_domain *domain, uint8_t bu
 			pr_err("dmar context entry is invalid");
 			ret = -EINVAL;
 		} else if ((uint16_t)dmar_get_bitslice(context_entry->hi_64, CTX_ENTRY_UPPER_DID_MASK,
-						CTX_ENTRY_UPPER_DID_POS) != vmid_to_domainid(domain->vm_id)) {
+						CTX_ENTRY_UPPER_DID_POS) != domain->domain_id) {
 			pr_err("%s: domain id mismatch", __func__);
 			ret = -EPERM;
 		} else {
@@ -1124,9 +1087,9 @@ static int32_t iommu_detach_device(const struct iommu_domain *domain, uint8_t bu
 			context_entry->hi_64 = 0UL;
 			iommu_flush_cache(context_entry, sizeof(struct dmar_entry));
 
-			dmar_invalid_context_cache(dmar_unit, vmid_to_domainid(domain->vm_id), sid.value, 0U,
+			dmar_invalid_context_cache(dmar_unit, domain->domain_id, sid.value, 0U,
 							DMAR_CIRG_DEVICE);
-			dmar_invalid_iotlb(dmar_unit, vmid_to_domainid(domain->vm_id), 0UL, 0U, false,
+			dmar_invalid_iotlb(dmar_unit, domain->domain_id, 0UL, 0U, false,
 							DMAR_IIRG_DOMAIN);
 		}
 	} else {
@@ -1176,16 +1139,73 @@ struct iommu_domain *create_iommu_domain(uint16_t vm_id, uint64_t translation_ta
 		domain = &iommu_domains[vmid_to_domainid(vm_id)];
 
 		domain->vm_id = vm_id;
+		domain->domain_id = vmid_to_domainid(vm_id);
 		domain->trans_table_ptr = translation_table;
 		domain->addr_width = addr_width;
 
 		dev_dbg(DBG_LEVEL_IOMMU, "create domain [%d]: vm_id = %hu, ept@0x%x",
-			vmid_to_domainid(domain->vm_id), domain->vm_id, domain->trans_table_ptr);
+			domain->domain_id, domain->vm_id, domain->trans_table_ptr);
 	}
 
 	return domain;
 }
 
+static bool is_domain_id_supported(uint16_t domain_id)
+{
+	const struct dmar_drhd_rt *dmar_unit;
+	bool supported = true;
+	uint32_t i;
+
+	for (i = 0U; i < platform_dmar_info->drhd_count; i++) {
+		dmar_unit = &dmar_drhd_units[i];
+		if (!dmar_unit->drhd->ignore && ((uint32_t)domain_id >= iommu_cap_ndoms(dmar_unit->cap))) {
+			supported = false;
+			break;
+		}
+	}
+
+	return supported;
+}
+
+struct iommu_domain *create_shadow_iommu_domain(uint16_t vm_id, uint16_t index, uint64_t translation_table,
+	uint32_t addr_width)
+{
+	static struct iommu_domain shadow_domains[MAX_SHADOW_DOMAIN_NUM];
+	struct iommu_domain *domain = NULL;
+	uint16_t idx = (uint16_t)((vm_id * IOMMU_SHADOW_DOMAINS_PER_VM) + index);
+	uint16_t domain_id = (uint16_t)(MAX_DOMAIN_NUM + idx);
+
+	if (translation_table == 0UL) {
+		pr_err("translation table is NULL");
+	} else if (!is_domain_id_supported(domain_id)) {
+		pr_err("domain id %hu is not supported by the DMAR units", domain_id);
+	} else {
+		domain = &shadow_domains[idx];
+		domain->vm_id = vm_id;
+		domain->domain_id = domain_id;
+		domain->trans_table_ptr = translation_table;
+		domain->addr_width = addr_width;
+
+		dev_dbg(DBG_LEVEL_IOMMU, "create shadow domain [%d]: vm_id = %hu, table@0x%lx",
+			domain->domain_id, domain->vm_id, domain->trans_table_ptr);
+	}
+
+	return domain;
+}
+
+void flush_iommu_domain(const struct iommu_domain *domain)
+{
+	struct dmar_drhd_rt *dmar_unit;
+	uint32_t i;
+
+	for (i = 0U; i < platform_dmar_info->drhd_count; i++) {
+		dmar_unit = &dmar_drhd_units[i];
+		if (!dmar_unit->drhd->ignore) {
+			dmar_invalid_iotlb(dmar_unit, domain->domain_id, 0UL, 0U, false, DMAR_IIRG_DOMAIN);
+		}
+	}
+}
+
 /**
  * @pre domain != NULL
  */
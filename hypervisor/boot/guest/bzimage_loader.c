@@ -15,6 +15,7 @@
 #include <efi_mmap.h>
 #include <errno.h>
 #include <logmsg.h>
+#include <boot_work.h>
 
 #define DBG_LEVEL_VM_BZIMAGE	6U
 
@@ -353,7 +354,7 @@ static void load_bzimage(struct acrn_vm *vm, struct acrn_vcpu *vcpu,
 				(sw_kernel->kernel_size - prot_code_offset) : 0U;
 
 	/* Copy the protected mode part kernel code to its run-time location */
-	(void)copy_to_gpa(vm, (sw_kernel->kernel_src_addr + prot_code_offset), kernel_load_gpa, prot_code_size);
+	(void)load_sw_image(vm, (sw_kernel->kernel_src_addr + prot_code_offset), kernel_load_gpa, prot_code_size);
 
 	if (vm->sw.ramdisk_info.size > 0U) {
 		/* Use customer specified ramdisk load addr if it is configured in VM configuration,
@@ -42,9 +42,9 @@ static void *do_load_elf64(struct acrn_vm *vm)
 				 *
 				 * We assume that the guest elf can put segments to valid gpa.
 				 */
-				(void)copy_to_gpa(vm, p_elf_img + p_prg_tbl_head64->p_offset,
+				(void)load_sw_image(vm, p_elf_img + p_prg_tbl_head64->p_offset,
 					p_prg_tbl_head64->p_paddr, (uint32_t)p_prg_tbl_head64->p_filesz);
-				/* copy_to_gpa has it's stac/clac inside. So call stac again here. */
+				/* load_sw_image has it's stac/clac inside. So call stac again here. */
 				stac();
 			}
 			p_prg_tbl_head64++;
@@ -108,9 +108,9 @@ static void *do_load_elf32(struct acrn_vm *vm)
 				 *
 				 * We assume that the guest elf can put segments to valid gpa.
 				 */
-				(void)copy_to_gpa(vm, p_elf_img + p_prg_tbl_head32->p_offset,
+				(void)load_sw_image(vm, p_elf_img + p_prg_tbl_head32->p_offset,
 					p_prg_tbl_head32->p_paddr, p_prg_tbl_head32->p_memsz);
-				/* copy_to_gpa has it's stac/clac inside. So call stac again here. */
+				/* load_sw_image has it's stac/clac inside. So call stac again here. */
 				stac();
 			}
 			p_prg_tbl_head32++;
@@ -20,7 +20,7 @@ static void load_rawimage(struct acrn_vm *vm)
 	kernel_load_gpa = vm_config->os_config.kernel_load_addr;
 
 	/* Copy the guest kernel image to its run-time location */
-	(void)copy_to_gpa(vm, sw_kernel->kernel_src_addr, kernel_load_gpa, sw_kernel->kernel_size);
+	(void)load_sw_image(vm, sw_kernel->kernel_src_addr, kernel_load_gpa, sw_kernel->kernel_size);
 
 	sw_kernel->kernel_entry_addr = (void *)vm_config->os_config.kernel_entry_addr;
 }
@@ -10,6 +10,8 @@
 
 int32_t init_vm_boot_info(struct acrn_vm *vm);
 void load_sw_module(struct acrn_vm *vm, struct sw_module_info *sw_module);
+int32_t load_sw_image(struct acrn_vm *vm, void *h_ptr, uint64_t gpa, uint32_t size);
+void deny_zero_copy_modules(struct acrn_vm *service_vm);
 
 #ifdef CONFIG_GUEST_KERNEL_BZIMAGE
 int32_t bzimage_loader(struct acrn_vm *vm);
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2026 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <types.h>
+#include <errno.h>
+#include <asm/lib/atomic.h>
+#include <asm/lib/bits.h>
+#include <asm/cpu.h>
+#include <asm/guest/vm.h>
+#include <ticks.h>
+#include <boot_work.h>
+
+#define BOOT_COPY_CHUNK		(2UL * 1024UL * 1024UL)
+
+/* one in flight job per submitting pCPU */
+struct boot_work {
+	boot_work_fn fn;
+	void *data;
+	uint32_t nr;
+	int32_t next;		/* next chunk to claim */
+	int32_t done;		/* chunks completed */
+	int32_t users;		/* helpers looking at this job */
+	volatile bool active;
+};
+
+static struct boot_work boot_works[MAX_PCPU_NUM];
+/* pCPUs which haven't finished launch_vms() yet, for the boot phase log */
+static volatile uint64_t launching_pcpus;
+
+static struct boot_phase boot_phases[BOOT_PHASE_MAX];
+static int32_t nr_boot_phases;
+
+void init_boot_work(uint64_t pcpu_mask)
+{
+	launching_pcpus = pcpu_mask;
+}
+
+/* @return true if a chunk has been run */
+static bool run_chunk(struct boot_work *work)
+{
+	int32_t idx = atomic_xadd32(&work->next, 1);
+	bool ret = false;
+
+	if ((uint32_t)idx < work->nr) {
+		work->fn(work->data, (uint32_t)idx);
+		(void)atomic_inc_return(&work->done);
+		ret = true;
+	}
+
+	return ret;
+}
+
+void boot_work_run(boot_work_fn fn, void *data, uint32_t nr)
+{
+	struct boot_work *work = &boot_works[get_pcpu_id()];
+
+	work->fn = fn;
+	work->data = data;
+	work->nr = nr;
+	work->next = 0;
+	work->done = 0;
+	cpu_write_memory_barrier();
+	work->active = true;
+
+	while (run_chunk(work)) {
+		/* the submitter takes its share as well */
+	}
+	/* chunks claimed by helpers may still run */
+	while ((uint32_t)work->done != nr) {
+		asm_pause();
+	}
+
+	/* no helper may still hold a stale view of the job when the slot is reused */
+	work->active = false;
+	cpu_memory_barrier();
+	while (work->users != 0) {
+		asm_pause();
+	}
+}
+
+void boot_work_help(void)
+{
+	struct boot_work *work;
+	uint16_t pcpu_id;
+	bool ran;
+
+	do {
+		ran = false;
+		for (pcpu_id = 0U; pcpu_id < get_pcpu_nums(); pcpu_id++) {
+			work = &boot_works[pcpu_id];
+			(void)atomic_inc_return(&work->users);
+			if (work->active) {
+				while (run_chunk(work)) {
+					ran = true;
+				}
+			}
+			(void)atomic_dec_return(&work->users);
+		}
+	} while (ran);
+}
+
+void boot_work_done(void)
+{
+	bitmap_clear_lock(get_pcpu_id(), &launching_pcpus);
+	if (launching_pcpus == 0UL) {
+		boot_phase("all VMs launched", ACRN_INVALID_VMID);
+	}
+}
+
+struct boot_copy {
+	struct acrn_vm *vm;
+	uint8_t *src;
+	uint64_t gpa;
+	uint32_t size;
+	int32_t err;
+};
+
+static void boot_copy_chunk(void *data, uint32_t idx)
+{
+	struct boot_copy *copy = (struct boot_copy *)data;
+	uint64_t offset = (uint64_t)idx * BOOT_COPY_CHUNK;
+	uint32_t len = (uint32_t)min(BOOT_COPY_CHUNK, (uint64_t)copy->size - offset);
+
+	if (copy_to_gpa(copy->vm, copy->src + offset, copy->gpa + offset, len) != 0) {
+		copy->err = -EINVAL;
+	}
+}
+
+int32_t boot_copy_to_gpa(struct acrn_vm *vm, void *h_ptr, uint64_t gpa, uint32_t size)
+{
+	struct boot_copy copy = { vm, (uint8_t *)h_ptr, gpa, size, 0 };
+	uint32_t nr = (uint32_t)(((uint64_t)size + BOOT_COPY_CHUNK - 1UL) / BOOT_COPY_CHUNK);
+
+	if (nr <= 1U) {
+		copy.err = copy_to_gpa(vm, h_ptr, gpa, size);
+	} else {
+		boot_work_run(boot_copy_chunk, &copy, nr);
+	}
+
+	return copy.err;
+}
+
+void boot_phase(const char *name, uint16_t vm_id)
+{
+	int32_t idx = atomic_xadd32(&nr_boot_phases, 1);
+
+	if ((uint32_t)idx < BOOT_PHASE_MAX) {
+		boot_phases[idx].tick = cpu_ticks();
+		boot_phases[idx].pcpu_id = get_pcpu_id();
+		boot_phases[idx].vm_id = vm_id;
+		boot_phases[idx].name = name;
+	}
+}
+
+const struct boot_phase *get_boot_phases(uint32_t *nr)
+{
+	*nr = min((uint32_t)nr_boot_phases, BOOT_PHASE_MAX);
+	return boot_phases;
+}
@@ -82,13 +82,12 @@ void default_idle(__unused struct thread_object *obj)
 		if (need_reschedule(pcpu_id)) {
 			schedule();
 		} else if (need_offline(pcpu_id)) {
+			save_lazy_xsave_state();
 			cpu_dead();
 		} else if (need_shutdown_vm(pcpu_id)) {
 			shutdown_vm_from_idle(pcpu_id);
 		} else {
-			CPU_IRQ_ENABLE_ON_CONFIG();
-			cpu_do_idle();
-			CPU_IRQ_DISABLE_ON_CONFIG();
+			cpu_do_idle(pcpu_id);
 		}
 	}
 }
@@ -27,6 +27,7 @@
 #include <ticks.h>
 #include <asm/cpuid.h>
 #include <vroot_port.h>
+#include <asm/guest/rdt_ctrl.h>
 
 #define DBG_LEVEL_HYCALL	6U
 
@@ -395,12 +396,135 @@ int32_t hcall_set_vcpu_regs(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm,
 	return ret;
 }
 
+/**
+ * @pre is_service_vm(vcpu->vm)
+ */
+int32_t hcall_get_vcpu_exit_stats(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm,
+		__unused uint64_t param1, uint64_t param2)
+{
+	struct acrn_vm *vm = vcpu->vm;
+	struct acrn_vcpu_exit_stats hdr;
+	struct acrn_vcpu *target_vcpu;
+	int32_t ret = -EINVAL;
+
+	/* the header only, the statistics are copied straight from the vCPU */
+	if (!is_poweroff_vm(target_vm) &&
+			(copy_from_gpa(vm, &hdr, param2, offsetof(struct acrn_vcpu_exit_stats, reasons)) == 0) &&
+			(hdr.vcpu_id < target_vm->hw.created_vcpus)) {
+		target_vcpu = vcpu_from_vid(target_vm, hdr.vcpu_id);
+		hdr.tsc_khz = cpu_tickrate();
+		hdr.tsc = cpu_ticks();
+		if (copy_to_gpa(vm, &hdr, param2, offsetof(struct acrn_vcpu_exit_stats, reasons)) == 0) {
+			ret = copy_to_gpa(vm, target_vcpu->exit_stats,
+				param2 + offsetof(struct acrn_vcpu_exit_stats, reasons),
+				sizeof(target_vcpu->exit_stats));
+		}
+	}
+
+	return ret;
+}
+
+static void get_io_stat_range(const struct acrn_vm *vm, uint32_t slot, struct acrn_io_exit_stat *entry)
+{
+	if (slot < IO_STAT_SLOT_MMIO0) {
+		entry->type = ACRN_IO_STAT_HV_PIO;
+		entry->start = vm->emul_pio[slot].port_start;
+		entry->end = vm->emul_pio[slot].port_end;
+	} else if (slot < IO_STAT_SLOT_PIO_DEFAULT) {
+		entry->type = ACRN_IO_STAT_HV_MMIO;
+		entry->start = vm->emul_mmio[slot - IO_STAT_SLOT_MMIO0].range_start;
+		entry->end = vm->emul_mmio[slot - IO_STAT_SLOT_MMIO0].range_end;
+	} else {
+		if (slot == IO_STAT_SLOT_DM_PIO) {
+			entry->type = ACRN_IO_STAT_DM_PIO;
+		} else if (slot == IO_STAT_SLOT_DM_MMIO) {
+			entry->type = ACRN_IO_STAT_DM_MMIO;
+		} else {
+			entry->type = ACRN_IO_STAT_DEFAULT;
+		}
+		entry->start = 0UL;
+		entry->end = 0UL;
+	}
+}
+
+/**
+ * @pre is_service_vm(vcpu->vm)
+ */
+int32_t hcall_get_vm_io_stats(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm,
+		__unused uint64_t param1, uint64_t param2)
+{
+	struct acrn_vm *vm = vcpu->vm;
+	struct acrn_vm_io_stats hdr;
+	struct acrn_io_exit_stat entry;
+	uint64_t gpa = param2 + offsetof(struct acrn_vm_io_stats, stats);
+	uint32_t slot;
+	int32_t ret = -EINVAL;
+
+	if (!is_poweroff_vm(target_vm) &&
+			(copy_from_gpa(vm, &hdr, param2, offsetof(struct acrn_vm_io_stats, stats)) == 0)) {
+		ret = 0;
+		hdr.nr = 0U;
+		for (slot = hdr.first; (slot < IO_STAT_SLOT_NUM) && (hdr.nr < ACRN_IO_STAT_MAX) && (ret == 0); slot++) {
+			if (target_vm->io_stats[slot].count != 0UL) {
+				get_io_stat_range(target_vm, slot, &entry);
+				entry.slot = slot;
+				entry.stat = target_vm->io_stats[slot];
+				ret = copy_to_gpa(vm, &entry, gpa, sizeof(entry));
+				gpa += sizeof(entry);
+				hdr.nr++;
+			}
+		}
+		hdr.next = slot;
+
+		if (ret == 0) {
+			ret = copy_to_gpa(vm, &hdr, param2, offsetof(struct acrn_vm_io_stats, stats));
+		}
+	}
+
+	return ret;
+}
+
 int32_t hcall_create_vcpu(__unused struct acrn_vcpu *vcpu, __unused struct acrn_vm *target_vm,
 		__unused uint64_t param1, __unused uint64_t param2)
 {
 	return 0;
 }
 
+/**
+ * @pre is_service_vm(vcpu->vm)
+ */
+int32_t hcall_get_rdt_mon(struct acrn_vcpu *vcpu, __unused struct acrn_vm *target_vm,
+		uint64_t param1, __unused uint64_t param2)
+{
+	struct acrn_vm *vm = vcpu->vm;
+	struct acrn_rdt_mon mon;
+	int32_t ret;
+
+	ret = rdt_ctrl_get_mon(vm, &mon);
+	if (ret == 0) {
+		ret = copy_to_gpa(vm, &mon, param1, sizeof(mon));
+	}
+
+	return ret;
+}
+
+/**
+ * @pre is_service_vm(vcpu->vm)
+ */
+int32_t hcall_set_rdt_ctrl(struct acrn_vcpu *vcpu, __unused struct acrn_vm *target_vm,
+		uint64_t param1, __unused uint64_t param2)
+{
+	struct acrn_vm *vm = vcpu->vm;
+	struct acrn_rdt_ctrl ctrl;
+	int32_t ret = -EINVAL;
+
+	if (copy_from_gpa(vm, &ctrl, param1, sizeof(ctrl)) == 0) {
+		ret = rdt_ctrl_set(vm, &ctrl);
+	}
+
+	return ret;
+}
+
 /**
  * @brief set or clear IRQ line
  *
@@ -1277,3 +1401,32 @@ int32_t hcall_remove_vdev(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, __u
 	}
 	return ret;
 }
+
+/**
+ * @brief Set the config space shadow of a DM-emulated PCI device.
+ *
+ * @param vcpu Pointer to vCPU that initiates the hypercall
+ * @param target_vm Pointer to target VM data structure
+ * @param param2 guest physical address. This gpa points to data structure of
+ *              acrn_pci_cfg_shadow including the vBDF and cached config space
+ *
+ * @pre is_service_vm(vcpu->vm)
+ * @return 0 on success, non-zero on error.
+ */
+int32_t hcall_set_pci_cfg_shadow(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm,
+		__unused uint64_t param1, uint64_t param2)
+{
+	struct acrn_vm *vm = vcpu->vm;
+	int32_t ret = -EINVAL;
+	struct acrn_pci_cfg_shadow shadow;
+
+	if (is_postlaunched_vm(target_vm) && !is_poweroff_vm(target_vm)) {
+		if (copy_from_gpa(vm, &shadow, param2, sizeof(shadow)) == 0) {
+			ret = vpci_set_cfg_shadow(target_vm, &shadow);
+		}
+	} else {
+		pr_err("%s, vm[%d] is not a postlaunched VM, or is powered off\n", __func__, target_vm->vm_id);
+	}
+
+	return ret;
+}
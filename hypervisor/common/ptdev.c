@@ -5,6 +5,7 @@
  */
 
 #include <hash.h>
+#include <slab.h>
 #include <asm/per_cpu.h>
 #include <asm/guest/vm.h>
 #include <softirq.h>
@@ -17,9 +18,9 @@
 #define PTIRQ_ENTRY_HASHBITS	9U
 #define PTIRQ_ENTRY_HASHSIZE	(1U << PTIRQ_ENTRY_HASHBITS)
 
-#define PTIRQ_BITMAP_ARRAY_SIZE	INT_DIV_ROUNDUP(CONFIG_MAX_PT_IRQ_ENTRIES, 64U)
 struct ptirq_remapping_info ptirq_entries[CONFIG_MAX_PT_IRQ_ENTRIES];
-static uint64_t ptirq_entry_bitmaps[PTIRQ_BITMAP_ARRAY_SIZE];
+static uint32_t ptirq_entry_links[CONFIG_MAX_PT_IRQ_ENTRIES];
+static struct slab_cache ptirq_entry_cache;
 spinlock_t ptdev_lock = { .head = 0U, .tail = 0U, };
 
 static struct ptirq_entry_head {
@@ -28,16 +29,9 @@ static struct ptirq_entry_head {
 
 static inline uint16_t ptirq_alloc_entry_id(void)
 {
-	uint16_t id = (uint16_t)ffz64_ex(ptirq_entry_bitmaps, CONFIG_MAX_PT_IRQ_ENTRIES);
+	uint32_t id = slab_alloc_idx(&ptirq_entry_cache);
 
-	while (id < CONFIG_MAX_PT_IRQ_ENTRIES) {
-		if (!bitmap_test_and_set_lock((id & 0x3FU), &ptirq_entry_bitmaps[id >> 6U])) {
-			break;
-		}
-		id = (uint16_t)ffz64_ex(ptirq_entry_bitmaps, CONFIG_MAX_PT_IRQ_ENTRIES);
-	}
-
-	return (id < CONFIG_MAX_PT_IRQ_ENTRIES) ? id: INVALID_PTDEV_ENTRY_ID;
+	return (id != INVALID_SLAB_IDX) ? (uint16_t)id : INVALID_PTDEV_ENTRY_ID;
 }
 
 struct ptirq_remapping_info *find_ptirq_entry(uint32_t intr_type,
@@ -69,18 +63,18 @@ struct ptirq_remapping_info *find_ptirq_entry(uint32_t intr_type,
 	return entry;
 }
 
+/*
+ * Mark the entry pending on the current pCPU and raise SOFTIRQ_PTDEV.
+ *
+ * The per-pCPU pending bitmap is updated with a locked bit operation, so no
+ * interrupt-disabled window is needed here. Setting an already pending bit is
+ * a no-op, which also avoids adding an entry recursively.
+ */
 static void ptirq_enqueue_softirq(struct ptirq_remapping_info *entry)
 {
-	uint64_t rflags;
-
-	/* enqueue request in order, SOFTIRQ_PTDEV will pickup */
-	CPU_INT_ALL_DISABLE(&rflags);
+	uint16_t id = entry->ptdev_entry_id;
 
-	/* avoid adding recursively */
-	list_del(&entry->softirq_node);
-	/* TODO: assert if entry already in list */
-	list_add_tail(&entry->softirq_node, &get_cpu_var(softirq_dev_entry_list));
-	CPU_INT_ALL_RESTORE(rflags);
+	bitmap_set_lock(id & 0x3FU, &get_cpu_var(ptirq_pending)[id >> 6U]);
 	fire_softirq(SOFTIRQ_PTDEV);
 }
 
@@ -91,29 +85,90 @@ static void ptirq_intr_delay_callback(void *data)
 	ptirq_enqueue_softirq(entry);
 }
 
+/*
+ * Move all pending bits of pcpu_id into its softirq-private batch, one atomic
+ * exchange per bitmap word. Return false when nothing was pending.
+ */
+static bool ptirq_fetch_pending_batch(uint16_t pcpu_id)
+{
+	uint64_t *pending = per_cpu(ptirq_pending, pcpu_id);
+	uint64_t *batch = per_cpu(ptirq_batch, pcpu_id);
+	uint16_t i;
+	bool found = false;
+
+	for (i = 0U; i < PTIRQ_BITMAP_ARRAY_SIZE; i++) {
+		batch[i] = atomic_readandclear64(&pending[i]);
+		if (batch[i] != 0UL) {
+			found = true;
+		}
+	}
+
+	return found;
+}
+
+/*
+ * Pop an entry id from the softirq-private batch of pcpu_id. The bitmap does
+ * not keep the arrival order, so the ids are taken round-robin from the one
+ * after the last popped id, the low ids don't always go first.
+ */
+static uint16_t ptirq_pop_batch(uint16_t pcpu_id)
+{
+	uint64_t *batch = per_cpu(ptirq_batch, pcpu_id);
+	uint16_t start = per_cpu(ptirq_next, pcpu_id);
+	uint16_t i, idx, bit, id = INVALID_PTDEV_ENTRY_ID;
+	uint64_t bits;
+
+	/* the start word is scanned twice: the ids from start on, then the ones below */
+	for (i = 0U; i <= PTIRQ_BITMAP_ARRAY_SIZE; i++) {
+		idx = (uint16_t)(((start >> 6U) + i) % PTIRQ_BITMAP_ARRAY_SIZE);
+		bits = batch[idx];
+		if (i == 0U) {
+			bits &= ~((1UL << (start & 0x3FU)) - 1UL);
+		}
+
+		if (bits != 0UL) {
+			bit = ffs64(bits);
+			batch[idx] &= ~(1UL << bit);
+			id = (uint16_t)((idx << 6U) + bit);
+			per_cpu(ptirq_next, pcpu_id) = (uint16_t)((id + 1U) % (PTIRQ_BITMAP_ARRAY_SIZE << 6U));
+			break;
+		}
+	}
+
+	return id;
+}
+
+/*
+ * Called in SOFTIRQ_PTDEV context only, with interrupts enabled. The pending
+ * bitmap is drained in one batch; new interrupts arriving meanwhile set bits
+ * in ptirq_pending again and are picked up by the next batch.
+ */
 struct ptirq_remapping_info *ptirq_dequeue_softirq(uint16_t pcpu_id)
 {
-	uint64_t rflags;
 	struct ptirq_remapping_info *entry = NULL;
+	uint16_t id = ptirq_pop_batch(pcpu_id);
 
-	CPU_INT_ALL_DISABLE(&rflags);
-
-	while (!list_empty(&get_cpu_var(softirq_dev_entry_list))) {
-		entry = get_first_item(&per_cpu(softirq_dev_entry_list, pcpu_id), struct ptirq_remapping_info, softirq_node);
+	if ((id == INVALID_PTDEV_ENTRY_ID) && ptirq_fetch_pending_batch(pcpu_id)) {
+		id = ptirq_pop_batch(pcpu_id);
+	}
 
-		list_del_init(&entry->softirq_node);
+	while (id != INVALID_PTDEV_ENTRY_ID) {
+		entry = &ptirq_entries[id];
 
 		/* if Service VM, just dequeue, if User VM, check delay timer */
-		if (is_service_vm(entry->vm) || timer_expired(&entry->intr_delay_timer, cpu_ticks(), NULL)) {
+		if (!is_entry_active(entry) || is_service_vm(entry->vm) ||
+				timer_expired(&entry->intr_delay_timer, cpu_ticks(), NULL)) {
 			break;
 		} else {
 			/* add it into timer list; dequeue next one */
-			(void)add_timer(&entry->intr_delay_timer);
+			if (!timer_is_started(&entry->intr_delay_timer)) {
+				(void)add_timer(&entry->intr_delay_timer);
+			}
 			entry = NULL;
+			id = ptirq_pop_batch(pcpu_id);
 		}
 	}
 
-	CPU_INT_ALL_RESTORE(rflags);
 	return entry;
 }
 
@@ -131,8 +186,6 @@ struct ptirq_remapping_info *ptirq_alloc_entry(struct acrn_vm *vm, uint32_t intr
 		entry->intr_count = 0UL;
 		entry->irte_idx = INVALID_IRTE_ID;
 
-		INIT_LIST_HEAD(&entry->softirq_node);
-
 		initialize_timer(&entry->intr_delay_timer, ptirq_intr_delay_callback, entry, 0UL, 0UL);
 
 		entry->active = false;
@@ -146,15 +199,20 @@ struct ptirq_remapping_info *ptirq_alloc_entry(struct acrn_vm *vm, uint32_t intr
 void ptirq_release_entry(struct ptirq_remapping_info *entry)
 {
 	uint64_t rflags;
+	uint16_t pcpu_id, id = entry->ptdev_entry_id;
+
+	/* drop a pending but not yet fetched request on any pCPU */
+	for (pcpu_id = 0U; pcpu_id < get_pcpu_nums(); pcpu_id++) {
+		bitmap_clear_lock(id & 0x3FU, &per_cpu(ptirq_pending, pcpu_id)[id >> 6U]);
+	}
 
 	CPU_INT_ALL_DISABLE(&rflags);
-	list_del_init(&entry->softirq_node);
 	del_timer(&entry->intr_delay_timer);
 	CPU_INT_ALL_RESTORE(rflags);
 
-	bitmap_clear_lock((entry->ptdev_entry_id) & 0x3FU, &ptirq_entry_bitmaps[entry->ptdev_entry_id >> 6U]);
-
 	(void)memset((void *)entry, 0U, sizeof(struct ptirq_remapping_info));
+
+	slab_free_idx(&ptirq_entry_cache, id);
 }
 
 /* interrupt context */
@@ -226,8 +284,11 @@ void ptdev_init(void)
 {
 	if (get_pcpu_id() == BSP_CPU_ID) {
 		register_softirq(SOFTIRQ_PTDEV, ptirq_softirq);
+		slab_init(&ptirq_entry_cache, "ptirq_entry", ptirq_entries, sizeof(struct ptirq_remapping_info),
+			CONFIG_MAX_PT_IRQ_ENTRIES, ptirq_entry_links);
 	}
-	INIT_LIST_HEAD(&get_cpu_var(softirq_dev_entry_list));
+	(void)memset(get_cpu_var(ptirq_pending), 0U, sizeof(get_cpu_var(ptirq_pending)));
+	(void)memset(get_cpu_var(ptirq_batch), 0U, sizeof(get_cpu_var(ptirq_batch)));
 }
 
 void ptdev_release_all_entries(const struct acrn_vm *vm)
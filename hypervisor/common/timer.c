@@ -169,6 +169,18 @@ void del_timer(struct hv_timer *timer)
 	CPU_INT_ALL_RESTORE(rflags);
 }
 
+uint64_t get_next_timer_deadline(void)
+{
+	struct per_cpu_timers *cpu_timer = &per_cpu(cpu_timers, get_pcpu_id());
+	uint64_t deadline = 0UL;
+
+	if (!list_empty(&cpu_timer->timer_list)) {
+		deadline = container_of((&cpu_timer->timer_list)->next, struct hv_timer, node)->timeout;
+	}
+
+	return deadline;
+}
+
 static void init_percpu_timer(uint16_t pcpu_id)
 {
 	struct per_cpu_timers *cpu_timer;
@@ -5,9 +5,139 @@
  */
 
 #include <asm/guest/vm.h>
+#include <asm/guest/ept.h>
+#include <asm/pgtable.h>
+#include <asm/mmu.h>
+#include <boot.h>
 #include <vboot.h>
 #include <errno.h>
 #include <logmsg.h>
+#include <boot_work.h>
+
+static bool is_mod_tagged(const struct acrn_boot_info *abi, const struct abi_module *mod, const char *tag)
+{
+	return (tag[0] != '\0') && (get_mod_by_tag(abi, tag) == mod);
+}
+
+/*
+ * A multiboot module may be handed over to the VM which loads it when that is
+ * a pre-launched VM with GUEST_FLAG_ZERO_COPY_MODULES, and no other VM uses
+ * the module: pre-launched VMs are loaded only once, so the module content
+ * isn't needed anymore afterwards.
+ *
+ * @return the id of the VM owning the module, ACRN_INVALID_VMID if it must be copied
+ */
+static uint16_t get_zero_copy_owner(const struct acrn_boot_info *abi, const struct abi_module *mod)
+{
+	uint16_t vm_id, owner = ACRN_INVALID_VMID;
+	uint32_t users = 0U;
+	struct acrn_vm_config *vm_config;
+
+	stac();
+	for (vm_id = 0U; vm_id < CONFIG_MAX_VM_NUM; vm_id++) {
+		vm_config = get_vm_config(vm_id);
+		if ((vm_config->load_order != POST_LAUNCHED_VM) &&
+				(is_mod_tagged(abi, mod, vm_config->os_config.kernel_mod_tag) ||
+				is_mod_tagged(abi, mod, vm_config->os_config.ramdisk_mod_tag) ||
+				is_mod_tagged(abi, mod, vm_config->acpi_config.acpi_mod_tag))) {
+			users++;
+			owner = vm_id;
+		}
+	}
+	clac();
+
+	if (users != 1U) {
+		owner = ACRN_INVALID_VMID;
+	} else {
+		vm_config = get_vm_config(owner);
+		if ((vm_config->load_order != PRE_LAUNCHED_VM) ||
+				((vm_config->guest_flags & GUEST_FLAG_ZERO_COPY_MODULES) == 0UL)) {
+			owner = ACRN_INVALID_VMID;
+		}
+	}
+
+	return owner;
+}
+
+/**
+ * @pre service_vm != NULL
+ */
+void deny_zero_copy_modules(struct acrn_vm *service_vm)
+{
+	const struct acrn_boot_info *abi = get_acrn_boot_info();
+	uint64_t start, end;
+	uint32_t i;
+
+	for (i = 0U; i < abi->mods_count; i++) {
+		if (get_zero_copy_owner(abi, &abi->mods[i]) != ACRN_INVALID_VMID) {
+			start = round_page_up(hva2hpa(abi->mods[i].start));
+			end = round_page_down(hva2hpa(abi->mods[i].start) + abi->mods[i].size);
+			if (start < end) {
+				ept_del_mr(service_vm, (uint64_t *)service_vm->arch_vm.nworld_eptp, start, end - start);
+			}
+		}
+	}
+}
+
+/*
+ * The pages which lie entirely in [h_ptr, h_ptr + size) are mapped into the
+ * VM at the target GPA instead of being copied, the guest memory which backed
+ * them stays unused. That only works when h_ptr and gpa share the same offset
+ * in a page, the partial pages at both ends are still copied.
+ *
+ * @return true if the page aligned part has been mapped
+ */
+static bool map_sw_image(struct acrn_vm *vm, void *h_ptr, uint64_t gpa, uint32_t size)
+{
+	const struct acrn_boot_info *abi = get_acrn_boot_info();
+	const struct abi_module *mod = NULL;
+	uint64_t hpa = hva2hpa(h_ptr);
+	uint64_t start = round_page_up(gpa);
+	uint64_t end = round_page_down(gpa + size);
+	uint64_t mod_hpa;
+	uint32_t i;
+	bool ret = false;
+
+	for (i = 0U; i < abi->mods_count; i++) {
+		mod_hpa = hva2hpa(abi->mods[i].start);
+		if ((hpa >= mod_hpa) && ((hpa + size) <= (mod_hpa + abi->mods[i].size))) {
+			mod = &abi->mods[i];
+			break;
+		}
+	}
+
+	if ((mod != NULL) && (((hpa ^ gpa) & ~PAGE_MASK) == 0UL) && (start < end) &&
+			(gpa2hpa(vm, start) != INVALID_HPA) && (gpa2hpa(vm, end - 1UL) != INVALID_HPA) &&
+			(get_zero_copy_owner(abi, mod) == vm->vm_id)) {
+		ept_del_mr(vm, (uint64_t *)vm->arch_vm.nworld_eptp, start, end - start);
+		ept_add_mr(vm, (uint64_t *)vm->arch_vm.nworld_eptp, hpa + (start - gpa), start,
+			end - start, EPT_RWX | EPT_WB);
+
+		if (start != gpa) {
+			(void)copy_to_gpa(vm, h_ptr, gpa, (uint32_t)(start - gpa));
+		}
+		if (end != (gpa + size)) {
+			(void)copy_to_gpa(vm, (uint8_t *)h_ptr + (end - gpa), end, (uint32_t)((gpa + size) - end));
+		}
+		ret = true;
+	}
+
+	return ret;
+}
+
+/**
+ * @pre vm != NULL
+ */
+int32_t load_sw_image(struct acrn_vm *vm, void *h_ptr, uint64_t gpa, uint32_t size)
+{
+	int32_t ret = 0;
+
+	if (!map_sw_image(vm, h_ptr, gpa, size)) {
+		ret = boot_copy_to_gpa(vm, h_ptr, gpa, size);
+	}
+
+	return ret;
+}
 
 /**
  * @pre sw_module != NULL
@@ -15,7 +145,7 @@
 void load_sw_module(struct acrn_vm *vm, struct sw_module_info *sw_module)
 {
 	if ((sw_module->size != 0) && (sw_module->load_addr != NULL)) {
-		(void)copy_to_gpa(vm, sw_module->src_addr, (uint64_t)sw_module->load_addr, sw_module->size);
+		(void)load_sw_image(vm, sw_module->src_addr, (uint64_t)sw_module->load_addr, sw_module->size);
 	}
 }
 
@@ -140,7 +140,7 @@ static struct acrn_vuart *vuart_console_active(void)
 	return ((vu != NULL) && vu->active) ? vu : NULL;
 }
 
-static void console_timer_callback(__unused void *data)
+static void console_kick(void)
 {
 	struct acrn_vuart *vu;
 
@@ -156,6 +156,16 @@ static void console_timer_callback(__unused void *data)
 	}
 }
 
+static void console_timer_callback(__unused void *data)
+{
+	/* the timer fires on the BSP again, log messages can wait for it */
+	defer_console_logmsg(true);
+	/* Print the log messages buffered since the last kick */
+	flush_logmsg();
+
+	console_kick();
+}
+
 void console_setup_timer(void)
 {
 	uint64_t period_in_cycle, fire_tsc;
@@ -169,6 +179,8 @@ void console_setup_timer(void)
 	/* Start an periodic timer */
 	if (add_timer(&console_timer) != 0) {
 		pr_err("Failed to add console kick timer");
+	} else {
+		defer_console_logmsg(true);
 	}
 }
 
@@ -178,6 +190,11 @@ void console_setup_timer(void)
  * Note that currently this approach will result in a laggy shell when
  * the number of VM-exits/second is low (which is mostly true when lapic-pt is
  * enabled).
+ *
+ * The log messages are not drained from here, that would print the rings
+ * of every pCPU on the VM exit path of the RT vCPU: each pCPU prints its
+ * own messages synchronously, after what is still buffered, until the
+ * console timer fires again.
  */
 void console_vmexit_callback(struct acrn_vcpu *vcpu)
 {
@@ -188,7 +205,8 @@ void console_vmexit_callback(struct acrn_vcpu *vcpu)
 	if ((pcpuid_from_vcpu(vcpu) == BSP_CPU_ID) && (is_lapic_pt_enabled(vcpu))) {
 		tsc = cpu_ticks();
 		if (tsc - prev_tsc > (TICKS_PER_MS * CONSOLE_KICK_TIMER_TIMEOUT)) {
-			console_timer_callback(NULL);
+			defer_console_logmsg(false);
+			console_kick();
 			prev_tsc = tsc;
 		}
 	}
@@ -196,6 +214,8 @@ void console_vmexit_callback(struct acrn_vcpu *vcpu)
 
 void suspend_console(void)
 {
+	defer_console_logmsg(false);
+	flush_logmsg();
 	del_timer(&console_timer);
 }
 
@@ -0,0 +1,274 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <types.h>
+#include <errno.h>
+#include <asm/cpu.h>
+#include <asm/cpuid.h>
+#include <asm/msr.h>
+#include <asm/apicreg.h>
+#include <asm/per_cpu.h>
+#include <asm/notify.h>
+#include <asm/irq.h>
+#include <asm/guest/vm.h>
+#include <ticks.h>
+#include <sbuf.h>
+#include <logmsg.h>
+#include <hvprof.h>
+
+/* fixed counter 1, unhalted core cycles */
+#define HVPROF_GLOBAL_BIT		(1UL << 33U)
+#define HVPROF_FIXED_CTL_MASK		0xF0UL
+/* ring 0 only, PMI on overflow */
+#define HVPROF_FIXED_CTL		0x90UL
+
+static struct hvprof_cpu {
+	volatile bool active;
+	uint64_t nr_samples;
+	uint64_t nr_lost;
+} hvprof_cpus[MAX_PCPU_NUM];
+
+static uint64_t hvprof_period;
+/* counter preset, overflows after hvprof_period cycles */
+static uint64_t hvprof_reload;
+/* pCPUs the profiler runs on */
+static uint64_t hvprof_pcpus;
+
+/*
+ * The PMU of a VM with a vPMU or PMU pass-through, and the LVTPC of a VM with
+ * LAPIC pass-through, belong to the guest. Serializes hvprof_start() against
+ * the creation of such VMs.
+ */
+static spinlock_t hvprof_lock = { .head = 0U, .tail = 0U, };
+static uint32_t hvprof_pmu_vms;
+static uint64_t hvprof_lapic_pt_pcpus;
+
+static void hvprof_start_on_cpu(__unused void *data)
+{
+	struct hvprof_cpu *pc = &hvprof_cpus[get_pcpu_id()];
+	uint64_t ctl;
+
+	msr_write(MSR_IA32_PERF_GLOBAL_CTRL, 0UL);
+	msr_write(MSR_IA32_PERF_GLOBAL_OVF_CTRL, HVPROF_GLOBAL_BIT);
+	msr_write(MSR_IA32_FIXED_CTR1, hvprof_reload);
+	ctl = msr_read(MSR_IA32_FIXED_CTR_CTL) & ~HVPROF_FIXED_CTL_MASK;
+	msr_write(MSR_IA32_FIXED_CTR_CTL, ctl | HVPROF_FIXED_CTL);
+	msr_write(MSR_IA32_EXT_APIC_LVT_PMI, APIC_LVT_DM_NMI);
+
+	pc->nr_samples = 0UL;
+	pc->nr_lost = 0UL;
+	pc->active = true;
+	/* we are in root mode here, hvprof_vmenter() turns it off for the guest */
+	msr_write(MSR_IA32_PERF_GLOBAL_CTRL, HVPROF_GLOBAL_BIT);
+}
+
+static void hvprof_stop_on_cpu(__unused void *data)
+{
+	struct hvprof_cpu *pc = &hvprof_cpus[get_pcpu_id()];
+	uint64_t ctl;
+
+	msr_write(MSR_IA32_PERF_GLOBAL_CTRL, 0UL);
+	ctl = msr_read(MSR_IA32_FIXED_CTR_CTL) & ~HVPROF_FIXED_CTL_MASK;
+	msr_write(MSR_IA32_FIXED_CTR_CTL, ctl);
+	msr_write(MSR_IA32_PERF_GLOBAL_OVF_CTRL, HVPROF_GLOBAL_BIT);
+	msr_write(MSR_IA32_EXT_APIC_LVT_PMI, APIC_LVT_M | PMI_VECTOR);
+	pc->active = false;
+
+	pr_acrnlog("hvprof: pCPU%hu %lu samples, %lu lost", get_pcpu_id(), pc->nr_samples, pc->nr_lost);
+}
+
+/* run func on the pCPUs of mask, the local one included if it is in mask */
+static void hvprof_call_all(uint64_t pcpus, smp_call_func_t func)
+{
+	uint16_t pcpu_id = get_pcpu_id();
+	uint64_t mask = pcpus;
+
+	bitmap_clear_nolock(pcpu_id, &mask);
+	if (mask != 0UL) {
+		smp_call_function(mask, func, NULL);
+	}
+	if (bitmap_test(pcpu_id, &pcpus)) {
+		func(NULL);
+	}
+}
+
+/**
+ * The pCPUs of a LAPIC pass-through VM are not profiled.
+ */
+int32_t hvprof_start(uint64_t period)
+{
+	uint32_t eax, ebx, ecx, edx, width = 0U;
+	uint16_t pcpu_id;
+	int32_t ret = 0;
+
+	if (hvprof_period != 0UL) {
+		ret = -EBUSY;
+	} else if (get_pcpu_info()->cpuid_level < 0xAU) {
+		ret = -ENODEV;
+	} else {
+		cpuid_subleaf(0xAU, 0U, &eax, &ebx, &ecx, &edx);
+		width = (edx >> 5U) & 0xffU;
+		if (((eax & 0xffU) < 2U) || ((edx & 0x1fU) < 2U) || (width == 0U) || (width >= 64U) ||
+				(period == 0UL) || (period >= (1UL << (width - 1U)))) {
+			ret = -EINVAL;
+		}
+	}
+
+	/* the PMU is owned by SEP/SoCWatch or a guest */
+	for (pcpu_id = 0U; (ret == 0) && (pcpu_id < get_pcpu_nums()); pcpu_id++) {
+		if (per_cpu(profiling_info.s_state, pcpu_id).pmu_state == PMU_RUNNING) {
+			ret = -EBUSY;
+		}
+	}
+
+	if (ret == 0) {
+		spinlock_obtain(&hvprof_lock);
+		if (hvprof_pmu_vms != 0U) {
+			ret = -EBUSY;
+		} else {
+			hvprof_period = period;
+			hvprof_reload = (~period + 1UL) & ((1UL << width) - 1UL);
+			hvprof_pcpus = get_active_pcpu_bitmap() & ~hvprof_lapic_pt_pcpus;
+		}
+		spinlock_release(&hvprof_lock);
+	}
+
+	if (ret == 0) {
+		hvprof_call_all(hvprof_pcpus, hvprof_start_on_cpu);
+	}
+
+	return ret;
+}
+
+void hvprof_stop(void)
+{
+	if (hvprof_period != 0UL) {
+		hvprof_call_all(hvprof_pcpus, hvprof_stop_on_cpu);
+		spinlock_obtain(&hvprof_lock);
+		hvprof_period = 0UL;
+		hvprof_pcpus = 0UL;
+		spinlock_release(&hvprof_lock);
+	}
+}
+
+/**
+ * A VM which would share the PMU or the LVTPC of its pCPUs with the profiler
+ * can't be created while the profiler runs.
+ *
+ * @pre vm != NULL
+ */
+int32_t hvprof_claim_vm(const struct acrn_vm *vm, uint64_t pcpu_bitmap)
+{
+	bool owns_pmu = is_pmu_pt_configured(vm) || is_vpmu_configured(vm);
+	bool lapic_pt = is_lapic_pt_configured(vm);
+	int32_t ret = 0;
+
+	spinlock_obtain(&hvprof_lock);
+	if ((hvprof_period != 0UL) && (owns_pmu || lapic_pt)) {
+		ret = -EBUSY;
+	} else {
+		if (owns_pmu) {
+			hvprof_pmu_vms++;
+		}
+		if (lapic_pt) {
+			hvprof_lapic_pt_pcpus |= pcpu_bitmap;
+		}
+	}
+	spinlock_release(&hvprof_lock);
+
+	return ret;
+}
+
+/**
+ * @pre vm != NULL
+ * @pre hvprof_claim_vm(vm, pcpu_bitmap) succeeded
+ */
+void hvprof_release_vm(const struct acrn_vm *vm, uint64_t pcpu_bitmap)
+{
+	spinlock_obtain(&hvprof_lock);
+	if ((is_pmu_pt_configured(vm) || is_vpmu_configured(vm)) && (hvprof_pmu_vms > 0U)) {
+		hvprof_pmu_vms--;
+	}
+	if (is_lapic_pt_configured(vm)) {
+		hvprof_lapic_pt_pcpus &= ~pcpu_bitmap;
+	}
+	spinlock_release(&hvprof_lock);
+}
+
+/* Don't count guest cycles, called with interrupts disabled right before VM entry */
+void hvprof_vmenter(void)
+{
+	if (hvprof_cpus[get_pcpu_id()].active) {
+		msr_write(MSR_IA32_PERF_GLOBAL_CTRL, 0UL);
+	}
+}
+
+void hvprof_vmexit(void)
+{
+	if (hvprof_cpus[get_pcpu_id()].active) {
+		msr_write(MSR_IA32_PERF_GLOBAL_CTRL, HVPROF_GLOBAL_BIT);
+	}
+}
+
+/*
+ * Walk the saved frame pointers of the interrupted stack. The NMI is taken
+ * on the interrupted stack, so every frame lies above the interrupted RSP
+ * and within one hypervisor stack of it; a frame pointer which isn't
+ * aligned, doesn't move up or leaves that window ends the chain.
+ */
+static uint16_t hvprof_walk_stack(const struct intr_excp_ctx *ctx, uint64_t *ip)
+{
+	uint64_t fp = ctx->gp_regs.rbp;
+	uint64_t lo = ctx->rsp, hi = ctx->rsp + CONFIG_STACK_SIZE;
+	const uint64_t *frame;
+	uint16_t depth = 1U;
+
+	ip[0] = ctx->rip;
+	while ((depth < HVPROF_MAX_DEPTH) && ((fp & 7UL) == 0UL) && (fp >= lo) && ((fp + 16UL) <= hi)) {
+		frame = (const uint64_t *)fp;
+		if (frame[1] == 0UL) {
+			break;
+		}
+		ip[depth] = frame[1];
+		depth++;
+		if (frame[0] <= fp) {
+			break;
+		}
+		fp = frame[0];
+	}
+
+	return depth;
+}
+
+bool hvprof_handle_nmi(const struct intr_excp_ctx *ctx)
+{
+	uint16_t pcpu_id = get_pcpu_id();
+	struct hvprof_cpu *pc = &hvprof_cpus[pcpu_id];
+	struct shared_buf *sbuf = per_cpu(sbuf, pcpu_id)[ACRN_HVPROF];
+	struct hvprof_sample sample;
+	bool ret = false;
+
+	if (pc->active && ((msr_read(MSR_IA32_PERF_GLOBAL_STATUS) & HVPROF_GLOBAL_BIT) != 0UL)) {
+		sample.tsc = cpu_ticks();
+		sample.pcpu_id = pcpu_id;
+		sample.reserved = 0U;
+		sample.depth = hvprof_walk_stack(ctx, sample.ip);
+		if ((sbuf != NULL) && (sbuf_put_record(sbuf, &sample,
+				(uint32_t)offsetof(struct hvprof_sample, ip) + (sample.depth * 8U)) != 0U)) {
+			pc->nr_samples++;
+		} else {
+			pc->nr_lost++;
+		}
+
+		msr_write(MSR_IA32_FIXED_CTR1, hvprof_reload);
+		msr_write(MSR_IA32_PERF_GLOBAL_OVF_CTRL, HVPROF_GLOBAL_BIT);
+		/* the LVT entry is masked on delivery */
+		msr_write(MSR_IA32_EXT_APIC_LVT_PMI, APIC_LVT_DM_NMI);
+		ret = true;
+	}
+
+	return ret;
+}
@@ -10,6 +10,7 @@
 #include <sbuf.h>
 #include <hypercall.h>
 #include <npk_log.h>
+#include <trace.h>
 #include <asm/guest/vm.h>
 #include <logmsg.h>
 
@@ -146,3 +147,47 @@ int32_t hcall_get_hw_info(struct acrn_vcpu *vcpu, __unused struct acrn_vm *targe
 	hw_info.cpu_num = get_pcpu_nums();
 	return copy_to_gpa(vcpu->vm, &hw_info, param1, sizeof(hw_info));
 }
+
+/**
+ * @brief Set which trace events are recorded
+ *
+ * @param vcpu Pointer to vCPU that initiates the hypercall
+ * @param param1 Guest physical address pointing to struct acrn_trace_filter
+ *
+ * @pre is_service_vm(vcpu->vm)
+ * @return 0 on success, non-zero on error.
+ */
+int32_t hcall_set_trace_filter(struct acrn_vcpu *vcpu, __unused struct acrn_vm *target_vm,
+		uint64_t param1, __unused uint64_t param2)
+{
+	struct acrn_trace_filter filter;
+	int32_t ret = -EINVAL;
+
+	if (copy_from_gpa(vcpu->vm, &filter, param1, sizeof(filter)) == 0) {
+		ret = trace_set_filter(&filter);
+	}
+
+	return ret;
+}
+
+/**
+ * @brief Select the trace record format
+ *
+ * @param vcpu Pointer to vCPU that initiates the hypercall
+ * @param param1 Guest physical address pointing to struct acrn_trace_format
+ *
+ * @pre is_service_vm(vcpu->vm)
+ * @return 0 on success, non-zero on error.
+ */
+int32_t hcall_set_trace_format(struct acrn_vcpu *vcpu, __unused struct acrn_vm *target_vm,
+		uint64_t param1, __unused uint64_t param2)
+{
+	struct acrn_trace_format fmt;
+	int32_t ret = -EINVAL;
+
+	if (copy_from_gpa(vcpu->vm, &fmt, param1, sizeof(fmt)) == 0) {
+		ret = trace_set_format(&fmt);
+	}
+
+	return ret;
+}
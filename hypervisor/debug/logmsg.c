@@ -18,12 +18,32 @@
  * bsp/uefi/clearlinux/acrn.conf: hvlog=2M@0x1FE00000
  */
 
+/*
+ * Console output is deferred: do_logmsg() only copies the message into the
+ * ring of its pCPU, and the console timer prints the rings out of the VM
+ * exit path. It is not while the console timer can't fire on the BSP, see
+ * console_vmexit_callback(). Each ring has a single producer, its pCPU with
+ * interrupts off, and each message is printed under logmsg_ctl.lock.
+ */
+#define LOG_RING_SLOTS		16U
+
+struct logmsg_ring {
+	volatile uint32_t head;		/* next slot to print */
+	volatile uint32_t tail;		/* next slot to fill */
+	volatile uint32_t dropped;	/* messages lost to a full ring */
+	uint32_t reported;		/* drops already reported */
+	char slot[LOG_RING_SLOTS][LOG_MESSAGE_MAX_SIZE];
+};
+
 struct acrn_logmsg_ctl {
 	int32_t seq;
 	spinlock_t lock;
+	/* set once the console timer drains the rings */
+	bool deferred;
 };
 
 static struct acrn_logmsg_ctl logmsg_ctl;
+static struct logmsg_ring logmsg_rings[MAX_PCPU_NUM];
 
 void init_logmsg()
 {
@@ -32,6 +52,114 @@ void init_logmsg()
 	spinlock_init(&(logmsg_ctl.lock));
 }
 
+/*
+ * Print the oldest message of the ring of pcpu_id, or the drop count once
+ * the ring is empty.
+ *
+ * @pre logmsg_ctl.lock is held
+ *
+ * @return false if the ring was empty
+ */
+static bool print_log_ring(uint16_t pcpu_id)
+{
+	struct logmsg_ring *ring = &logmsg_rings[pcpu_id];
+	uint32_t head = ring->head, dropped;
+	bool printed = false;
+
+	if (head != ring->tail) {
+		printf("%s\n\r", ring->slot[head % LOG_RING_SLOTS]);
+		/* the slot is printed before the producer may reuse it */
+		cpu_memory_barrier();
+		ring->head = head + 1U;
+		printed = true;
+	} else {
+		dropped = ring->dropped;
+		if (dropped != ring->reported) {
+			printf("[cpu=%hu] %u log messages dropped\n\r", pcpu_id, dropped - ring->reported);
+			ring->reported = dropped;
+		}
+	}
+
+	return printed;
+}
+
+/*
+ * The lock is dropped between the messages, interrupts are only held off for
+ * one of them. A ring refilled meanwhile is printed up to its size per call.
+ */
+void flush_logmsg(void)
+{
+	uint16_t pcpu_id;
+	uint32_t i;
+	uint64_t rflags;
+	bool printed = true;
+
+	for (pcpu_id = 0U; pcpu_id < get_pcpu_nums(); pcpu_id++) {
+		for (i = 0U; printed && (i <= LOG_RING_SLOTS); i++) {
+			spinlock_irqsave_obtain(&(logmsg_ctl.lock), &rflags);
+			printed = print_log_ring(pcpu_id);
+			spinlock_irqrestore_release(&(logmsg_ctl.lock), rflags);
+		}
+		printed = true;
+	}
+}
+
+void defer_console_logmsg(bool deferred)
+{
+	logmsg_ctl.deferred = deferred;
+}
+
+static void put_log_ring(uint16_t pcpu_id, const char *buffer)
+{
+	struct logmsg_ring *ring = &logmsg_rings[pcpu_id];
+	uint32_t tail;
+	uint64_t rflags;
+
+	/* interrupt handlers on this pCPU log too */
+	CPU_INT_ALL_DISABLE(&rflags);
+	tail = ring->tail;
+	if ((tail - ring->head) >= LOG_RING_SLOTS) {
+		ring->dropped++;
+	} else {
+		(void)strncpy_s(ring->slot[tail % LOG_RING_SLOTS], LOG_MESSAGE_MAX_SIZE,
+				buffer, LOG_MESSAGE_MAX_SIZE);
+		cpu_write_memory_barrier();
+		ring->tail = tail + 1U;
+	}
+	CPU_INT_ALL_RESTORE(rflags);
+}
+
+bool logmsg_ratelimit(struct logmsg_ratelimit *rl, uint32_t severity, const char *func)
+{
+	uint64_t now, begin;
+	uint32_t missed;
+	bool ret = true;
+
+	/* a filtered message must not use up the burst of the call site */
+	if ((severity > console_loglevel) && (severity > mem_loglevel) && (severity > npk_loglevel)) {
+		return false;
+	}
+
+	now = cpu_ticks();
+	begin = rl->begin;
+	if (((now - begin) >= (LOG_RATELIMIT_INTERVAL_MS * TICKS_PER_MS)) &&
+			(atomic_cmpxchg64(&rl->begin, begin, now) == begin)) {
+		/* this pCPU opened the new interval */
+		rl->printed = 0;
+		missed = atomic_swap32(&rl->missed, 0U);
+		if (missed != 0U) {
+			do_logmsg(LOG_WARNING, "%s: %u messages suppressed by rate limit", func, missed);
+		}
+	}
+
+	if (atomic_xadd32(&rl->printed, 1) >= LOG_RATELIMIT_BURST) {
+		atomic_inc32(&rl->missed);
+		ret = false;
+	}
+
+	return ret;
+}
+
 void do_logmsg(uint32_t severity, const char *fmt, ...)
 {
 	va_list args;
@@ -81,28 +209,31 @@ void do_logmsg(uint32_t severity, const char *fmt, ...)
 
 	/* Check whether output to stdout */
 	if (do_console_log) {
-		spinlock_irqsave_obtain(&(logmsg_ctl.lock), &rflags);
-
-		/* Send buffer to stdout */
-		printf("%s\n\r", buffer);
-
-		spinlock_irqrestore_release(&(logmsg_ctl.lock), rflags);
+		/* fatal errors and crash dumps (LOG_ACRN) must not wait for the timer */
+		if (logmsg_ctl.deferred && (severity > LOG_ACRN)) {
+			put_log_ring(pcpu_id, buffer);
+		} else {
+			/* keep the order with what is still buffered */
+			flush_logmsg();
+
+			spinlock_irqsave_obtain(&(logmsg_ctl.lock), &rflags);
+			/* Send buffer to stdout */
+			printf("%s\n\r", buffer);
+			spinlock_irqrestore_release(&(logmsg_ctl.lock), rflags);
+		}
 	}
 
 	/* Check whether output to memory */
 	if (do_mem_log) {
-		uint32_t i, msg_len;
+		uint32_t msg_len;
 		struct shared_buf *sbuf = per_cpu(sbuf, pcpu_id)[ACRN_HVLOG];
 
 		/* If sbuf is not ready, we just drop the massage */
 		if (sbuf != NULL) {
 			msg_len = strnlen_s(buffer, LOG_MESSAGE_MAX_SIZE);
 
-			for (i = 0U; i < (((msg_len - 1U) / LOG_ENTRY_SIZE) + 1U);
-					i++) {
-				(void)sbuf_put(sbuf, (uint8_t *)buffer +
-							(i * LOG_ENTRY_SIZE));
-			}
+			(void)sbuf_put_many(sbuf, (uint8_t *)buffer,
+					((msg_len - 1U) / LOG_ENTRY_SIZE) + 1U);
 		}
 	}
 }
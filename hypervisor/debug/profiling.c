@@ -16,6 +16,7 @@
 #include <sprintf.h>
 #include <logmsg.h>
 #include <ticks.h>
+#include <hvprof.h>
 
 #define DBG_LEVEL_PROFILING		5U
 #define DBG_LEVEL_ERR_PROFILING		3U
@@ -303,8 +304,9 @@ static int32_t profiling_sbuf_put_variable(struct shared_buf *sbuf,
  */
 static int32_t profiling_generate_data(int32_t collector, uint32_t type)
 {
-	uint64_t i;
 	uint32_t remaining_space = 0U;
+	uint32_t hdr_ele, payload_ele;
+	struct sbuf_resv resv;
 	int32_t 	ret = 0;
 	struct data_header pkt_header;
 	uint64_t payload_size = 0UL;
@@ -380,13 +382,16 @@ static int32_t profiling_generate_data(int32_t collector, uint32_t type)
 				return 0;
 			}
 
-			for (i = 0U; i < (((DATA_HEADER_SIZE - 1U) / SEP_BUF_ENTRY_SIZE) + 1U); i++) {
-				(void)sbuf_put(sbuf, (uint8_t *)&pkt_header + i * SEP_BUF_ENTRY_SIZE);
-			}
-
-			for (i = 0U; i < (((payload_size - 1U) / SEP_BUF_ENTRY_SIZE) + 1U); i++) {
-				(void)sbuf_put(sbuf, (uint8_t *)payload + i * SEP_BUF_ENTRY_SIZE);
+			/* header and payload each start on an entry boundary, published at once */
+			hdr_ele = (uint32_t)(((DATA_HEADER_SIZE - 1U) / SEP_BUF_ENTRY_SIZE) + 1U);
+			payload_ele = (uint32_t)(((payload_size - 1U) / SEP_BUF_ENTRY_SIZE) + 1U);
+			if (sbuf_reserve(sbuf, hdr_ele + payload_ele, &resv) == 0U) {
+				ss->samples_dropped++;
+				return 0;
 			}
+			sbuf_resv_fill(sbuf, &resv, &pkt_header, hdr_ele * SEP_BUF_ENTRY_SIZE);
+			sbuf_resv_fill(sbuf, &resv, payload, payload_ele * SEP_BUF_ENTRY_SIZE);
+			sbuf_commit(sbuf, &resv);
 
 			ss->samples_logged++;
 		}
@@ -1299,6 +1304,8 @@ void profiling_ipi_handler(__unused void *data)
  */
 void profiling_vmenter_handler(__unused struct acrn_vcpu *vcpu)
 {
+	hvprof_vmenter();
+
 	if (((get_cpu_var(profiling_info.s_state).pmu_state == PMU_RUNNING) &&
 			((sep_collection_switch &
 				(1UL << (uint64_t)VM_SWITCH_TRACING)) > 0UL)) ||
@@ -1319,6 +1326,8 @@ void profiling_pre_vmexit_handler(struct acrn_vcpu *vcpu)
 
 	exit_reason = vcpu->arch.exit_reason & 0xFFFFUL;
 
+	hvprof_vmexit();
+
 	if ((get_cpu_var(profiling_info.s_state).pmu_state == PMU_RUNNING) ||
 		(get_cpu_var(profiling_info.soc_state) == SW_RUNNING)) {
 
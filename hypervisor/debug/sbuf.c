@@ -79,6 +79,193 @@ uint32_t sbuf_put(struct shared_buf *sbuf, uint8_t *data)
 	return ele_size;
 }
 
+static inline uint32_t sbuf_used(const struct shared_buf *sbuf, uint32_t head)
+{
+	return (sbuf->tail >= head) ? (sbuf->tail - head) : (sbuf->size - (head - sbuf->tail));
+}
+
+/*
+ * Make room for nr_ele elements at the tail. With OVERWRITE_EN the oldest
+ * data is dropped; a buffer of framed records drops whole records so the
+ * reader never lands in the middle of one.
+ *
+ * @pre stac() is in effect
+ */
+static bool sbuf_make_room(struct shared_buf *sbuf, uint32_t nr_ele, bool framed)
+{
+	const struct sbuf_rec_hdr *hdr;
+	uint32_t need = nr_ele * sbuf->ele_size;
+	uint32_t head, skip;
+	bool ret = true;
+
+	/* one element always stays empty to tell a full buffer from an empty one */
+	if ((nr_ele == 0U) || (nr_ele >= sbuf->ele_num)) {
+		ret = false;
+	} else if ((sbuf->size - sbuf_used(sbuf, sbuf->head)) <= need) {
+		sbuf->overrun_cnt += sbuf->flags & OVERRUN_CNT_EN;
+		if ((sbuf->flags & OVERWRITE_EN) == 0U) {
+			ret = false;
+		} else {
+			head = sbuf->head;
+			while ((sbuf->size - sbuf_used(sbuf, head)) <= need) {
+				skip = 1U;
+				if (framed) {
+					hdr = (const struct sbuf_rec_hdr *)((void *)sbuf + SBUF_HEAD_SIZE + head);
+					skip = hdr->nr_ele;
+					if ((skip == 0U) || (skip >= sbuf->ele_num)) {
+						/* corrupted framing, drop everything */
+						head = sbuf->tail;
+						break;
+					}
+				}
+				head = sbuf_next_ptr(head, skip * sbuf->ele_size, sbuf->size);
+			}
+			sbuf->head = head;
+		}
+	}
+
+	return ret;
+}
+
+/*
+ * @pre stac() is in effect
+ */
+static uint32_t sbuf_reserve_ele(struct shared_buf *sbuf, uint32_t nr_ele,
+		struct sbuf_resv *resv, bool framed)
+{
+	uint32_t ret = 0U;
+
+	if (sbuf_make_room(sbuf, nr_ele, framed)) {
+		resv->pos = sbuf->tail;
+		resv->room = nr_ele * sbuf->ele_size;
+		resv->end = sbuf_next_ptr(sbuf->tail, resv->room, sbuf->size);
+		ret = nr_ele;
+	}
+
+	return ret;
+}
+
+/*
+ * @pre stac() is in effect
+ */
+static void sbuf_fill(struct shared_buf *sbuf, struct sbuf_resv *resv, const void *data, uint32_t len)
+{
+	uint32_t n = min(len, resv->room);
+	uint32_t first = min(n, sbuf->size - resv->pos);
+
+	(void)memcpy_s((void *)sbuf + SBUF_HEAD_SIZE + resv->pos, first, data, first);
+	if (n > first) {
+		/* wrap-around */
+		(void)memcpy_s((void *)sbuf + SBUF_HEAD_SIZE, n - first, data + first, n - first);
+	}
+	resv->pos = sbuf_next_ptr(resv->pos, n, sbuf->size);
+	resv->room -= n;
+}
+
+/*
+ * @pre stac() is in effect
+ */
+static inline void sbuf_publish(struct shared_buf *sbuf, const struct sbuf_resv *resv)
+{
+	/* the reader must not see the new tail before the data */
+	cpu_write_memory_barrier();
+	sbuf->tail = resv->end;
+}
+
+/**
+ * Reserve nr_ele elements at the tail. Overrun is handled as in sbuf_put().
+ *
+ * return:
+ * nr_ele:	reserved, fill it with sbuf_resv_fill() and publish it
+ *		with sbuf_commit()
+ * 0:		no room
+ */
+uint32_t sbuf_reserve(struct shared_buf *sbuf, uint32_t nr_ele, struct sbuf_resv *resv)
+{
+	uint32_t ret;
+
+	stac();
+	ret = sbuf_reserve_ele(sbuf, nr_ele, resv, false);
+	clac();
+
+	return ret;
+}
+
+/**
+ * Append len bytes to a reservation, anything beyond its room is dropped.
+ */
+void sbuf_resv_fill(struct shared_buf *sbuf, struct sbuf_resv *resv, const void *data, uint32_t len)
+{
+	stac();
+	sbuf_fill(sbuf, resv, data, len);
+	clac();
+}
+
+void sbuf_commit(struct shared_buf *sbuf, const struct sbuf_resv *resv)
+{
+	stac();
+	sbuf_publish(sbuf, resv);
+	clac();
+}
+
+/**
+ * Batched sbuf_put(): copy nr_ele consecutive elements from data with a
+ * single tail update. Either all of them are written or none.
+ *
+ * return:
+ * nr_ele * ele_size:	write succeeded.
+ * 0:			no write, buf is full
+ */
+uint32_t sbuf_put_many(struct shared_buf *sbuf, const uint8_t *data, uint32_t nr_ele)
+{
+	struct sbuf_resv resv;
+	uint32_t ret = 0U;
+
+	stac();
+	if (sbuf_reserve_ele(sbuf, nr_ele, &resv, false) != 0U) {
+		ret = resv.room;
+		sbuf_fill(sbuf, &resv, data, resv.room);
+		sbuf_publish(sbuf, &resv);
+	}
+	clac();
+
+	return ret;
+}
+
+/**
+ * Write a variable-length record framed by struct sbuf_rec_hdr, padded
+ * up to whole elements.
+ *
+ * return:
+ * len:		write succeeded.
+ * 0:		no write, buf is full or the record is too large
+ */
+uint32_t sbuf_put_record(struct shared_buf *sbuf, const void *data, uint32_t len)
+{
+	struct sbuf_rec_hdr hdr;
+	struct sbuf_resv resv;
+	uint32_t total = (uint32_t)sizeof(hdr) + len;
+	uint32_t nr_ele, ret = 0U;
+
+	stac();
+	nr_ele = (total + sbuf->ele_size - 1U) / sbuf->ele_size;
+	if ((len <= 0xffffU) && (nr_ele <= 0xffffU) &&
+			(sbuf_reserve_ele(sbuf, nr_ele, &resv, true) != 0U)) {
+		hdr.nr_ele = (uint16_t)nr_ele;
+		hdr.len = (uint16_t)len;
+		hdr.reserved = 0U;
+		sbuf_fill(sbuf, &resv, &hdr, sizeof(hdr));
+		if (len != 0U) {
+			sbuf_fill(sbuf, &resv, data, len);
+		}
+		sbuf_publish(sbuf, &resv);
+		ret = len;
+	}
+	clac();
+
+	return ret;
+}
+
 int32_t sbuf_share_setup(uint16_t pcpu_id, uint32_t sbuf_id, uint64_t *hva)
 {
 	if ((pcpu_id >= get_pcpu_nums()) || (sbuf_id >= ACRN_SBUF_ID_MAX)) {
@@ -86,6 +273,10 @@ int32_t sbuf_share_setup(uint16_t pcpu_id, uint32_t sbuf_id, uint64_t *hva)
 	}
 
 	per_cpu(sbuf, pcpu_id)[sbuf_id] = (struct shared_buf *) hva;
+	if (sbuf_id == ACRN_TRACE) {
+		/* a newly set up trace sbuf holds struct trace_entry elements */
+		per_cpu(trace_format, pcpu_id) = ACRN_TRACE_FORMAT_V1;
+	}
 	pr_info("%s share sbuf for pCPU[%u] with sbuf_id[%u] setup successfully",
 			__func__, pcpu_id, sbuf_id);
 
@@ -22,6 +22,9 @@
 #include <shell.h>
 #include <asm/guest/vmcs.h>
 #include <asm/host_pm.h>
+#include <hvprof.h>
+#include <boot_work.h>
+#include <slab.h>
 
 #define TEMP_STR_SIZE		60U
 #define MAX_STR_SIZE		256U
@@ -52,6 +55,15 @@ static int32_t shell_cpuid(int32_t argc, char **argv);
 static int32_t shell_reboot(int32_t argc, char **argv);
 static int32_t shell_rdmsr(int32_t argc, char **argv);
 static int32_t shell_wrmsr(int32_t argc, char **argv);
+static int32_t shell_hvprof(int32_t argc, char **argv);
+static int32_t shell_boottime(__unused int32_t argc, __unused char **argv);
+static int32_t shell_xsave_stat(__unused int32_t argc, __unused char **argv);
+static int32_t shell_idle_stat(__unused int32_t argc, __unused char **argv);
+static int32_t shell_slab_stat(__unused int32_t argc, __unused char **argv);
+static int32_t shell_world_stat(int32_t argc, char **argv);
+#ifdef CONFIG_NVMX_ENABLED
+static int32_t shell_nested(int32_t argc, char **argv);
+#endif
 
 static struct shell_cmd shell_cmds[] = {
 	{
@@ -156,6 +168,50 @@ static struct shell_cmd shell_cmds[] = {
 		.help_str	= SHELL_CMD_WRMSR_HELP,
 		.fcn		= shell_wrmsr,
 	},
+	{
+		.str		= SHELL_CMD_HVPROF,
+		.cmd_param	= SHELL_CMD_HVPROF_PARAM,
+		.help_str	= SHELL_CMD_HVPROF_HELP,
+		.fcn		= shell_hvprof,
+	},
+	{
+		.str		= SHELL_CMD_BOOTTIME,
+		.cmd_param	= SHELL_CMD_BOOTTIME_PARAM,
+		.help_str	= SHELL_CMD_BOOTTIME_HELP,
+		.fcn		= shell_boottime,
+	},
+	{
+		.str		= SHELL_CMD_XSAVE_STAT,
+		.cmd_param	= SHELL_CMD_XSAVE_STAT_PARAM,
+		.help_str	= SHELL_CMD_XSAVE_STAT_HELP,
+		.fcn		= shell_xsave_stat,
+	},
+	{
+		.str		= SHELL_CMD_IDLE_STAT,
+		.cmd_param	= SHELL_CMD_IDLE_STAT_PARAM,
+		.help_str	= SHELL_CMD_IDLE_STAT_HELP,
+		.fcn		= shell_idle_stat,
+	},
+	{
+		.str		= SHELL_CMD_SLAB_STAT,
+		.cmd_param	= SHELL_CMD_SLAB_STAT_PARAM,
+		.help_str	= SHELL_CMD_SLAB_STAT_HELP,
+		.fcn		= shell_slab_stat,
+	},
+	{
+		.str		= SHELL_CMD_WORLD_STAT,
+		.cmd_param	= SHELL_CMD_WORLD_STAT_PARAM,
+		.help_str	= SHELL_CMD_WORLD_STAT_HELP,
+		.fcn		= shell_world_stat,
+	},
+#ifdef CONFIG_NVMX_ENABLED
+	{
+		.str		= SHELL_CMD_NESTED,
+		.cmd_param	= SHELL_CMD_NESTED_PARAM,
+		.help_str	= SHELL_CMD_NESTED_HELP,
+		.fcn		= shell_nested,
+	},
+#endif
 };
 
 /* The initial log level*/
@@ -1169,7 +1225,10 @@ static void get_vioapic_info(char *str_arg, size_t str_max, uint16_t vmid)
 	uint32_t delmode, vector, dest;
 	bool level, phys, remote_irr, mask;
 	struct acrn_vm *vm = get_vm_from_vmid(vmid);
+	struct acrn_vcpu *vcpu;
+	const struct acrn_vlapic *vlapic;
 	uint32_t gsi, gsi_count;
+	uint16_t i;
 
 	if (is_poweroff_vm(vm)) {
 		len = snprintf(str, size, "\r\nvm is not exist for vmid %hu", vmid);
@@ -1212,6 +1271,24 @@ static void get_vioapic_info(char *str_arg, size_t str_max, uint16_t vmid)
 		size -= len;
 		str += len;
 	}
+
+	len = snprintf(str, size, "\r\n\r\nVCPU\tEOI_EXITS\tAVOIDED");
+	if (len >= size) {
+		goto overflow;
+	}
+	size -= len;
+	str += len;
+
+	foreach_vcpu(i, vm, vcpu) {
+		vlapic = vcpu_vlapic(vcpu);
+		len = snprintf(str, size, "\r\n%hu\t%lu\t\t%lu", vcpu->vcpu_id,
+				vlapic->eoi_exits, vlapic->eoi_exits_avoided);
+		if (len >= size) {
+			goto overflow;
+		}
+		size -= len;
+		str += len;
+	}
 END:
 	snprintf(str, size, "\r\n");
 	return;
@@ -1447,3 +1524,236 @@ static int32_t shell_wrmsr(int32_t argc, char **argv)
 
 	return ret;
 }
+
+static int32_t shell_hvprof(int32_t argc, char **argv)
+{
+	uint64_t period = HVPROF_DEFAULT_PERIOD;
+	int32_t ret = -EINVAL;
+
+	if ((argc >= 2) && (strcmp(argv[1], "start") == 0)) {
+		if (argc == 3) {
+			period = (uint64_t)strtol_deci(argv[2]);
+		}
+		if (argc <= 3) {
+			ret = hvprof_start(period);
+			if (ret == -EBUSY) {
+				shell_puts("hvprof: already running, or the PMU is in use by SEP or a VM\r\n");
+			}
+		}
+	} else if ((argc == 2) && (strcmp(argv[1], "stop") == 0)) {
+		hvprof_stop();
+		ret = 0;
+	} else {
+		/* invalid parameters, reported by the caller */
+	}
+
+	return ret;
+}
+
+static int32_t shell_boottime(__unused int32_t argc, __unused char **argv)
+{
+	const struct boot_phase *phases;
+	uint32_t i, nr;
+	uint64_t prev, delta;
+	char temp_str[MAX_STR_SIZE];
+
+	phases = get_boot_phases(&nr);
+	shell_puts("\r\n       TIME(us)    DELTA(us)  PCPU  VM  PHASE\r\n");
+	prev = (nr > 0U) ? phases[0].tick : 0UL;
+	for (i = 0U; i < nr; i++) {
+		/* entries logged by different pCPUs at the same time may be out of order */
+		delta = (phases[i].tick > prev) ? ticks_to_us(phases[i].tick - prev) : 0UL;
+		if (phases[i].vm_id == ACRN_INVALID_VMID) {
+			snprintf(temp_str, MAX_STR_SIZE, "%15lu %12lu  %4hu   -  %s\r\n",
+				ticks_to_us(phases[i].tick), delta,
+				phases[i].pcpu_id, phases[i].name);
+		} else {
+			snprintf(temp_str, MAX_STR_SIZE, "%15lu %12lu  %4hu  %2hu  %s\r\n",
+				ticks_to_us(phases[i].tick), delta,
+				phases[i].pcpu_id, phases[i].vm_id, phases[i].name);
+		}
+		shell_puts(temp_str);
+		prev = max(prev, phases[i].tick);
+	}
+
+	return 0;
+}
+
+/* upper bound of the histogram bucket holding the 99th percentile, in cycles */
+static uint64_t exit_stat_p99(const struct acrn_exit_stat *stat)
+{
+	uint64_t seen = 0UL;
+	uint32_t i;
+
+	for (i = 0U; i < (ACRN_EXIT_HIST_BUCKETS - 1U); i++) {
+		seen += stat->hist[i];
+		if ((seen * 100UL) >= (stat->count * 99UL)) {
+			break;
+		}
+	}
+
+	return 1UL << (ACRN_EXIT_HIST_SHIFT + i);
+}
+
+static int32_t shell_xsave_stat(__unused int32_t argc, __unused char **argv)
+{
+	const struct acrn_exit_stat *stat;
+	char temp_str[MAX_STR_SIZE];
+	uint16_t pcpu_id;
+
+	shell_puts("\r\nPCPU      SWITCHES       SKIPPED   AVG(cycles)   P99(cycles)\r\n");
+	for (pcpu_id = 0U; pcpu_id < get_pcpu_nums(); pcpu_id++) {
+		stat = &per_cpu(xsave_switch, pcpu_id);
+		snprintf(temp_str, MAX_STR_SIZE, "%4hu  %12lu  %12lu  %12lu  %12lu\r\n", pcpu_id,
+			stat->count, per_cpu(xsave_switch_skipped, pcpu_id),
+			(stat->count != 0UL) ? (stat->cycles / stat->count) : 0UL,
+			(stat->count != 0UL) ? exit_stat_p99(stat) : 0UL);
+		shell_puts(temp_str);
+	}
+
+	return 0;
+}
+
+static int32_t shell_idle_stat(__unused int32_t argc, __unused char **argv)
+{
+	const struct idle_state *states;
+	const struct idle_stat *stat;
+	char temp_str[MAX_STR_SIZE];
+	uint32_t nr, i;
+	uint16_t pcpu_id;
+
+	states = get_idle_states(&nr);
+	shell_puts("\r\nSTATE  MWAIT  LATENCY(us)  TARGET(us)\r\n");
+	for (i = 0U; i < nr; i++) {
+		if (i == IDLE_STATE_POLL) {
+			snprintf(temp_str, MAX_STR_SIZE, "%5u   poll  %11u  %10u\r\n", i,
+				states[i].exit_latency, states[i].target_residency);
+		} else {
+			snprintf(temp_str, MAX_STR_SIZE, "%5u   0x%02x  %11u  %10u\r\n", i, states[i].mwait_hint,
+				states[i].exit_latency, states[i].target_residency);
+		}
+		shell_puts(temp_str);
+	}
+
+	shell_puts("\r\nPCPU  LIMIT  STATE         USAGE  RESIDENCY(ms)         ABOVE         BELOW\r\n");
+	for (pcpu_id = 0U; pcpu_id < get_pcpu_nums(); pcpu_id++) {
+		for (i = 0U; i < nr; i++) {
+			stat = &per_cpu(cpu_idle, pcpu_id).stats[i];
+			snprintf(temp_str, MAX_STR_SIZE, "%4hu  %5u  %5u  %12lu  %13lu  %12lu  %12lu\r\n",
+				pcpu_id, get_idle_state_limit(pcpu_id), i, stat->usage,
+				ticks_to_ms(stat->residency), stat->above, stat->below);
+			shell_puts(temp_str);
+		}
+	}
+
+	return 0;
+}
+
+static int32_t shell_slab_stat(__unused int32_t argc, __unused char **argv)
+{
+	const struct slab_cache *cache;
+	char temp_str[MAX_STR_SIZE];
+	uint32_t i = 0U;
+
+	shell_puts("\r\nCACHE             OBJ_SIZE   TOTAL  IN_USE  HIGH_WATER      FAILURES\r\n");
+	cache = get_slab_cache(i);
+	while (cache != NULL) {
+		snprintf(temp_str, MAX_STR_SIZE, "%-16s  %8u  %6u  %6u  %10u  %12lu\r\n", cache->name,
+			cache->obj_size, cache->nr_objs, cache->in_use, cache->high_water, cache->failures);
+		shell_puts(temp_str);
+		i++;
+		cache = get_slab_cache(i);
+	}
+
+	return 0;
+}
+
+static int32_t shell_world_stat(int32_t argc, char **argv)
+{
+	static const char *const world_names[NR_WORLD] = {
+		[NORMAL_WORLD] = "normal",
+		[SECURE_WORLD] = "secure",
+	};
+	const struct acrn_exit_stat *stat;
+	struct acrn_vcpu *vcpu;
+	struct acrn_vm *vm;
+	char temp_str[MAX_STR_SIZE];
+	uint16_t i;
+	int32_t world, ret = -EINVAL;
+
+	if (argc == 2) {
+		ret = strtol_deci(argv[1]);
+	}
+
+	if (ret >= 0) {
+		vm = get_vm_from_vmid(sanitize_vmid((uint16_t)ret));
+		ret = 0;
+		if (is_poweroff_vm(vm)) {
+			shell_puts("VM is not running\r\n");
+		} else if (vm->sworld_control.flag.active == 0UL) {
+			shell_puts("No Secure World in the VM\r\n");
+		} else {
+			shell_puts("\r\nVCPU  CURRENT  TO WORLD         COUNT   AVG(cycles)   P99(cycles)\r\n");
+			foreach_vcpu(i, vm, vcpu) {
+				for (world = 0; world < NR_WORLD; world++) {
+					stat = &vcpu->arch.world_switch_stats[world];
+					snprintf(temp_str, MAX_STR_SIZE, "%4hu  %7s  %8s  %12lu  %12lu  %12lu\r\n",
+						vcpu->vcpu_id, world_names[vcpu->arch.cur_context], world_names[world],
+						stat->count, (stat->count != 0UL) ? (stat->cycles / stat->count) : 0UL,
+						(stat->count != 0UL) ? exit_stat_p99(stat) : 0UL);
+					shell_puts(temp_str);
+				}
+			}
+		}
+	}
+
+	return ret;
+}
+
+#ifdef CONFIG_NVMX_ENABLED
+
+static int32_t shell_nested(int32_t argc, char **argv)
+{
+	static const char *const stat_names[NESTED_STAT_NUM] = {
+		[NESTED_STAT_ENTRY] = "L2 entry",
+		[NESTED_STAT_EXIT] = "L2 exit to L1",
+		[NESTED_STAT_EPT] = "L2 EPT fixup",
+		[NESTED_STAT_VMPTRLD_MISS] = "VMPTRLD miss",
+		[NESTED_STAT_VMCS12_FLUSH] = "VMCS12 flush",
+	};
+	const struct acrn_exit_stat *stat;
+	struct acrn_vcpu *vcpu;
+	struct acrn_vm *vm;
+	char temp_str[MAX_STR_SIZE];
+	uint16_t i;
+	uint32_t idx;
+	int32_t ret = -EINVAL;
+
+	if (argc == 2) {
+		ret = strtol_deci(argv[1]);
+	}
+
+	if (ret >= 0) {
+		vm = get_vm_from_vmid(sanitize_vmid((uint16_t)ret));
+		ret = 0;
+		if (is_poweroff_vm(vm)) {
+			shell_puts("VM is not running\r\n");
+		} else {
+			shell_puts("\r\nVCPU  EVENT                 COUNT   AVG(cycles)   P99(cycles)\r\n");
+			foreach_vcpu(i, vm, vcpu) {
+				for (idx = 0U; idx < NESTED_STAT_NUM; idx++) {
+					stat = &vcpu->arch.nested.stats[idx];
+					if (stat->count != 0UL) {
+						snprintf(temp_str, MAX_STR_SIZE, "%4hu  %-15s %12lu  %12lu  %12lu\r\n",
+							vcpu->vcpu_id, stat_names[idx], stat->count,
+							stat->cycles / stat->count, exit_stat_p99(stat));
+						shell_puts(temp_str);
+					}
+				}
+			}
+		}
+	}
+
+	return ret;
+}
+#endif
@@ -87,7 +87,8 @@ struct shell {
 
 #define SHELL_CMD_VIOAPIC		"vioapic"
 #define SHELL_CMD_VIOAPIC_PARAM		"<vm id>"
-#define SHELL_CMD_VIOAPIC_HELP		"Show virtual IOAPIC (vIOAPIC) information for a specific VM"
+#define SHELL_CMD_VIOAPIC_HELP		"Show virtual IOAPIC (vIOAPIC) information for a specific VM, and the EOI "\
+					"exits of its vCPUs"
 
 #define SHELL_CMD_LOG_LVL		"loglevel"
 #define SHELL_CMD_LOG_LVL_PARAM		"[<console_loglevel> [<mem_loglevel> [npk_loglevel]]]"
@@ -106,4 +107,35 @@ struct shell {
 #define SHELL_CMD_WRMSR_PARAM		"[-p<pcpu_id>]	<msr_index> <value>"
 #define SHELL_CMD_WRMSR_HELP		"Write value (in hexadecimal) to the MSR at msr_index (in hexadecimal) for CPU"\
 					" ID pcpu_id"
+
+#define SHELL_CMD_BOOTTIME		"boottime"
+#define SHELL_CMD_BOOTTIME_PARAM	NULL
+#define SHELL_CMD_BOOTTIME_HELP		"Show when the boot phases were reached, in us since power on"
+
+#define SHELL_CMD_HVPROF		"hvprof"
+#define SHELL_CMD_HVPROF_PARAM		"<start [period] | stop>"
+#define SHELL_CMD_HVPROF_HELP		"Sample the hypervisor call stacks on all pCPUs every period (in decimal) "\
+					"unhalted cycles, default 1000000. Samples go to the ACRN_HVPROF sbufs"
+
+#define SHELL_CMD_XSAVE_STAT		"xsave_stat"
+#define SHELL_CMD_XSAVE_STAT_PARAM	NULL
+#define SHELL_CMD_XSAVE_STAT_HELP	"Show the XSAVE state switches of each pCPU, the skipped ones and their cost"
+
+#define SHELL_CMD_IDLE_STAT		"idle_stat"
+#define SHELL_CMD_IDLE_STAT_PARAM	NULL
+#define SHELL_CMD_IDLE_STAT_HELP	"Show the idle state residency of each pCPU, and how often a state was too "\
+					"deep (above) or too shallow (below) for the idle time"
+
+#define SHELL_CMD_WORLD_STAT		"world_stat"
+#define SHELL_CMD_WORLD_STAT_PARAM	"<vm_id>"
+#define SHELL_CMD_WORLD_STAT_HELP	"Show the Trusty world switches of each vCPU of the VM and their cost"
+
+#define SHELL_CMD_SLAB_STAT		"slab_stat"
+#define SHELL_CMD_SLAB_STAT_PARAM	NULL
+#define SHELL_CMD_SLAB_STAT_HELP	"Show the objects of each slab cache in use, their high-water mark and the "\
+					"allocation failures"
+
+#define SHELL_CMD_NESTED		"nested"
+#define SHELL_CMD_NESTED_PARAM		"<vm_id>"
+#define SHELL_CMD_NESTED_HELP		"Show the nested VMX entry/exit and VMCS12 cache statistics of each vCPU of the VM"
 #endif /* SHELL_PRIV_H */
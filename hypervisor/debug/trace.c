@@ -5,7 +5,12 @@
  */
 
 #include <types.h>
+#include <errno.h>
+#include <rtl.h>
+#include <asm/cpu.h>
 #include <asm/per_cpu.h>
+#include <asm/notify.h>
+#include <asm/lib/bits.h>
 #include <ticks.h>
 #include <trace.h>
 
@@ -39,13 +44,299 @@ struct trace_entry {
 	} payload;
 } __aligned(8);
 
-static inline bool trace_check(uint16_t cpu_id)
+/*
+ * Trace format v2, selected by HC_SET_TRACE_FORMAT, uses TRACE_V2_ELE_SIZE
+ * byte sbuf elements (v1 writes one struct trace_entry per element).
+ * Every record covers whole elements:
+ *
+ *   byte 0:	number of elements in the record
+ *   byte 1:	record kind (bits 0-3), argument count (bits 4-7)
+ *
+ * An event record continues with the TSC delta to the previous record,
+ * the event ID and the arguments, all LEB128 varints; trailing zero
+ * arguments are omitted. TRACE_16STR records carry the string bytes and
+ * use the argument count as string length.
+ *
+ * A sync record is three elements: byte 2 is the pCPU ID, bytes 4-7 the
+ * sbuf overrun count, then TRACE_V2_SYNC_MAGIC and the full TSC. It opens
+ * the stream and is repeated every TRACE_V2_SYNC_INTERVAL records, so a
+ * reader which lost its place (overwrite mode, or started in the middle)
+ * can scan for the magic and resume.
+ */
+#define TRACE_V2_ELE_SIZE	8U
+#define TRACE_V2_SYNC		0U
+#define TRACE_V2_2L		1U
+#define TRACE_V2_4I		2U
+#define TRACE_V2_6C		3U
+#define TRACE_V2_STR		4U
+#define TRACE_V2_SYNC_MAGIC	0x434e595354524341UL	/* "ACRTSYNC" */
+#define TRACE_V2_SYNC_SIZE	24U
+#define TRACE_V2_SYNC_INTERVAL	64U
+#define TRACE_V2_MAX_DELTA	(1UL << 32U)	/* larger gaps resync instead */
+#define TRACE_V2_REC_MAX	64U
+
+/* bit set: the event index is filtered out on every pCPU */
+static uint64_t trace_evfilter_all[ACRN_TRACE_EVMASK_WORDS];
+
+/* serializes the filter and format updates, the trace fast path takes no lock */
+static spinlock_t trace_filter_lock = { .head = 0U, .tail = 0U, };
+
+/*
+ * Disabled-event fast path: a single test against a global mask, taken
+ * before reading the pCPU ID or building the entry.
+ */
+static inline bool trace_filtered(uint32_t evid)
+{
+	uint32_t idx = trace_event_index(evid);
+
+	return ((trace_evfilter_all[idx >> 6U] & (1UL << (idx & 0x3fU))) != 0UL);
+}
+
+static inline bool trace_check(uint16_t cpu_id, uint32_t evid)
 {
+	uint32_t idx = trace_event_index(evid);
+
 	if (per_cpu(sbuf, cpu_id)[ACRN_TRACE] == NULL) {
 		return false;
 	}
 
-	return true;
+	return ((per_cpu(trace_evfilter, cpu_id)[idx >> 6U] & (1UL << (idx & 0x3fU))) == 0UL);
+}
+
+/**
+ * The per-pCPU filters are updated first and the global fast-path mask last,
+ * so an event enabled by the global mask is already enabled on its pCPU.
+ *
+ * @pre filter != NULL
+ */
+int32_t trace_set_filter(const struct acrn_trace_filter *filter)
+{
+	uint16_t pcpu_id, pcpu_nums = get_pcpu_nums();
+	uint64_t all[ACRN_TRACE_EVMASK_WORDS];
+	uint32_t i;
+	int32_t ret = 0;
+
+	if ((filter->pcpu_id != ACRN_TRACE_ALL_PCPUS) && (filter->pcpu_id >= pcpu_nums)) {
+		ret = -EINVAL;
+	} else {
+		spinlock_obtain(&trace_filter_lock);
+		for (pcpu_id = 0U; pcpu_id < pcpu_nums; pcpu_id++) {
+			if ((filter->pcpu_id == ACRN_TRACE_ALL_PCPUS) || (filter->pcpu_id == pcpu_id)) {
+				for (i = 0U; i < ACRN_TRACE_EVMASK_WORDS; i++) {
+					per_cpu(trace_evfilter, pcpu_id)[i] = ~filter->evmask[i];
+				}
+			}
+		}
+
+		for (i = 0U; i < ACRN_TRACE_EVMASK_WORDS; i++) {
+			all[i] = ~0UL;
+			for (pcpu_id = 0U; pcpu_id < pcpu_nums; pcpu_id++) {
+				all[i] &= per_cpu(trace_evfilter, pcpu_id)[i];
+			}
+		}
+
+		cpu_write_memory_barrier();
+		for (i = 0U; i < ACRN_TRACE_EVMASK_WORDS; i++) {
+			trace_evfilter_all[i] = all[i];
+		}
+		spinlock_release(&trace_filter_lock);
+	}
+
+	return ret;
+}
+
+/*
+ * Runs on the pCPU that owns the trace sbuf, so it cannot interleave with a
+ * record being written there. Data buffered in the old format is dropped.
+ */
+static void trace_switch_format(void *data)
+{
+	uint16_t format = *(uint16_t *)data;
+	uint16_t pcpu_id = get_pcpu_id();
+	struct shared_buf *sbuf = per_cpu(sbuf, pcpu_id)[ACRN_TRACE];
+	uint32_t ele_size = (format == ACRN_TRACE_FORMAT_V2) ? TRACE_V2_ELE_SIZE :
+			(uint32_t)sizeof(struct trace_entry);
+
+	stac();
+	sbuf->ele_num = sbuf->size / ele_size;
+	sbuf->ele_size = ele_size;
+	sbuf->tail = 0U;
+	sbuf->head = 0U;
+	clac();
+
+	per_cpu(trace_format, pcpu_id) = format;
+	/* v2 output starts with a sync record */
+	per_cpu(trace_sync_cnt, pcpu_id) = 0U;
+}
+
+/**
+ * The format is only switched while the trace filter of every selected
+ * pCPU disables all events, so no record is written in the old layout
+ * after the switch and the reader sees the new element size first.
+ *
+ * @pre fmt != NULL
+ */
+int32_t trace_set_format(const struct acrn_trace_format *fmt)
+{
+	uint16_t pcpu_id, pcpu_nums = get_pcpu_nums();
+	uint16_t format = fmt->format;
+	uint64_t mask = 0UL;
+	uint32_t i;
+	int32_t ret = 0;
+
+	if (((fmt->pcpu_id != ACRN_TRACE_ALL_PCPUS) && (fmt->pcpu_id >= pcpu_nums)) ||
+			((format != ACRN_TRACE_FORMAT_V1) && (format != ACRN_TRACE_FORMAT_V2))) {
+		ret = -EINVAL;
+	} else {
+		/* no filter update can enable events during the switch */
+		spinlock_obtain(&trace_filter_lock);
+		for (pcpu_id = 0U; pcpu_id < pcpu_nums; pcpu_id++) {
+			if ((fmt->pcpu_id == ACRN_TRACE_ALL_PCPUS) || (fmt->pcpu_id == pcpu_id)) {
+				if (per_cpu(sbuf, pcpu_id)[ACRN_TRACE] == NULL) {
+					ret = -ENODEV;
+					break;
+				}
+				for (i = 0U; i < ACRN_TRACE_EVMASK_WORDS; i++) {
+					if (per_cpu(trace_evfilter, pcpu_id)[i] != ~0UL) {
+						ret = -EBUSY;
+					}
+				}
+				if (ret != 0) {
+					break;
+				}
+				bitmap_set_nolock(pcpu_id, &mask);
+			}
+		}
+
+		if (ret == 0) {
+			smp_call_function(mask, trace_switch_format, &format);
+		}
+		spinlock_release(&trace_filter_lock);
+	}
+
+	return ret;
+}
+
+static uint32_t trace_v2_varint(uint8_t *buf, uint64_t val)
+{
+	uint64_t v = val;
+	uint32_t n = 0U;
+
+	while (v >= 0x80UL) {
+		buf[n] = (uint8_t)(v | 0x80UL);
+		v >>= 7U;
+		n++;
+	}
+	buf[n] = (uint8_t)v;
+
+	return n + 1U;
+}
+
+static uint32_t trace_v2_sync(uint8_t *rec, const struct shared_buf *sbuf, uint16_t cpu_id, uint64_t tsc)
+{
+	uint64_t magic = TRACE_V2_SYNC_MAGIC;
+	uint32_t overrun;
+
+	stac();
+	overrun = sbuf->overrun_cnt;
+	clac();
+
+	(void)memset(rec, 0U, TRACE_V2_SYNC_SIZE);
+	rec[0] = (uint8_t)(TRACE_V2_SYNC_SIZE / TRACE_V2_ELE_SIZE);
+	rec[1] = (uint8_t)TRACE_V2_SYNC;
+	rec[2] = (uint8_t)cpu_id;
+	(void)memcpy_s(&rec[4], 4U, &overrun, 4U);
+	(void)memcpy_s(&rec[8], 8U, &magic, 8U);
+	(void)memcpy_s(&rec[16], 8U, &tsc, 8U);
+
+	return TRACE_V2_SYNC_SIZE;
+}
+
+/*
+ * Encode the entry as a v2 event record, preceded by a sync record when
+ * one is due. Both go into one reservation, so either both or none are
+ * written, and a dropped record leaves the delta base untouched.
+ */
+static void trace_put_v2(struct shared_buf *sbuf, uint16_t cpu_id, const struct trace_entry *entry)
+{
+	uint8_t rec[TRACE_V2_SYNC_SIZE + TRACE_V2_REC_MAX];
+	uint64_t args[6];
+	uint64_t delta = entry->tsc - per_cpu(trace_last_tsc, cpu_id);
+	uint32_t kind, nargs, start = 0U, len, i;
+	struct sbuf_resv resv;
+	bool sync;
+
+	switch (entry->n_data) {
+	case 2U:
+		kind = TRACE_V2_2L;
+		args[0] = entry->payload.fields_64.e;
+		args[1] = entry->payload.fields_64.f;
+		nargs = 2U;
+		break;
+	case 4U:
+		kind = TRACE_V2_4I;
+		args[0] = entry->payload.fields_32.a;
+		args[1] = entry->payload.fields_32.b;
+		args[2] = entry->payload.fields_32.c;
+		args[3] = entry->payload.fields_32.d;
+		nargs = 4U;
+		break;
+	case 8U:
+		kind = TRACE_V2_6C;
+		args[0] = entry->payload.fields_8.a1;
+		args[1] = entry->payload.fields_8.a2;
+		args[2] = entry->payload.fields_8.a3;
+		args[3] = entry->payload.fields_8.a4;
+		args[4] = entry->payload.fields_8.b1;
+		args[5] = entry->payload.fields_8.b2;
+		nargs = 6U;
+		break;
+	default:
+		kind = TRACE_V2_STR;
+		nargs = (uint32_t)strnlen_s(entry->payload.str, 15U);
+		break;
+	}
+
+	if (kind != TRACE_V2_STR) {
+		while ((nargs > 0U) && (args[nargs - 1U] == 0UL)) {
+			nargs--;
+		}
+	}
+
+	sync = (per_cpu(trace_sync_cnt, cpu_id) == 0U) || (delta >= TRACE_V2_MAX_DELTA);
+	if (sync) {
+		start = trace_v2_sync(rec, sbuf, cpu_id, entry->tsc);
+		delta = 0UL;
+	}
+
+	len = start + 2U;
+	len += trace_v2_varint(&rec[len], delta);
+	len += trace_v2_varint(&rec[len], entry->id);
+	for (i = 0U; i < nargs; i++) {
+		if (kind == TRACE_V2_STR) {
+			rec[len] = (uint8_t)entry->payload.str[i];
+			len++;
+		} else {
+			len += trace_v2_varint(&rec[len], args[i]);
+		}
+	}
+
+	/* zero padding up to whole elements */
+	while (((len - start) % TRACE_V2_ELE_SIZE) != 0U) {
+		rec[len] = 0U;
+		len++;
+	}
+	rec[start] = (uint8_t)((len - start) / TRACE_V2_ELE_SIZE);
+	rec[start + 1U] = (uint8_t)(kind | (nargs << 4U));
+
+	if (sbuf_reserve(sbuf, len / TRACE_V2_ELE_SIZE, &resv) != 0U) {
+		sbuf_resv_fill(sbuf, &resv, rec, len);
+		sbuf_commit(sbuf, &resv);
+
+		per_cpu(trace_last_tsc, cpu_id) = entry->tsc;
+		per_cpu(trace_sync_cnt, cpu_id) = sync ? (TRACE_V2_SYNC_INTERVAL - 1U) :
+				(per_cpu(trace_sync_cnt, cpu_id) - 1U);
+	}
 }
 
 static inline void trace_put(uint16_t cpu_id, uint32_t evid, uint32_t n_data, struct trace_entry *entry)
@@ -56,15 +347,25 @@ static inline void trace_put(uint16_t cpu_id, uint32_t evid, uint32_t n_data, st
 	entry->id = evid;
 	entry->n_data = (uint8_t)n_data;
 	entry->cpu = (uint8_t)cpu_id;
-	(void)sbuf_put(sbuf, (uint8_t *)entry);
+
+	if (per_cpu(trace_format, cpu_id) == ACRN_TRACE_FORMAT_V2) {
+		trace_put_v2(sbuf, cpu_id, entry);
+	} else {
+		(void)sbuf_put(sbuf, (uint8_t *)entry);
+	}
 }
 
 void TRACE_2L(uint32_t evid, uint64_t e, uint64_t f)
 {
 	struct trace_entry entry;
-	uint16_t cpu_id = get_pcpu_id();
+	uint16_t cpu_id;
 
-	if (!trace_check(cpu_id)) {
+	if (trace_filtered(evid)) {
+		return;
+	}
+
+	cpu_id = get_pcpu_id();
+	if (!trace_check(cpu_id, evid)) {
 		return;
 	}
 
@@ -76,9 +377,14 @@ void TRACE_2L(uint32_t evid, uint64_t e, uint64_t f)
 void TRACE_4I(uint32_t evid, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
 {
 	struct trace_entry entry;
-	uint16_t cpu_id = get_pcpu_id();
+	uint16_t cpu_id;
 
-	if (!trace_check(cpu_id)) {
+	if (trace_filtered(evid)) {
+		return;
+	}
+
+	cpu_id = get_pcpu_id();
+	if (!trace_check(cpu_id, evid)) {
 		return;
 	}
 
@@ -92,9 +398,14 @@ void TRACE_4I(uint32_t evid, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
 void TRACE_6C(uint32_t evid, uint8_t a1, uint8_t a2, uint8_t a3, uint8_t a4, uint8_t b1, uint8_t b2)
 {
 	struct trace_entry entry;
-	uint16_t cpu_id = get_pcpu_id();
+	uint16_t cpu_id;
+
+	if (trace_filtered(evid)) {
+		return;
+	}
 
-	if (!trace_check(cpu_id)) {
+	cpu_id = get_pcpu_id();
+	if (!trace_check(cpu_id, evid)) {
 		return;
 	}
 
@@ -114,10 +425,15 @@ void TRACE_6C(uint32_t evid, uint8_t a1, uint8_t a2, uint8_t a3, uint8_t a4, uin
 static inline void TRACE_16STR(uint32_t evid, const char name[])
 {
 	struct trace_entry entry;
-	uint16_t cpu_id = get_pcpu_id();
+	uint16_t cpu_id;
 	size_t len, i;
 
-	if (!trace_check(cpu_id)) {
+	if (trace_filtered(evid)) {
+		return;
+	}
+
+	cpu_id = get_pcpu_id();
+	if (!trace_check(cpu_id, evid)) {
 		return;
 	}
 
@@ -7,6 +7,7 @@
 #include <asm/irq.h>
 #include <errno.h>
 #include <logmsg.h>
+#include <sprintf.h>
 
 #define DBG_LEVEL_IOREQ	6U
 
@@ -428,6 +429,9 @@ hv_emulate_pio(struct acrn_vcpu *vcpu, struct io_request *io_req)
 		break;
 	}
 
+	/* for the VM exit statistics, a DM request overrides it */
+	vcpu->io_stat_slot = (idx < EMUL_PIO_IDX_MAX) ? (uint16_t)idx : IO_STAT_SLOT_PIO_DEFAULT;
+
 	if ((pio_req->direction == ACRN_IOREQ_DIR_WRITE) && (io_write != NULL)) {
 		if (io_write(vcpu, port, size, pio_req->value)) {
 			status = 0;
@@ -461,7 +465,7 @@ hv_emulate_mmio(struct acrn_vcpu *vcpu, struct io_request *io_req)
 {
 	int32_t status = -ENODEV;
 	bool hold_lock = true;
-	uint16_t idx;
+	uint16_t idx, stat_slot = IO_STAT_SLOT_MMIO_DEFAULT;
 	uint64_t address, size, base, end;
 	struct acrn_mmio_request *mmio_req = &io_req->reqs.mmio_request;
 	struct mem_io_node *mmio_handler = NULL;
@@ -487,6 +491,7 @@ hv_emulate_mmio(struct acrn_vcpu *vcpu, struct io_request *io_req)
 			} else {
 				 if ((address >= base) && ((address + size) <= end)) {
 					hold_lock = mmio_handler->hold_lock;
+					stat_slot = IO_STAT_SLOT_MMIO0 + idx;
 					read_write = mmio_handler->read_write;
 					handler_private_data = mmio_handler->handler_private_data;
 				} else {
@@ -502,6 +507,7 @@ hv_emulate_mmio(struct acrn_vcpu *vcpu, struct io_request *io_req)
 		/* This mmio_handler will never modify once register, so we don't
 		 * need to hold the lock when handling the MMIO access.
 		 */
+		vcpu->io_stat_slot = stat_slot;
 		if (!hold_lock) {
 			spinlock_release(&vcpu->vm->emul_mmio_lock);
 		}
@@ -568,6 +574,8 @@ emulate_io(struct acrn_vcpu *vcpu, struct io_request *io_req)
 		 *
 		 * ACRN insert request to HSM and inject upcall.
 		 */
+		vcpu->io_stat_slot = (io_req->io_type == ACRN_IOREQ_TYPE_PORTIO) ?
+				IO_STAT_SLOT_DM_PIO : IO_STAT_SLOT_DM_MMIO;
 		status = acrn_insert_request(vcpu, io_req);
 		if (status == 0) {
 			dm_emulate_io_complete(vcpu);
@@ -634,7 +642,7 @@ static inline struct mem_io_node *find_match_mmio_node(struct acrn_vm *vm,
 	}
 
 	if (!found) {
-		pr_info("%s, vm[%d] no match mmio region [0x%lx, 0x%lx] is found",
+		pr_info_ratelimited("%s, vm[%d] no match mmio region [0x%lx, 0x%lx] is found",
 				__func__, vm->vm_id, start, end);
 		mmio_node = NULL;
 	}
@@ -654,13 +662,15 @@ static inline struct mem_io_node *find_match_mmio_node(struct acrn_vm *vm,
 static inline struct mem_io_node *find_free_mmio_node(struct acrn_vm *vm)
 {
 	uint16_t idx;
-	struct mem_io_node *mmio_node = find_match_mmio_node(vm, 0UL, 0UL);
+	struct mem_io_node *mmio_node = (struct mem_io_node *)slab_alloc(&vm->emul_mmio_cache);
 
 	if (mmio_node != NULL) {
 		idx = (uint16_t)(uint64_t)(mmio_node - &(vm->emul_mmio[0U]));
 		if (vm->nr_emul_mmio_regions < idx) {
 			vm->nr_emul_mmio_regions = idx;
 		}
+	} else {
+		pr_err("%s, vm[%d] no free mmio node", __func__, vm->vm_id);
 	}
 
 	return mmio_node;
@@ -722,10 +732,21 @@ void unregister_mmio_emulation_handler(struct acrn_vm *vm,
 	mmio_node = find_match_mmio_node(vm, start, end);
 	if (mmio_node != NULL) {
 		(void)memset(mmio_node, 0U, sizeof(struct mem_io_node));
+		slab_free(&vm->emul_mmio_cache, mmio_node);
 	}
 	spinlock_release(&vm->emul_mmio_lock);
 }
 
+void init_emul_io(struct acrn_vm *vm)
+{
+	char name[SLAB_NAME_LEN];
+
+	vm->nr_emul_mmio_regions = 0U;
+	(void)snprintf(name, SLAB_NAME_LEN, "vm%hu_mmio", vm->vm_id);
+	slab_init(&vm->emul_mmio_cache, name, vm->emul_mmio, sizeof(struct mem_io_node),
+		CONFIG_MAX_EMULATED_MMIO_REGIONS, vm->emul_mmio_links);
+}
+
 void deinit_emul_io(struct acrn_vm *vm)
 {
 	(void)memset(vm->emul_mmio, 0U, sizeof(vm->emul_mmio));
@@ -284,6 +284,45 @@ static inline bool vioapic_need_intr(const struct acrn_single_vioapic *vioapic,
 	return ret;
 }
 
+/*
+ * A guest EOI clears the remote IRR of the level triggered pins with the
+ * EOIed vector, and acks their pass-through INTx. The vector of such a pin
+ * needs an EOI exit if the pin can deliver an interrupt or still waits for
+ * the EOI of one. Edge triggered and idle masked pins don't.
+ *
+ * @pre vioapic->lock is held
+ */
+static void vioapic_update_eoi_vectors(struct acrn_single_vioapic *vioapic)
+{
+	uint64_t vectors[VECTOR_BITMAP_SIZE] = { 0UL };
+	uint64_t changed;
+	union ioapic_rte rte;
+	struct acrn_vcpu *vcpu;
+	uint32_t pin, i, vector;
+	uint16_t vcpu_id;
+
+	for (pin = 0U; pin < vioapic->chipinfo.nr_pins; pin++) {
+		rte = vioapic->rtbl[pin];
+		if ((rte.bits.trigger_mode == IOAPIC_RTE_TRGRMODE_LEVEL) &&
+				((rte.bits.intr_mask == IOAPIC_RTE_MASK_CLR) || (rte.bits.remote_irr != 0UL))) {
+			vector = rte.bits.vector;
+			bitmap_set_nolock((uint16_t)(vector & 0x3fU), &vectors[(vector & 0xffU) >> 6U]);
+		}
+	}
+
+	for (i = 0U; i < VECTOR_BITMAP_SIZE; i++) {
+		changed = vioapic->eoi_vectors[i] ^ vectors[i];
+		vioapic->eoi_vectors[i] = vectors[i];
+		while (changed != 0UL) {
+			vector = (i << 6U) + (uint32_t)ffs64(changed);
+			bitmap_clear_nolock((uint16_t)(vector & 0x3fU), &changed);
+			foreach_vcpu(vcpu_id, vioapic->vm, vcpu) {
+				vlapic_update_eoi_exit(vcpu_vlapic(vcpu), vector);
+			}
+		}
+	}
+}
+
 /*
  * Due to the race between vcpus and vioapic->lock could be accessed from softirq, ensure to do
  * spinlock_irqsave_obtain(&(vioapic->lock), &rflags) & spinlock_irqrestore_release(&(vioapic->lock), rflags)
@@ -367,6 +406,10 @@ static void vioapic_indirect_write(struct acrn_single_vioapic *vioapic, uint32_t
 			dev_dbg(DBG_LEVEL_VIOAPIC, "ioapic pin%hhu: redir table entry %#lx",
 				pin, vioapic->rtbl[pin].full);
 
+			if (changed.full != 0UL) {
+				vioapic_update_eoi_vectors(vioapic);
+			}
+
 			/* remap for ptdev */
 			if ((new.bits.intr_mask == IOAPIC_RTE_MASK_CLR) || (last.bits.intr_mask  == IOAPIC_RTE_MASK_CLR)) {
 				/* VM enable intr */
@@ -441,6 +484,7 @@ vioapic_process_eoi(struct acrn_single_vioapic *vioapic, uint32_t vector)
 	uint32_t pin, pincount = vioapic->chipinfo.nr_pins;
 	union ioapic_rte rte;
 	uint64_t rflags;
+	bool masked_eoi = false;
 
 	if ((vector < VECTOR_DYNAMIC_START) || (vector > NR_MAX_VECTOR)) {
 		pr_err("vioapic_process_eoi: invalid vector %u", vector);
@@ -472,15 +516,39 @@ vioapic_process_eoi(struct acrn_single_vioapic *vioapic, uint32_t vector)
 		}
 
 		vioapic->rtbl[pin].bits.remote_irr = 0U;
+		if (rte.bits.intr_mask == IOAPIC_RTE_MASK_SET) {
+			/* the pin doesn't wait for an EOI anymore */
+			masked_eoi = true;
+		}
 		if (vioapic_need_intr(vioapic, (uint16_t)pin)) {
 			dev_dbg(DBG_LEVEL_VIOAPIC,
 				"ioapic pin%hhu: asserted at eoi", pin);
 			vioapic_generate_intr(vioapic, pin);
 		}
 	}
+	if (masked_eoi) {
+		vioapic_update_eoi_vectors(vioapic);
+	}
 	spinlock_irqrestore_release(&(vioapic->lock), rflags);
 }
 
+bool vioapic_need_eoi_exit(const struct acrn_vm *vm, uint32_t vector)
+{
+	const struct acrn_single_vioapic *vioapic;
+	uint8_t vioapic_index;
+	bool ret = false;
+
+	for (vioapic_index = 0U; vioapic_index < vm->arch_vm.vioapics.ioapic_num; vioapic_index++) {
+		vioapic = &(vm_ioapics(vm)->vioapic_array[vioapic_index]);
+		if (bitmap_test((uint16_t)(vector & 0x3fU), &vioapic->eoi_vectors[(vector & 0xffU) >> 6U])) {
+			ret = true;
+			break;
+		}
+	}
+
+	return ret;
+}
+
 void vioapic_broadcast_eoi(const struct acrn_vm *vm, uint32_t vector)
 {
 	struct acrn_single_vioapic *vioapic;
@@ -508,6 +576,8 @@ static void reset_one_vioapic(struct acrn_single_vioapic *vioapic)
 	}
 	vioapic->chipinfo.id = 0U;
 	vioapic->ioregsel = 0U;
+	/* the vLAPICs are reset along, with no EOI exiting vector */
+	(void)memset((void *)vioapic->eoi_vectors, 0U, sizeof(vioapic->eoi_vectors));
 }
 
 void reset_vioapics(const struct acrn_vm *vm)
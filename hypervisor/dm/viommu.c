@@ -0,0 +1,987 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Virtual VT-d for the post-launched VMs with GUEST_FLAG_VIOMMU, so that user
+ * space drivers (vfio, DPDK) can use their pass-through devices.
+ *
+ * The register page at VIOMMU_BASE is emulated, the device model reports it
+ * with a DMAR table. Only second-level translation with 4-level tables and 4K
+ * pages is exposed, along with queued invalidation. Interrupt remapping and
+ * fault recording are not.
+ *
+ * Caching mode is reported, so the guest invalidates the IOTLB when it makes
+ * entries present as well. Each guest domain with a pass-through device in it
+ * gets a shadow domain, whose page table maps the IOVAs to the HPAs behind the
+ * guest's GPAs. It is updated on the guest's IOTLB invalidations. These are
+ * batched up to a wait descriptor or the end of the queued descriptors: each
+ * shadow domain syncs the union of its invalidated ranges once, then its host
+ * IOTLB entries are flushed once. A change to the VM's EPT resyncs all of its
+ * shadow domains.
+ */
+
+#include <types.h>
+#include <errno.h>
+#include <logmsg.h>
+#include <asm/io.h>
+#include <asm/mmu.h>
+#include <asm/page.h>
+#include <asm/pgtable.h>
+#include <asm/vtd.h>
+#include <asm/e820.h>
+#include <asm/guest/vm.h>
+#include <asm/guest/ept.h>
+#include <asm/guest/guest_memory.h>
+#include <asm/guest/vlapic.h>
+#include <vpci.h>
+#include <viommu.h>
+
+#define VIOMMU_IVA_REG		0x100U
+#define VIOMMU_IOTLB_REG	0x108U
+#define VIOMMU_FRCD_REG		0x200U
+#define VIOMMU_IECTL_REG	0xa0U
+#define VIOMMU_IEDATA_REG	0xa4U
+#define VIOMMU_IEADDR_REG	0xa8U
+#define VIOMMU_IEUADDR_REG	0xacU
+
+/* VT-d 1.0 */
+#define VIOMMU_VER		0x10UL
+/* 256 domains, caching mode, 4-level tables, 48-bit GPA, page selective invalidation up to 2M */
+#define VIOMMU_MAMV		9UL
+#define VIOMMU_CAP		(0x2UL | (1UL << 7U) | (0x4UL << 8U) | (47UL << 16U) \
+				| ((uint64_t)(VIOMMU_FRCD_REG >> 4U) << 24U) | (1UL << 39U) | (VIOMMU_MAMV << 48U))
+/* coherent page walks, queued invalidation, pass-through contexts */
+#define VIOMMU_ECAP		(0x1UL | (1UL << 1U) | (1UL << 6U) | ((uint64_t)(VIOMMU_IVA_REG >> 4U) << 8U))
+
+#define VIOMMU_CCMD_ICC		(1UL << 63U)
+#define VIOMMU_IOTLB_IVT	(1UL << 63U)
+#define VIOMMU_FSTS_IQE		(1U << 4U)
+#define VIOMMU_FSTS_RW1C	0x71U
+#define VIOMMU_ICS_IWC		(1U << 0U)
+#define VIOMMU_INTR_IM		(1U << 31U)
+#define VIOMMU_INTR_IP		(1U << 30U)
+#define VIOMMU_IQA_QS_MASK	0x7UL
+#define VIOMMU_IQT_MASK		0x7fff0UL
+
+#define VIOMMU_PTE_RW		(EPT_RD | EPT_WR)
+#define VIOMMU_PTE_SP		(1UL << 7U)
+#define VIOMMU_PTE_ADDR_MASK	0x000ffffffffff000UL
+#define VIOMMU_LEVELS		4U
+#define VIOMMU_ADDR_WIDTH	48U
+#define VIOMMU_IOVA_LIMIT	(1UL << VIOMMU_ADDR_WIDTH)
+
+/* The shadow tables of a vIOMMU, 1024 pages map 2G of IOVA with 4K leaves */
+#define VIOMMU_SHADOW_PAGE_NUM	1024UL
+
+/* Each post-launched VM has its own shadow pages, a VM can't use up those of the others */
+static struct page_pool viommu_page_pool[CONFIG_MAX_VM_NUM];
+static uint64_t viommu_page_bitmap[CONFIG_MAX_VM_NUM][VIOMMU_SHADOW_PAGE_NUM / 64UL];
+static uint64_t viommu_free_pages[CONFIG_MAX_VM_NUM];
+static spinlock_t viommu_free_pages_lock;
+
+/*
+ * Only post-launched VMs get a vIOMMU, no shadow pages are reserved if
+ * none is configured.
+ */
+void reserve_buffer_for_viommu_pages(void)
+{
+	uint64_t page_base = 0UL, size = 0UL;
+	uint16_t vm_id;
+
+	spinlock_init(&viommu_free_pages_lock);
+	for (vm_id = 0U; vm_id < CONFIG_MAX_VM_NUM; vm_id++) {
+		if (get_vm_config(vm_id)->load_order == POST_LAUNCHED_VM) {
+			size += VIOMMU_SHADOW_PAGE_NUM * PAGE_SIZE;
+		}
+	}
+
+	if (size != 0UL) {
+		page_base = e820_alloc_memory(size, ~0UL);
+		set_paging_supervisor(page_base, size);
+	}
+
+	for (vm_id = 0U; vm_id < CONFIG_MAX_VM_NUM; vm_id++) {
+		spinlock_init(&viommu_page_pool[vm_id].lock);
+		if (get_vm_config(vm_id)->load_order == POST_LAUNCHED_VM) {
+			viommu_page_pool[vm_id].start_page = (struct page *)page_base;
+			viommu_page_pool[vm_id].bitmap_size = VIOMMU_SHADOW_PAGE_NUM / 64UL;
+			viommu_page_pool[vm_id].bitmap = viommu_page_bitmap[vm_id];
+			viommu_page_pool[vm_id].dummy_page = NULL;
+			viommu_page_pool[vm_id].last_hint_id = 0UL;
+			viommu_free_pages[vm_id] = VIOMMU_SHADOW_PAGE_NUM;
+			page_base += VIOMMU_SHADOW_PAGE_NUM * PAGE_SIZE;
+		}
+	}
+}
+
+/*
+ * Unlike the EPT pools, running out of shadow pages is up to the guest:
+ * the IOVAs are left unmapped.
+ */
+static uint64_t *alloc_shadow_page(uint16_t vm_id)
+{
+	uint64_t *page = NULL;
+
+	spinlock_obtain(&viommu_free_pages_lock);
+	if (viommu_free_pages[vm_id] > 0UL) {
+		viommu_free_pages[vm_id]--;
+		page = (uint64_t *)alloc_page(&viommu_page_pool[vm_id]);
+	}
+	spinlock_release(&viommu_free_pages_lock);
+
+	if (page == NULL) {
+		pr_err("vm%u: no vIOMMU shadow page left", vm_id);
+	}
+
+	return page;
+}
+
+static void free_shadow_page(uint16_t vm_id, uint64_t *page)
+{
+	free_page(&viommu_page_pool[vm_id], (struct page *)page);
+	spinlock_obtain(&viommu_free_pages_lock);
+	viommu_free_pages[vm_id]++;
+	spinlock_release(&viommu_free_pages_lock);
+}
+
+static inline uint32_t level_shift(uint32_t level)
+{
+	return PAGE_SHIFT + (9U * (level - 1U));
+}
+
+/*
+ * The non-leaf shadow entries are always readable and writable, the leaves
+ * are all 4K ones. A table is released once all the tables below it are.
+ *
+ * @pre 1 <= level <= VIOMMU_LEVELS
+ */
+static void free_shadow_table(uint16_t vm_id, uint64_t *table, uint32_t level)
+{
+	uint64_t *tables[VIOMMU_LEVELS + 1U];
+	uint64_t index[VIOMMU_LEVELS + 1U];
+	uint32_t cur = level;
+	uint64_t entry;
+
+	tables[level] = table;
+	index[level] = 0UL;
+
+	while (cur <= level) {
+		if ((cur == 1U) || (index[cur] == PTRS_PER_PTE)) {
+			/* done with this table, back to its parent */
+			free_shadow_page(vm_id, tables[cur]);
+			cur++;
+			if (cur <= level) {
+				index[cur]++;
+			}
+		} else {
+			entry = tables[cur][index[cur]];
+			if ((entry & VIOMMU_PTE_RW) != 0UL) {
+				tables[cur - 1U] = (uint64_t *)hpa2hva(entry & VIOMMU_PTE_ADDR_MASK);
+				cur--;
+				index[cur] = 0UL;
+			} else {
+				index[cur]++;
+			}
+		}
+	}
+}
+
+static const uint64_t *lookup_ept_entry(struct acrn_vm *vm, uint64_t gpa, uint64_t *pg_size)
+{
+	return pgtable_lookup_entry((uint64_t *)vm->arch_vm.nworld_eptp, gpa, pg_size, &vm->arch_vm.ept_pgtable);
+}
+
+/*
+ * Guest tables are only read from guest RAM, never from the MMIO of a device.
+ */
+static const uint64_t *get_guest_table(struct acrn_vm *vm, uint64_t gpa)
+{
+	const uint64_t *ept_entry;
+	const uint64_t *table = NULL;
+	uint64_t pg_size = 0UL;
+
+	ept_entry = lookup_ept_entry(vm, gpa, &pg_size);
+	if ((ept_entry != NULL) && ((*ept_entry & EPT_MT_MASK) == EPT_WB) && ((*ept_entry & EPT_RD) != 0UL)) {
+		table = (const uint64_t *)hpa2hva(((*ept_entry & EPT_ENTRY_PFN_MASK) & ~(pg_size - 1UL))
+			| (gpa & (pg_size - 1UL)));
+	}
+
+	return table;
+}
+
+/*
+ * The guest may map anything its EPT maps, with no more rights than the EPT
+ * gives. The leaves are rebuilt when the EPT changes, see viommu_ept_changed().
+ */
+static uint64_t shadow_leaf_entry(struct acrn_vm *vm, uint64_t guest_entry)
+{
+	const uint64_t *ept_entry;
+	uint64_t gpa = guest_entry & VIOMMU_PTE_ADDR_MASK;
+	uint64_t pg_size = 0UL, entry = 0UL;
+
+	ept_entry = lookup_ept_entry(vm, gpa, &pg_size);
+	if (ept_entry != NULL) {
+		entry = ((*ept_entry & EPT_ENTRY_PFN_MASK) & ~(pg_size - 1UL)) | (gpa & (pg_size - 1UL));
+		entry |= guest_entry & *ept_entry & VIOMMU_PTE_RW;
+	}
+
+	return ((entry & VIOMMU_PTE_RW) != 0UL) ? entry : 0UL;
+}
+
+/*
+ * Grow [*start, *end) to cover [start, end), an empty range if *start >= *end.
+ */
+static void extend_range(uint64_t *range_start, uint64_t *range_end, uint64_t start, uint64_t end)
+{
+	if (*range_start >= *range_end) {
+		*range_start = start;
+		*range_end = end;
+	} else {
+		*range_start = min(*range_start, start);
+		*range_end = max(*range_end, end);
+	}
+}
+
+/*
+ * Mirror the entries of the guest tables which map IOVAs in [start, end).
+ * Guest large pages are not supported and are left unmapped.
+ *
+ * Only the tables which have a shadow page are walked, so a sync visits at
+ * most VIOMMU_SHADOW_PAGE_NUM * PTRS_PER_PTE entries.
+ *
+ * The GPAs the guest leaves point to are added to the leaf range of the
+ * domain, a sync of the whole IOVA space recomputes it.
+ *
+ * @pre start < end <= VIOMMU_IOVA_LIMIT
+ * @pre vm->viommu.shadow_lock is held
+ */
+static void sync_shadow_table(struct acrn_vm *vm, struct viommu_domain *vdom, uint64_t start, uint64_t end)
+{
+	uint64_t *shadow[VIOMMU_LEVELS + 1U];
+	const uint64_t *guest[VIOMMU_LEVELS + 1U];
+	uint64_t base[VIOMMU_LEVELS + 1U];
+	uint64_t index[VIOMMU_LEVELS + 1U];
+	uint64_t last[VIOMMU_LEVELS + 1U];
+	uint32_t level = VIOMMU_LEVELS;
+	uint64_t i, guest_entry, entry;
+	uint64_t *child;
+
+	if ((start == 0UL) && (end == VIOMMU_IOVA_LIMIT)) {
+		vdom->leaf_start = 0UL;
+		vdom->leaf_end = 0UL;
+	}
+
+	shadow[level] = vdom->table;
+	guest[level] = get_guest_table(vm, vdom->guest_table);
+	base[level] = 0UL;
+	index[level] = start >> level_shift(level);
+	last[level] = (end - 1UL) >> level_shift(level);
+
+	while (level <= VIOMMU_LEVELS) {
+		if (index[level] > last[level]) {
+			/* done with this table, back to its parent */
+			level++;
+			if (level <= VIOMMU_LEVELS) {
+				index[level]++;
+			}
+			continue;
+		}
+
+		i = index[level];
+		guest_entry = (guest[level] != NULL) ? guest[level][i] : 0UL;
+		entry = 0UL;
+
+		if (((guest_entry & VIOMMU_PTE_RW) != 0UL) && ((level == 1U) || ((guest_entry & VIOMMU_PTE_SP) == 0UL))) {
+			if (level == 1U) {
+				extend_range(&vdom->leaf_start, &vdom->leaf_end, guest_entry & VIOMMU_PTE_ADDR_MASK,
+					(guest_entry & VIOMMU_PTE_ADDR_MASK) + PAGE_SIZE);
+				entry = shadow_leaf_entry(vm, guest_entry);
+			} else {
+				child = ((shadow[level][i] & VIOMMU_PTE_RW) != 0UL) ?
+					(uint64_t *)hpa2hva(shadow[level][i] & VIOMMU_PTE_ADDR_MASK) : alloc_shadow_page(vm->vm_id);
+				if (child != NULL) {
+					entry = hva2hpa(child) | VIOMMU_PTE_RW;
+					if (shadow[level][i] != entry) {
+						shadow[level][i] = entry;
+						iommu_flush_cache(&shadow[level][i], sizeof(uint64_t));
+					}
+
+					/* sync the child table, the entry is done when back here */
+					shadow[level - 1U] = child;
+					guest[level - 1U] = get_guest_table(vm, guest_entry & VIOMMU_PTE_ADDR_MASK);
+					base[level - 1U] = base[level] + (i << level_shift(level));
+					index[level - 1U] = (max(start, base[level - 1U]) - base[level - 1U]) >> level_shift(level - 1U);
+					last[level - 1U] = (min(end, base[level - 1U] + (1UL << level_shift(level))) - 1UL
+						- base[level - 1U]) >> level_shift(level - 1U);
+					level--;
+					continue;
+				}
+			}
+		} else if ((level > 1U) && ((shadow[level][i] & VIOMMU_PTE_RW) != 0UL)) {
+			free_shadow_table(vm->vm_id, (uint64_t *)hpa2hva(shadow[level][i] & VIOMMU_PTE_ADDR_MASK), level - 1U);
+		} else {
+			/* nothing mapped */
+		}
+
+		if (shadow[level][i] != entry) {
+			shadow[level][i] = entry;
+			iommu_flush_cache(&shadow[level][i], sizeof(uint64_t));
+		}
+		index[level]++;
+	}
+}
+
+static void mark_dirty(struct viommu_domain *vdom, uint64_t start, uint64_t end)
+{
+	extend_range(&vdom->dirty_start, &vdom->dirty_end, start, end);
+}
+
+/*
+ * End of a batch: sync the invalidated ranges, one host IOTLB flush per
+ * shadow domain.
+ */
+static void viommu_sync_domains(struct acrn_vm *vm, struct acrn_viommu *viommu)
+{
+	struct viommu_domain *vdom;
+	uint32_t i;
+
+	spinlock_obtain(&viommu->shadow_lock);
+	for (i = 0U; i < VIOMMU_MAX_DOMAINS; i++) {
+		vdom = &viommu->domains[i];
+		if ((vdom->domain != NULL) && (vdom->dirty_start < vdom->dirty_end)) {
+			sync_shadow_table(vm, vdom, vdom->dirty_start, vdom->dirty_end);
+			vdom->dirty_start = 0UL;
+			vdom->dirty_end = 0UL;
+			flush_iommu_domain(vdom->domain);
+		}
+	}
+	spinlock_release(&viommu->shadow_lock);
+}
+
+/*
+ * @param[in] iirg granularity, DMA_IOTLB_GLOBAL_INVL, DMA_IOTLB_DOMAIN_INVL or DMA_IOTLB_PAGE_INVL
+ */
+static void viommu_invalidate_iotlb(struct acrn_viommu *viommu, uint64_t iirg, uint16_t did,
+		uint64_t addr, uint64_t am)
+{
+	struct viommu_domain *vdom;
+	uint64_t start = 0UL, end = VIOMMU_IOVA_LIMIT;
+	uint32_t i;
+
+	if ((iirg == DMA_IOTLB_PAGE_INVL) && (am <= VIOMMU_MAMV)) {
+		start = addr & ~((PAGE_SIZE << am) - 1UL);
+		end = min(start + (PAGE_SIZE << am), VIOMMU_IOVA_LIMIT);
+	}
+
+	spinlock_obtain(&viommu->shadow_lock);
+	for (i = 0U; i < VIOMMU_MAX_DOMAINS; i++) {
+		vdom = &viommu->domains[i];
+		if ((vdom->domain != NULL) && (start < end) &&
+				((iirg == DMA_IOTLB_GLOBAL_INVL) || (vdom->guest_did == did))) {
+			mark_dirty(vdom, start, end);
+		}
+	}
+	spinlock_release(&viommu->shadow_lock);
+}
+
+/*
+ * @pre viommu->shadow_lock is held
+ */
+static void put_viommu_domain(uint16_t vm_id, struct viommu_domain *vdom)
+{
+	free_shadow_table(vm_id, vdom->table, VIOMMU_LEVELS);
+	destroy_iommu_domain(vdom->domain);
+	(void)memset(vdom, 0U, sizeof(*vdom));
+}
+
+/*
+ * A new or retargeted shadow domain is synced with the next batch: with
+ * caching mode, the guest invalidates the IOTLB after changing a context
+ * entry.
+ *
+ * @pre viommu->shadow_lock is held
+ *
+ * @return the shadow domain of the guest domain, NULL if the shadow pages or
+ *	   slots are used up
+ */
+static struct viommu_domain *get_viommu_domain(struct acrn_vm *vm, struct acrn_viommu *viommu,
+		uint16_t did, uint64_t guest_table)
+{
+	struct viommu_domain *vdom = NULL;
+	uint64_t *table;
+	uint16_t i, free_idx = VIOMMU_MAX_DOMAINS;
+
+	for (i = 0U; i < VIOMMU_MAX_DOMAINS; i++) {
+		if (viommu->domains[i].domain == NULL) {
+			free_idx = min(free_idx, i);
+		} else if (viommu->domains[i].guest_did == did) {
+			vdom = &viommu->domains[i];
+			break;
+		} else {
+			/* another guest domain */
+		}
+	}
+
+	if (vdom != NULL) {
+		if (vdom->guest_table != guest_table) {
+			vdom->guest_table = guest_table;
+			mark_dirty(vdom, 0UL, VIOMMU_IOVA_LIMIT);
+		}
+	} else if (free_idx < VIOMMU_MAX_DOMAINS) {
+		table = alloc_shadow_page(vm->vm_id);
+		if (table != NULL) {
+			vdom = &viommu->domains[free_idx];
+			vdom->domain = create_shadow_iommu_domain(vm->vm_id, free_idx, hva2hpa(table), VIOMMU_ADDR_WIDTH);
+			if (vdom->domain != NULL) {
+				vdom->table = table;
+				vdom->guest_table = guest_table;
+				vdom->guest_did = did;
+				vdom->nr_devs = 0U;
+				mark_dirty(vdom, 0UL, VIOMMU_IOVA_LIMIT);
+			} else {
+				free_shadow_page(vm->vm_id, table);
+				vdom = NULL;
+			}
+		}
+	} else {
+		pr_err("vm%u: more than %u vIOMMU domains", vm->vm_id, VIOMMU_MAX_DOMAINS);
+	}
+
+	return vdom;
+}
+
+/*
+ * The host domain a device goes to per its guest context entry: the VM's
+ * domain if translation is disabled or the context passes through, a shadow
+ * domain if it translates, none if the entry is not present or not supported.
+ */
+static const struct iommu_domain *viommu_device_domain(struct acrn_vm *vm, struct acrn_viommu *viommu,
+		union pci_bdf bdf)
+{
+	const struct iommu_domain *domain = NULL;
+	const struct viommu_domain *vdom;
+	struct dmar_entry root_entry, context_entry;
+	uint64_t context_table, tt;
+
+	if ((viommu->gsts & DMA_GSTS_TES) == 0U) {
+		domain = vm->iommu;
+	} else if ((copy_from_gpa(vm, &root_entry, viommu->root_table + (bdf.bits.b * sizeof(struct dmar_entry)),
+				sizeof(struct dmar_entry)) == 0) &&
+			((root_entry.lo_64 & ROOT_ENTRY_LOWER_PRESENT_MASK) != 0UL)) {
+		context_table = root_entry.lo_64 & ROOT_ENTRY_LOWER_CTP_MASK;
+		if ((copy_from_gpa(vm, &context_entry, context_table + (bdf.fields.devfun * sizeof(struct dmar_entry)),
+					sizeof(struct dmar_entry)) == 0) &&
+				((context_entry.lo_64 & CTX_ENTRY_LOWER_P_MASK) != 0UL)) {
+			tt = dmar_get_bitslice(context_entry.lo_64, CTX_ENTRY_LOWER_TT_MASK, CTX_ENTRY_LOWER_TT_POS);
+			if (tt == DMAR_CTX_TT_PASSTHROUGH) {
+				domain = vm->iommu;
+			} else if ((tt == DMAR_CTX_TT_UNTRANSLATED) && (dmar_get_bitslice(context_entry.hi_64,
+					CTX_ENTRY_UPPER_AW_MASK, CTX_ENTRY_UPPER_AW_POS) == 2UL)) {
+				vdom = get_viommu_domain(vm, viommu, (uint16_t)dmar_get_bitslice(context_entry.hi_64,
+					CTX_ENTRY_UPPER_DID_MASK, CTX_ENTRY_UPPER_DID_POS),
+					context_entry.lo_64 & CTX_ENTRY_LOWER_SLPTPTR_MASK);
+				domain = (vdom != NULL) ? vdom->domain : NULL;
+			} else {
+				pr_err("vm%u: unsupported vIOMMU context for %x:%x.%x", vm->vm_id,
+					bdf.bits.b, bdf.bits.d, bdf.bits.f);
+			}
+		}
+	} else {
+		/* DMA is blocked */
+	}
+
+	return domain;
+}
+
+/*
+ * Move the pass-through devices to the host domains their guest context
+ * entries ask for, and release the shadow domains no device uses any more.
+ * The new shadow domains are not synced here, nothing is walked with
+ * vpci->lock held.
+ */
+static void viommu_update_devices(struct acrn_vm *vm, struct acrn_viommu *viommu)
+{
+	struct acrn_vpci *vpci = &vm->vpci;
+	struct pci_vdev *vdev;
+	const struct iommu_domain *domain;
+	uint32_t i, j;
+
+	spinlock_obtain(&vpci->lock);
+	spinlock_obtain(&viommu->shadow_lock);
+	for (i = 0U; i < vpci->pci_vdev_cnt; i++) {
+		vdev = &vpci->pci_vdevs[i];
+		if (is_pt_vdev(vdev)) {
+			domain = viommu_device_domain(vm, viommu, vdev->bdf);
+			if (domain != vdev->iommu) {
+				if (move_pt_device(vdev->iommu, domain, (uint8_t)vdev->pdev->bdf.bits.b,
+						(uint8_t)(vdev->pdev->bdf.value & 0xFFU)) == 0) {
+					vdev->iommu = domain;
+				} else {
+					pr_err("vm%u: failed to move %x:%x.%x", vm->vm_id, vdev->bdf.bits.b,
+						vdev->bdf.bits.d, vdev->bdf.bits.f);
+				}
+			}
+		}
+	}
+
+	for (j = 0U; j < VIOMMU_MAX_DOMAINS; j++) {
+		viommu->domains[j].nr_devs = 0U;
+	}
+	for (i = 0U; i < vpci->pci_vdev_cnt; i++) {
+		vdev = &vpci->pci_vdevs[i];
+		for (j = 0U; j < VIOMMU_MAX_DOMAINS; j++) {
+			if (is_pt_vdev(vdev) && (vdev->iommu != NULL) && (vdev->iommu == viommu->domains[j].domain)) {
+				viommu->domains[j].nr_devs++;
+			}
+		}
+	}
+	spinlock_release(&viommu->shadow_lock);
+	spinlock_release(&vpci->lock);
+
+	spinlock_obtain(&viommu->shadow_lock);
+	for (j = 0U; j < VIOMMU_MAX_DOMAINS; j++) {
+		if ((viommu->domains[j].domain != NULL) && (viommu->domains[j].nr_devs == 0U)) {
+			put_viommu_domain(vm->vm_id, &viommu->domains[j]);
+		}
+	}
+	spinlock_release(&viommu->shadow_lock);
+}
+
+static void viommu_inject_intr(struct acrn_vm *vm, struct acrn_viommu *viommu)
+{
+	if ((viommu->iectl & VIOMMU_INTR_IM) != 0U) {
+		viommu->iectl |= VIOMMU_INTR_IP;
+	} else {
+		viommu->iectl &= ~VIOMMU_INTR_IP;
+		(void)vlapic_inject_msi(vm, ((uint64_t)viommu->ieuaddr << 32U) | viommu->ieaddr, viommu->iedata);
+	}
+}
+
+static void viommu_complete_wait(struct acrn_vm *vm, struct acrn_viommu *viommu, const struct dmar_entry *desc)
+{
+	uint32_t data = (uint32_t)(desc->lo_64 >> 32U);
+
+	if ((desc->lo_64 & DMAR_INV_STATUS_WRITE) != 0UL) {
+		(void)copy_to_gpa(vm, &data, desc->hi_64 & ~0x3UL, sizeof(data));
+	}
+
+	if (((desc->lo_64 & DMAR_INV_INTR_FLAG) != 0UL) && ((viommu->ics & VIOMMU_ICS_IWC) == 0U)) {
+		viommu->ics |= VIOMMU_ICS_IWC;
+		viommu_inject_intr(vm, viommu);
+	}
+}
+
+/*
+ * Process the descriptors from the head to the tail. The IOTLB invalidations
+ * before a wait descriptor, or before the tail, are synced as one batch.
+ */
+static void viommu_process_queue(struct acrn_vm *vm, struct acrn_viommu *viommu)
+{
+	struct dmar_entry desc;
+	uint64_t base = viommu->iqa & VIOMMU_PTE_ADDR_MASK;
+	uint64_t size = PAGE_SIZE << (viommu->iqa & VIOMMU_IQA_QS_MASK);
+
+	if (viommu->iqt >= size) {
+		viommu->fsts |= VIOMMU_FSTS_IQE;
+	}
+
+	while (((viommu->gsts & DMA_GSTS_QIES) != 0U) && ((viommu->fsts & VIOMMU_FSTS_IQE) == 0U)
+			&& (viommu->iqh != viommu->iqt)) {
+		if (copy_from_gpa(vm, &desc, base + viommu->iqh, sizeof(desc)) != 0) {
+			desc.lo_64 = 0UL;
+		}
+
+		switch (desc.lo_64 & 0xfUL) {
+		case DMAR_INV_CONTEXT_CACHE_DESC:
+			viommu_update_devices(vm, viommu);
+			break;
+		case DMAR_INV_IOTLB_DESC:
+			viommu_invalidate_iotlb(viommu, desc.lo_64 & DMA_IOTLB_PAGE_INVL, (uint16_t)(desc.lo_64 >> 16U),
+				desc.hi_64 & VIOMMU_PTE_ADDR_MASK, desc.hi_64 & 0x3fUL);
+			break;
+		case DMAR_INV_IEC_DESC:
+			/* no interrupt remapping, nothing cached */
+			break;
+		case DMAR_INV_WAIT_DESC:
+			viommu_sync_domains(vm, viommu);
+			viommu_complete_wait(vm, viommu, &desc);
+			break;
+		default:
+			viommu->fsts |= VIOMMU_FSTS_IQE;
+			break;
+		}
+
+		if ((viommu->fsts & VIOMMU_FSTS_IQE) == 0U) {
+			viommu->iqh = (viommu->iqh + sizeof(struct dmar_entry)) % size;
+		}
+	}
+
+	viommu_sync_domains(vm, viommu);
+}
+
+static void viommu_write_gcmd(struct acrn_vm *vm, struct acrn_viommu *viommu, uint32_t value)
+{
+	if ((value & DMA_GCMD_SRTP) != 0U) {
+		viommu->root_table = viommu->rtaddr & VIOMMU_PTE_ADDR_MASK;
+		viommu->gsts |= DMA_GSTS_RTPS;
+	}
+
+	if (((value & DMA_GCMD_QIE) != 0U) != ((viommu->gsts & DMA_GSTS_QIES) != 0U)) {
+		viommu->gsts ^= DMA_GSTS_QIES;
+		viommu->iqh = 0UL;
+	}
+
+	if (((value & DMA_GCMD_TE) != 0U) != ((viommu->gsts & DMA_GSTS_TES) != 0U)) {
+		viommu->gsts ^= DMA_GSTS_TES;
+		viommu_update_devices(vm, viommu);
+		/* no invalidation follows, the new shadow domains are populated before any DMA */
+		viommu_sync_domains(vm, viommu);
+	}
+}
+
+static bool is_64bit_reg(uint32_t offset)
+{
+	bool ret;
+
+	switch (offset) {
+	case DMAR_CAP_REG:
+	case DMAR_ECAP_REG:
+	case DMAR_RTADDR_REG:
+	case DMAR_CCMD_REG:
+	case DMAR_IQH_REG:
+	case DMAR_IQT_REG:
+	case DMAR_IQA_REG:
+	case VIOMMU_IVA_REG:
+	case VIOMMU_IOTLB_REG:
+	case VIOMMU_FRCD_REG:
+	case VIOMMU_FRCD_REG + 8U:
+		ret = true;
+		break;
+	default:
+		ret = false;
+		break;
+	}
+
+	return ret;
+}
+
+static uint64_t viommu_read_reg(const struct acrn_viommu *viommu, uint32_t offset)
+{
+	uint64_t value;
+
+	switch (offset) {
+	case DMAR_VER_REG:
+		value = VIOMMU_VER;
+		break;
+	case DMAR_CAP_REG:
+		value = VIOMMU_CAP;
+		break;
+	case DMAR_ECAP_REG:
+		value = VIOMMU_ECAP;
+		break;
+	case DMAR_GSTS_REG:
+		value = viommu->gsts;
+		break;
+	case DMAR_RTADDR_REG:
+		value = viommu->rtaddr;
+		break;
+	case DMAR_CCMD_REG:
+		value = viommu->ccmd;
+		break;
+	case DMAR_FSTS_REG:
+		value = viommu->fsts;
+		break;
+	case DMAR_FECTL_REG:
+		value = viommu->fectl;
+		break;
+	case DMAR_FEDATA_REG:
+		value = viommu->fedata;
+		break;
+	case DMAR_FEADDR_REG:
+		value = viommu->feaddr;
+		break;
+	case DMAR_FEUADDR_REG:
+		value = viommu->feuaddr;
+		break;
+	case DMAR_IQH_REG:
+		value = viommu->iqh;
+		break;
+	case DMAR_IQT_REG:
+		value = viommu->iqt;
+		break;
+	case DMAR_IQA_REG:
+		value = viommu->iqa;
+		break;
+	case DMAR_ICS_REG:
+		value = viommu->ics;
+		break;
+	case VIOMMU_IECTL_REG:
+		value = viommu->iectl;
+		break;
+	case VIOMMU_IEDATA_REG:
+		value = viommu->iedata;
+		break;
+	case VIOMMU_IEADDR_REG:
+		value = viommu->ieaddr;
+		break;
+	case VIOMMU_IEUADDR_REG:
+		value = viommu->ieuaddr;
+		break;
+	case VIOMMU_IVA_REG:
+		value = viommu->iva;
+		break;
+	case VIOMMU_IOTLB_REG:
+		value = viommu->iotlb;
+		break;
+	default:
+		/* GCMD and the fault recording registers read 0 */
+		value = 0UL;
+		break;
+	}
+
+	return value;
+}
+
+static void viommu_write_reg(struct acrn_vm *vm, struct acrn_viommu *viommu, uint32_t offset, uint64_t value)
+{
+	switch (offset) {
+	case DMAR_GCMD_REG:
+		viommu_write_gcmd(vm, viommu, (uint32_t)value);
+		break;
+	case DMAR_RTADDR_REG:
+		viommu->rtaddr = value & VIOMMU_PTE_ADDR_MASK;
+		break;
+	case DMAR_CCMD_REG:
+		if ((value & VIOMMU_CCMD_ICC) != 0UL) {
+			viommu_update_devices(vm, viommu);
+			/* the actual granularity (CAIG) is the requested one (CIRG) */
+			value = (value & ~(VIOMMU_CCMD_ICC | (3UL << 59U))) | (((value >> 61U) & 3UL) << 59U);
+		}
+		viommu->ccmd = value;
+		break;
+	case DMAR_FSTS_REG:
+		viommu->fsts &= ~((uint32_t)value & VIOMMU_FSTS_RW1C);
+		if ((viommu->fsts & VIOMMU_FSTS_IQE) == 0U) {
+			viommu_process_queue(vm, viommu);
+		}
+		break;
+	case DMAR_FECTL_REG:
+		viommu->fectl = (uint32_t)value & VIOMMU_INTR_IM;
+		break;
+	case DMAR_FEDATA_REG:
+		viommu->fedata = (uint32_t)value;
+		break;
+	case DMAR_FEADDR_REG:
+		viommu->feaddr = (uint32_t)value;
+		break;
+	case DMAR_FEUADDR_REG:
+		viommu->feuaddr = (uint32_t)value;
+		break;
+	case DMAR_IQT_REG:
+		viommu->iqt = value & VIOMMU_IQT_MASK;
+		viommu_process_queue(vm, viommu);
+		break;
+	case DMAR_IQA_REG:
+		viommu->iqa = value & (VIOMMU_PTE_ADDR_MASK | VIOMMU_IQA_QS_MASK);
+		break;
+	case DMAR_ICS_REG:
+		viommu->ics &= ~((uint32_t)value & VIOMMU_ICS_IWC);
+		if ((viommu->ics & VIOMMU_ICS_IWC) == 0U) {
+			viommu->iectl &= ~VIOMMU_INTR_IP;
+		}
+		break;
+	case VIOMMU_IECTL_REG:
+		viommu->iectl = ((uint32_t)value & VIOMMU_INTR_IM) | (viommu->iectl & VIOMMU_INTR_IP);
+		if ((viommu->iectl & (VIOMMU_INTR_IM | VIOMMU_INTR_IP)) == VIOMMU_INTR_IP) {
+			viommu_inject_intr(vm, viommu);
+		}
+		break;
+	case VIOMMU_IEDATA_REG:
+		viommu->iedata = (uint32_t)value;
+		break;
+	case VIOMMU_IEADDR_REG:
+		viommu->ieaddr = (uint32_t)value;
+		break;
+	case VIOMMU_IEUADDR_REG:
+		viommu->ieuaddr = (uint32_t)value;
+		break;
+	case VIOMMU_IVA_REG:
+		viommu->iva = value;
+		break;
+	case VIOMMU_IOTLB_REG:
+		if ((value & VIOMMU_IOTLB_IVT) != 0UL) {
+			viommu_invalidate_iotlb(viommu, ((value >> 60U) & 3UL) << 4U, (uint16_t)(value >> 32U),
+				viommu->iva & VIOMMU_PTE_ADDR_MASK, viommu->iva & 0x3fUL);
+			viommu_sync_domains(vm, viommu);
+			/* the actual granularity (IAIG) is the requested one (IIRG) */
+			value = (value & ~(VIOMMU_IOTLB_IVT | (3UL << 57U))) | (((value >> 60U) & 3UL) << 57U);
+		}
+		viommu->iotlb = value;
+		break;
+	default:
+		/* read only or reserved */
+		break;
+	}
+}
+
+/*
+ * 64-bit registers may be accessed as two 32-bit halves, a write to a half
+ * takes effect as a write of the whole register.
+ */
+static int32_t viommu_mmio_access_handler(struct io_request *io_req, void *handler_private_data)
+{
+	struct acrn_mmio_request *mmio = &io_req->reqs.mmio_request;
+	struct acrn_vm *vm = (struct acrn_vm *)handler_private_data;
+	struct acrn_viommu *viommu = &vm->viommu;
+	uint32_t offset = (uint32_t)(mmio->address - VIOMMU_BASE);
+	uint32_t reg = offset;
+	uint64_t value, mask = ~0UL;
+	uint32_t shift = 0U;
+	int32_t ret = 0;
+
+	if ((mmio->size == 4UL) && ((offset & 0x3U) == 0U)) {
+		if (is_64bit_reg(offset & ~0x7U)) {
+			reg = offset & ~0x7U;
+			shift = (offset & 0x4U) * 8U;
+		}
+		mask = 0xffffffffUL << shift;
+	} else if ((mmio->size != 8UL) || ((offset & 0x7U) != 0U) || !is_64bit_reg(offset)) {
+		ret = -EINVAL;
+	} else {
+		/* 64-bit access to a 64-bit register */
+	}
+
+	if (ret == 0) {
+		spinlock_obtain(&viommu->lock);
+		value = viommu_read_reg(viommu, reg);
+		if (mmio->direction == ACRN_IOREQ_DIR_READ) {
+			mmio->value = (value & mask) >> shift;
+		} else {
+			viommu_write_reg(vm, viommu, reg, (value & ~mask) | ((mmio->value << shift) & mask));
+		}
+		spinlock_release(&viommu->lock);
+	}
+
+	return ret;
+}
+
+static void reset_viommu_regs(struct acrn_viommu *viommu)
+{
+	viommu->gsts = 0U;
+	viommu->rtaddr = 0UL;
+	viommu->root_table = 0UL;
+	viommu->ccmd = 0UL;
+	viommu->fsts = 0U;
+	viommu->fectl = VIOMMU_INTR_IM;
+	viommu->fedata = 0U;
+	viommu->feaddr = 0U;
+	viommu->feuaddr = 0U;
+	viommu->iqh = 0UL;
+	viommu->iqt = 0UL;
+	viommu->iqa = 0UL;
+	viommu->ics = 0U;
+	viommu->iectl = VIOMMU_INTR_IM;
+	viommu->iedata = 0U;
+	viommu->ieaddr = 0U;
+	viommu->ieuaddr = 0U;
+	viommu->iva = 0UL;
+	viommu->iotlb = 0UL;
+}
+
+/**
+ * @pre vm != NULL
+ * @pre vm->iommu != NULL
+ */
+void viommu_init(struct acrn_vm *vm)
+{
+	struct acrn_viommu *viommu = &vm->viommu;
+
+	spinlock_init(&viommu->lock);
+	spinlock_init(&viommu->shadow_lock);
+	reset_viommu_regs(viommu);
+	(void)memset(viommu->domains, 0U, sizeof(viommu->domains));
+	viommu->enabled = true;
+
+	register_mmio_emulation_handler(vm, viommu_mmio_access_handler, VIOMMU_BASE, VIOMMU_BASE + VIOMMU_SIZE,
+		(void *)vm, false);
+	ept_del_mr(vm, (uint64_t *)vm->arch_vm.nworld_eptp, VIOMMU_BASE, VIOMMU_SIZE);
+}
+
+/**
+ * Translation is disabled, the pass-through devices go back to the VM's
+ * domain and the shadow domains are released.
+ *
+ * @pre vm != NULL
+ */
+void reset_viommu(struct acrn_vm *vm)
+{
+	struct acrn_viommu *viommu = &vm->viommu;
+
+	if (viommu->enabled) {
+		spinlock_obtain(&viommu->lock);
+		reset_viommu_regs(viommu);
+		viommu_update_devices(vm, viommu);
+		spinlock_release(&viommu->lock);
+	}
+}
+
+/**
+ * @pre vm != NULL
+ * @pre the pass-through devices of the VM are deinitialized
+ */
+void deinit_viommu(struct acrn_vm *vm)
+{
+	struct acrn_viommu *viommu = &vm->viommu;
+	uint32_t i;
+
+	if (viommu->enabled) {
+		spinlock_obtain(&viommu->lock);
+		spinlock_obtain(&viommu->shadow_lock);
+		for (i = 0U; i < VIOMMU_MAX_DOMAINS; i++) {
+			if (viommu->domains[i].domain != NULL) {
+				put_viommu_domain(vm->vm_id, &viommu->domains[i]);
+			}
+		}
+		viommu->enabled = false;
+		spinlock_release(&viommu->shadow_lock);
+		spinlock_release(&viommu->lock);
+	}
+}
+
+/**
+ * The shadow entries are built from the EPT, they are rebuilt once EPT
+ * entries of the VM are added, changed or removed, before the old HPAs can be
+ * reused. Only the domains with guest leaves in [gpa, gpa + size) are synced:
+ * a leaf the guest changed without invalidating it yet may still be shadowed
+ * from its old GPA, so the whole domain is synced rather than the leaves
+ * which point to the range now. This may come with vpci->lock held,
+ * viommu->lock is not taken.
+ *
+ * @pre vm != NULL
+ */
+void viommu_ept_changed(struct acrn_vm *vm, uint64_t gpa, uint64_t size)
+{
+	struct acrn_viommu *viommu = &vm->viommu;
+	struct viommu_domain *vdom;
+	bool changed = false;
+	uint32_t i;
+
+	if (viommu->enabled) {
+		spinlock_obtain(&viommu->shadow_lock);
+		for (i = 0U; i < VIOMMU_MAX_DOMAINS; i++) {
+			vdom = &viommu->domains[i];
+			if ((vdom->domain != NULL) && (vdom->leaf_start < (gpa + size)) && (gpa < vdom->leaf_end)) {
+				mark_dirty(vdom, 0UL, VIOMMU_IOVA_LIMIT);
+				changed = true;
+			}
+		}
+		spinlock_release(&viommu->shadow_lock);
+
+		if (changed) {
+			viommu_sync_domains(vm, viommu);
+		}
+	}
+}
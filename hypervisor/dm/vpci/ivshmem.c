@@ -64,6 +64,13 @@ struct ivshmem_device {
 		} regs;
 	} mmio;
 	struct ivshmem_shm_region *region;
+	/*
+	 * One bit per MSI-X vector: a doorbell arrived while the vector was
+	 * masked. It is delivered when the guest unmasks the vector, and is
+	 * reported through the vMSI-X PBA meanwhile.
+	 */
+	uint64_t pending_vectors;
+	spinlock_t lock;
 };
 
 /* IVSHMEM_SHM_SIZE is provided by offline tool */
@@ -131,12 +138,22 @@ static void ivshmem_server_unbind_peer(struct pci_vdev *vdev)
 	region->doorbell_peers[vpci2vm(vdev->vpci)->vm_id] = NULL;
 }
 
+/*
+ * @pre dest_ivs_dev != NULL
+ * @pre vector_index < dest_ivs_dev->pcidev->msix.table_count
+ */
+static void ivshmem_inject_vector(const struct ivshmem_device *dest_ivs_dev, uint16_t vector_index)
+{
+	struct msix_table_entry *entry = &(dest_ivs_dev->pcidev->msix.table_entries[vector_index]);
+
+	vlapic_inject_msi(vpci2vm(dest_ivs_dev->pcidev->vpci), entry->addr, entry->data);
+}
+
 /*
  * @pre src_ivs_dev != NULL
  */
 static void ivshmem_server_notify_peer(struct ivshmem_device *src_ivs_dev, uint16_t dest_peer_id, uint16_t vector_index)
 {
-	struct acrn_vm *dest_vm;
 	struct ivshmem_device *dest_ivs_dev;
 	struct msix_table_entry *entry;
 	struct ivshmem_shm_region *region = src_ivs_dev->region;
@@ -148,14 +165,17 @@ static void ivshmem_server_notify_peer(struct ivshmem_device *src_ivs_dev, uint1
 			&& (vector_index < dest_ivs_dev->pcidev->msix.table_count)) {
 
 			entry = &(dest_ivs_dev->pcidev->msix.table_entries[vector_index]);
+			spinlock_obtain(&dest_ivs_dev->lock);
 			if ((entry->vector_control & PCIM_MSIX_VCTRL_MASK) == 0U) {
-
-				dest_vm = vpci2vm(dest_ivs_dev->pcidev->vpci);
-				vlapic_inject_msi(dest_vm, entry->addr, entry->data);
+				ivshmem_inject_vector(dest_ivs_dev, vector_index);
 			} else {
-				pr_err("%s,target msix entry [%d] is masked.\n",
-					__func__, vector_index);
+				/*
+				 * A receiver masks its vector while it is busy draining
+				 * its rings, latch the doorbell and deliver it on unmask.
+				 */
+				bitmap_set_nolock(vector_index, &dest_ivs_dev->pending_vectors);
 			}
+			spinlock_release(&dest_ivs_dev->lock);
 		} else {
 			pr_err("%s,Invalid peer, ID = %d, vector index [%d] or MSI-X is disabled.\n",
 				__func__, dest_peer_id, vector_index);
@@ -174,6 +194,8 @@ static void create_ivshmem_device(struct pci_vdev *vdev)
 	for (i = 0U; i < IVSHMEM_DEV_NUM; i++) {
 		if (ivshmem_dev[i].pcidev == NULL) {
 			ivshmem_dev[i].pcidev = vdev;
+			ivshmem_dev[i].pending_vectors = 0UL;
+			spinlock_init(&ivshmem_dev[i].lock);
 			vdev->priv_data = &ivshmem_dev[i];
 			break;
 		}
@@ -221,6 +243,41 @@ static int32_t ivshmem_mmio_handler(struct io_request *io_req, void *data)
 	return 0;
 }
 
+/*
+ * @pre io_req != NULL
+ * @pre priv_data != NULL
+ * @pre vdev->priv_data != NULL
+ */
+static int32_t ivshmem_vmsix_handle_table_mmio_access(struct io_request *io_req, void *priv_data)
+{
+	struct acrn_mmio_request *mmio = &io_req->reqs.mmio_request;
+	struct pci_vdev *vdev = (struct pci_vdev *)priv_data;
+	struct ivshmem_device *ivs_dev = (struct ivshmem_device *)vdev->priv_data;
+	uint64_t offset = mmio->address - vdev->msix.mmio_gpa;
+	uint32_t index;
+
+	spinlock_obtain(&ivs_dev->lock);
+	index = rw_vmsix_table(vdev, io_req);
+	if (index < vdev->msix.table_count) {
+		if ((mmio->direction == ACRN_IOREQ_DIR_WRITE)
+			&& ((vdev->msix.table_entries[index].vector_control & PCIM_MSIX_VCTRL_MASK) == 0U)
+			&& bitmap_test_and_clear_nolock((uint16_t)index, &ivs_dev->pending_vectors)) {
+			ivshmem_inject_vector(ivs_dev, (uint16_t)index);
+		}
+	} else if ((mmio->direction == ACRN_IOREQ_DIR_READ) && (offset == VMSIX_MAX_ENTRY_TABLE_SIZE)) {
+		/* The first PBA qword covers every vector of an ivshmem device */
+		mmio->value = ivs_dev->pending_vectors;
+		if (mmio->size == 4U) {
+			mmio->value &= 0xffffffffUL;
+		}
+	} else {
+		/* No action required */
+	}
+	spinlock_release(&ivs_dev->lock);
+
+	return 0;
+}
+
 static int32_t read_ivshmem_vdev_cfg(const struct pci_vdev *vdev, uint32_t offset, uint32_t bytes, uint32_t *val)
 {
 	*val = pci_vdev_read_vcfg(vdev, offset, bytes);
@@ -255,11 +312,12 @@ static void ivshmem_vbar_map(struct pci_vdev *vdev, uint32_t idx)
 				vbar->base_gpa, vbar->size, EPT_RD | EPT_WR | EPT_WB | EPT_IGNORE_PAT);
 	} else if ((idx == IVSHMEM_MMIO_BAR) && (vbar->base_gpa != 0UL)) {
 		(void)memset(&ivs_dev->mmio, 0U, sizeof(ivs_dev->mmio));
+		ivs_dev->pending_vectors = 0UL;
 		register_mmio_emulation_handler(vm, ivshmem_mmio_handler, vbar->base_gpa,
 				(vbar->base_gpa + vbar->size), vdev, false);
 		ept_del_mr(vm, (uint64_t *)vm->arch_vm.nworld_eptp, vbar->base_gpa, round_page_up(vbar->size));
 	} else if ((idx == IVSHMEM_MSIX_BAR) && (vbar->base_gpa != 0UL)) {
-		register_mmio_emulation_handler(vm, vmsix_handle_table_mmio_access, vbar->base_gpa,
+		register_mmio_emulation_handler(vm, ivshmem_vmsix_handle_table_mmio_access, vbar->base_gpa,
 			(vbar->base_gpa + vbar->size), vdev, false);
 		ept_del_mr(vm, (uint64_t *)vm->arch_vm.nworld_eptp, vbar->base_gpa, vbar->size);
 		vdev->msix.mmio_gpa = vbar->base_gpa;
@@ -76,9 +76,8 @@ void pci_vdev_write_vcfg(struct pci_vdev *vdev, uint32_t offset, uint32_t bytes,
 
 /**
  * @pre vpci != NULL
- * @pre vpci->pci_vdev_cnt <= CONFIG_MAX_PCI_DEV_NUM
  */
-struct pci_vdev *pci_find_vdev(struct acrn_vpci *vpci, union pci_bdf vbdf)
+static struct pci_vdev *hlist_find_vdev(struct acrn_vpci *vpci, union pci_bdf vbdf)
 {
 	struct pci_vdev *vdev = NULL, *tmp;
 	struct hlist_node *n;
@@ -94,6 +93,85 @@ struct pci_vdev *pci_find_vdev(struct acrn_vpci *vpci, union pci_bdf vbdf)
 	return vdev;
 }
 
+/**
+ * @brief Get the devfn table of a bus, allocate one if the bus is not indexed yet.
+ *
+ * @pre vpci != NULL
+ *
+ * @return NULL if the bus is not indexed and all devfn tables are in use.
+ */
+static struct pci_vdev **get_devfn_tbl(struct acrn_vpci *vpci, uint8_t bus, bool alloc)
+{
+	struct pci_vdev **tbl = NULL;
+	uint8_t idx = vpci->bus_tbl_idx[bus];
+
+	if ((idx == 0U) && alloc && (vpci->bus_tbl_cnt < VDEV_BDF_TBL_BUS_NUM)) {
+		vpci->bus_tbl_cnt++;
+		idx = vpci->bus_tbl_cnt;
+		vpci->bus_tbl_idx[bus] = idx;
+	}
+
+	if (idx != 0U) {
+		tbl = vpci->devfn_tbl[idx - 1U];
+	}
+
+	return tbl;
+}
+
+/**
+ * @brief Add vdev to the vBDF lookup structures of vpci.
+ *
+ * The latest linked vdev wins if several vdevs share the same vBDF (e.g. a zombie one).
+ *
+ * @pre vpci != NULL
+ * @pre vdev != NULL
+ */
+void vpci_link_vdev(struct acrn_vpci *vpci, struct pci_vdev *vdev)
+{
+	struct pci_vdev **tbl = get_devfn_tbl(vpci, vdev->bdf.fields.bus, true);
+
+	hlist_add_head(&vdev->link, &vpci->vdevs_hlist_heads[hash64(vdev->bdf.value, VDEV_LIST_HASHBITS)]);
+	if (tbl != NULL) {
+		tbl[vdev->bdf.fields.devfun] = vdev;
+	}
+}
+
+/**
+ * @brief Remove vdev from the vBDF lookup structures of vpci.
+ *
+ * @pre vpci != NULL
+ * @pre vdev != NULL
+ * @pre vdev is linked to vpci
+ */
+void vpci_unlink_vdev(struct acrn_vpci *vpci, struct pci_vdev *vdev)
+{
+	struct pci_vdev **tbl = get_devfn_tbl(vpci, vdev->bdf.fields.bus, false);
+
+	hlist_del(&vdev->link);
+	if ((tbl != NULL) && (tbl[vdev->bdf.fields.devfun] == vdev)) {
+		/* fall back to an older vdev with the same vBDF, if any */
+		tbl[vdev->bdf.fields.devfun] = hlist_find_vdev(vpci, vdev->bdf);
+	}
+}
+
+/**
+ * @pre vpci != NULL
+ * @pre vpci->pci_vdev_cnt <= CONFIG_MAX_PCI_DEV_NUM
+ */
+struct pci_vdev *pci_find_vdev(struct acrn_vpci *vpci, union pci_bdf vbdf)
+{
+	struct pci_vdev *vdev;
+	uint8_t idx = vpci->bus_tbl_idx[vbdf.fields.bus];
+
+	if (idx != 0U) {
+		vdev = vpci->devfn_tbl[idx - 1U][vbdf.fields.devfun];
+	} else {
+		vdev = hlist_find_vdev(vpci, vbdf);
+	}
+
+	return vdev;
+}
+
 static bool is_pci_mem_bar_base_valid(struct acrn_vm *vm, uint64_t base)
 {
 	struct acrn_vpci *vpci = &vm->vpci;
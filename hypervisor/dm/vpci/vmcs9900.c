@@ -51,7 +51,14 @@ static int32_t vmcs9900_mmio_handler(struct io_request *io_req, void *data)
 
 	offset = (uint16_t)(mmio->address - vbar->base_gpa);
 
-	if (mmio->direction == ACRN_IOREQ_DIR_READ) {
+	if (offset >= VUART_BURST_CTRL) {
+		/* burst mode window, past the 16550 registers */
+		if (mmio->direction == ACRN_IOREQ_DIR_READ) {
+			mmio->value = vuart_burst_read(vu, offset, (uint8_t)mmio->size);
+		} else {
+			vuart_burst_write(vu, offset, (uint8_t)mmio->size, mmio->value);
+		}
+	} else if (mmio->direction == ACRN_IOREQ_DIR_READ) {
 		mmio->value = vuart_read_reg(vu, offset);
 	} else {
 		vuart_write_reg(vu, offset, (uint8_t) mmio->value);
@@ -311,19 +311,19 @@ static void assign_vdev_pt_iommu_domain(struct pci_vdev *vdev)
 	if (ret != 0) {
 		panic("failed to assign iommu device!");
 	}
+	vdev->iommu = vm->iommu;
 }
 
 /**
  * @pre vdev != NULL
  * @pre vdev->vpci != NULL
- * @pre vpci2vm(vdev->vpci)->iommu != NULL
  */
-static void remove_vdev_pt_iommu_domain(const struct pci_vdev *vdev)
+static void remove_vdev_pt_iommu_domain(struct pci_vdev *vdev)
 {
 	int32_t ret;
-	const struct acrn_vm *vm = vpci2vm(vdev->vpci);
 
-	ret = move_pt_device(vm->iommu, NULL, (uint8_t)vdev->pdev->bdf.bits.b,
+	/* the vIOMMU of the VM may have moved the device to a shadow domain, or detached it */
+	ret = move_pt_device(vdev->iommu, NULL, (uint8_t)vdev->pdev->bdf.bits.b,
 		(uint8_t)(vdev->pdev->bdf.value & 0xFFU));
 	if (ret != 0) {
 		/*
@@ -335,6 +335,7 @@ static void remove_vdev_pt_iommu_domain(const struct pci_vdev *vdev)
 		 */
 		panic("failed to unassign iommu device!");
 	}
+	vdev->iommu = NULL;
 }
 
 /**
@@ -568,6 +569,89 @@ static const struct pci_vdev_ops pci_pt_dev_ops = {
 	.read_vdev_cfg	= read_pt_dev_cfg,
 };
 
+/**
+ * @pre vdev != NULL
+ *
+ * @return true if vdev is a pass-through device in use by the VM of its vpci
+ */
+bool is_pt_vdev(const struct pci_vdev *vdev)
+{
+	return ((vdev->user == vdev) && (vdev->vdev_ops == &pci_pt_dev_ops));
+}
+
+/**
+ * @pre vpci != NULL
+ */
+static struct pci_cfg_shadow *find_cfg_shadow(struct acrn_vpci *vpci, union pci_bdf bdf)
+{
+	struct pci_cfg_shadow *shadow = NULL;
+	uint32_t i;
+
+	for (i = 0U; i < VPCI_CFG_SHADOW_NUM; i++) {
+		if ((vpci->cfg_shadows[i].cached_map != 0UL) && bdf_is_equal(vpci->cfg_shadows[i].vbdf, bdf)) {
+			shadow = &vpci->cfg_shadows[i];
+			break;
+		}
+	}
+
+	return shadow;
+}
+
+/**
+ * @brief Answer a config read of a DM-emulated device from its shadow.
+ *
+ * @pre vpci != NULL
+ *
+ * @return true if the access hits a cached dword, false if it must go to the DM.
+ */
+static bool read_cfg_shadow(struct acrn_vpci *vpci, union pci_bdf bdf,
+	uint32_t offset, uint32_t bytes, uint32_t *val)
+{
+	const struct pci_cfg_shadow *shadow;
+	uint32_t idx = offset >> 2U;
+	bool hit = false;
+
+	if ((idx < VPCI_CFG_SHADOW_DWORDS) && (((offset & 0x3U) + bytes) <= 4U)) {
+		shadow = find_cfg_shadow(vpci, bdf);
+		if ((shadow != NULL) && ((shadow->cached_map & (1UL << idx)) != 0UL)) {
+			*val = shadow->data[idx] >> ((offset & 0x3U) << 3U);
+			if (bytes < 4U) {
+				*val &= (1U << (bytes << 3U)) - 1U;
+			}
+			hit = true;
+		}
+	}
+
+	return hit;
+}
+
+/**
+ * @brief Reflect a config write of a DM-emulated device in its shadow.
+ *
+ * A dword aligned 4-byte write is merged under the write mask, which matches how
+ * the DM emulates registers like BARs. The effect of any other write is unknown
+ * here, so the dword is dropped from the shadow.
+ *
+ * @pre vpci != NULL
+ */
+static void write_cfg_shadow(struct acrn_vpci *vpci, union pci_bdf bdf,
+	uint32_t offset, uint32_t bytes, uint32_t val)
+{
+	struct pci_cfg_shadow *shadow;
+	uint32_t idx = offset >> 2U;
+
+	if (idx < VPCI_CFG_SHADOW_DWORDS) {
+		shadow = find_cfg_shadow(vpci, bdf);
+		if ((shadow != NULL) && ((shadow->cached_map & (1UL << idx)) != 0UL)) {
+			if ((bytes == 4U) && ((offset & 0x3U) == 0U)) {
+				shadow->data[idx] = (shadow->data[idx] & ~shadow->wmask[idx]) | (val & shadow->wmask[idx]);
+			} else {
+				shadow->cached_map &= ~(1UL << idx);
+			}
+		}
+	}
+}
+
 /**
  * @pre vpci != NULL
  */
@@ -583,7 +667,9 @@ static int32_t vpci_read_cfg(struct acrn_vpci *vpci, union pci_bdf bdf,
 		ret = vdev->vdev_ops->read_vdev_cfg(vdev, offset, bytes, val);
 	} else {
 		if (is_postlaunched_vm(vpci2vm(vpci))) {
-			ret = -ENODEV;
+			if (!read_cfg_shadow(vpci, bdf, offset, bytes, val)) {
+				ret = -ENODEV;
+			}
 		} else if (is_plat_hidden_pdev(bdf)) {
 			/* expose and pass through platform hidden devices */
 			*val = pci_pdev_read_cfg(bdf, offset, bytes);
@@ -610,6 +696,8 @@ static int32_t vpci_write_cfg(struct acrn_vpci *vpci, union pci_bdf bdf,
 		ret = vdev->vdev_ops->write_vdev_cfg(vdev, offset, bytes, val);
 	} else {
 		if (is_postlaunched_vm(vpci2vm(vpci))) {
+			/* the DM still emulates the write, keep the shadow in sync */
+			write_cfg_shadow(vpci, bdf, offset, bytes, val);
 			ret = -ENODEV;
 		} else if (is_plat_hidden_pdev(bdf)) {
 			/* expose and pass through platform hidden devices */
@@ -652,7 +740,7 @@ struct pci_vdev *vpci_init_vdev(struct acrn_vpci *vpci, struct acrn_vm_pci_dev_c
 	vdev->pci_dev_config = dev_config;
 	vdev->phyfun = parent_pf_vdev;
 
-	hlist_add_head(&vdev->link, &vpci->vdevs_hlist_heads[hash64(dev_config->vbdf.value, VDEV_LIST_HASHBITS)]);
+	vpci_link_vdev(vpci, vdev);
 	if (dev_config->vdev_ops != NULL) {
 		vdev->vdev_ops = dev_config->vdev_ops;
 	} else {
@@ -748,10 +836,10 @@ int32_t vpci_assign_pcidev(struct acrn_vm *tgt_vm, struct acrn_pcidev *pcidev)
 
 		if (ret == 0) {
 			vdev->flags |= pcidev->type;
+			/* We should re-link the vdev since its vbdf has changed */
+			vpci_unlink_vdev(vpci, vdev);
 			vdev->bdf.value = pcidev->virt_bdf;
-			/*We should re-add the vdev to hashlist since its vbdf has changed */
-			hlist_del(&vdev->link);
-			hlist_add_head(&vdev->link, &vpci->vdevs_hlist_heads[hash64(vdev->bdf.value, VDEV_LIST_HASHBITS)]);
+			vpci_link_vdev(vpci, vdev);
 			vdev->parent_user = vdev_in_service_vm;
 			vdev_in_service_vm->user = vdev;
 		} else {
@@ -893,3 +981,56 @@ bool vpci_vmsix_enabled(const struct pci_vdev *vdev)
 	}
 	return ret;
 }
+
+/**
+ * @brief Register, update or unregister the config space shadow of a DM-emulated device.
+ *
+ * @pre vm != NULL
+ * @pre shadow != NULL
+ *
+ * @return 0 on success, -ENODEV if the vBDF belongs to a vdev handled by hypervisor,
+ *	   -ENOMEM if there's no free shadow.
+ */
+int32_t vpci_set_cfg_shadow(struct acrn_vm *vm, const struct acrn_pci_cfg_shadow *shadow)
+{
+	struct acrn_vpci *vpci = &vm->vpci;
+	struct pci_cfg_shadow *cfg_shadow;
+	union pci_bdf bdf;
+	uint32_t i;
+	int32_t ret = 0;
+
+	bdf.value = shadow->vbdf;
+	spinlock_obtain(&vpci->lock);
+	if (find_available_vdev(vpci, bdf) != NULL) {
+		ret = -ENODEV;
+	} else {
+		cfg_shadow = find_cfg_shadow(vpci, bdf);
+		if (cfg_shadow == NULL) {
+			for (i = 0U; i < VPCI_CFG_SHADOW_NUM; i++) {
+				if (vpci->cfg_shadows[i].cached_map == 0UL) {
+					cfg_shadow = &vpci->cfg_shadows[i];
+					break;
+				}
+			}
+		}
+
+		if (cfg_shadow != NULL) {
+			cfg_shadow->vbdf = bdf;
+			(void)memcpy_s((void *)cfg_shadow->wmask, sizeof(cfg_shadow->wmask),
+				(const void *)shadow->wmask, sizeof(shadow->wmask));
+			(void)memcpy_s((void *)cfg_shadow->data, sizeof(cfg_shadow->data),
+				(const void *)shadow->data, sizeof(shadow->data));
+			/* publish last, an empty map frees the shadow */
+			cfg_shadow->cached_map = shadow->cached_map;
+		} else if (shadow->cached_map != 0UL) {
+			pr_err("%s: no free config space shadow for %x:%x.%x\n", __func__,
+				bdf.bits.b, bdf.bits.d, bdf.bits.f);
+			ret = -ENOMEM;
+		} else {
+			/* unregister a not registered shadow: nothing to do */
+		}
+	}
+	spinlock_release(&vpci->lock);
+
+	return ret;
+}
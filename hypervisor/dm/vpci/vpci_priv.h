@@ -170,6 +170,8 @@ void read_sriov_cap_reg(const struct pci_vdev *vdev, uint32_t offset, uint32_t b
 void write_sriov_cap_reg(struct pci_vdev *vdev, uint32_t offset, uint32_t bytes, uint32_t val);
 uint32_t sriov_bar_offset(const struct pci_vdev *vdev, uint32_t bar_idx);
 
+void vpci_link_vdev(struct acrn_vpci *vpci, struct pci_vdev *vdev);
+void vpci_unlink_vdev(struct acrn_vpci *vpci, struct pci_vdev *vdev);
 uint32_t pci_vdev_read_vcfg(const struct pci_vdev *vdev, uint32_t offset, uint32_t bytes);
 void pci_vdev_write_vcfg(struct pci_vdev *vdev, uint32_t offset, uint32_t bytes, uint32_t val);
 uint32_t vpci_add_capability(struct pci_vdev *vdev, uint8_t *capdata, uint8_t caplen);
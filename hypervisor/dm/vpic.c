@@ -992,6 +992,34 @@ static void vpic_register_io_handler(struct acrn_vm *vm)
 			vpic_elc_io_read, vpic_elc_io_write);
 }
 
+/*
+ * Back to the power on state for a VM reset, the handlers stay registered. The
+ * pin levels are driven by the devices and the ELCR is set up by the
+ * firmware, both are kept as they are.
+ */
+void reset_vpic(struct acrn_vm *vm)
+{
+	struct acrn_vpic *vpic = vm_pic(vm);
+	struct i8259_reg_state *i8259;
+	uint8_t pin_state[8];
+	uint8_t elc;
+	uint64_t rflags;
+	uint32_t i;
+
+	spinlock_irqsave_obtain(&(vpic->lock), &rflags);
+	for (i = 0U; i < 2U; i++) {
+		i8259 = &vpic->i8259[i];
+		(void)memcpy_s(pin_state, sizeof(pin_state), i8259->pin_state, sizeof(i8259->pin_state));
+		elc = i8259->elc;
+
+		(void)memset(i8259, 0U, sizeof(*i8259));
+		(void)memcpy_s(i8259->pin_state, sizeof(i8259->pin_state), pin_state, sizeof(pin_state));
+		i8259->elc = elc;
+		i8259->mask = 0xffU;
+	}
+	spinlock_irqrestore_release(&(vpic->lock), rflags);
+}
+
 void vpic_init(struct acrn_vm *vm)
 {
 	struct acrn_vpic *vpic = vm_pic(vm);
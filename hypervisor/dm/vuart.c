@@ -35,12 +35,20 @@
 #include <vuart.h>
 #include <vmcs9900.h>
 #include <asm/guest/vm.h>
+#include <asm/guest/virq.h>
+#include <asm/notify.h>
 #include <logmsg.h>
+#include <slab.h>
 
 #define init_vuart_lock(vu)	spinlock_init(&((vu)->lock))
 #define obtain_vuart_lock(vu, flags)	spinlock_irqsave_obtain(&((vu)->lock), &(flags))
 #define release_vuart_lock(vu, flags)	spinlock_irqrestore_release(&((vu)->lock), (flags))
 
+/* the enlarged RX FIFOs of the PCI vuarts, legacy vuarts keep their embedded one */
+static char pci_vuart_rx_bufs[PCI_RX_BUF_NUM][PCI_RX_BUF_SIZE];
+static uint32_t pci_vuart_rx_buf_links[PCI_RX_BUF_NUM];
+static struct slab_cache pci_vuart_rx_buf_cache;
+
 static inline void reset_fifo(struct vuart_fifo *fifo)
 {
 	fifo->rindex = 0U;
@@ -77,6 +85,11 @@ static inline uint32_t fifo_numchars(const struct vuart_fifo *fifo)
 	return fifo->num;
 }
 
+static inline uint32_t fifo_room(const struct vuart_fifo *fifo)
+{
+	return fifo->size - fifo->num;
+}
+
 static inline bool fifo_isfull(const struct vuart_fifo *fifo)
 {
 	bool ret = false;
@@ -211,9 +224,111 @@ void vuart_toggle_intr(const struct acrn_vuart *vu)
 	}
 }
 
+static void vuart_burst_timeout(void *data)
+{
+	struct acrn_vuart *vu = (struct acrn_vuart *)data;
+	uint64_t rflags;
+
+	obtain_vuart_lock(vu, rflags);
+	if (vu->active) {
+		vuart_toggle_intr(vu);
+	}
+	release_vuart_lock(vu, rflags);
+}
+
+/*
+ * The timer lists are per pCPU, so the burst timer of a vuart is only armed
+ * and deleted on the pCPU of its VM's BSP vCPU. Hypervisor timers don't fire
+ * on the pCPUs of a LAPIC pass-through VM, its RX interrupts are not coalesced.
+ */
+static inline struct acrn_vcpu *burst_timer_vcpu(struct acrn_vuart *vu)
+{
+	return ((vu->vm->hw.created_vcpus > 0U) && !is_lapic_pt_configured(vu->vm)) ?
+		vcpu_from_vid(vu->vm, BSP_CPU_ID) : NULL;
+}
+
+/*
+ * @pre vu->lock is held
+ * @pre the current pCPU is the one of burst_timer_vcpu(vu)
+ */
+static void start_burst_timer(struct acrn_vuart *vu)
+{
+	struct vuart_burst *burst = &vu->burst;
+
+	if (burst->arm_pending) {
+		burst->arm_pending = false;
+		if (vu->active && !timer_is_started(&burst->intr_timer)) {
+			update_timer(&burst->intr_timer, cpu_ticks() + us_to_ticks(burst->intr_timeout_us), 0UL);
+			(void)add_timer(&burst->intr_timer);
+		}
+	}
+}
+
+/* smp call on the pCPU of burst_timer_vcpu(vu) */
+static void arm_burst_timer(void *data)
+{
+	struct acrn_vuart *vu = (struct acrn_vuart *)data;
+	uint64_t rflags;
+
+	obtain_vuart_lock(vu, rflags);
+	start_burst_timer(vu);
+	release_vuart_lock(vu, rflags);
+}
+
+/*
+ * Interrupt evaluation after new data landed in the RX FIFO. In burst mode
+ * it is held back until intr_threshold bytes are buffered, a one-shot timer
+ * makes sure a short message is still delivered after intr_timeout_us.
+ *
+ * The timer is armed right away on its own pCPU. From another pCPU, the
+ * caller arms it with an smp call once vu->lock is released, the receiving
+ * vCPU is not woken up for it.
+ *
+ * @pre vu->lock is held
+ *
+ * @return the pCPU to arm the burst timer on, INVALID_CPU_ID if none
+ */
+static uint16_t vuart_toggle_rx_intr(struct acrn_vuart *vu)
+{
+	struct vuart_burst *burst = &vu->burst;
+	struct acrn_vcpu *vcpu = burst_timer_vcpu(vu);
+	uint16_t pcpu_id = INVALID_CPU_ID;
+
+	if (burst->enabled && (vcpu != NULL) && (fifo_numchars(&vu->rxfifo) < burst->intr_threshold)) {
+		/* a timer already started flushes the new data along, the owner checks it again */
+		if (!burst->arm_pending && !timer_is_started(&burst->intr_timer)) {
+			burst->arm_pending = true;
+			pcpu_id = pcpuid_from_vcpu(vcpu);
+			if (pcpu_id == get_pcpu_id()) {
+				start_burst_timer(vu);
+				pcpu_id = INVALID_CPU_ID;
+			}
+		}
+	} else {
+		vuart_toggle_intr(vu);
+	}
+
+	return pcpu_id;
+}
+
+static void kick_burst_timer(struct acrn_vuart *vu, uint16_t pcpu_id)
+{
+	if (pcpu_id != INVALID_CPU_ID) {
+		smp_call_function(1UL << pcpu_id, arm_burst_timer, vu);
+	}
+}
+
+static void del_burst_timer(void *data)
+{
+	struct acrn_vuart *vu = (struct acrn_vuart *)data;
+
+	del_timer(&vu->burst.intr_timer);
+}
+
 static bool send_to_target(struct acrn_vuart *vu, uint8_t value_u8)
 {
 	uint64_t rflags;
+	uint16_t pcpu_id = INVALID_CPU_ID;
 	bool ret = false;
 
 	obtain_vuart_lock(vu, rflags);
@@ -222,12 +337,34 @@ static bool send_to_target(struct acrn_vuart *vu, uint8_t value_u8)
 		if (fifo_isfull(&vu->rxfifo)) {
 			ret = true;
 		}
-		vuart_toggle_intr(vu);
+		pcpu_id = vuart_toggle_rx_intr(vu);
 	}
 	release_vuart_lock(vu, rflags);
+	kick_burst_timer(vu, pcpu_id);
 	return ret;
 }
 
+/*
+ * Unlike send_to_target(), never overwrites unread data: bytes which do
+ * not fit are dropped, the sender is expected to check VUART_BURST_TX_ROOM.
+ */
+static void send_burst_to_target(struct acrn_vuart *vu, uint64_t value, uint8_t size)
+{
+	uint64_t rflags;
+	uint16_t pcpu_id = INVALID_CPU_ID;
+	uint8_t i;
+
+	obtain_vuart_lock(vu, rflags);
+	if (vu->active) {
+		for (i = 0U; (i < size) && (fifo_room(&vu->rxfifo) > 0U); i++) {
+			fifo_putchar(&vu->rxfifo, (char)(value >> (i * 8U)));
+		}
+		pcpu_id = vuart_toggle_rx_intr(vu);
+	}
+	release_vuart_lock(vu, rflags);
+	kick_burst_timer(vu, pcpu_id);
+}
+
 static uint8_t get_modem_status(uint8_t mcr)
 {
 	uint8_t msr;
@@ -529,6 +666,102 @@ uint8_t vuart_read_reg(struct acrn_vuart *vu, uint16_t offset)
 	return reg;
 }
 
+/**
+ * @pre vu != NULL
+ * @pre size <= 8U
+ */
+uint64_t vuart_burst_read(struct acrn_vuart *vu, uint16_t offset, uint8_t size)
+{
+	struct acrn_vuart *t_vu = vu->target_vu;
+	uint64_t value = 0UL, rflags;
+	bool drained = false;
+	uint8_t i;
+
+	obtain_vuart_lock(vu, rflags);
+	if ((offset >= VUART_BURST_DATA) && (offset < VUART_BURST_DATA_END) && !vu->burst.enabled) {
+		/* the data window is reserved while burst mode is off */
+		value = 0UL;
+	} else if ((offset >= VUART_BURST_DATA) && (offset < VUART_BURST_DATA_END)) {
+		for (i = 0U; (i < size) && (fifo_numchars(&vu->rxfifo) > 0U); i++) {
+			value |= ((uint64_t)(uint8_t)fifo_getchar(&vu->rxfifo)) << (i * 8U);
+		}
+		vu->lsr &= ~LSR_OE;
+		drained = (i != 0U);
+	} else {
+		switch (offset) {
+		case VUART_BURST_CTRL:
+			value = vu->burst.enabled ? VUART_BURST_CTRL_EN : 0UL;
+			break;
+		case VUART_BURST_RX_AVAIL:
+			value = fifo_numchars(&vu->rxfifo);
+			break;
+		case VUART_BURST_TX_ROOM:
+			value = (t_vu != NULL) ? fifo_room(&t_vu->rxfifo) : fifo_room(&vu->txfifo);
+			break;
+		case VUART_BURST_INTR_THRESHOLD:
+			value = vu->burst.intr_threshold;
+			break;
+		case VUART_BURST_INTR_TIMEOUT:
+			value = vu->burst.intr_timeout_us;
+			break;
+		default:
+			value = 0UL;
+			break;
+		}
+	}
+	release_vuart_lock(vu, rflags);
+
+	/* One THRE notification per burst, rather than one per character */
+	if (drained) {
+		notify_target(vu);
+	}
+
+	return value;
+}
+
+/**
+ * @pre vu != NULL
+ * @pre size <= 8U
+ */
+void vuart_burst_write(struct acrn_vuart *vu, uint16_t offset, uint8_t size, uint64_t value)
+{
+	struct acrn_vuart *t_vu = vu->target_vu;
+	uint64_t rflags;
+	uint8_t i;
+
+	if ((offset >= VUART_BURST_DATA) && (offset < VUART_BURST_DATA_END) && !vu->burst.enabled) {
+		/* the data window is reserved while burst mode is off, writes are ignored */
+	} else if ((offset >= VUART_BURST_DATA) && (offset < VUART_BURST_DATA_END)
+			&& (t_vu != NULL) && ((vu->mcr & MCR_LOOPBACK) == 0U)) {
+		send_burst_to_target(t_vu, value, size);
+	} else {
+		obtain_vuart_lock(vu, rflags);
+		if ((offset >= VUART_BURST_DATA) && (offset < VUART_BURST_DATA_END)) {
+			/* Not connected, e.g. the console vuart */
+			for (i = 0U; i < size; i++) {
+				fifo_putchar(&vu->txfifo, (char)(value >> (i * 8U)));
+			}
+		} else {
+			switch (offset) {
+			case VUART_BURST_CTRL:
+				vu->burst.enabled = ((value & VUART_BURST_CTRL_EN) != 0UL);
+				break;
+			case VUART_BURST_INTR_THRESHOLD:
+				/* Must be reachable before the RX FIFO reports full */
+				vu->burst.intr_threshold = (uint32_t)max(1UL, min(value, vu->rxfifo.size - 64UL));
+				break;
+			case VUART_BURST_INTR_TIMEOUT:
+				vu->burst.intr_timeout_us = (uint32_t)max(1UL, min(value, 1000000UL));
+				break;
+			default:
+				/* Read-only or reserved register */
+				break;
+			}
+		}
+		release_vuart_lock(vu, rflags);
+	}
+}
+
 /**
  * @pre vcpu != NULL
  * @pre vcpu->vm != NULL
@@ -583,6 +816,12 @@ static void setup_vuart(struct acrn_vm *vm, uint16_t vuart_idx)
 	vu->ier = 0U;
 	vuart_toggle_intr(vu);
 	vu->target_vu = NULL;
+	vu->burst.enabled = false;
+	vu->burst.arm_pending = false;
+	vu->burst.intr_threshold = VUART_BURST_DEF_THRESHOLD;
+	vu->burst.intr_timeout_us = VUART_BURST_DEF_TIMEOUT_US;
+	/* deinit_pci_vuart() deleted the timer of a previous instance */
+	initialize_timer(&vu->burst.intr_timer, vuart_burst_timeout, vu, 0UL, 0UL);
 }
 
 static struct acrn_vuart *find_active_target_vuart(const struct vuart_config *vu_config)
@@ -682,15 +921,29 @@ void deinit_legacy_vuarts(struct acrn_vm *vm)
 	}
 }
 
+void init_pci_vuart_rx_bufs(void)
+{
+	slab_init(&pci_vuart_rx_buf_cache, "pci_vuart_rx", pci_vuart_rx_bufs, PCI_RX_BUF_SIZE,
+		PCI_RX_BUF_NUM, pci_vuart_rx_buf_links);
+}
+
 void init_pci_vuart(struct pci_vdev *vdev)
 {
 	struct acrn_vuart *vu = vdev->priv_data;
+	char *buf;
 	struct acrn_vm_pci_dev_config *pci_cfg = vdev->pci_dev_config;
 	uint16_t idx = pci_cfg->vuart_idx;
 	struct acrn_vm *vm = container_of(vdev->vpci, struct acrn_vm, vpci);
 	struct acrn_vm_config *vm_cfg = get_vm_config(vm->vm_id);
 
 	setup_vuart(vm, idx);
+	buf = (char *)slab_alloc(&pci_vuart_rx_buf_cache);
+	if (buf != NULL) {
+		vu->rxfifo.buf = buf;
+		vu->rxfifo.size = PCI_RX_BUF_SIZE;
+	} else {
+		pr_warn("vm%hu vuart%hu: no enlarged RX FIFO left, using a %u bytes one", vm->vm_id, idx, RX_BUF_SIZE);
+	}
 	vu->vdev = vdev;
 	vm_cfg->vuart[idx].type = VUART_PCI;
 	vm_cfg->vuart[idx].t_vuart.vm_id = pci_cfg->t_vuart.vm_id;
@@ -706,9 +959,34 @@ void init_pci_vuart(struct pci_vdev *vdev)
 void deinit_pci_vuart(struct pci_vdev *vdev)
 {
 	struct acrn_vuart *vu = vdev->priv_data;
+	struct acrn_vcpu *vcpu = burst_timer_vcpu(vu);
+	uint16_t pcpu_id;
+	uint64_t rflags;
 
+	/* a pending arm request sees the vuart inactive */
+	obtain_vuart_lock(vu, rflags);
 	vu->active = false;
+	release_vuart_lock(vu, rflags);
+
+	if (vcpu != NULL) {
+		pcpu_id = pcpuid_from_vcpu(vcpu);
+		if (pcpu_id == get_pcpu_id()) {
+			del_burst_timer(vu);
+		} else {
+			smp_call_function(1UL << pcpu_id, del_burst_timer, vu);
+		}
+	}
+
 	if (vu->target_vu != NULL) {
 		vuart_deinit_connection(vu);
 	}
+
+	obtain_vuart_lock(vu, rflags);
+	if (vu->rxfifo.buf != vu->vuart_rx_buf) {
+		slab_free(&pci_vuart_rx_buf_cache, vu->rxfifo.buf);
+		vu->rxfifo.buf = vu->vuart_rx_buf;
+		vu->rxfifo.size = RX_BUF_SIZE;
+		reset_fifo(&vu->rxfifo);
+	}
+	release_vuart_lock(vu, rflags);
 }
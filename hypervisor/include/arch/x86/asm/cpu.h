@@ -446,10 +446,9 @@ void dispatch_exception(struct intr_excp_ctx *ctx);
  *
  * @param ctx Pointer to interrupt exception context
  */
-void handle_nmi(__unused struct intr_excp_ctx *ctx);
+void handle_nmi(struct intr_excp_ctx *ctx);
 
 /* Function prototypes */
-void cpu_do_idle(void);
 void cpu_dead(void);
 void trampoline_start16(void);
 void load_pcpu_state_data(void);
@@ -534,6 +533,16 @@ static inline void asm_hlt(void)
 	asm volatile ("hlt");
 }
 
+static inline void asm_monitor(volatile const uint64_t *addr, uint64_t ecx, uint64_t edx)
+{
+	asm volatile("monitor\n" : : "a" (addr), "c" (ecx), "d" (edx));
+}
+
+static inline void asm_mwait(uint64_t eax, uint64_t ecx)
+{
+	asm volatile("mwait\n" : : "a" (eax), "c" (ecx));
+}
+
 /* Disables interrupts on the current CPU */
 #ifdef CONFIG_KEEP_IRQ_DISABLED
 #define CPU_IRQ_DISABLE_ON_CONFIG()		do { } while (0)
@@ -134,6 +134,8 @@
 #define CPUID_ECX_KL_NOBACKUP	(1U<<0U)
 /* CPUID.19H.ECX.KL_RANDOM_KS */
 #define CPUID_ECX_KL_RANDOM_KS	(1U<<1U)
+/* CPUID.06H.EAX.ARAT: the APIC timer keeps running in deep C-states */
+#define CPUID_EAX_ARAT		(1U<<2U)
 /* CPUID.80000001H.EDX.XD_BIT_AVAILABLE */
 #define CPUID_EDX_XD_BIT_AVIL   (1U<<20U)
 
@@ -142,8 +144,11 @@
 #define CPUID_FEATURES          1U
 #define CPUID_TLB               2U
 #define CPUID_SERIALNUM         3U
+#define CPUID_MONITOR_MWAIT     5U
+#define CPUID_THERMAL_POWER     6U
 #define CPUID_EXTEND_FEATURE    7U
 #define CPUID_XSAVE_FEATURES   0xDU
+#define CPUID_RDT_MONITORING   0xFU
 #define CPUID_RDT_ALLOCATION   0x10U
 #define CPUID_MAX_EXTENDED_FUNCTION  0x80000000U
 #define CPUID_EXTEND_FUNCTION_1      0x80000001U
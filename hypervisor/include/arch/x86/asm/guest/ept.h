@@ -165,5 +165,14 @@ void walk_ept_table(struct acrn_vm *vm, pge_handler cb);
 int32_t ept_misconfig_vmexit_handler(__unused struct acrn_vcpu *vcpu);
 
 void init_ept_pgtable(struct pgtable *table, uint16_t vm_id);
+
+/**
+ * @brief Number of EPT paging structure pages a VM currently holds
+ *
+ * @param[in] vm_id the id of the VM
+ *
+ * @return the number of pages allocated from the VM's EPT page pool
+ */
+uint64_t get_ept_used_page_num(uint16_t vm_id);
 void reserve_buffer_for_ept_pages(void);
 #endif /* EPT_H */
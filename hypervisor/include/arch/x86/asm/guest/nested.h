@@ -334,16 +334,34 @@ struct acrn_vvmcs {
 	uint8_t vmcs02[PAGE_SIZE];	/* VMCS to run L2 and as Link Pointer in VMCS01 */
 	struct acrn_vmcs12 vmcs12;	/* To cache L1's VMCS12*/
 	uint64_t vmcs12_gpa;            /* The corresponding L1 GPA for this VMCS12 */
-	uint32_t ref_cnt;		/* Count of being VMPTRLDed without VMCLEARed */
+	uint64_t last_used;		/* LRU stamp of the last VMPTRLD, larger is more recent */
 	bool host_state_dirty;		/* To indicate need to merge VMCS12 host-state fields to VMCS01 */
-	bool control_fields_dirty;	/* For all other non-host-state fields that need to be merged */
+	uint32_t control_fields_dirty;	/* VMCS12_DIRTY_xxx groups of non-host-state fields that need to be merged */
 } __aligned(PAGE_SIZE);
 
-#define MAX_ACTIVE_VVMCS_NUM	4
+/* groups of merged VMCS12 control fields, see merge_and_sync_control_fields() */
+#define VMCS12_DIRTY_MSR_BITMAP		(1U << 0U)
+#define VMCS12_DIRTY_EPTP		(1U << 1U)
+#define VMCS12_DIRTY_ENTRY_EXIT_CTLS	(1U << 2U)
+#define VMCS12_DIRTY_VPID		(1U << 3U)
+#define VMCS12_DIRTY_ALL		(VMCS12_DIRTY_MSR_BITMAP | VMCS12_DIRTY_EPTP | \
+					VMCS12_DIRTY_ENTRY_EXIT_CTLS | VMCS12_DIRTY_VPID)
+
+#define MAX_ACTIVE_VVMCS_NUM	8
+
+/* nested VMX events accounted per vCPU */
+#define NESTED_STAT_ENTRY		0U	/* VMLAUNCH/VMRESUME to L2 */
+#define NESTED_STAT_EXIT		1U	/* L2 VM exit reflected to L1 */
+#define NESTED_STAT_EPT		2U	/* L2 EPT violation fixed up in the shadow EPT */
+#define NESTED_STAT_VMPTRLD_MISS	3U	/* VMPTRLD of a VMCS12 which isn't cached */
+#define NESTED_STAT_VMCS12_FLUSH	4U	/* cached VMCS12 written back to L1 */
+#define NESTED_STAT_NUM		5U
 
 struct acrn_nested {
 	struct acrn_vvmcs vvmcs[MAX_ACTIVE_VVMCS_NUM];
 	struct acrn_vvmcs *current_vvmcs;	/* Refer to the current loaded VMCS12 */
+	uint64_t lru_clock;
+	struct acrn_exit_stat stats[NESTED_STAT_NUM];
 	uint64_t vmxon_ptr;		/* GPA */
 	bool vmxon;		/* To indicate if vCPU entered VMX operation */
 	bool in_l2_guest;	/* To indicate if vCPU is currently in Guest mode (from L1's perspective) */
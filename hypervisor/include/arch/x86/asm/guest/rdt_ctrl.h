@@ -0,0 +1,35 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef RDT_CTRL_H_
+#define RDT_CTRL_H_
+
+#include <acrn_common.h>
+
+struct acrn_vm;
+
+/**
+ * @brief Read the L3 occupancy and memory bandwidth counters of all VMs
+ *
+ * @param[in] service_vm The Service VM, relative VM ids are based on it
+ * @param[out] mon The readout
+ *
+ * @return 0 on success, -ENODEV if the platform can't monitor the L3
+ */
+int32_t rdt_ctrl_get_mon(const struct acrn_vm *service_vm, struct acrn_rdt_mon *mon);
+
+/**
+ * @brief Enable, update or disable the RDT control loop
+ *
+ * @param[in] service_vm The Service VM, relative VM ids are based on it
+ * @param[in] ctrl Parameters of the control loop
+ *
+ * @return 0 on success, -ENODEV if the platform can't monitor and allocate a
+ *	   single L3, -EINVAL if the VMs or bounds don't fit the CLOS configuration
+ */
+int32_t rdt_ctrl_set(const struct acrn_vm *service_vm, const struct acrn_rdt_ctrl *ctrl);
+
+#endif /* RDT_CTRL_H_ */
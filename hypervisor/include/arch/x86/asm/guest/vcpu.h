@@ -21,6 +21,7 @@
 #include <asm/guest/virtual_cr.h>
 #include <asm/guest/vlapic.h>
 #include <asm/guest/vmtrr.h>
+#include <asm/guest/vpmu.h>
 #include <schedule.h>
 #include <event.h>
 #include <io_req.h>
@@ -249,8 +250,12 @@ struct acrn_vcpu_arch {
 
 	struct acrn_vmtrr vmtrr;
 
+	struct acrn_vpmu vpmu;
+
 	int32_t cur_context;
 	struct guest_cpu_context contexts[NR_WORLD];
+	/* switches into each world, with the cycles spent in switch_world() */
+	struct acrn_exit_stat world_switch_stats[NR_WORLD];
 
 	/* common MSRs, world_msrs[] is a subset of it */
 	uint64_t guest_msrs[NUM_EMULATED_MSRS];
@@ -324,6 +329,10 @@ struct acrn_vcpu {
 	uint64_t reg_updated;
 
 	struct sched_event events[VCPU_EVENT_NUM];
+
+	/* always-on VM exit statistics, per basic exit reason */
+	struct acrn_exit_stat exit_stats[ACRN_EXIT_REASON_NUM];
+	uint16_t io_stat_slot;	/* I/O handler which served the current exit */
 } __aligned(PAGE_SIZE);
 
 struct vcpu_dump {
@@ -634,6 +643,16 @@ struct acrn_vcpu *get_ever_run_vcpu(uint16_t pcpu_id);
 
 void save_xsave_area(struct acrn_vcpu *vcpu, struct ext_context *ectx);
 void rstore_xsave_area(const struct acrn_vcpu *vcpu, const struct ext_context *ectx);
+void switch_world_xsave_area(struct ext_context *prev, const struct ext_context *next);
+
+/**
+ * @brief Save the lazily switched XSAVE state loaded on the current pCPU
+ *
+ * Called before the pCPU goes offline, the state would be lost with it.
+ *
+ * @return None
+ */
+void save_lazy_xsave_state(void);
 void load_iwkey(struct acrn_vcpu *vcpu);
 
 /**
@@ -7,6 +7,8 @@
 #define VEPT_H
 
 #ifdef CONFIG_NVMX_ENABLED
+#include <list.h>
+#include <asm/lib/spinlock.h>
 
 #define RESERVED_BITS(start, end) (((1UL << (end - start + 1)) - 1) << start)
 #define IA32E_PML4E_RESERVED_BITS(phy_addr_width)	(RESERVED_BITS(3U, 7U) | RESERVED_BITS(phy_addr_width, 51U))
@@ -36,6 +38,9 @@ struct vept_desc {
 	 */
 	uint64_t shadow_eptp;
 	uint32_t ref_count;
+	/* serializes the updates of the shadow EPT */
+	spinlock_t lock;
+	struct hlist_node link;
 };
 
 void init_vept(void);
@@ -84,6 +84,10 @@ struct acrn_vlapic {
 	 */
 	uint32_t	svr_last;
 	uint32_t	lvt_last[VLAPIC_MAXLVT_INDEX + 1];
+
+	/* EOI exits taken, and level triggered interrupts accepted without one */
+	uint64_t	eoi_exits;
+	uint64_t	eoi_exits_avoided;
 } __aligned(PAGE_SIZE);
 
 
@@ -203,6 +207,7 @@ uint64_t vlapic_apicv_get_apic_page_addr(struct acrn_vlapic *vlapic);
 int32_t apic_access_vmexit_handler(struct acrn_vcpu *vcpu);
 int32_t apic_write_vmexit_handler(struct acrn_vcpu *vcpu);
 int32_t veoi_vmexit_handler(struct acrn_vcpu *vcpu);
+void vlapic_update_eoi_exit(struct acrn_vlapic *vlapic, uint32_t vector);
 void vlapic_update_tpr_threshold(const struct acrn_vlapic *vlapic);
 int32_t tpr_below_threshold_vmexit_handler(struct acrn_vcpu *vcpu);
 uint64_t vlapic_calc_dest_noshort(struct acrn_vm *vm, bool is_broadcast,
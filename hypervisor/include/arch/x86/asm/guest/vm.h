@@ -15,6 +15,7 @@
 
 #include <asm/lib/bits.h>
 #include <asm/lib/spinlock.h>
+#include <slab.h>
 #include <asm/pgtable.h>
 #include <asm/guest/vcpu.h>
 #include <vioapic.h>
@@ -24,6 +25,7 @@
 #include <asm/guest/trusty.h>
 #include <asm/guest/vcpuid.h>
 #include <vpci.h>
+#include <viommu.h>
 #include <asm/cpu_caps.h>
 #include <asm/e820.h>
 #include <asm/vm_config.h>
@@ -153,9 +155,14 @@ struct acrn_vm {
 	spinlock_t emul_mmio_lock;	/* Used to protect emulation mmio_node concurrent access for a VM */
 	uint16_t nr_emul_mmio_regions;	/* the emulated mmio_region number */
 	struct mem_io_node emul_mmio[CONFIG_MAX_EMULATED_MMIO_REGIONS];
+	struct slab_cache emul_mmio_cache;	/* the free nodes of emul_mmio */
+	uint32_t emul_mmio_links[CONFIG_MAX_EMULATED_MMIO_REGIONS];
 
 	struct vm_io_handler_desc emul_pio[EMUL_PIO_IDX_MAX];
 
+	/* I/O exit statistics per handler, indexed by IO_STAT_SLOT_*, updated atomically */
+	struct acrn_exit_stat io_stats[IO_STAT_SLOT_NUM];
+
 	char name[MAX_VM_NAME_LEN];
 	struct secure_world_control sworld_control;
 
@@ -169,6 +176,7 @@ struct acrn_vm {
 	uint32_t vcpuid_entry_nr, vcpuid_level, vcpuid_xlevel;
 	struct vcpuid_entry vcpuid_entries[MAX_VM_VCPUID_ENTRIES];
 	struct acrn_vpci vpci;
+	struct acrn_viommu viommu;
 	uint8_t vrtc_offset;
 
 	uint64_t intr_inject_delay_delta; /* delay of intr injection */
@@ -259,6 +267,7 @@ bool is_pmu_pt_configured(const struct acrn_vm *vm);
 bool is_rt_vm(const struct acrn_vm *vm);
 bool is_stateful_vm(const struct acrn_vm *vm);
 bool is_nvmx_configured(const struct acrn_vm *vm);
+bool is_viommu_configured(const struct acrn_vm *vm);
 bool is_vcat_configured(const struct acrn_vm *vm);
 bool is_static_configured_vm(const struct acrn_vm *vm);
 uint16_t get_unused_vmid(void);
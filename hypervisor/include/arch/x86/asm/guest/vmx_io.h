@@ -28,6 +28,19 @@
 #define PIO_RESET_REG_IDX		(CF9_PIO_IDX + 1U)
 #define SLEEP_CTL_PIO_IDX		(PIO_RESET_REG_IDX + 1U)
 #define EMUL_PIO_IDX_MAX		(SLEEP_CTL_PIO_IDX + 1U)
+
+/*
+ * Slots of the per-VM I/O exit statistics: one per port I/O handler, one
+ * per MMIO handler, then the default handlers and the requests forwarded
+ * to the DM.
+ */
+#define IO_STAT_SLOT_MMIO0		EMUL_PIO_IDX_MAX
+#define IO_STAT_SLOT_PIO_DEFAULT	(IO_STAT_SLOT_MMIO0 + CONFIG_MAX_EMULATED_MMIO_REGIONS)
+#define IO_STAT_SLOT_MMIO_DEFAULT	(IO_STAT_SLOT_PIO_DEFAULT + 1U)
+#define IO_STAT_SLOT_DM_PIO		(IO_STAT_SLOT_MMIO_DEFAULT + 1U)
+#define IO_STAT_SLOT_DM_MMIO		(IO_STAT_SLOT_DM_PIO + 1U)
+#define IO_STAT_SLOT_NUM		(IO_STAT_SLOT_DM_MMIO + 1U)
+#define IO_STAT_SLOT_NONE		0xffffU
 /**
  * @brief The handler of VM exits on I/O instructions
  *
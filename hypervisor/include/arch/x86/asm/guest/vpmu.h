@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/**
+ * @file vpmu.h
+ *
+ * @brief Architectural PMU virtualization
+ */
+#ifndef VPMU_H
+#define VPMU_H
+
+/**
+ * @brief Architectural PMU virtualization
+ *
+ * A VM with GUEST_FLAG_VPMU gets an architectural PMU of version 2: general
+ * purpose and fixed counters, global control/status and PMIs delivered
+ * through its vLAPIC LVT performance counter register. The counters are
+ * loaded on the physical PMU while the vCPU runs, so counter reads and
+ * writes don't exit, and IA32_PERF_GLOBAL_CTRL is switched on VM entry and
+ * exit so nothing is counted in the hypervisor.
+ *
+ * GUEST_FLAG_PMU_PASSTHROUGH takes precedence: such a VM owns the physical
+ * PMU exclusively, and is meant for partitioned RT VMs.
+ *
+ * @addtogroup acrn_vcpu ACRN vcpu
+ * @{
+ */
+
+#define VPMU_MAX_GP_COUNTERS		8U
+#define VPMU_MAX_FIXED_COUNTERS		3U
+
+struct acrn_vpmu {
+	uint64_t evtsel[VPMU_MAX_GP_COUNTERS];
+	uint64_t pmc[VPMU_MAX_GP_COUNTERS];
+	uint64_t fixed_ctr[VPMU_MAX_FIXED_COUNTERS];
+	uint64_t fixed_ctr_ctrl;
+	/* overflow bits taken off the physical IA32_PERF_GLOBAL_STATUS */
+	uint64_t global_status;
+};
+
+struct acrn_vm;
+struct acrn_vcpu;
+
+/**
+ * @brief Probe the physical PMU, called once on the BSP
+ *
+ * @return None
+ */
+void init_vpmu_caps(void);
+
+/**
+ * @brief Whether the VM has a virtualized PMU
+ *
+ * @param[in] vm The VM to check
+ *
+ * @return true if GUEST_FLAG_VPMU is set, the PMU isn't passed through and the
+ *	   platform has an architectural PMU of version 2 or later
+ */
+bool is_vpmu_configured(const struct acrn_vm *vm);
+
+/**
+ * @brief Guest CPUID leaf 0AH of a VM with a virtualized PMU
+ *
+ * @return None
+ */
+void vpmu_cpuid_leaf_0ah(uint32_t *eax, uint32_t *ebx, uint32_t *ecx, uint32_t *edx);
+
+/**
+ * @brief Whether a counter MSR may be passed through to a VM with a virtualized PMU
+ *
+ * @param[in] msr IA32_PMCx or IA32_FIXED_CTRx
+ *
+ * @return true if the counter is exposed to the guest
+ */
+bool is_vpmu_counter_msr(uint32_t msr);
+
+/**
+ * @brief Reset the vPMU state of a vCPU, called on VMCS initialization
+ *
+ * @param[inout] vcpu The pointer that points VCPU data structure
+ *
+ * @return None
+ */
+void init_vpmu(struct acrn_vcpu *vcpu);
+
+/**
+ * @brief Emulate RDMSR of a PMU MSR
+ *
+ * @param[in] vcpu The pointer that points VCPU data structure
+ * @param[in] msr The PMU MSR to read
+ * @param[out] val The value read
+ *
+ * @return 0 on success, -EACCES if the MSR isn't exposed to the guest
+ */
+int32_t vpmu_read_msr(struct acrn_vcpu *vcpu, uint32_t msr, uint64_t *val);
+
+/**
+ * @brief Emulate WRMSR of a PMU MSR
+ *
+ * @param[inout] vcpu The pointer that points VCPU data structure
+ * @param[in] msr The PMU MSR to write
+ * @param[in] val The value to write
+ *
+ * @return 0 on success, -EACCES if the MSR isn't exposed to the guest or
+ *	   reserved bits are set
+ */
+int32_t vpmu_write_msr(struct acrn_vcpu *vcpu, uint32_t msr, uint64_t val);
+
+/**
+ * @brief Save the vPMU state of a vCPU being switched out
+ *
+ * @return None
+ */
+void vpmu_save(struct acrn_vcpu *vcpu);
+
+/**
+ * @brief Load the vPMU state of a vCPU being switched in
+ *
+ * @return None
+ */
+void vpmu_restore(struct acrn_vcpu *vcpu);
+
+/**
+ * @brief Handle a PMI which caused a VM exit of a vCPU
+ *
+ * Overflows of the guest counters are latched into the guest's global
+ * status and injected through its LVT performance counter register.
+ *
+ * @param[inout] vcpu The vCPU which was running when the PMI arrived
+ *
+ * @return true if the vCPU owns the PMU and the PMI has been handled
+ *	   (including its EOI), false if it is the hypervisor's
+ */
+bool vpmu_handle_pmi(struct acrn_vcpu *vcpu);
+
+/**
+ * @}
+ */
+#endif /* VPMU_H */
@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IDLE_H
+#define IDLE_H
+
+#include <types.h>
+#include <asm/cpu_caps.h>
+
+/* polling plus MWAIT C1 plus the MWAIT states of the board's Cx table */
+#define IDLE_MAX_STATES		(MAX_CX_ENTRY + 2U)
+#define IDLE_STATE_POLL		0U
+#define IDLE_STATE_C1		1U
+#define IDLE_HISTORY_NUM	8U
+
+struct idle_state {
+	uint32_t mwait_hint;		/* EAX of MWAIT */
+	uint32_t exit_latency;		/* in us */
+	uint32_t target_residency;	/* in us, the break even idle time */
+};
+
+struct idle_stat {
+	uint64_t usage;
+	uint64_t residency;	/* in TSC ticks */
+	uint64_t above;		/* woken up before the target residency, the state was too deep */
+	uint64_t below;		/* a deeper state would have paid off */
+};
+
+struct cpu_idle {
+	uint32_t history[IDLE_HISTORY_NUM];	/* the last idle intervals in us */
+	uint32_t hist_idx;
+	struct idle_stat stats[IDLE_MAX_STATES];
+};
+
+void init_idle_states(void);
+const struct idle_state *get_idle_states(uint32_t *nr);
+uint32_t get_idle_state_limit(uint16_t pcpu_id);
+void cpu_do_idle(uint16_t pcpu_id);
+
+#endif /* IDLE_H */
@@ -61,6 +61,10 @@
 #define MSR_IA32_PERFEVTSEL1			0x00000187U
 #define MSR_IA32_PERFEVTSEL2			0x00000188U
 #define MSR_IA32_PERFEVTSEL3			0x00000189U
+#define MSR_IA32_PERFEVTSEL4			0x0000018AU
+#define MSR_IA32_PERFEVTSEL5			0x0000018BU
+#define MSR_IA32_PERFEVTSEL6			0x0000018CU
+#define MSR_IA32_PERFEVTSEL7			0x0000018DU
 #define MSR_IA32_PERF_STATUS			0x00000198U
 #define MSR_IA32_PERF_CTL			0x00000199U
 #define MSR_IA32_CLOCK_MODULATION		0x0000019AU
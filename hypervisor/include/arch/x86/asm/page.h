@@ -44,4 +44,5 @@ struct page_pool {
 
 struct page *alloc_page(struct page_pool *pool);
 void free_page(struct page_pool *pool, struct page *page);
+uint64_t get_used_page_num(struct page_pool *pool);
 #endif /* PAGE_H */
@@ -19,6 +19,10 @@
 #include <asm/gdt.h>
 #include <asm/security.h>
 #include <asm/vm_config.h>
+#include <asm/idle.h>
+
+/* one pending bit per ptirq entry, see ptirq_enqueue_softirq() */
+#define PTIRQ_BITMAP_ARRAY_SIZE	INT_DIV_ROUNDUP(CONFIG_MAX_PT_IRQ_ENTRIES, 64U)
 
 struct per_cpu_region {
 	/* vmxon_region MUST be 4KB-aligned */
@@ -26,6 +30,10 @@ struct per_cpu_region {
 	void *vmcs_run;
 #ifdef HV_DEBUG
 	struct shared_buf *sbuf[ACRN_SBUF_ID_MAX];
+	uint64_t trace_evfilter[ACRN_TRACE_EVMASK_WORDS];	/* bit set: event index not traced */
+	uint64_t trace_last_tsc;	/* v2 trace: TSC of the last record */
+	uint32_t trace_sync_cnt;	/* v2 trace: records left until the next sync record */
+	uint16_t trace_format;		/* ACRN_TRACE_FORMAT_V2 or v1, only changed while tracing is stopped */
 	char logbuf[LOG_MESSAGE_MAX_SIZE];
 	uint32_t npk_log_ref;
 #endif
@@ -55,13 +63,25 @@ struct per_cpu_region {
 	uint32_t lapic_ldr;
 	uint32_t softirq_servicing;
 	struct smp_call_info_data smp_call_info;
-	struct list_head softirq_dev_entry_list;
+	/*
+	 * ptirq_pending is set from interrupt context with locked bit operations;
+	 * ptirq_batch is a snapshot owned by the SOFTIRQ_PTDEV handler only,
+	 * popped round-robin from ptirq_next on.
+	 */
+	uint64_t ptirq_pending[PTIRQ_BITMAP_ARRAY_SIZE] __aligned(8);
+	uint64_t ptirq_batch[PTIRQ_BITMAP_ARRAY_SIZE];
+	uint16_t ptirq_next;
 #ifdef PROFILING_ON
 	struct profiling_info_wrapper profiling_info;
 #endif
 	uint64_t shutdown_vm_bitmap;
 	uint64_t tsc_suspend;
 	struct acrn_vcpu *whose_iwkey;
+	/* vCPU whose extended state is loaded, switched lazily, see context_switch_in() */
+	struct acrn_vcpu *whose_xsave;
+	struct acrn_exit_stat xsave_switch;	/* cost of the XSAVE state switches */
+	uint64_t xsave_switch_skipped;		/* switches in of the vCPU whose state is loaded */
+	struct cpu_idle cpu_idle;
 	/*
 	 * We maintain a per-pCPU array of vCPUs. vCPUs of a VM won't
 	 * share same pCPU. So the maximum possible # of vCPUs that can
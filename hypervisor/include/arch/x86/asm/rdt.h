@@ -20,6 +20,14 @@ enum {
 #define RDT_RESID_L2    2U
 #define RDT_RESID_MBA   3U
 
+/* RDT monitoring event IDs of IA32_QM_EVTSEL */
+#define RDT_MON_EVT_OCCUPANCY	1U	/* L3 occupancy */
+#define RDT_MON_EVT_MBM_TOTAL	2U	/* total memory bandwidth */
+#define RDT_MON_EVT_MBM_LOCAL	3U	/* local memory bandwidth */
+
+#define RDT_RMID_MASK		0x3FFUL	/* IA32_PQR_ASSOC[9:0] */
+#define RDT_MON_INVALID		(~0UL)
+
 extern const uint16_t hv_clos;
 
 /* The intel Resource Director Tech(RDT) based Allocation Tech support */
@@ -43,10 +51,24 @@ struct rdt_info {
 	struct platform_clos_info *platform_clos_array; /* user configured mask and MSR info for each CLOS*/
 };
 
+/* The intel Resource Director Tech(RDT) based Monitoring support (CMT/MBM) of the L3 */
+struct rdt_mon_info {
+	uint32_t max_rmid;	/* Highest RMID of the L3, 0 indicates monitoring is not supported */
+	uint32_t upscale;	/* Bytes per counter unit */
+	uint32_t events;	/* Bit n set if event ID n is supported */
+	uint32_t mbm_width;	/* Width of the MBM counters in bits */
+};
+
 void init_rdt_info(void);
 void setup_clos(uint16_t pcpu_id);
 uint64_t clos2pqr_msr(uint16_t clos);
 bool is_platform_rdt_capable(void);
 const struct rdt_info *get_rdt_res_cap_info(int res);
+const struct rdt_mon_info *get_rdt_mon_info(void);
+bool is_rdt_mon_capable(void);
+uint32_t vm_rmid(uint16_t vm_id);
+uint64_t rdt_read_mon_counter(uint32_t rmid, uint32_t evt);
+void rdt_write_clos_msr(int res, uint16_t clos, uint32_t val);
+uint16_t get_rdt_num_closids(void);
 
 #endif	/* RDT_H */
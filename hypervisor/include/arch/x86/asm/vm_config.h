@@ -59,7 +59,8 @@
 #define DM_OWNED_GUEST_FLAG_MASK	0UL
 #else
 #define DM_OWNED_GUEST_FLAG_MASK	(GUEST_FLAG_SECURE_WORLD_ENABLED | GUEST_FLAG_LAPIC_PASSTHROUGH \
-					| GUEST_FLAG_RT | GUEST_FLAG_IO_COMPLETION_POLLING | GUEST_FLAG_PMU_PASSTHROUGH)
+					| GUEST_FLAG_RT | GUEST_FLAG_IO_COMPLETION_POLLING | GUEST_FLAG_PMU_PASSTHROUGH \
+					| GUEST_FLAG_VPMU | GUEST_FLAG_VIOMMU)
 #endif
 
 /* ACRN guest severity */
@@ -199,6 +200,9 @@ struct acrn_vm_config {
 	struct vuart_config vuart[MAX_VUART_NUM_PER_VM];/* vuart configuration for VM */
 
 	bool pt_tpm2;
+	uint32_t max_idle_latency;			/* The longest C-state exit latency in us the pCPUs
+							 * of the VM may see, 0 for no limit.
+							 */
 	struct acrn_mmiodev mmiodevs[MAX_MMIO_DEV_NUM];
 
 	bool pt_p2sb_bar; /* whether to passthru p2sb bridge to pre-launched VM or not */
@@ -60,8 +60,12 @@ enum acpi_dmar_scope_type {
 	ACPI_DMAR_SCOPE_TYPE_RESERVED       = 6 /* 6 and greater are reserved */
 };
 
+/* shadow domains a vIOMMU can create for the guest domains of its VM */
+#define IOMMU_SHADOW_DOMAINS_PER_VM	8U
+
 struct iommu_domain {
 	uint16_t vm_id;
+	uint16_t domain_id;
 	uint32_t addr_width;   /* address width of the domain */
 	uint64_t trans_table_ptr;
 };
@@ -517,6 +521,47 @@ struct dmar_entry {
 	uint64_t hi_64;
 };
 
+#define ROOT_ENTRY_LOWER_PRESENT_POS        (0U)
+#define ROOT_ENTRY_LOWER_PRESENT_MASK       (1UL << ROOT_ENTRY_LOWER_PRESENT_POS)
+#define ROOT_ENTRY_LOWER_CTP_POS            (12U)
+#define ROOT_ENTRY_LOWER_CTP_MASK           (0xFFFFFFFFFFFFFUL << ROOT_ENTRY_LOWER_CTP_POS)
+
+#define CTX_ENTRY_UPPER_AW_POS          (0U)
+#define CTX_ENTRY_UPPER_AW_MASK         (0x7UL << CTX_ENTRY_UPPER_AW_POS)
+#define CTX_ENTRY_UPPER_DID_POS         (8U)
+#define CTX_ENTRY_UPPER_DID_MASK        (0xFFFFUL << CTX_ENTRY_UPPER_DID_POS)
+#define CTX_ENTRY_LOWER_P_POS           (0U)
+#define CTX_ENTRY_LOWER_P_MASK          (0x1UL << CTX_ENTRY_LOWER_P_POS)
+#define CTX_ENTRY_LOWER_FPD_POS         (1U)
+#define CTX_ENTRY_LOWER_FPD_MASK        (0x1UL << CTX_ENTRY_LOWER_FPD_POS)
+#define CTX_ENTRY_LOWER_TT_POS          (2U)
+#define CTX_ENTRY_LOWER_TT_MASK         (0x3UL << CTX_ENTRY_LOWER_TT_POS)
+#define CTX_ENTRY_LOWER_SLPTPTR_POS     (12U)
+#define CTX_ENTRY_LOWER_SLPTPTR_MASK    (0xFFFFFFFFFFFFFUL <<  CTX_ENTRY_LOWER_SLPTPTR_POS)
+
+static inline uint64_t dmar_get_bitslice(uint64_t var, uint64_t mask, uint32_t pos)
+{
+	return ((var & mask) >> pos);
+}
+
+static inline uint64_t dmar_set_bitslice(uint64_t var, uint64_t mask, uint32_t pos, uint64_t val)
+{
+	return ((var & ~mask) | ((val << pos) & mask));
+}
+
+/* translation type */
+#define DMAR_CTX_TT_UNTRANSLATED    0x0UL
+#define DMAR_CTX_TT_ALL             0x1UL
+#define DMAR_CTX_TT_PASSTHROUGH     0x2UL
+
+#define DMAR_INV_STATUS_WRITE_SHIFT	5U
+#define DMAR_INV_CONTEXT_CACHE_DESC	0x01UL
+#define DMAR_INV_IOTLB_DESC		0x02UL
+#define DMAR_INV_IEC_DESC		0x04UL
+#define DMAR_INV_WAIT_DESC		0x05UL
+#define DMAR_INV_STATUS_WRITE		(1UL << DMAR_INV_STATUS_WRITE_SHIFT)
+#define DMAR_INV_INTR_FLAG		(1UL << 4U)
+
 union dmar_ir_entry {
 	struct dmar_entry value;
 
@@ -629,6 +674,38 @@ int32_t move_pt_device(const struct iommu_domain *from_domain, const struct iomm
  */
 struct iommu_domain *create_iommu_domain(uint16_t vm_id, uint64_t translation_table, uint32_t addr_width);
 
+/**
+ * @brief Create a shadow iommu domain for a guest domain of a VM.
+ *
+ * The domain translates with a page table the hypervisor builds from a page table of the VM's
+ * vIOMMU. Each shadow domain gets a domain id of its own, above the ones of the VM domains.
+ *
+ * @param[in] vm_id vm_id of the VM the domain created for
+ * @param[in] index index of the shadow domain within the VM
+ * @param[in] translation_table the physical address of the shadow page table
+ * @param[in] addr_width address width of the domain
+ *
+ * @return Pointer to the created iommu_domain
+ *
+ * @retval NULL when \p translation_table is 0 or the domain id is not supported by all DMAR units
+ *
+ * @pre vm_id < CONFIG_MAX_VM_NUM
+ * @pre index < IOMMU_SHADOW_DOMAINS_PER_VM
+ */
+struct iommu_domain *create_shadow_iommu_domain(uint16_t vm_id, uint16_t index, uint64_t translation_table,
+	uint32_t addr_width);
+
+/**
+ * @brief Invalidate the IOTLB entries of a domain.
+ *
+ * Issue a domain selective IOTLB invalidation on all DMAR units, which are not ignored on the platform.
+ *
+ * @param[in] domain iommu domain to flush
+ *
+ * @pre domain != NULL
+ */
+void flush_iommu_domain(const struct iommu_domain *domain);
+
 /**
  * @brief Destroy the specific iommu domain.
  *
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2026 Intel Corporation.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef COMMON_BOOT_WORK_H
+#define COMMON_BOOT_WORK_H
+
+#include <types.h>
+
+/**
+ * @brief Boot time work dispatcher and boot phase log
+ *
+ * While the pre-launched VMs and the Service VM are prepared, every pCPU
+ * runs launch_vms() for the VMs it is the BSP of, then helps the others
+ * with the chunks they have published through boot_work_run(), and enters
+ * the scheduler once none is left: its own VMs don't wait for the slowest
+ * pCPU.
+ */
+
+#define BOOT_PHASE_MAX		64U
+
+typedef void (*boot_work_fn)(void *data, uint32_t idx);
+
+struct boot_phase {
+	const char *name;
+	uint16_t vm_id;		/* ACRN_INVALID_VMID if not about a VM */
+	uint16_t pcpu_id;
+	uint64_t tick;
+};
+
+/**
+ * @brief Set the pCPUs "all VMs launched" is logged after
+ *
+ * @param[in] pcpu_mask The pCPUs going to call launch_vms()
+ */
+void init_boot_work(uint64_t pcpu_mask);
+
+/**
+ * @brief Run fn(data, 0) ... fn(data, nr - 1), spread over the helping pCPUs
+ *
+ * The caller runs chunks too, so it also works when no pCPU helps, e.g.
+ * once the system has booted. Returns when every chunk has completed.
+ *
+ * @param[in] fn The work function, called from any pCPU
+ * @param[in] data The argument of fn
+ * @param[in] nr The number of chunks
+ */
+void boot_work_run(boot_work_fn fn, void *data, uint32_t nr);
+
+/**
+ * @brief Run chunks published by other pCPUs, until no job has any left
+ *
+ * @return None
+ */
+void boot_work_help(void);
+
+/**
+ * @brief The calling pCPU is done with launch_vms()
+ *
+ * @return None
+ */
+void boot_work_done(void);
+
+/**
+ * @brief Copy to guest memory with boot_work_run() in chunks of 2MB
+ *
+ * @return 0 on success, -EINVAL if a part of the range isn't mapped
+ */
+int32_t boot_copy_to_gpa(struct acrn_vm *vm, void *h_ptr, uint64_t gpa, uint32_t size);
+
+/**
+ * @brief Log the time a boot phase is reached
+ *
+ * @param[in] name The phase, a string constant
+ * @param[in] vm_id The VM concerned or ACRN_INVALID_VMID
+ */
+void boot_phase(const char *name, uint16_t vm_id);
+
+/**
+ * @brief The boot phase log
+ *
+ * @param[out] nr The number of entries
+ *
+ * @return The entries, in the order they were logged
+ */
+const struct boot_phase *get_boot_phases(uint32_t *nr);
+
+#endif /* COMMON_BOOT_WORK_H */
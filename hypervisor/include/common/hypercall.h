@@ -153,6 +153,75 @@ int32_t hcall_pause_vm(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64
  */
 int32_t hcall_set_vcpu_regs(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64_t param1, uint64_t param2);
 
+/**
+ * @brief get VM exit statistics of a vCPU
+ *
+ * Read the always-on per exit reason counters and latency histograms of
+ * one vCPU of the target VM.
+ *
+ * @param vcpu Pointer to vCPU that initiates the hypercall
+ * @param target_vm Pointer to target VM data structure
+ * @param param1 relative vmid to service vm
+ * @param param2 guest physical address. This gpa points to
+ *              struct acrn_vcpu_exit_stats
+ *
+ * @pre is_service_vm(vcpu->vm)
+ * @return 0 on success, non-zero on error.
+ */
+int32_t hcall_get_vcpu_exit_stats(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64_t param1, uint64_t param2);
+
+/**
+ * @brief get I/O handler exit statistics of a VM
+ *
+ * Read the exit counters and latency histograms of the port I/O and MMIO
+ * handlers of the target VM, starting from handler slot 'first'.
+ *
+ * @param vcpu Pointer to vCPU that initiates the hypercall
+ * @param target_vm Pointer to target VM data structure
+ * @param param1 relative vmid to service vm
+ * @param param2 guest physical address. This gpa points to
+ *              struct acrn_vm_io_stats
+ *
+ * @pre is_service_vm(vcpu->vm)
+ * @return 0 on success, non-zero on error.
+ */
+int32_t hcall_get_vm_io_stats(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64_t param1, uint64_t param2);
+
+/**
+ * @brief read the RDT monitoring counters
+ *
+ * Read the L3 occupancy and memory bandwidth of each VM, the CLOS settings
+ * in effect and the state of the RDT control loop.
+ *
+ * @param vcpu Pointer to vCPU that initiates the hypercall
+ * @param target_vm not used
+ * @param param1 guest physical address. This gpa points to
+ *              struct acrn_rdt_mon
+ * @param param2 not used
+ *
+ * @pre is_service_vm(vcpu->vm)
+ * @return 0 on success, -ENODEV if the platform can't monitor the L3,
+ *	   other non-zero values on error.
+ */
+int32_t hcall_get_rdt_mon(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64_t param1, uint64_t param2);
+
+/**
+ * @brief configure the RDT control loop
+ *
+ * Enable, update or disable the loop which resizes the L3 CBMs and MBA
+ * delays of best effort VMs to keep an RT VM below its LLC miss rate target.
+ *
+ * @param vcpu Pointer to vCPU that initiates the hypercall
+ * @param target_vm not used
+ * @param param1 guest physical address. This gpa points to
+ *              struct acrn_rdt_ctrl
+ * @param param2 not used
+ *
+ * @pre is_service_vm(vcpu->vm)
+ * @return 0 on success, non-zero on error.
+ */
+int32_t hcall_set_rdt_ctrl(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64_t param1, uint64_t param2);
+
 /**
  * @brief set or clear IRQ line
  *
@@ -346,6 +415,23 @@ int32_t hcall_add_vdev(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64
  */
 int32_t hcall_remove_vdev(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64_t param1, uint64_t param2);
 
+/**
+ * @brief Set the config space shadow of a DM-emulated PCI device.
+ *
+ * Registered config space dwords are answered by hypervisor without
+ * forwarding the read to the DM.
+ *
+ * @param vcpu Pointer to vCPU that initiates the hypercall
+ * @param target_vm Pointer to target VM data structure
+ * @param param1 not used
+ * @param param2 guest physical address. This gpa points to data structure of
+ *              acrn_pci_cfg_shadow including the vBDF and cached config space
+ *
+ * @pre is_service_vm(vcpu->vm)
+ * @return 0 on success, non-zero on error.
+ */
+int32_t hcall_set_pci_cfg_shadow(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64_t param1, uint64_t param2);
+
 /**
  * @brief Set interrupt mapping info of ptdev.
  *
@@ -554,6 +640,34 @@ int32_t hcall_setup_hv_npk_log(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm
  */
 int32_t hcall_get_hw_info(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64_t param1, uint64_t param2);
 
+/**
+ * @brief Set which trace events are recorded
+ *
+ * @param vcpu Pointer to vCPU that initiates the hypercall
+ * @param target_vm not used
+ * @param param1 Guest physical address pointing to struct acrn_trace_filter
+ * @param param2 not used
+ *
+ * @pre is_service_vm(vcpu->vm)
+ *
+ * @return 0 on success, non-zero on error.
+ */
+int32_t hcall_set_trace_filter(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64_t param1, uint64_t param2);
+
+/**
+ * @brief Select the trace record format
+ *
+ * @param vcpu Pointer to vCPU that initiates the hypercall
+ * @param target_vm not used
+ * @param param1 Guest physical address pointing to struct acrn_trace_format
+ * @param param2 not used
+ *
+ * @pre is_service_vm(vcpu->vm)
+ *
+ * @return 0 on success, non-zero on error.
+ */
+int32_t hcall_set_trace_format(struct acrn_vcpu *vcpu, struct acrn_vm *target_vm, uint64_t param1, uint64_t param2);
+
 /**
  * @brief Execute profiling operation
  *
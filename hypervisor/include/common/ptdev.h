@@ -136,7 +136,6 @@ struct ptirq_remapping_info {
 	bool active;	/* true=active, false=inactive*/
 	uint32_t allocated_pirq;
 	uint32_t polarity; /* 0=active high, 1=active low*/
-	struct list_head softirq_node;
 	struct msi_info vmsi;
 	struct msi_info pmsi;
 	uint16_t irte_idx;
@@ -204,7 +203,7 @@ void ptirq_softirq(uint16_t pcpu_id);
  * During the hypervisor cpu initialization stage, this function:
  * - init global spinlock for ptdev (on BSP)
  * - register SOFTIRQ_PTDEV handler (on BSP)
- * - init the softirq entry list for each CPU
+ * - init the softirq pending bitmap for each CPU
  *
  */
 void ptdev_init(void);
@@ -222,9 +221,10 @@ void ptdev_init(void);
 void ptdev_release_all_entries(const struct acrn_vm *vm);
 
 /**
- * @brief Dequeue an entry from per cpu ptdev softirq queue.
+ * @brief Dequeue an entry from per cpu ptdev softirq pending bitmap.
  *
- * Dequeue an entry from the ptdev softirq queue on the specific physical cpu.
+ * Dequeue an entry from the ptdev softirq pending bitmap on the specific physical
+ * cpu. The pending bitmap is fetched in batches without disabling interrupts.
  *
  * @param[in]    pcpu_id physical cpu id
  *
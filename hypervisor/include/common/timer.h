@@ -120,6 +120,15 @@ int32_t add_timer(struct hv_timer *timer);
  */
 void del_timer(struct hv_timer *timer);
 
+/**
+ * @brief Get the expiry of the nearest timer of the current pCPU.
+ *
+ * @return TSC deadline of the first timer in the list, 0 if there is none
+ *
+ * @remark Call it with interrupts disabled.
+ */
+uint64_t get_next_timer_deadline(void);
+
 /**
  * @brief Initialize timer.
  *
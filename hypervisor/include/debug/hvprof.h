@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef HVPROF_H
+#define HVPROF_H
+
+#include <types.h>
+
+/*
+ * Hypervisor self-profiler: fixed counter 1 (unhalted core cycles) counts
+ * in VMX root mode only and raises an NMI every period cycles. The NMI
+ * handler records the interrupted host RIP and a frame pointer call chain
+ * into the pCPU's ACRN_HVPROF shared buffer, one framed record per sample.
+ * Debug builds only, they are the ones built with frame pointers.
+ */
+
+#define HVPROF_MAX_DEPTH		16U
+#define HVPROF_DEFAULT_PERIOD		1000000UL
+
+/* payload of an ACRN_HVPROF sbuf record, ip[0] is the interrupted RIP */
+struct hvprof_sample {
+	uint64_t tsc;
+	uint16_t pcpu_id;
+	uint16_t depth;		/* valid entries of ip[] */
+	uint32_t reserved;
+	uint64_t ip[HVPROF_MAX_DEPTH];
+};
+
+struct intr_excp_ctx;
+struct acrn_vm;
+
+int32_t hvprof_start(uint64_t period);
+void hvprof_stop(void);
+void hvprof_vmenter(void);
+void hvprof_vmexit(void);
+int32_t hvprof_claim_vm(const struct acrn_vm *vm, uint64_t pcpu_bitmap);
+void hvprof_release_vm(const struct acrn_vm *vm, uint64_t pcpu_bitmap);
+
+/**
+ * @brief Take a sample if the NMI was raised by the self-profiler
+ *
+ * @param[in] ctx The interrupted context
+ *
+ * @return true if the NMI was the profiler's and has been consumed
+ */
+bool hvprof_handle_nmi(const struct intr_excp_ctx *ctx);
+
+#endif /* HVPROF_H */
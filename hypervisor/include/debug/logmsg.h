@@ -45,8 +45,47 @@ void asm_assert(int32_t line, const char *file, const char *txt);
 
 #endif /* HV_DEBUG */
 
+/* at most LOG_RATELIMIT_BURST messages per call site and interval */
+#define LOG_RATELIMIT_INTERVAL_MS	5000UL
+#define LOG_RATELIMIT_BURST		10
+
+struct logmsg_ratelimit {
+	uint64_t begin;		/* start of the current interval, in ticks */
+	int32_t printed;	/* messages let through in this interval */
+	uint32_t missed;	/* messages suppressed in this interval */
+};
+
 void init_logmsg();
 
+/**
+ * @brief Print out the console messages buffered by all pCPUs
+ *
+ * Called periodically by the console timer.
+ */
+void flush_logmsg(void);
+
+/**
+ * @brief Buffer console messages for flush_logmsg() instead of printing them
+ *
+ * LOG_FATAL and LOG_ACRN messages are still printed right away, after
+ * everything buffered.
+ * Turning it off doesn't flush the buffers, the next message printed does.
+ */
+void defer_console_logmsg(bool deferred);
+
+/**
+ * @brief Whether a message of a rate limited call site may be logged
+ *
+ * Messages below every log level are neither logged nor counted. The
+ * number of suppressed messages is logged with the call site when the next
+ * interval starts.
+ *
+ * @param[inout] rl The state of the call site
+ * @param[in] severity The severity of the message
+ * @param[in] func The function of the call site
+ */
+bool logmsg_ratelimit(struct logmsg_ratelimit *rl, uint32_t severity, const char *func);
+
 /*
  * @pre the severity > 0
  */
@@ -117,6 +156,18 @@ void vprintf(const char *fmt, va_list args);
 		}                                               \
 	} while (0)
 
+#define pr_ratelimited(severity, ...)					\
+	do {								\
+		static struct logmsg_ratelimit rl_;			\
+		if (logmsg_ratelimit(&rl_, (severity), __func__)) {	\
+			do_logmsg((severity), pr_prefix __VA_ARGS__);	\
+		}							\
+	} while (0)
+
+#define pr_err_ratelimited(...)		pr_ratelimited(LOG_ERROR, __VA_ARGS__)
+#define pr_warn_ratelimited(...)	pr_ratelimited(LOG_WARNING, __VA_ARGS__)
+#define pr_info_ratelimited(...)	pr_ratelimited(LOG_INFO, __VA_ARGS__)
+
 #define panic(...) 							\
 	do { pr_fatal("PANIC: %s line: %d\n", __func__, __LINE__);	\
 		pr_fatal(__VA_ARGS__); 					\
@@ -41,6 +41,7 @@ enum {
 	ACRN_HVLOG,
 	ACRN_SEP,
 	ACRN_SOCWATCH,
+	ACRN_HVPROF,
 	ACRN_SBUF_ID_MAX,
 };
 
@@ -58,12 +59,60 @@ struct shared_buf {
 	uint32_t padding[6];
 };
 
+/*
+ * Framing of variable-length records written by sbuf_put_record(): a
+ * record covers one or more whole elements and its first element starts
+ * with this header, so a reader can skip it without knowing its type.
+ * A buffer holds either framed records or plain elements, never both.
+ */
+struct sbuf_rec_hdr {
+	uint16_t nr_ele;	/* elements covered by the record, header included */
+	uint16_t len;		/* payload bytes following the header */
+	uint32_t reserved;
+};
+
+/*
+ * Space handed out by sbuf_reserve(). Filling it does not make anything
+ * visible to the reader; sbuf_commit() publishes the whole reservation
+ * with a single tail update.
+ */
+struct sbuf_resv {
+	uint32_t pos;		/* offset of the next byte to fill */
+	uint32_t end;		/* tail once committed */
+	uint32_t room;		/* bytes left to fill */
+};
 
 /**
  *@pre sbuf != NULL
  *@pre data != NULL
  */
 uint32_t sbuf_put(struct shared_buf *sbuf, uint8_t *data);
+
+/**
+ *@pre sbuf != NULL
+ *@pre data != NULL
+ */
+uint32_t sbuf_put_many(struct shared_buf *sbuf, const uint8_t *data, uint32_t nr_ele);
+
+/**
+ *@pre sbuf != NULL
+ *@pre data != NULL || len == 0U
+ */
+uint32_t sbuf_put_record(struct shared_buf *sbuf, const void *data, uint32_t len);
+
+/**
+ *@pre sbuf != NULL
+ *@pre resv != NULL
+ */
+uint32_t sbuf_reserve(struct shared_buf *sbuf, uint32_t nr_ele, struct sbuf_resv *resv);
+
+/**
+ *@pre sbuf != NULL
+ *@pre resv was filled by a successful sbuf_reserve() on sbuf
+ */
+void sbuf_resv_fill(struct shared_buf *sbuf, struct sbuf_resv *resv, const void *data, uint32_t len);
+void sbuf_commit(struct shared_buf *sbuf, const struct sbuf_resv *resv);
+
 int32_t sbuf_share_setup(uint16_t pcpu_id, uint32_t sbuf_id, uint64_t *hva);
 void sbuf_reset(void);
 uint32_t sbuf_next_ptr(uint32_t pos, uint32_t span, uint32_t scope);
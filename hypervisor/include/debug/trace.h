@@ -41,6 +41,26 @@
 
 #define TRACE_VMEXIT_UNHANDLED		0x20000U
 
+/*
+ * Map an event ID to its bit in the trace filter masks,
+ * see struct acrn_trace_filter.
+ */
+static inline uint32_t trace_event_index(uint32_t evid)
+{
+	uint32_t idx;
+
+	if (evid < ACRN_TRACE_EVIDX_VMEXIT) {
+		idx = evid;
+	} else if ((evid & ~0xffU) == TRACE_VMEXIT_ENTRY) {
+		idx = ACRN_TRACE_EVIDX_VMEXIT | (evid & 0xffU);
+	} else {
+		idx = ACRN_TRACE_EVIDX_OTHER;
+	}
+	return idx;
+}
+
+int32_t trace_set_filter(const struct acrn_trace_filter *filter);
+int32_t trace_set_format(const struct acrn_trace_format *fmt);
 void TRACE_2L(uint32_t evid, uint64_t e, uint64_t f);
 void TRACE_4I(uint32_t evid, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
 void TRACE_6C(uint32_t evid, uint8_t a1, uint8_t a2, uint8_t a3, uint8_t a4, uint8_t b1, uint8_t b2);
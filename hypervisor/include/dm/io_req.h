@@ -290,6 +290,7 @@ void register_mmio_emulation_handler(struct acrn_vm *vm,
  */
 void unregister_mmio_emulation_handler(struct acrn_vm *vm,
 					uint64_t start, uint64_t end);
+void init_emul_io(struct acrn_vm *vm);
 void deinit_emul_io(struct acrn_vm *vm);
 /**
  * @}
@@ -46,6 +46,7 @@
 
 #define REDIR_ENTRIES_HW	120U /* Service VM align with native ioapic */
 #define STATE_BITMAP_SIZE	INT_DIV_ROUNDUP(REDIR_ENTRIES_HW, 64U)
+#define VECTOR_BITMAP_SIZE	(256U >> 6U)
 
 #define IOAPIC_RTE_LOW_INTVEC	((uint32_t)IOAPIC_RTE_INTVEC)
 
@@ -61,6 +62,8 @@ struct acrn_single_vioapic {
 	union ioapic_rte rtbl[REDIR_ENTRIES_HW];
 	/* pin_state status bitmap: 1 - high, 0 - low */
 	uint64_t pin_state[STATE_BITMAP_SIZE];
+	/* the vectors a guest EOI has to be reported for, see vioapic_update_eoi_vectors() */
+	uint64_t eoi_vectors[VECTOR_BITMAP_SIZE];
 };
 
 /*
@@ -117,6 +120,17 @@ void	vioapic_set_irqline_nolock(const struct acrn_vm *vm, uint32_t vgsi, uint32_
 
 uint32_t get_vm_gsicount(const struct acrn_vm *vm);
 void	vioapic_broadcast_eoi(const struct acrn_vm *vm, uint32_t vector);
+
+/**
+ * @brief Check if a guest EOI of the vector has anything to do in the vIOAPICs
+ *
+ * @param[in] vm     Pointer to target VM
+ * @param[in] vector The EOIed vector
+ *
+ * @pre vm != NULL
+ * @return true if the vector belongs to a level triggered pin which may wait for its EOI
+ */
+bool	vioapic_need_eoi_exit(const struct acrn_vm *vm, uint32_t vector);
 void	vioapic_get_rte(const struct acrn_vm *vm, uint32_t vgsi, union ioapic_rte *rte);
 int32_t	vioapic_mmio_access_handler(struct io_request *io_req, void *handler_private_data);
 struct acrn_single_vioapic *vgsi_to_vioapic_and_vpin(const struct acrn_vm *vm, uint32_t vgsi, uint32_t *vpin);
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef VIOMMU_H
+#define VIOMMU_H
+
+#include <types.h>
+#include <asm/lib/spinlock.h>
+#include <asm/vtd.h>
+
+/**
+ * @file viommu.h
+ *
+ * @brief public APIs for the virtual VT-d of post-launched VMs
+ */
+
+#define VIOMMU_MAX_DOMAINS	IOMMU_SHADOW_DOMAINS_PER_VM
+
+/* A guest domain the VM's pass-through devices are attached to, shadowed into a host domain */
+struct viommu_domain {
+	struct iommu_domain *domain;	/* NULL if the slot is free */
+	uint64_t *table;		/* shadow PML4 */
+	uint64_t guest_table;		/* GPA of the guest PML4 */
+	uint16_t guest_did;
+	uint32_t nr_devs;
+	/* IOVA range invalidated by the guest and not synced yet, empty if start >= end */
+	uint64_t dirty_start;
+	uint64_t dirty_end;
+	/* GPAs the synced guest leaves point to, empty if start >= end */
+	uint64_t leaf_start;
+	uint64_t leaf_end;
+};
+
+/*
+ * Lock order: lock, then vpci->lock, then shadow_lock. The EPT changes only
+ * take shadow_lock, some of them come with vpci->lock held.
+ */
+struct acrn_viommu {
+	/* serializes the register accesses */
+	spinlock_t lock;
+	/* protects the shadow domains */
+	spinlock_t shadow_lock;
+	bool enabled;
+
+	uint32_t gsts;
+	uint64_t rtaddr;	/* RTADDR_REG */
+	uint64_t root_table;	/* latched by GCMD.SRTP */
+	uint64_t ccmd;
+	uint32_t fsts;
+	uint32_t fectl;
+	uint32_t fedata;
+	uint32_t feaddr;
+	uint32_t feuaddr;
+	uint64_t iqh;
+	uint64_t iqt;
+	uint64_t iqa;
+	uint32_t ics;
+	uint32_t iectl;
+	uint32_t iedata;
+	uint32_t ieaddr;
+	uint32_t ieuaddr;
+	uint64_t iva;
+	uint64_t iotlb;
+
+	struct viommu_domain domains[VIOMMU_MAX_DOMAINS];
+};
+
+struct acrn_vm;
+
+void reserve_buffer_for_viommu_pages(void);
+void viommu_init(struct acrn_vm *vm);
+void reset_viommu(struct acrn_vm *vm);
+void deinit_viommu(struct acrn_vm *vm);
+void viommu_ept_changed(struct acrn_vm *vm, uint64_t gpa, uint64_t size);
+
+#endif /* VIOMMU_H */
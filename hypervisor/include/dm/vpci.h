@@ -37,6 +37,17 @@
 #define VDEV_LIST_HASHBITS 4U
 #define VDEV_LIST_HASHSIZE (1U << VDEV_LIST_HASHBITS)
 
+/*
+ * Number of PCI buses per VM whose vdevs are indexed directly by devfn.
+ * vdevs on further buses are only reachable through the vdev hash list.
+ */
+#define VDEV_BDF_TBL_BUS_NUM	4U
+#define VDEV_BDF_TBL_DEVFN_NUM	256U
+
+/* Max number of config space shadows of DM-emulated devices per VM */
+#define VPCI_CFG_SHADOW_NUM	16U
+#define VPCI_CFG_SHADOW_DWORDS	64U
+
 struct pci_vbar {
 	bool is_mem64hi;	/* this is to indicate the high part of 64 bits MMIO bar */
 	uint64_t size;		/* BAR size */
@@ -149,6 +160,8 @@ struct pci_vdev {
 	 */
 	struct pci_vdev *parent_user;
 	struct pci_vdev *user;	/* NULL means this device is not used or is a zombie VF */
+	/* iommu domain a pass-through device is attached to, the VM's one unless its vIOMMU moved it */
+	const struct iommu_domain *iommu;
 	struct hlist_node link;
 	void *priv_data;
 };
@@ -169,6 +182,14 @@ struct pci_mmio_res {
 	uint64_t end;
 };
 
+/* Config space shadow of a DM-emulated PCI device of a post-launched VM */
+struct pci_cfg_shadow {
+	union pci_bdf vbdf;
+	uint64_t cached_map;	/* 0 means the shadow is free */
+	uint32_t wmask[VPCI_CFG_SHADOW_DWORDS];
+	uint32_t data[VPCI_CFG_SHADOW_DWORDS];
+};
+
 struct acrn_vpci {
 	spinlock_t lock;
 	union pci_cfg_addr_reg addr;
@@ -178,6 +199,14 @@ struct acrn_vpci {
 	struct pci_mmio_res res64; 	/* 64-bit mmio start/end address */
 	struct pci_vdev pci_vdevs[CONFIG_MAX_PCI_DEV_NUM];
 	struct hlist_head vdevs_hlist_heads [VDEV_LIST_HASHSIZE];
+	/*
+	 * Direct vBDF index mirroring the first match of vdevs_hlist_heads:
+	 * bus_tbl_idx[bus] is 1-based index into devfn_tbl, 0 means not indexed.
+	 */
+	uint8_t bus_tbl_idx[PCI_BUSMAX + 1U];
+	uint8_t bus_tbl_cnt;
+	struct pci_vdev *devfn_tbl[VDEV_BDF_TBL_BUS_NUM][VDEV_BDF_TBL_DEVFN_NUM];
+	struct pci_cfg_shadow cfg_shadows[VPCI_CFG_SHADOW_NUM];
 };
 
 struct acrn_vm;
@@ -187,9 +216,12 @@ extern const struct pci_vdev_ops vpci_bridge_ops;
 int32_t init_vpci(struct acrn_vm *vm);
 void deinit_vpci(struct acrn_vm *vm);
 struct pci_vdev *pci_find_vdev(struct acrn_vpci *vpci, union pci_bdf vbdf);
+bool is_pt_vdev(const struct pci_vdev *vdev);
 struct acrn_pcidev;
 int32_t vpci_assign_pcidev(struct acrn_vm *tgt_vm, struct acrn_pcidev *pcidev);
 int32_t vpci_deassign_pcidev(struct acrn_vm *tgt_vm, struct acrn_pcidev *pcidev);
+struct acrn_pci_cfg_shadow;
+int32_t vpci_set_cfg_shadow(struct acrn_vm *vm, const struct acrn_pci_cfg_shadow *shadow);
 struct pci_vdev *vpci_init_vdev(struct acrn_vpci *vpci, struct acrn_vm_pci_dev_config *dev_config, struct pci_vdev *parent_pf_vdev);
 
 static inline bool is_pci_io_bar(struct pci_vbar *vbar)
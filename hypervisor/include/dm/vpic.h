@@ -137,6 +137,7 @@ struct acrn_vpic {
 
 struct acrn_vm;
 void vpic_init(struct acrn_vm *vm);
+void reset_vpic(struct acrn_vm *vm);
 
 /**
  * @brief virtual PIC
@@ -32,8 +32,11 @@
 #include <types.h>
 #include <asm/lib/spinlock.h>
 #include <asm/vm_config.h>
+#include <timer.h>
 
 #define RX_BUF_SIZE		256U
+#define PCI_RX_BUF_SIZE		4096U	/* PCI vuarts get an enlarged RX FIFO */
+#define PCI_RX_BUF_NUM		(CONFIG_MAX_VM_NUM * 2U)
 #define TX_BUF_SIZE		8192U
 #define INVAILD_VUART_IDX	0xFFU
 
@@ -56,6 +59,38 @@ struct vuart_fifo {
 	uint32_t size;		/* size of the fifo */
 };
 
+/*
+ * Burst mode of the PCI vuart, located in its MMIO BAR right after the
+ * 16550 registers, so a legacy 8250 driver never touches it.
+ *
+ * Once enabled, every access to the data window moves 1 - 8 bytes at once,
+ * and RX interrupts towards the guest are coalesced until either
+ * intr_threshold bytes are buffered or intr_timeout_us elapsed.
+ */
+#define VUART_BURST_CTRL		0x100U	/* R/W, bit 0: enable */
+#define VUART_BURST_RX_AVAIL		0x104U	/* RO, bytes ready in the RX FIFO */
+#define VUART_BURST_TX_ROOM		0x108U	/* RO, bytes the peer can accept */
+#define VUART_BURST_INTR_THRESHOLD	0x10cU	/* R/W, RX bytes per interrupt */
+#define VUART_BURST_INTR_TIMEOUT	0x110U	/* R/W, microseconds */
+#define VUART_BURST_DATA		0x800U	/* 0x800 - 0xfff, data window */
+#define VUART_BURST_DATA_END		0x1000U
+
+#define VUART_BURST_CTRL_EN		0x1U
+#define VUART_BURST_DEF_THRESHOLD	64U
+#define VUART_BURST_DEF_TIMEOUT_US	100U
+
+struct vuart_burst {
+	bool enabled;
+	uint32_t intr_threshold;
+	uint32_t intr_timeout_us;
+	/*
+	 * Flushes a coalesced RX interrupt. Only armed and deleted on the pCPU
+	 * of the BSP vCPU of the vuart's VM, see burst_timer_vcpu().
+	 */
+	struct hv_timer intr_timer;
+	bool arm_pending;
+};
+
 struct acrn_vuart {
 	uint8_t data;		/* Data register (R/W) */
 	uint8_t ier;		/* Interrupt enable register (R/W) */
@@ -79,11 +114,13 @@ struct acrn_vuart {
 	struct acrn_vuart *target_vu; /* Pointer to target vuart */
 	struct acrn_vm *vm;
 	struct pci_vdev *vdev;	/* pci vuart */
+	struct vuart_burst burst;	/* pci vuart only */
 	spinlock_t lock;	/* protects all softc elements */
 };
 
 void init_legacy_vuarts(struct acrn_vm *vm, const struct vuart_config *vu_config);
 void deinit_legacy_vuarts(struct acrn_vm *vm);
+void init_pci_vuart_rx_bufs(void);
 void init_pci_vuart(struct pci_vdev *vdev);
 void deinit_pci_vuart(struct pci_vdev *vdev);
 
@@ -95,4 +132,6 @@ bool is_vuart_intx(const struct acrn_vm *vm, uint32_t intx_gsi);
 
 uint8_t vuart_read_reg(struct acrn_vuart *vu, uint16_t offset);
 void vuart_write_reg(struct acrn_vuart *vu, uint16_t offset, uint8_t value);
+uint64_t vuart_burst_read(struct acrn_vuart *vu, uint16_t offset, uint8_t size);
+void vuart_burst_write(struct acrn_vuart *vu, uint16_t offset, uint8_t size, uint64_t value);
 #endif /* VUART_H */
@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <types.h>
+#include <asm/lib/spinlock.h>
+
+/**
+ * @file slab.h
+ *
+ * @brief Fixed pools of same-sized objects with O(1) allocation
+ *
+ * The objects and the free list links are static arrays provided by the user
+ * of a cache. The links are kept out of the objects, so a free object keeps
+ * its contents (an initialized lock, a cleared active flag) and the objects
+ * can still be scanned as an array.
+ */
+
+#define SLAB_NAME_LEN		16U
+#define MAX_SLAB_CACHES		(CONFIG_MAX_VM_NUM + 8U)
+#define INVALID_SLAB_IDX	0xffffffffU
+
+struct slab_cache {
+	spinlock_t lock;
+	char name[SLAB_NAME_LEN];
+	uint8_t *objs;
+	uint32_t obj_size;
+	uint32_t nr_objs;
+	/* links[i]: the free object following object i, SLAB_IDX_USED if i is allocated */
+	uint32_t *links;
+	uint32_t free_head;
+
+	/* statistics */
+	uint32_t in_use;
+	uint32_t high_water;
+	uint64_t failures;
+
+	bool registered;
+};
+
+/**
+ * @brief Initialize a cache, all objects free
+ *
+ * The cache is listed for the statistics the first time it is initialized.
+ * The objects are not touched.
+ *
+ * @pre cache != NULL && objs != NULL && links != NULL
+ * @pre nr_objs < INVALID_SLAB_IDX
+ */
+void slab_init(struct slab_cache *cache, const char *name, void *objs, uint32_t obj_size,
+		uint32_t nr_objs, uint32_t *links);
+
+/**
+ * @return the index of the allocated object, INVALID_SLAB_IDX if the cache is exhausted
+ */
+uint32_t slab_alloc_idx(struct slab_cache *cache);
+
+/**
+ * @return the allocated object, NULL if the cache is exhausted
+ */
+void *slab_alloc(struct slab_cache *cache);
+
+/**
+ * @pre idx < cache->nr_objs and the object is allocated
+ */
+void slab_free_idx(struct slab_cache *cache, uint32_t idx);
+
+/**
+ * @pre obj is an allocated object of the cache
+ */
+void slab_free(struct slab_cache *cache, const void *obj);
+
+/**
+ * @return the idx-th cache ever initialized, NULL if there are less caches
+ */
+const struct slab_cache *get_slab_cache(uint32_t idx);
+
+#endif /* SLAB_H */
@@ -49,6 +49,10 @@
 #error "VIOAPIC_RTE_NUM must be larger than 23"
 #endif
 
+/* vIOMMU register page, reported to the guest by the DMAR table of the device model */
+#define VIOMMU_BASE	0xFED90000UL
+#define VIOMMU_SIZE	0x1000UL
+
 /* Generic VM flags from guest OS */
 #define GUEST_FLAG_SECURE_WORLD_ENABLED		(1UL << 0U)	/* Whether secure world is enabled */
 #define GUEST_FLAG_LAPIC_PASSTHROUGH		(1UL << 1U)  	/* Whether LAPIC is passed through */
@@ -62,6 +66,9 @@
 #define GUEST_FLAG_TEE				(1UL << 9U)	/* Whether the VM is TEE VM */
 #define GUEST_FLAG_REE				(1UL << 10U)	/* Whether the VM is REE VM */
 #define GUEST_FLAG_PMU_PASSTHROUGH	(1UL << 11U)    /* Whether PMU is passed through */
+#define GUEST_FLAG_VPMU			(1UL << 12U)	/* Whether the architectural PMU is virtualized */
+#define GUEST_FLAG_ZERO_COPY_MODULES	(1UL << 13U)	/* Whether boot modules are mapped into the VM in place */
+#define GUEST_FLAG_VIOMMU		(1UL << 14U)	/* Whether a virtual VT-d is exposed to the VM */
 
 
 /* TODO: We may need to get this addr from guest ACPI instead of hardcode here */
@@ -681,6 +688,301 @@ struct acrn_mmiodev {
 	} res[MMIODEV_RES_NUM];
 };
 
+#define ACRN_PCI_CFG_SHADOW_DWORDS	64U
+
+/**
+ * @brief Info to register a config space shadow of a DM-emulated PCI device
+ *
+ * the parameter for HC_SET_PCI_CFG_SHADOW hypercall. Reads of the dwords set in
+ * cached_map are answered by the hypervisor from data[] without an I/O request
+ * to the DM. Writes are always forwarded to the DM; a dword aligned 4-byte write
+ * to a cached dword is also merged into the shadow under wmask, any other write
+ * to a cached dword drops it from the shadow.
+ */
+struct acrn_pci_cfg_shadow {
+	/** virtual BDF of the device */
+	uint16_t vbdf;
+
+	/** Reserved for alignment and should be 0 */
+	uint16_t reserved[3];
+
+	/** bit n set means dword n of the config space is cached, 0 to unregister */
+	uint64_t cached_map;
+
+	/** writable bits of each cached dword */
+	uint32_t wmask[ACRN_PCI_CFG_SHADOW_DWORDS];
+
+	/** current value of each cached dword */
+	uint32_t data[ACRN_PCI_CFG_SHADOW_DWORDS];
+} __aligned(8);
+
+#define ACRN_EXIT_REASON_NUM	70U
+#define ACRN_EXIT_HIST_BUCKETS	20U
+#define ACRN_EXIT_HIST_SHIFT	7U
+
+/**
+ * @brief Count and latency histogram of one class of VM exits
+ *
+ * Latencies are the TSC cycles spent in the hypervisor's VM exit handler.
+ * hist[0] counts exits shorter than 2^ACRN_EXIT_HIST_SHIFT cycles, hist[i]
+ * those in [2^(ACRN_EXIT_HIST_SHIFT + i - 1), 2^(ACRN_EXIT_HIST_SHIFT + i))
+ * and the last bucket everything longer.
+ */
+struct acrn_exit_stat {
+	/** number of exits */
+	uint64_t count;
+
+	/** total cycles spent handling them */
+	uint64_t cycles;
+
+	/** log2 latency histogram */
+	uint32_t hist[ACRN_EXIT_HIST_BUCKETS];
+} __aligned(8);
+
+/**
+ * @brief VM exit statistics of one vCPU
+ *
+ * the parameter for HC_GET_VCPU_EXIT_STATS hypercall
+ */
+struct acrn_vcpu_exit_stats {
+	/** relative id of the VM, used by HSM to route the request */
+	uint16_t vmid;
+
+	/** the vCPU to read */
+	uint16_t vcpu_id;
+
+	/** Reserved for alignment and should be 0 */
+	uint32_t reserved;
+
+	/** filled by the hypervisor: TSC frequency in kHz */
+	uint64_t tsc_khz;
+
+	/** filled by the hypervisor: TSC at the time of the readout */
+	uint64_t tsc;
+
+	/** filled by the hypervisor: one entry per basic exit reason */
+	struct acrn_exit_stat reasons[ACRN_EXIT_REASON_NUM];
+} __aligned(8);
+
+/* Handler classes of struct acrn_io_exit_stat */
+#define ACRN_IO_STAT_HV_PIO	0U	/* hypervisor port I/O handler */
+#define ACRN_IO_STAT_HV_MMIO	1U	/* hypervisor MMIO handler */
+#define ACRN_IO_STAT_DEFAULT	2U	/* hypervisor default handler, no device */
+#define ACRN_IO_STAT_DM_PIO	3U	/* port I/O forwarded to the DM */
+#define ACRN_IO_STAT_DM_MMIO	4U	/* MMIO forwarded to the DM */
+
+#define ACRN_IO_STAT_MAX	32U
+
+/**
+ * @brief VM exit statistics of one I/O handler of a VM
+ *
+ * For requests forwarded to the DM only the hypervisor side is accounted.
+ */
+struct acrn_io_exit_stat {
+	/** handler class, ACRN_IO_STAT_* */
+	uint32_t type;
+
+	/** handler slot in the hypervisor */
+	uint32_t slot;
+
+	/** port or guest physical address range of a hypervisor handler */
+	uint64_t start;
+	uint64_t end;
+
+	struct acrn_exit_stat stat;
+} __aligned(8);
+
+/**
+ * @brief I/O handler exit statistics of a VM
+ *
+ * the parameter for HC_GET_VM_IO_STATS hypercall. Handlers which never saw
+ * an exit are skipped; call again with first = next until nr is 0.
+ */
+struct acrn_vm_io_stats {
+	/** relative id of the VM, used by HSM to route the request */
+	uint16_t vmid;
+
+	/** Reserved for alignment and should be 0 */
+	uint16_t reserved;
+
+	/** first handler slot to look at */
+	uint32_t first;
+
+	/** filled by the hypervisor: slot to continue from */
+	uint32_t next;
+
+	/** filled by the hypervisor: valid entries in stats[] */
+	uint32_t nr;
+
+	struct acrn_io_exit_stat stats[ACRN_IO_STAT_MAX];
+} __aligned(8);
+
+#define ACRN_RDT_MAX_VMS		16U
+
+/* flags of struct acrn_rdt_mon */
+#define ACRN_RDT_MON_CAPABLE		(1U << 0U)	/* the L3 supports CMT/MBM */
+#define ACRN_RDT_CTRL_ENABLED		(1U << 1U)	/* the control loop is running */
+
+/* flags of struct acrn_rdt_vm_mon */
+#define ACRN_RDT_VM_RT			(1U << 0U)	/* the RT VM of the control loop */
+#define ACRN_RDT_VM_BE			(1U << 1U)	/* a best effort VM of the control loop */
+
+/**
+ * @brief Cache and memory bandwidth monitoring of one VM
+ *
+ * The counters are the L3 occupancy and the memory traffic in bytes of the
+ * VM's RMID. Only VMs whose vCPUs switch MSR_IA32_PQR_ASSOC (own CLOS or
+ * vCAT) get an RMID, the others are accounted to the hypervisor.
+ */
+struct acrn_rdt_vm_mon {
+	/** relative id of the VM */
+	uint16_t vmid;
+
+	/** Reserved for alignment and should be 0 */
+	uint16_t reserved;
+
+	/** RMID of the VM, 0 if the VM isn't monitored */
+	uint32_t rmid;
+
+	/** L3 CBM of the CLOS of the VM's vCPU 0, as currently programmed */
+	uint32_t l3_mask;
+
+	/** MBA delay of the CLOS of the VM's vCPU 0, as currently programmed */
+	uint16_t mba_delay;
+
+	/** ACRN_RDT_VM_* */
+	uint16_t flags;
+
+	/** L3 occupancy in bytes */
+	uint64_t occupancy;
+
+	/** total memory traffic in bytes since the VM started being monitored */
+	uint64_t mbm_total;
+
+	/** local memory traffic in bytes since the VM started being monitored */
+	uint64_t mbm_local;
+} __aligned(8);
+
+/**
+ * @brief RDT monitoring readout
+ *
+ * the parameter for HC_GET_RDT_MON hypercall, filled by the hypervisor
+ */
+struct acrn_rdt_mon {
+	/** TSC frequency in kHz */
+	uint64_t tsc_khz;
+
+	/** TSC at the time of the readout */
+	uint64_t tsc;
+
+	/** ACRN_RDT_MON_CAPABLE and ACRN_RDT_CTRL_ENABLED */
+	uint32_t flags;
+
+	/** valid entries in vms[] */
+	uint32_t nr_vms;
+
+	/** last measured LLC miss rate of the RT VM, in 64 byte lines per ms */
+	uint64_t rt_miss_rate;
+
+	/** number of times the control loop throttled or relaxed the best effort VMs */
+	uint64_t nr_throttle;
+	uint64_t nr_relax;
+
+	/** L3 ways currently taken off each best effort VM */
+	uint16_t ways_cut;
+
+	/** MBA delay currently added to each best effort VM */
+	uint16_t mba_extra;
+
+	/** Reserved for alignment and should be 0 */
+	uint32_t reserved;
+
+	struct acrn_rdt_vm_mon vms[ACRN_RDT_MAX_VMS];
+} __aligned(8);
+
+/**
+ * @brief Parameters of the RDT control loop
+ *
+ * the parameter for HC_SET_RDT_CTRL hypercall. While enabled, the L3 CBMs and
+ * MBA delays of the best effort VMs are reduced step by step whenever the
+ * RT VM misses more than target_miss_rate, and given back when it stays well
+ * below. Disabling restores the scenario configuration.
+ */
+struct acrn_rdt_ctrl {
+	/** relative id of the RT VM */
+	uint16_t rt_vmid;
+
+	/** 1 to enable the control loop, 0 to disable it */
+	uint16_t enable;
+
+	/** sampling period in ms */
+	uint32_t period_ms;
+
+	/** bit n set: the VM of relative id n is a best effort VM */
+	uint64_t be_vm_bitmap;
+
+	/** target LLC miss rate of the RT VM, in 64 byte lines per ms */
+	uint64_t target_miss_rate;
+
+	/** L3 ways each best effort VM keeps at least */
+	uint16_t min_ways;
+
+	/** highest MBA delay a best effort VM may be throttled to */
+	uint16_t max_mba_delay;
+
+	/** Reserved for alignment and should be 0 */
+	uint32_t reserved;
+} __aligned(8);
+
+/*
+ * Trace events are filtered by event index, bit n of a trace filter mask
+ * stands for index n:
+ * - event IDs 0x0 - 0xff use their ID as index
+ * - VM exit events (0x10000 + exit reason) use 0x100 + exit reason
+ * - any other event ID uses index 0x1ff
+ */
+#define ACRN_TRACE_EVMASK_WORDS		8U
+#define ACRN_TRACE_EVIDX_VMEXIT		0x100U
+#define ACRN_TRACE_EVIDX_OTHER		0x1ffU
+#define ACRN_TRACE_ALL_PCPUS		0xffffU
+
+/**
+ * @brief Info to set the trace event filter
+ *
+ * the parameter for HC_SET_TRACE_FILTER hypercall
+ */
+struct acrn_trace_filter {
+	/** physical cpu id, or ACRN_TRACE_ALL_PCPUS */
+	uint16_t pcpu_id;
+
+	/** Reserved */
+	uint16_t reserved[3];
+
+	/** bit set: the event index is recorded */
+	uint64_t evmask[ACRN_TRACE_EVMASK_WORDS];
+} __aligned(8);
+
+/* trace record formats */
+#define ACRN_TRACE_FORMAT_V1		1U	/* fixed size 32 byte entries */
+#define ACRN_TRACE_FORMAT_V2		2U	/* compact records in 8 byte elements */
+
+/**
+ * @brief Info to select the trace record format
+ *
+ * the parameter for HC_SET_TRACE_FORMAT hypercall. It is only accepted
+ * while the trace filter of each selected pCPU disables all events.
+ */
+struct acrn_trace_format {
+	/** physical cpu id, or ACRN_TRACE_ALL_PCPUS */
+	uint16_t pcpu_id;
+
+	/** ACRN_TRACE_FORMAT_V1 or ACRN_TRACE_FORMAT_V2 */
+	uint16_t format;
+
+	/** Reserved */
+	uint32_t reserved;
+} __aligned(8);
+
 /**
  * @brief Info to create or destroy a virtual PCI or legacy device for a VM
  *
@@ -39,6 +39,8 @@
 #define HC_CREATE_VCPU              BASE_HC_ID(HC_ID, HC_ID_VM_BASE + 0x04UL)
 #define HC_RESET_VM                 BASE_HC_ID(HC_ID, HC_ID_VM_BASE + 0x05UL)
 #define HC_SET_VCPU_REGS            BASE_HC_ID(HC_ID, HC_ID_VM_BASE + 0x06UL)
+#define HC_GET_VCPU_EXIT_STATS      BASE_HC_ID(HC_ID, HC_ID_VM_BASE + 0x07UL)
+#define HC_GET_VM_IO_STATS          BASE_HC_ID(HC_ID, HC_ID_VM_BASE + 0x08UL)
 
 /* IRQ and Interrupts */
 #define HC_ID_IRQ_BASE              0x20UL
@@ -70,6 +72,7 @@
 #define HC_DEASSIGN_MMIODEV         BASE_HC_ID(HC_ID, HC_ID_PCI_BASE + 0x08UL)
 #define HC_ADD_VDEV                 BASE_HC_ID(HC_ID, HC_ID_PCI_BASE + 0x09UL)
 #define HC_REMOVE_VDEV              BASE_HC_ID(HC_ID, HC_ID_PCI_BASE + 0x0AUL)
+#define HC_SET_PCI_CFG_SHADOW       BASE_HC_ID(HC_ID, HC_ID_PCI_BASE + 0x0BUL)
 
 /* DEBUG */
 #define HC_ID_DBG_BASE              0x60UL
@@ -77,6 +80,8 @@
 #define HC_SETUP_HV_NPK_LOG         BASE_HC_ID(HC_ID, HC_ID_DBG_BASE + 0x01UL)
 #define HC_PROFILING_OPS            BASE_HC_ID(HC_ID, HC_ID_DBG_BASE + 0x02UL)
 #define HC_GET_HW_INFO              BASE_HC_ID(HC_ID, HC_ID_DBG_BASE + 0x03UL)
+#define HC_SET_TRACE_FILTER         BASE_HC_ID(HC_ID, HC_ID_DBG_BASE + 0x04UL)
+#define HC_SET_TRACE_FORMAT         BASE_HC_ID(HC_ID, HC_ID_DBG_BASE + 0x05UL)
 
 /* Trusty */
 #define HC_ID_TRUSTY_BASE           0x70UL
@@ -93,6 +98,11 @@
 #define HC_TEE_VCPU_BOOT_DONE	    BASE_HC_ID(HC_ID, HC_ID_TEE_BASE + 0x00UL)
 #define HC_SWITCH_EE		    BASE_HC_ID(HC_ID, HC_ID_TEE_BASE + 0x01UL)
 
+/* Resource Director Technology */
+#define HC_ID_RDT_BASE              0xA0UL
+#define HC_GET_RDT_MON              BASE_HC_ID(HC_ID, HC_ID_RDT_BASE + 0x00UL)
+#define HC_SET_RDT_CTRL             BASE_HC_ID(HC_ID, HC_ID_RDT_BASE + 0x01UL)
+
 #define ACRN_INVALID_VMID (0xffffU)
 #define ACRN_INVALID_HPA (~0UL)
 
@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <types.h>
+#include <rtl.h>
+#include <slab.h>
+#include <logmsg.h>
+
+/* in the link of an allocated object, catches double frees */
+#define SLAB_IDX_USED		0xfffffffeU
+
+static struct slab_cache *slab_caches[MAX_SLAB_CACHES];
+static uint32_t nr_slab_caches;
+static spinlock_t slab_caches_lock = { .head = 0U, .tail = 0U, };
+
+void slab_init(struct slab_cache *cache, const char *name, void *objs, uint32_t obj_size,
+		uint32_t nr_objs, uint32_t *links)
+{
+	uint32_t i;
+
+	spinlock_init(&cache->lock);
+	(void)strncpy_s(cache->name, SLAB_NAME_LEN, name, SLAB_NAME_LEN - 1U);
+	cache->objs = (uint8_t *)objs;
+	cache->obj_size = obj_size;
+	cache->nr_objs = nr_objs;
+	cache->links = links;
+
+	/* lowest index first, as the array scans they replace did */
+	for (i = 0U; i < nr_objs; i++) {
+		links[i] = ((i + 1U) < nr_objs) ? (i + 1U) : INVALID_SLAB_IDX;
+	}
+	cache->free_head = (nr_objs != 0U) ? 0U : INVALID_SLAB_IDX;
+
+	cache->in_use = 0U;
+	cache->high_water = 0U;
+	cache->failures = 0UL;
+
+	spinlock_obtain(&slab_caches_lock);
+	if (!cache->registered && (nr_slab_caches < MAX_SLAB_CACHES)) {
+		slab_caches[nr_slab_caches] = cache;
+		nr_slab_caches++;
+		cache->registered = true;
+	}
+	spinlock_release(&slab_caches_lock);
+}
+
+uint32_t slab_alloc_idx(struct slab_cache *cache)
+{
+	uint32_t idx;
+
+	spinlock_obtain(&cache->lock);
+	idx = cache->free_head;
+	if (idx != INVALID_SLAB_IDX) {
+		cache->free_head = cache->links[idx];
+		cache->links[idx] = SLAB_IDX_USED;
+		cache->in_use++;
+		if (cache->in_use > cache->high_water) {
+			cache->high_water = cache->in_use;
+		}
+	} else {
+		cache->failures++;
+	}
+	spinlock_release(&cache->lock);
+
+	return idx;
+}
+
+void *slab_alloc(struct slab_cache *cache)
+{
+	uint32_t idx = slab_alloc_idx(cache);
+
+	return (idx != INVALID_SLAB_IDX) ? (void *)(cache->objs + ((uint64_t)idx * cache->obj_size)) : NULL;
+}
+
+void slab_free_idx(struct slab_cache *cache, uint32_t idx)
+{
+	spinlock_obtain(&cache->lock);
+	ASSERT(cache->links[idx] == SLAB_IDX_USED, "%s: object %u freed twice", cache->name, idx);
+	if (cache->links[idx] == SLAB_IDX_USED) {
+		cache->links[idx] = cache->free_head;
+		cache->free_head = idx;
+		cache->in_use--;
+	}
+	spinlock_release(&cache->lock);
+}
+
+void slab_free(struct slab_cache *cache, const void *obj)
+{
+	uint64_t offset = (uint64_t)((const uint8_t *)obj - cache->objs);
+
+	slab_free_idx(cache, (uint32_t)(offset / cache->obj_size));
+}
+
+const struct slab_cache *get_slab_cache(uint32_t idx)
+{
+	const struct slab_cache *cache = NULL;
+
+	spinlock_obtain(&slab_caches_lock);
+	if (idx < nr_slab_caches) {
+		cache = slab_caches[idx];
+	}
+	spinlock_release(&slab_caches_lock);
+
+	return cache;
+}
@@ -0,0 +1,20 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <types.h>
+#include <hvprof.h>
+
+bool hvprof_handle_nmi(__unused const struct intr_excp_ctx *ctx)
+{
+	return false;
+}
+
+int32_t hvprof_claim_vm(__unused const struct acrn_vm *vm, __unused uint64_t pcpu_bitmap)
+{
+	return 0;
+}
+
+void hvprof_release_vm(__unused const struct acrn_vm *vm, __unused uint64_t pcpu_bitmap) {}
@@ -5,8 +5,16 @@
  */
 
 #include <types.h>
+#include <logmsg.h>
 
 void init_logmsg() {}
+void flush_logmsg(void) {}
+void defer_console_logmsg(__unused bool deferred) {}
+bool logmsg_ratelimit(__unused struct logmsg_ratelimit *rl, __unused uint32_t severity,
+		__unused const char *func)
+{
+	return false;
+}
 void do_logmsg(__unused uint32_t severity, __unused const char *fmt, ...) {}
 void printf(__unused const char *fmt, ...) {}
 void vprintf(__unused const char *fmt, __unused va_list args) {}
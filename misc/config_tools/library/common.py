@@ -24,7 +24,8 @@ PY_CACHES = ["__pycache__", "../board_config/__pycache__", "../scenario_config/_
 GUEST_FLAG = ["0", "0UL", "GUEST_FLAG_SECURE_WORLD_ENABLED", "GUEST_FLAG_LAPIC_PASSTHROUGH",
               "GUEST_FLAG_IO_COMPLETION_POLLING", "GUEST_FLAG_NVMX_ENABLED", "GUEST_FLAG_HIDE_MTRR",
               "GUEST_FLAG_RT", "GUEST_FLAG_SECURITY_VM", "GUEST_FLAG_VCAT_ENABLED",
-              "GUEST_FLAG_TEE", "GUEST_FLAG_REE"]
+              "GUEST_FLAG_TEE", "GUEST_FLAG_REE", "GUEST_FLAG_PMU_PASSTHROUGH", "GUEST_FLAG_VPMU",
+              "GUEST_FLAG_ZERO_COPY_MODULES", "GUEST_FLAG_VIOMMU"]
 
 MULTI_ITEM = ["guest_flag", "pcpu_id", "vcpu_clos", "input", "block", "network", "pci_dev", "shm_region", "communication_vuart"]
 
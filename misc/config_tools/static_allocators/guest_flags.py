@@ -20,6 +20,9 @@ policies = [
     GuestFlagPolicy(".//secure_world_support = 'y'", "GUEST_FLAG_SECURE_WORLD_ENABLED"),
     GuestFlagPolicy(".//hide_mtrr_support = 'y'", "GUEST_FLAG_HIDE_MTRR"),
     GuestFlagPolicy(".//nested_virtualization_support = 'y'", "GUEST_FLAG_NVMX_ENABLED"),
+    GuestFlagPolicy(".//vpmu_support = 'y' and .//lapic_passthrough = 'y'", "GUEST_FLAG_PMU_PASSTHROUGH"),
+    GuestFlagPolicy(".//vpmu_support = 'y' and not(.//lapic_passthrough = 'y')", "GUEST_FLAG_VPMU"),
+    GuestFlagPolicy(".//zero_copy_modules = 'y'", "GUEST_FLAG_ZERO_COPY_MODULES"),
     GuestFlagPolicy(".//security_vm = 'y'", "GUEST_FLAG_SECURITY_VM"),
     GuestFlagPolicy(".//vm_type = 'RTVM'", "GUEST_FLAG_RT"),
     GuestFlagPolicy(".//vm_type = 'TEE_VM'", "GUEST_FLAG_TEE"),
@@ -91,6 +91,9 @@
     </xsl:if>
     <xsl:value-of select="acrn:initializer('vm_prio', priority)" />
     <xsl:value-of select="acrn:initializer('companion_vm_id', concat(companion_vmid, 'U'))" />
+    <xsl:if test="max_idle_latency and max_idle_latency != 0">
+      <xsl:value-of select="acrn:initializer('max_idle_latency', concat(max_idle_latency, 'U'))" />
+    </xsl:if>
     <xsl:call-template name="guest_flags" />
 
     <xsl:if test="acrn:is-rdt-enabled()">
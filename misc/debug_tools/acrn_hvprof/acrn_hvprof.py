@@ -0,0 +1,231 @@
+#!/usr/bin/python3
+# -*- coding: UTF-8 -*-
+#
+# Copyright (C) 2026 Intel Corporation.
+#
+# SPDX-License-Identifier: BSD-3-Clause
+#
+
+"""
+Reader of the hypervisor self-profiler (hypervisor shell command hvprof):
+- drains the per pCPU ACRN_HVPROF shared buffers, or reads a raw capture
+- symbolizes the sampled call chains against the hypervisor ELF
+- prints them as folded stacks, the input of flamegraph.pl
+"""
+
+import sys
+import os
+import glob
+import time
+import mmap
+import struct
+import getopt
+import bisect
+import subprocess
+
+DEV_PREFIX = "/dev/acrn_hvprof_"
+SBUF_MAGIC = 0x5aa57aa71aa13aa3
+SBUF_HEAD_SIZE = 64
+# magic, ele_num, ele_size, head, tail, flags, overrun_cnt, size
+SBUF_HEAD_FMT = "<QIIIIQII"
+SBUF_HEAD_OFF = 16
+# struct sbuf_rec_hdr: nr_ele, len, reserved
+REC_HDR_FMT = "<HHI"
+REC_HDR_SIZE = 8
+# struct hvprof_sample: tsc, pcpu_id, depth, reserved, ip[depth]
+SAMPLE_FMT = "<QHHI"
+SAMPLE_SIZE = 16
+
+def usage():
+    """print the usage of the script
+    Args: NA
+    Returns: None
+    Raises: NA
+    """
+    print ('''
+    [Usage] acrn_hvprof.py [options] ...
+
+    [options]
+    -h: print this message
+    -e, --elf=[string]: hypervisor ELF (acrn.out) to resolve symbols
+    -t, --time=[unsigned int]: capture from /dev/acrn_hvprof_* for that many seconds
+    -w, --wfile=[string]: also save the raw samples captured to this file
+    -i, --ifile=[string]: read raw samples from this file instead of capturing
+    -o, --ofile=[string]: output file of the folded stacks, default stdout
+    -a, --addr: keep unresolved addresses instead of dropping the frame
+    ''')
+
+class Sbuf:
+    """consumer side of a shared buffer mmapped from a device"""
+
+    def __init__(self, path):
+        self.fd = os.open(path, os.O_RDWR)
+        head = mmap.mmap(self.fd, mmap.PAGESIZE)
+        magic, _, _, _, _, _, _, size = struct.unpack_from(SBUF_HEAD_FMT, head, 0)
+        head.close()
+        if magic != SBUF_MAGIC:
+            raise ValueError("%s: bad sbuf magic 0x%x" % (path, magic))
+        self.size = size
+        self.buf = mmap.mmap(self.fd, SBUF_HEAD_SIZE + size)
+
+    def copy_from(self, pos, length):
+        """read length bytes at pos of the data area, wrapping around"""
+        first = min(length, self.size - pos)
+        data = self.buf[SBUF_HEAD_SIZE + pos:SBUF_HEAD_SIZE + pos + first]
+        if length > first:
+            data += self.buf[SBUF_HEAD_SIZE:SBUF_HEAD_SIZE + length - first]
+        return data
+
+    def drain(self):
+        """return the payloads of all published records"""
+        _, _, ele_size, head, tail, _, _, _ = struct.unpack_from(SBUF_HEAD_FMT, self.buf, 0)
+        records = []
+        while head != tail:
+            avail = (tail - head) if tail > head else (self.size - head + tail)
+            nr_ele, length, _ = struct.unpack(REC_HDR_FMT, self.copy_from(head, REC_HDR_SIZE))
+            if nr_ele == 0 or nr_ele * ele_size > avail or \
+                    REC_HDR_SIZE + length > nr_ele * ele_size:
+                # broken framing, resync by dropping what is buffered
+                head = tail
+                break
+            records.append(self.copy_from((head + REC_HDR_SIZE) % self.size, length))
+            head = (head + nr_ele * ele_size) % self.size
+        struct.pack_into("<I", self.buf, SBUF_HEAD_OFF, head)
+        return records
+
+    def close(self):
+        """unmap and close the device"""
+        self.buf.close()
+        os.close(self.fd)
+
+def capture(seconds, wfile):
+    """drain every /dev/acrn_hvprof_* for seconds, return the raw samples"""
+    sbufs = [Sbuf(dev) for dev in sorted(glob.glob(DEV_PREFIX + "*"))]
+    assert sbufs, "no %s* device, is the Service VM kernel sharing ACRN_HVPROF?" % DEV_PREFIX
+
+    records = []
+    end = time.time() + seconds
+    while True:
+        for sbuf in sbufs:
+            records += sbuf.drain()
+        if time.time() >= end:
+            break
+        time.sleep(0.05)
+
+    for sbuf in sbufs:
+        sbuf.close()
+
+    if wfile:
+        with open(wfile, "wb") as fd:
+            for rec in records:
+                fd.write(rec)
+    return records
+
+def read_raw(ifile):
+    """split a raw capture, samples written back to back, into samples"""
+    with open(ifile, "rb") as fd:
+        data = fd.read()
+    records = []
+    pos = 0
+    while pos + SAMPLE_SIZE <= len(data):
+        _, _, depth, _ = struct.unpack_from(SAMPLE_FMT, data, pos)
+        length = SAMPLE_SIZE + depth * 8
+        records.append(data[pos:pos + length])
+        pos += length
+    return records
+
+def load_symbols(elf):
+    """sorted text symbol addresses and names of the hypervisor ELF"""
+    addrs = []
+    names = []
+    out = subprocess.check_output(["nm", "-n", "--defined-only", elf]).decode()
+    for line in out.splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[1] in "tTwW":
+            addrs.append(int(fields[0], 16))
+            names.append(fields[2])
+    return addrs, names
+
+def resolve(addr, symbols, keep_addr):
+    """name of the function holding addr, or None"""
+    addrs, names = symbols
+    idx = bisect.bisect_right(addrs, addr) - 1
+    if idx >= 0:
+        return names[idx]
+    return "0x%x" % addr if keep_addr else None
+
+def fold(records, symbols, keep_addr):
+    """count identical call chains, outermost frame first"""
+    stacks = {}
+    for rec in records:
+        _, _, depth, _ = struct.unpack_from(SAMPLE_FMT, rec, 0)
+        ips = struct.unpack_from("<%dQ" % depth, rec, SAMPLE_SIZE)
+        frames = []
+        for i, addr in enumerate(ips):
+            # return addresses point after the call, look up the call itself
+            name = resolve(addr if i == 0 else addr - 1, symbols, keep_addr)
+            if name is not None:
+                frames.append(name)
+        if frames:
+            key = ";".join(reversed(frames))
+            stacks[key] = stacks.get(key, 0) + 1
+    return stacks
+
+def main(argv):
+    """Main enterance function
+
+    Args:
+        argv: arguments string
+    Returns:
+        None
+    Raises:
+        GetoptError
+    """
+    elf = ''
+    seconds = 0
+    wfile = ''
+    ifile = ''
+    ofile = ''
+    keep_addr = False
+    opts_short = "he:t:w:i:o:a"
+    opts_long = ["elf=", "time=", "wfile=", "ifile=", "ofile=", "addr"]
+
+    try:
+        opts, _ = getopt.getopt(argv, opts_short, opts_long)
+    except getopt.GetoptError:
+        usage()
+        sys.exit(1)
+
+    for opt, arg in opts:
+        if opt == '-h':
+            usage()
+            sys.exit()
+        elif opt in ("-e", "--elf"):
+            elf = arg
+        elif opt in ("-t", "--time"):
+            seconds = int(arg)
+        elif opt in ("-w", "--wfile"):
+            wfile = arg
+        elif opt in ("-i", "--ifile"):
+            ifile = arg
+        elif opt in ("-o", "--ofile"):
+            ofile = arg
+        elif opt in ("-a", "--addr"):
+            keep_addr = True
+        else:
+            assert False, "unhandled option"
+
+    assert elf != '', "hypervisor ELF is required"
+    assert (ifile != '') != (seconds > 0), "either an input file or a capture time is required"
+
+    records = read_raw(ifile) if ifile else capture(seconds, wfile)
+    stacks = fold(records, load_symbols(elf), keep_addr)
+
+    out = open(ofile, "w") if ofile else sys.stdout
+    for key in sorted(stacks):
+        out.write("%s %d\n" % (key, stacks[key]))
+    if ofile:
+        out.close()
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -12,6 +12,7 @@
 #include <sys/statvfs.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/ioctl.h>
 #include <time.h>
 #include <dirent.h>
 #include <signal.h>
@@ -30,7 +31,7 @@ static int exiting = 0;
 
 /* for opt */
 static uint64_t period = 10000;
-static const char optString[] = "i:hcrt:a:";
+static const char optString[] = "i:hcrt:a:e:E:f:";
 static const char dev_prefix[] = "acrn_trace_";
 
 static uint32_t flags = FLAG_CLEAR_BUF;
@@ -41,6 +42,26 @@ static int dev_cnt = 0; /* Count of /dev/acrn_trace_xxx devices */
 
 static struct bitmask *cpu_bitmask = NULL;
 
+/* event indexes to record, see struct acrn_trace_filter */
+static unsigned long evmask[ACRN_TRACE_EVMASK_WORDS];
+static int filter_set = 0;
+
+/* trace record format, 1: fixed size entries, 2: compact records */
+static uint16_t trace_format = ACRN_TRACE_FORMAT_V1;
+
+struct trace_class {
+	const char *name;
+	uint32_t first, last;	/* event index range */
+	int other;		/* also the shared index of all other IDs */
+};
+
+static const struct trace_class trace_classes[] = {
+	{ "timer",	0x00, 0x0f, 0 },
+	{ "vm",		0x10, 0x11, 0 },	/* VM entry and exit */
+	{ "vmexit",	ACRN_TRACE_EVIDX_VMEXIT, ACRN_TRACE_EVIDX_OTHER - 1, 0 },
+	{ "misc",	0x12, 0xff, 1 },
+};
+
 static void display_usage(void)
 {
 	printf("acrntrace - tool to collect ACRN trace data\n"
@@ -51,7 +72,12 @@ static void display_usage(void)
 	       "\t-t: max time to capture trace data (in second)\n"
 	       "\t-c: clear the buffered old data (deprecated)\n"
 	       "\t-r: capture the buffered old data instead of clearing it\n"
-	       "\t-a: cpu-set: only capture the trace data on these configured cpu-set\n");
+	       "\t-a: cpu-set: only capture the trace data on these configured cpu-set\n"
+	       "\t-e: class-list: only record these event classes, comma separated\n"
+	       "\t    from timer, vm, vmexit, misc and all\n"
+	       "\t-E: id-list: also record these event IDs, comma separated\n"
+	       "\t-f: format: 1 for fixed size trace entries (default),\n"
+	       "\t    2 for compact delta encoded records\n");
 }
 
 static void timer_handler(union sigval sv)
@@ -94,6 +120,128 @@ static int init_timer(int timeout)
 	return 0;
 }
 
+static uint32_t trace_event_index(uint64_t evid)
+{
+	if (evid < ACRN_TRACE_EVIDX_VMEXIT)
+		return evid;
+	if ((evid & ~0xffUL) == TRACE_VMEXIT_ENTRY)
+		return ACRN_TRACE_EVIDX_VMEXIT | (evid & 0xff);
+	return ACRN_TRACE_EVIDX_OTHER;
+}
+
+static void evmask_set(uint32_t idx)
+{
+	evmask[idx / 64] |= 1UL << (idx % 64);
+}
+
+static int parse_classes(char *list)
+{
+	char *name, *saveptr = NULL;
+	uint32_t i, idx;
+	int found;
+
+	for (name = strtok_r(list, ",", &saveptr); name != NULL;
+			name = strtok_r(NULL, ",", &saveptr)) {
+		found = 0;
+		for (i = 0; i < sizeof(trace_classes) / sizeof(trace_classes[0]); i++) {
+			if (strcmp(name, "all") && strcmp(name, trace_classes[i].name))
+				continue;
+			for (idx = trace_classes[i].first; idx <= trace_classes[i].last; idx++)
+				evmask_set(idx);
+			if (trace_classes[i].other)
+				evmask_set(ACRN_TRACE_EVIDX_OTHER);
+			found = 1;
+		}
+		if (!found) {
+			pr_err("unknown event class '%s'\n", name);
+			return -EINVAL;
+		}
+	}
+	filter_set = 1;
+	return 0;
+}
+
+static int parse_events(char *list)
+{
+	char *id, *end, *saveptr = NULL;
+	uint64_t evid;
+
+	for (id = strtok_r(list, ",", &saveptr); id != NULL;
+			id = strtok_r(NULL, ",", &saveptr)) {
+		evid = strtoul(id, &end, 0);
+		if (*end != '\0') {
+			pr_err("invalid event ID '%s'\n", id);
+			return -EINVAL;
+		}
+		evmask_set(trace_event_index(evid));
+	}
+	filter_set = 1;
+	return 0;
+}
+
+static int set_filter(int fd, uint16_t pcpu_id, const unsigned long *mask)
+{
+	struct acrn_trace_filter filter;
+
+	memset(&filter, 0, sizeof(filter));
+	filter.pcpu_id = pcpu_id;
+	if (mask)
+		memcpy(filter.evmask, mask, sizeof(filter.evmask));
+	return ioctl(fd, ACRN_IOCTL_SET_TRACE_FILTER, &filter);
+}
+
+static int set_format(int fd, uint16_t format)
+{
+	struct acrn_trace_format fmt;
+
+	memset(&fmt, 0, sizeof(fmt));
+	fmt.pcpu_id = ACRN_TRACE_ALL_PCPUS;
+	fmt.format = format;
+	return ioctl(fd, ACRN_IOCTL_SET_TRACE_FORMAT, &fmt);
+}
+
+/*
+ * Program the record format and the per-pCPU event masks: the selected
+ * events on the captured cpu-set, nothing on the other pCPUs. Restore
+ * goes back to v1 records of every event.
+ *
+ * The hypervisor only switches the format while no event is recorded, so
+ * tracing is stopped on all pCPUs around the switch.
+ */
+static int apply_filter(int restore)
+{
+	unsigned long all[ACRN_TRACE_EVMASK_WORDS];
+	int fd, cpu, ret = 0;
+
+	fd = open(HSM_DEV, O_RDWR);
+	if (fd < 0) {
+		pr_err("Failed to open %s, err %d\n", HSM_DEV, errno);
+		return -1;
+	}
+
+	memset(all, 0xff, sizeof(all));
+	if (trace_format != ACRN_TRACE_FORMAT_V1) {
+		ret = set_filter(fd, ACRN_TRACE_ALL_PCPUS, NULL);
+		if (ret == 0)
+			ret = set_format(fd, restore ? ACRN_TRACE_FORMAT_V1 : trace_format);
+	}
+
+	if (ret < 0) {
+		pr_err("Failed to set trace format, err %d\n", errno);
+	} else if (restore || !filter_set) {
+		ret = set_filter(fd, ACRN_TRACE_ALL_PCPUS, all);
+	} else {
+		for (cpu = 0; (cpu < dev_cnt) && (ret == 0); cpu++)
+			ret = set_filter(fd, cpu,
+				numa_bitmask_isbitset(cpu_bitmask, cpu) ? evmask : NULL);
+	}
+
+	if (ret < 0)
+		pr_err("Failed to set trace filter, err %d\n", errno);
+	close(fd);
+	return ret;
+}
+
 static int parse_opt(int argc, char *argv[])
 {
 	int opt, ret;
@@ -130,6 +278,22 @@ static int parse_opt(int argc, char *argv[])
 		case 'a':
 			cpu_bitmask = numa_parse_cpustring_all(optarg);
 			break;
+		case 'e':
+			if (parse_classes(optarg) < 0)
+				return -EINVAL;
+			break;
+		case 'E':
+			if (parse_events(optarg) < 0)
+				return -EINVAL;
+			break;
+		case 'f':
+			trace_format = strtol(optarg, NULL, 10);
+			if ((trace_format != ACRN_TRACE_FORMAT_V1) &&
+					(trace_format != ACRN_TRACE_FORMAT_V2)) {
+				pr_err("'-f' require 1 or 2\n");
+				return -EINVAL;
+			}
+			break;
 		case 'h':
 			display_usage();
 			return -EINVAL;
@@ -243,6 +407,19 @@ static void reader_fn(param_t * param)
 	}
 }
 
+static int write_file_hdr(reader_struct *reader)
+{
+	struct trace_file_hdr hdr;
+
+	memcpy(hdr.magic, TRACE_V2_FILE_MAGIC, sizeof(hdr.magic));
+	hdr.version = 2;
+	hdr.cpu = reader->param.devid;
+	if (write(reader->param.trace_fd, &hdr, sizeof(hdr)) != sizeof(hdr))
+		return -1;
+
+	return 0;
+}
+
 static int create_reader(reader_struct * reader, uint32_t dev_id)
 {
 	char trace_file_name[TRACE_FILE_NAME_LEN];
@@ -283,6 +460,11 @@ static int create_reader(reader_struct * reader, uint32_t dev_id)
 		return -3;
 	}
 
+	if ((trace_format == ACRN_TRACE_FORMAT_V2) && (write_file_hdr(reader) < 0)) {
+		pr_err("Failed to write %s, err %d\n", trace_file_name, errno);
+		return -3;
+	}
+
 	pr_info("trace data file %s created for %s\n",
 		trace_file_name, reader->dev_name);
 
@@ -334,6 +516,10 @@ static void handle_on_exit(void)
 		if (numa_bitmask_isbitset(cpu_bitmask, dev_id))
 			destory_reader(&reader[dev_id]);
 	}
+
+	/* leave the hypervisor recording everything again */
+	if (filter_set || (trace_format != ACRN_TRACE_FORMAT_V1))
+		apply_filter(1);
 }
 
 static void signal_exit_handler(int sig)
@@ -386,6 +572,9 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	if ((filter_set || (trace_format != ACRN_TRACE_FORMAT_V1)) && (apply_filter(0) < 0))
+		exit(EXIT_FAILURE);
+
 	atexit(handle_on_exit);
 
 	/* acquair res for each trace dev */
@@ -406,11 +595,7 @@ int main(int argc, char *argv[])
 		printf("q <enter> to quit:\n");
 
  out_free:
-	foreach_dev(dev_id) {
-		if (numa_bitmask_isbitset(cpu_bitmask, dev_id))
-			destory_reader(&reader[dev_id]);
-	}
-
+	handle_on_exit();
 	free(reader);
 	flags &= ~FLAG_TO_REL;
 
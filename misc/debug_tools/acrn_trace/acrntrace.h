@@ -5,6 +5,7 @@
  */
 
 
+#include "hsm_ioctl_defs.h"
 #include "sbuf.h"
 
 #define PCPU_NUM        	4
@@ -42,6 +43,27 @@
 #define FLAG_TO_REL		(1UL << 0)
 #define FLAG_CLEAR_BUF		(1UL << 1)
 
+/*
+ * v2 trace files start with this header, v1 files are raw trace entries.
+ * The hypervisor writes v2 records once ACRN_IOCTL_SET_TRACE_FORMAT
+ * selected ACRN_TRACE_FORMAT_V2.
+ */
+#define TRACE_V2_FILE_MAGIC	"ACRNTRC2"
+
+struct trace_file_hdr {
+	char magic[8];
+	uint32_t version;
+	uint32_t cpu;
+};
+
+/*
+ * The trace event filter is passed through by the HSM driver to
+ * HC_SET_TRACE_FILTER, see struct acrn_trace_filter.
+ */
+#define HSM_DEV			"/dev/acrn_hsm"
+#define TRACE_EVIDX_NUM		(ACRN_TRACE_EVMASK_WORDS * 64)
+#define TRACE_VMEXIT_ENTRY	0x10000
+
 #define foreach_dev(dev_id)                                       \
         for ((dev_id) = 0; (dev_id) < (dev_cnt); (dev_id)++)
 
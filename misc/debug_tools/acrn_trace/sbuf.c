@@ -46,9 +46,60 @@ int sbuf_get(shared_buf_t *sbuf, uint8_t *data)
 	return sbuf->ele_size;
 }
 
+/*
+ * Copy len bytes starting at offset 'pos' of the data area, following the
+ * wrap-around.
+ */
+static void sbuf_copy_from(shared_buf_t *sbuf, uint32_t pos, uint8_t *data, uint32_t len)
+{
+	const uint8_t *base = (const uint8_t *)sbuf + SBUF_HEAD_SIZE;
+	uint32_t first = (len < sbuf->size - pos) ? len : sbuf->size - pos;
+
+	memcpy(data, base + pos, first);
+	if (len > first)
+		memcpy(data + first, base, len - first);
+}
+
+int sbuf_get_record(shared_buf_t *sbuf, uint8_t *data, uint32_t len)
+{
+	sbuf_rec_hdr_t hdr;
+	uint32_t head, avail;
+
+	if ((sbuf == NULL) || (data == NULL))
+		return -EINVAL;
+
+	if (sbuf_is_empty(sbuf))
+		return 0;
+
+	head = sbuf->head;
+	sbuf_copy_from(sbuf, head, (uint8_t *)&hdr, sizeof(hdr));
+
+	avail = (sbuf->tail >= head) ? (sbuf->tail - head) : (sbuf->size - head + sbuf->tail);
+	if ((hdr.nr_ele == 0) || ((uint32_t)hdr.nr_ele * sbuf->ele_size > avail) ||
+			(sizeof(hdr) + hdr.len > (uint32_t)hdr.nr_ele * sbuf->ele_size)) {
+		/* broken framing, resync by dropping what is buffered */
+		sbuf->head = sbuf->tail;
+		return -EIO;
+	}
+
+	if (hdr.len > len)
+		return -ENOSPC;
+
+	sbuf_copy_from(sbuf, sbuf_next_ptr(head, sizeof(hdr), sbuf->size), data, hdr.len);
+	sbuf->head = sbuf_next_ptr(head, hdr.nr_ele * sbuf->ele_size, sbuf->size);
+
+	return hdr.len;
+}
+
+/*
+ * Write everything buffered up to the end of the data area with a single
+ * write(), the caller loops to pick up the wrapped part. The producer only
+ * ever publishes whole elements or records, so the output stays aligned.
+ */
 int sbuf_write(int fd, shared_buf_t *sbuf)
 {
 	const void *start;
+	uint32_t head, tail, len;
 	int written;
 
 	if (sbuf == NULL)
@@ -58,17 +109,21 @@ int sbuf_write(int fd, shared_buf_t *sbuf)
 		return 0;
 	}
 
-	start = (void *)sbuf + SBUF_HEAD_SIZE + sbuf->head;
-        written = write(fd, start, sbuf->ele_size);
-	if (written != sbuf->ele_size) {
-		printf("Failed to write: ret %d (ele_size %d), errno %d\n",
-			written, sbuf->ele_size, (written == -1) ? errno : 0);
+	head = sbuf->head;
+	tail = sbuf->tail;
+	len = (tail > head) ? (tail - head) : (sbuf->size - head);
+
+	start = (void *)sbuf + SBUF_HEAD_SIZE + head;
+	written = write(fd, start, len);
+	if (written != (int)len) {
+		printf("Failed to write: ret %d (len %u), errno %d\n",
+			written, len, (written == -1) ? errno : 0);
 		return -1;
 	}
 
-	sbuf->head = sbuf_next_ptr(sbuf->head, sbuf->ele_size, sbuf->size);
+	sbuf->head = sbuf_next_ptr(head, len, sbuf->size);
 
-	return sbuf->ele_size;
+	return len;
 }
 
 int sbuf_clear_buffered(shared_buf_t *sbuf)
@@ -50,6 +50,17 @@ typedef struct shared_buf {
         uint32_t padding[6];
 } shared_buf_t;
 
+/*
+ * Header of a variable-length record (hypervisor sbuf_put_record()): the
+ * record covers nr_ele whole elements, header included, and carries len
+ * bytes of payload right after the header.
+ */
+typedef struct sbuf_rec_hdr {
+        unsigned short nr_ele;
+        unsigned short len;
+        uint32_t reserved;
+} sbuf_rec_hdr_t;
+
 static inline void sbuf_clear_flags(shared_buf_t *sbuf, uint64_t flags)
 {
         sbuf->flags &= ~flags;
@@ -66,6 +77,7 @@ static inline void sbuf_add_flags(shared_buf_t *sbuf, uint64_t flags)
 }
 
 int sbuf_get(shared_buf_t *sbuf, uint8_t *data);
+int sbuf_get_record(shared_buf_t *sbuf, uint8_t *data, uint32_t len);
 int sbuf_write(int fd, shared_buf_t *sbuf);
 int sbuf_clear_buffered(shared_buf_t *sbuf);
 #endif /* SHARED_BUF_H */
@@ -0,0 +1,222 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * Host-side benchmark of the sbuf producer APIs against this directory's
+ * consumer. The producer thread mirrors hypervisor/debug/sbuf.c: one tail
+ * update per element (sbuf_put), one per batch (sbuf_put_many) or one per
+ * framed variable-length record (sbuf_put_record).
+ */
+
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <stdbool.h>
+#include <sched.h>
+#include "sbuf.h"
+
+enum bench_mode {
+	MODE_PUT,
+	MODE_PUT_MANY,
+	MODE_RECORD,
+};
+
+static const char *mode_names[] = { "put", "put_many", "record" };
+
+static uint32_t ele_size = 32U;
+static uint32_t ele_num = 4096U;
+static uint32_t batch = 16U;
+static uint64_t nr_records = 20000000UL;
+static enum bench_mode mode = MODE_PUT;
+
+#define load_acquire(p)		__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define store_release(p, v)	__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+static inline uint32_t next_ptr(uint32_t pos, uint32_t span, uint32_t scope)
+{
+	pos += span;
+	return (pos >= scope) ? (pos - scope) : pos;
+}
+
+static uint32_t free_bytes(shared_buf_t *sbuf)
+{
+	uint32_t head = load_acquire(&sbuf->head), tail = sbuf->tail;
+
+	return (tail >= head) ? (sbuf->size - (tail - head)) : (head - tail);
+}
+
+static void copy_to(shared_buf_t *sbuf, uint32_t pos, const void *data, uint32_t len)
+{
+	uint8_t *base = (uint8_t *)sbuf + SBUF_HEAD_SIZE;
+	uint32_t first = (len < sbuf->size - pos) ? len : sbuf->size - pos;
+
+	memcpy(base + pos, data, first);
+	if (len > first)
+		memcpy(base, (const uint8_t *)data + first, len - first);
+}
+
+/* Non-overwriting producer, returns false when the buffer is full */
+static bool produce(shared_buf_t *sbuf, const uint8_t *data, uint32_t nr_ele, uint32_t rec_len)
+{
+	sbuf_rec_hdr_t hdr;
+	uint32_t bytes = nr_ele * sbuf->ele_size, tail = sbuf->tail;
+
+	if (free_bytes(sbuf) <= bytes) {
+		/* let the consumer catch up, it may share our CPU */
+		sched_yield();
+		return false;
+	}
+
+	if (rec_len != 0U) {
+		hdr.nr_ele = nr_ele;
+		hdr.len = rec_len;
+		hdr.reserved = 0U;
+		copy_to(sbuf, tail, &hdr, sizeof(hdr));
+		copy_to(sbuf, next_ptr(tail, sizeof(hdr), sbuf->size), data, rec_len);
+	} else {
+		copy_to(sbuf, tail, data, bytes);
+	}
+	store_release(&sbuf->tail, next_ptr(tail, bytes, sbuf->size));
+
+	return true;
+}
+
+static void *producer(void *arg)
+{
+	shared_buf_t *sbuf = arg;
+	uint8_t data[ele_size * batch];
+	uint64_t i = 0UL;
+	uint32_t n, len;
+
+	memset(data, 0xa5, sizeof(data));
+	while (i < nr_records) {
+		switch (mode) {
+		case MODE_PUT:
+			n = 1U;
+			if (produce(sbuf, data, 1U, 0U))
+				i++;
+			break;
+		case MODE_PUT_MANY:
+			n = (nr_records - i < batch) ? (uint32_t)(nr_records - i) : batch;
+			if (produce(sbuf, data, n, 0U))
+				i += n;
+			break;
+		case MODE_RECORD:
+		default:
+			/* 8 - 64 byte payloads, like trace events with 1 - 8 arguments */
+			len = 8U * (1U + (uint32_t)(i & 7U));
+			n = (sizeof(sbuf_rec_hdr_t) + len + ele_size - 1U) / ele_size;
+			if (produce(sbuf, data, n, len))
+				i++;
+			break;
+		}
+	}
+	return NULL;
+}
+
+static void *consumer(void *arg)
+{
+	shared_buf_t *sbuf = arg;
+	uint8_t data[ele_size * batch + 64U];
+	uint64_t i = 0UL;
+	int ret;
+
+	while (i < nr_records) {
+		if (mode == MODE_RECORD)
+			ret = sbuf_get_record(sbuf, data, sizeof(data));
+		else
+			ret = sbuf_get(sbuf, data);
+
+		if (ret > 0) {
+			i++;
+		} else if (ret < 0) {
+			fprintf(stderr, "consumer failed: %d\n", ret);
+			exit(EXIT_FAILURE);
+		} else {
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void usage(const char *prog)
+{
+	printf("Usage: %s [options]\n"
+		"  -m  producer: put, put_many or record, default put\n"
+		"  -e  element size, default %u\n"
+		"  -N  number of elements, default %u\n"
+		"  -b  elements per put_many batch, default %u\n"
+		"  -n  number of records, default %lu\n"
+		"  -h  this help\n",
+		prog, ele_size, ele_num, batch, nr_records);
+}
+
+int main(int argc, char *argv[])
+{
+	pthread_t prod, cons;
+	struct timespec start, end;
+	shared_buf_t *sbuf;
+	double secs;
+	uint32_t i;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "m:e:N:b:n:h")) != -1) {
+		switch (opt) {
+		case 'm':
+			for (i = 0U; i < sizeof(mode_names) / sizeof(mode_names[0]); i++) {
+				if (strcmp(optarg, mode_names[i]) == 0)
+					mode = (enum bench_mode)i;
+			}
+			break;
+		case 'e':
+			ele_size = strtoul(optarg, NULL, 0);
+			break;
+		case 'N':
+			ele_num = strtoul(optarg, NULL, 0);
+			break;
+		case 'b':
+			batch = strtoul(optarg, NULL, 0);
+			break;
+		case 'n':
+			nr_records = strtoull(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return (opt == 'h') ? 0 : 1;
+		}
+	}
+
+	if ((ele_size < sizeof(sbuf_rec_hdr_t)) || (batch == 0U) || (batch >= ele_num)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	sbuf = calloc(1, SBUF_HEAD_SIZE + (size_t)ele_num * ele_size);
+	if (sbuf == NULL)
+		return 1;
+	sbuf->magic = SBUF_MAGIC;
+	sbuf->ele_num = ele_num;
+	sbuf->ele_size = ele_size;
+	sbuf->size = ele_num * ele_size;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_create(&cons, NULL, consumer, sbuf);
+	pthread_create(&prod, NULL, producer, sbuf);
+	pthread_join(prod, NULL);
+	pthread_join(cons, NULL);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+
+	secs = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+	printf("%s: %lu records of %u-byte elements in %.3fs, %.1f Mrecords/s\n",
+		mode_names[mode], nr_records, ele_size, secs, (double)nr_records / secs / 1e6);
+
+	free(sbuf);
+	return 0;
+}
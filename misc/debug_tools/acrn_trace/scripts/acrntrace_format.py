@@ -18,7 +18,8 @@ def usage():
           [options]
           -h: print this message
 
-          Parses trace_data in binary format generated by acrntrace and
+          Parses trace_data in binary format generated by acrntrace, either
+          fixed size entries or compact records (acrntrace -f 2), and
           reformats it according to the rules in the [formats] file.
           The rules in formats should have the format ({ and } show grouping
           and are not part of the syntax):
@@ -73,104 +74,173 @@ D4REC = "IIII"
 D8REC = "BBBBBBBBBBBBBBBB"
 D16REC = "bbbbbbbbbbbbbbbb"
 
-def main_loop(formats, fd):
-    global exit
-    i = 0
+# v2 (acrntrace -f 2): a file header, then compact records of whole 8-byte
+# elements, see hypervisor/debug/trace.c
+V2_FILE_MAGIC = b"ACRNTRC2"
+V2_FILE_HDR = "8sII"
+V2_ELE_SIZE = 8
+V2_SYNC = 0
+V2_STR = 4
+V2_SYNC_MAGIC = 0x434e595354524341
+V2_SYNC_ELES = 3
+# v2 record kind to the v1 n_data it replaces
+V2_N_DATA = {1: 2, 2: 4, 3: 8, 4: 16}
+
+def read_v1(fd):
+    while True:
+        line = fd.read(struct.calcsize(TSCREC))
+        if not line:
+            break
+        tsc = struct.unpack(TSCREC, line)[0]
 
+        line = fd.read(struct.calcsize(HDRREC))
+        if not line:
+            break
+        event = struct.unpack(HDRREC, line)[0]
+        n_data = event >> 48 & 0xff
+        cpu = event >> 56
+        event = event & 0xffffffffffff
 
-    while not exit:
-        try:
-            i = i + 1
+        data = [0] * 16
 
-            line = fd.read(struct.calcsize(TSCREC))
+        if n_data == 2:
+            line = fd.read(struct.calcsize(D2REC))
             if not line:
                 break
-            tsc = struct.unpack(TSCREC, line)[0]
+            data[0:2] = struct.unpack(D2REC, line)
 
-            line = fd.read(struct.calcsize(HDRREC))
+        if n_data == 4:
+            line = fd.read(struct.calcsize(D4REC))
             if not line:
                 break
-            event = struct.unpack(HDRREC, line)[0]
-            n_data = event >> 48 & 0xff
-            cpu = event >> 56
-            event = event & 0xffffffffffff
-
-            d1 = 0
-            d2 = 0
-            d3 = 0
-            d4 = 0
-            d5 = 0
-            d6 = 0
-            d7 = 0
-            d8 = 0
-            d9 = 0
-            d10 = 0
-            d11 = 0
-            d12 = 0
-            d13 = 0
-            d14 = 0
-            d15 = 0
-            d16 = 0
-
-            if n_data == 2:
-                line = fd.read(struct.calcsize(D2REC))
-                if not line:
-                    break
-                (d1, d2) = struct.unpack(D2REC, line)
-
-            if n_data == 4:
-                line = fd.read(struct.calcsize(D4REC))
-                if not line:
-                    break
-                (d1, d2, d3, d4) = struct.unpack(D4REC, line)
-
-            if n_data == 8:
-                line = fd.read(struct.calcsize(D8REC))
-                if not line:
-                    break
-                # TRACE_6C using the first 6 data of fields_8. Actaully we have
-                # 16 data in every trace entry.
-                (d1, d2, d3, d4, d5, d6, d7, d8,
-                 d9, d10, d11, d12, d13, d14, d15, d16) = struct.unpack(D8REC, line)
-
-            if n_data == 16:
-                line = fd.read(struct.calcsize(D16REC))
-                if not line:
-                    break
-
-                (d1, d2, d3, d4, d5, d6, d7, d8,
-                 d9, d10, d11, d12, d13, d14, d15, d16) = struct.unpack(D16REC, line)
+            data[0:4] = struct.unpack(D4REC, line)
+
+        if n_data == 8:
+            line = fd.read(struct.calcsize(D8REC))
+            if not line:
+                break
+            # TRACE_6C using the first 6 data of fields_8. Actaully we have
+            # 16 data in every trace entry.
+            data = list(struct.unpack(D8REC, line))
+
+        if n_data == 16:
+            line = fd.read(struct.calcsize(D16REC))
+            if not line:
+                break
+            data = list(struct.unpack(D16REC, line))
+
+        yield (cpu, tsc, event, data)
+
+def varint(buf, pos, end):
+    val = 0
+    shift = 0
+    while pos < end:
+        b = buf[pos]
+        pos += 1
+        val |= (b & 0x7f) << shift
+        if not b & 0x80:
+            return (val, pos)
+        shift += 7
+    raise ValueError("truncated varint")
+
+def is_sync(buf, pos):
+    return (pos + V2_SYNC_ELES * V2_ELE_SIZE <= len(buf) and
+            buf[pos] == V2_SYNC_ELES and buf[pos + 1] == V2_SYNC and
+            struct.unpack_from("Q", buf, pos + 8)[0] == V2_SYNC_MAGIC)
+
+def read_v2(buf, cpu):
+    pos = struct.calcsize(V2_FILE_HDR)
+    synced = False
+    tsc = 0
+    overruns = None
+
+    while pos + V2_ELE_SIZE <= len(buf):
+        if not synced and not is_sync(buf, pos):
+            # lost our place: skip elements up to the next sync record
+            pos += V2_ELE_SIZE
+            continue
+
+        end = pos + buf[pos] * V2_ELE_SIZE
+        kind = buf[pos + 1] & 0xf
+        nargs = buf[pos + 1] >> 4
+        if buf[pos] == 0 or end > len(buf):
+            synced = False
+            pos += V2_ELE_SIZE
+            continue
+
+        if kind == V2_SYNC:
+            if not is_sync(buf, pos):
+                synced = False
+                pos += V2_ELE_SIZE
+                continue
+            # the sbuf counts how often it ran full, not the records it
+            # dropped, and only when overrun counting is enabled
+            overrun = struct.unpack_from("I", buf, pos + 4)[0]
+            if overruns is not None and overrun != overruns:
+                print("CPU%d: trace buffer overran %d times, records dropped" %
+                      (buf[pos + 2], (overrun - overruns) & 0xffffffff),
+                      file=sys.stderr)
+            overruns = overrun
+            cpu = buf[pos + 2]
+            tsc = struct.unpack_from("Q", buf, pos + 16)[0]
+            synced = True
+            pos = end
+            continue
+
+        try:
+            (delta, p) = varint(buf, pos + 2, end)
+            (event, p) = varint(buf, p, end)
+            data = [0] * 16
+            if kind == V2_STR:
+                for i in range(nargs):
+                    # signed, as for v1 TRACE_16STR entries
+                    data[i] = struct.unpack_from("b", buf, p + i)[0]
+            else:
+                for i in range(nargs):
+                    (data[i], p) = varint(buf, p, end)
+            n_data = V2_N_DATA[kind]
+        except (ValueError, KeyError, struct.error):
+            synced = False
+            pos += V2_ELE_SIZE
+            continue
+
+        tsc += delta
+        pos = end
+        yield (cpu, tsc, event, data)
+
+def read_trace(fd):
+    hdr = fd.read(struct.calcsize(V2_FILE_HDR))
+    if len(hdr) == struct.calcsize(V2_FILE_HDR) and hdr[0:8] == V2_FILE_MAGIC:
+        (magic, version, cpu) = struct.unpack(V2_FILE_HDR, hdr)
+        return read_v2(hdr + fd.read(), cpu)
+
+    fd.seek(0)
+    return read_v1(fd)
+
+def main_loop(formats, fd):
+    global exit
+
+    try:
+        for (cpu, tsc, event, data) in read_trace(fd):
+            if exit:
+                break
 
             args = {'cpu'   : cpu,
                     'tsc'   : tsc,
-                    'event' : event,
-                    '1'     : d1,
-                    '2'     : d2,
-                    '3'     : d3,
-                    '4'     : d4,
-                    '5'     : d5,
-                    '6'     : d6,
-                    '7'     : d7,
-                    '8'     : d8,
-                    '9'     : d9,
-                    '10'    : d10,
-                    '11'    : d11,
-                    '12'    : d12,
-                    '13'    : d13,
-                    '14'    : d14,
-                    '15'    : d15,
-                    '16'    : d16      }
+                    'event' : event }
+            for i in range(16):
+                args[str(i + 1)] = data[i]
 
             try:
                 if str(event) in formats.keys():
                     print (formats[str(event)] % args)
             except TypeError:
-                if str(event) in formats.key():
+                if str(event) in formats.keys():
                     print (formats[str(event)])
                     print (args)
 
-        except struct.error:
-            sys.exit()
+    except struct.error:
+        sys.exit()
 
 def main(argv):
     try:
@@ -0,0 +1,184 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#include <errno.h>
+#include <string.h>
+#include "ivshmem_ring.h"
+
+#define load_acquire(p)		__atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define store_release(p, v)	__atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define full_barrier()		__atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+static inline bool is_pow2(uint32_t v)
+{
+	return (v != 0U) && ((v & (v - 1U)) == 0U);
+}
+
+static inline uint32_t queue_stride(uint32_t nr_slots, uint32_t slot_size)
+{
+	uint64_t stride = sizeof(struct ivshm_queue_hdr) + (uint64_t)nr_slots * slot_size;
+
+	return (uint32_t)((stride + IVSHM_CACHELINE - 1U) & ~(uint64_t)(IVSHM_CACHELINE - 1U));
+}
+
+uint64_t ivshm_ring_region_size(uint32_t nr_queues, uint32_t nr_slots, uint32_t slot_size)
+{
+	return sizeof(struct ivshm_region_hdr) +
+		(uint64_t)nr_queues * queue_stride(nr_slots, slot_size);
+}
+
+int ivshm_ring_format(void *base, uint64_t size, uint32_t nr_queues,
+		uint32_t nr_slots, uint32_t slot_size)
+{
+	struct ivshm_region_hdr *hdr = base;
+
+	if ((base == NULL) || (nr_queues == 0U) || (nr_queues > IVSHM_RING_MAX_QUEUES) ||
+		!is_pow2(nr_slots) || (slot_size <= sizeof(struct ivshm_slot)) ||
+		((slot_size & 7U) != 0U) ||
+		(ivshm_ring_region_size(nr_queues, nr_slots, slot_size) > size))
+		return -EINVAL;
+
+	memset(base, 0, ivshm_ring_region_size(nr_queues, nr_slots, slot_size));
+	hdr->version = IVSHM_RING_VERSION;
+	hdr->nr_queues = nr_queues;
+	hdr->nr_slots = nr_slots;
+	hdr->slot_size = slot_size;
+	hdr->queue_stride = queue_stride(nr_slots, slot_size);
+	/* publish the magic last so a peer never sees a half formatted header */
+	store_release(&hdr->magic, IVSHM_RING_MAGIC);
+
+	return 0;
+}
+
+int ivshm_ring_attach(struct ivshm_ring *ring, void *base, uint64_t size,
+		ivshm_notify_fn notify, void *opaque, bool suppress)
+{
+	struct ivshm_region_hdr *hdr = base;
+	struct ivshm_queue *q;
+	uint8_t *p;
+	uint32_t i;
+
+	if ((ring == NULL) || (base == NULL) || (notify == NULL))
+		return -EINVAL;
+
+	if ((load_acquire(&hdr->magic) != IVSHM_RING_MAGIC) ||
+		(hdr->version != IVSHM_RING_VERSION) ||
+		(hdr->nr_queues == 0U) || (hdr->nr_queues > IVSHM_RING_MAX_QUEUES) ||
+		!is_pow2(hdr->nr_slots) ||
+		(hdr->queue_stride != queue_stride(hdr->nr_slots, hdr->slot_size)) ||
+		(ivshm_ring_region_size(hdr->nr_queues, hdr->nr_slots, hdr->slot_size) > size))
+		return -EINVAL;
+
+	memset(ring, 0, sizeof(*ring));
+	ring->hdr = hdr;
+	ring->nr_queues = hdr->nr_queues;
+
+	p = (uint8_t *)base + sizeof(struct ivshm_region_hdr);
+	for (i = 0U; i < ring->nr_queues; i++) {
+		q = &ring->queues[i];
+		q->hdr = (struct ivshm_queue_hdr *)p;
+		q->slots = p + sizeof(struct ivshm_queue_hdr);
+		q->qid = i;
+		q->mask = hdr->nr_slots - 1U;
+		q->slot_size = hdr->slot_size;
+		q->suppress = suppress;
+		q->notify = notify;
+		q->opaque = opaque;
+		p += hdr->queue_stride;
+	}
+
+	return 0;
+}
+
+static inline struct ivshm_slot *queue_slot(const struct ivshm_queue *q, uint32_t idx)
+{
+	return (struct ivshm_slot *)(q->slots + (uint64_t)(idx & q->mask) * q->slot_size);
+}
+
+static void queue_kick(struct ivshm_queue *q, volatile uint32_t *event,
+		uint32_t new, uint32_t old)
+{
+	bool kick = true;
+
+	if (q->suppress) {
+		/* order our index update against reading the peer's event index */
+		full_barrier();
+		kick = ivshm_need_event(*event, new, old);
+	}
+
+	if (kick) {
+		q->kicks++;
+		q->notify(q->opaque, q->qid);
+	}
+}
+
+int ivshm_queue_send(struct ivshm_queue *q, const void *data, uint32_t len)
+{
+	struct ivshm_queue_hdr *hdr = q->hdr;
+	struct ivshm_slot *slot;
+	uint32_t prod = hdr->prod_idx;
+
+	if (len > (q->slot_size - sizeof(struct ivshm_slot)))
+		return -EINVAL;
+
+	if ((prod - load_acquire(&hdr->cons_idx)) > q->mask)
+		return -EAGAIN;
+
+	slot = queue_slot(q, prod);
+	memcpy(slot->data, data, len);
+	slot->len = len;
+	store_release(&hdr->prod_idx, prod + 1U);
+
+	queue_kick(q, &hdr->cons_event, prod + 1U, prod);
+
+	return 0;
+}
+
+int ivshm_queue_recv(struct ivshm_queue *q, void *buf, uint32_t len)
+{
+	struct ivshm_queue_hdr *hdr = q->hdr;
+	struct ivshm_slot *slot;
+	uint32_t cons = hdr->cons_idx;
+	uint32_t msg_len;
+
+	if (load_acquire(&hdr->prod_idx) == cons)
+		return 0;
+
+	slot = queue_slot(q, cons);
+	msg_len = slot->len;
+	if (msg_len > len)
+		return -ENOSPC;
+
+	memcpy(buf, slot->data, msg_len);
+	store_release(&hdr->cons_idx, cons + 1U);
+
+	/* with suppression only a producer which saw a full queue is woken */
+	queue_kick(q, &hdr->prod_event, cons + 1U, cons);
+
+	return (int)msg_len;
+}
+
+bool ivshm_queue_arm_recv(struct ivshm_queue *q)
+{
+	struct ivshm_queue_hdr *hdr = q->hdr;
+	uint32_t cons = hdr->cons_idx;
+
+	hdr->cons_event = cons;
+	full_barrier();
+
+	return (load_acquire(&hdr->prod_idx) == cons);
+}
+
+bool ivshm_queue_arm_send(struct ivshm_queue *q)
+{
+	struct ivshm_queue_hdr *hdr = q->hdr;
+	uint32_t cons = hdr->cons_idx;
+
+	hdr->prod_event = cons;
+	full_barrier();
+
+	return ((hdr->prod_idx - load_acquire(&hdr->cons_idx)) > q->mask);
+}
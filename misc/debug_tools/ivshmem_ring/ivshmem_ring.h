@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 Intel Corporation. All rights reserved.
+ *
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+#ifndef IVSHMEM_RING_H
+#define IVSHMEM_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Multi-queue ring layout on top of an ivshmem shared memory region.
+ *
+ * The region is split into a region header followed by nr_queues
+ * single-producer/single-consumer queues. Queue N is signalled through
+ * MSI-X vector N of the consumer's ivshmem device, so each queue gets its
+ * own interrupt.
+ *
+ * -------------------------------------------------------------------------
+ * | ivshm_region_hdr | ivshm_queue_hdr 0 | slots 0 | ... | queue hdr N-1 | slots N-1 |
+ * -------------------------------------------------------------------------
+ *
+ * Notification suppression follows the virtio "event index" scheme:
+ * every side publishes the index at which it wants to be woken up, and
+ * the other side only rings the doorbell when its update crosses that
+ * index. A side which is busy polling publishes nothing, so a stream of
+ * messages costs no doorbell (MMIO exit) and no interrupt at all.
+ */
+
+#define IVSHM_RING_MAGIC	0x474e495248535649UL	/* "IVSHRING" */
+#define IVSHM_RING_VERSION	1U
+#define IVSHM_RING_MAX_QUEUES	8U	/* MSI-X vectors of an ivshmem device */
+#define IVSHM_CACHELINE		64U
+
+/* ivshmem device MMIO registers (BAR0) */
+#define IVSHM_IV_POS_REG	0x8U
+#define IVSHM_DOORBELL_REG	0xcU
+
+struct ivshm_region_hdr {
+	uint64_t magic;
+	uint32_t version;
+	uint32_t nr_queues;
+	uint32_t nr_slots;	/* per queue, power of 2 */
+	uint32_t slot_size;	/* bytes, multiple of 8 */
+	uint32_t queue_stride;	/* bytes between two queue headers */
+	uint32_t reserved;
+} __attribute__((aligned(IVSHM_CACHELINE)));
+
+/*
+ * Producer- and consumer-owned fields live in different cache lines so
+ * the two peers never write to the same line.
+ */
+struct ivshm_queue_hdr {
+	/* written by the producer */
+	volatile uint32_t prod_idx;	/* free running, next slot to fill */
+	volatile uint32_t prod_event;	/* wake the producer once cons_idx passes this */
+	uint8_t pad0[IVSHM_CACHELINE - 8U];
+	/* written by the consumer */
+	volatile uint32_t cons_idx;	/* free running, next slot to drain */
+	volatile uint32_t cons_event;	/* wake the consumer once prod_idx passes this */
+	uint8_t pad1[IVSHM_CACHELINE - 8U];
+} __attribute__((aligned(IVSHM_CACHELINE)));
+
+/* Each slot starts with the payload length, followed by payload bytes */
+struct ivshm_slot {
+	uint32_t len;
+	uint32_t reserved;
+	uint8_t data[];
+};
+
+/*
+ * Called when the peer has to be notified for queue 'qid'. For an ivshmem
+ * device this writes (peer_id << 16) | qid to the doorbell register.
+ */
+typedef void (*ivshm_notify_fn)(void *opaque, uint32_t qid);
+
+struct ivshm_queue {
+	struct ivshm_queue_hdr *hdr;
+	uint8_t *slots;
+	uint32_t qid;
+	uint32_t mask;		/* nr_slots - 1 */
+	uint32_t slot_size;
+	bool suppress;		/* honour the peer's event index */
+	ivshm_notify_fn notify;
+	void *opaque;
+	uint64_t kicks;		/* doorbells actually rung */
+};
+
+struct ivshm_ring {
+	struct ivshm_region_hdr *hdr;
+	uint32_t nr_queues;
+	struct ivshm_queue queues[IVSHM_RING_MAX_QUEUES];
+};
+
+/*
+ * 'v16'-style wrap safe test used by virtio: has the index moved from
+ * 'old' to 'new' across 'event'?
+ */
+static inline bool ivshm_need_event(uint32_t event, uint32_t new, uint32_t old)
+{
+	return (uint32_t)(new - event - 1U) < (uint32_t)(new - old);
+}
+
+/* Bytes of shared memory needed by the given geometry */
+uint64_t ivshm_ring_region_size(uint32_t nr_queues, uint32_t nr_slots, uint32_t slot_size);
+
+/* Lay out an empty ring set in 'base'; done once by the region creator */
+int ivshm_ring_format(void *base, uint64_t size, uint32_t nr_queues,
+		uint32_t nr_slots, uint32_t slot_size);
+
+/* Attach to an already formatted region */
+int ivshm_ring_attach(struct ivshm_ring *ring, void *base, uint64_t size,
+		ivshm_notify_fn notify, void *opaque, bool suppress);
+
+/*
+ * Producer side. Returns 0 on success, -EAGAIN if the queue is full and
+ * -EINVAL if the message does not fit into a slot.
+ */
+int ivshm_queue_send(struct ivshm_queue *q, const void *data, uint32_t len);
+
+/*
+ * Consumer side. Returns the message length, 0 if the queue is empty and
+ * -ENOSPC if 'buf' is too small.
+ */
+int ivshm_queue_recv(struct ivshm_queue *q, void *buf, uint32_t len);
+
+/*
+ * Consumer side: about to sleep on the queue's vector. Publishes the event
+ * index and returns false if messages arrived meanwhile, in which case the
+ * caller must keep draining instead of sleeping.
+ */
+bool ivshm_queue_arm_recv(struct ivshm_queue *q);
+
+/* Producer side: same as above for waiting on free slots */
+bool ivshm_queue_arm_send(struct ivshm_queue *q);
+
+#endif /* IVSHMEM_RING_H */
@@ -34,6 +34,7 @@
 #define ADD_DESC       "Add one virtual machine with SCRIPTS and OPTIONS"
 #define RESET_DESC     "Stop and then start virtual machine VM_NAME"
 #define BLKRESCAN_DESC  "Rescan virtio-blk device attached to a virtual machine"
+#define TOP_DESC       "Show VM exit rates and latencies, [INTERVAL [COUNT]]"
 
 #define VM_NAME (1)
 #define CMD_ARGS (2)
@@ -616,6 +617,19 @@ static int acrnctl_do_reset(int argc, char *argv[])
 	return ret;
 }
 
+/* command: top */
+static int acrnctl_do_top(int argc, char *argv[])
+{
+	unsigned int interval = 1, iterations = 0;
+
+	if (argc > 1)
+		interval = strtoul(argv[1], NULL, 10);
+	if (argc > 2)
+		iterations = strtoul(argv[2], NULL, 10);
+
+	return top_vm(interval, iterations);
+}
+
 /* Default args validation function */
 int df_valid_args(struct acrnctl_cmd *cmd, int argc, char *argv[])
 {
@@ -675,6 +689,16 @@ static int valid_list_args(struct acrnctl_cmd *cmd, int argc, char *argv[])
 	return 0;
 }
 
+static int valid_top_args(struct acrnctl_cmd *cmd, int argc, char *argv[])
+{
+	if (argc > 3 || (argc > 1 && (!strcmp(argv[1], "help") || !strtoul(argv[1], NULL, 10)))) {
+		printf("acrnctl %s [INTERVAL [COUNT]]\n", cmd->cmd);
+		return -1;
+	}
+
+	return 0;
+}
+
 struct acrnctl_cmd acmds[] = {
 	ACMD("list", acrnctl_do_list, LIST_DESC, valid_list_args),
 	ACMD("start", acrnctl_do_start, START_DESC, valid_start_args),
@@ -683,6 +707,7 @@ struct acrnctl_cmd acmds[] = {
 	ACMD("add", acrnctl_do_add, ADD_DESC, valid_add_args),
 	ACMD("reset", acrnctl_do_reset, RESET_DESC, df_valid_args),
 	ACMD("blkrescan", acrnctl_do_blkrescan, BLKRESCAN_DESC, valid_blkrescan_args),
+	ACMD("top", acrnctl_do_top, TOP_DESC, valid_top_args),
 };
 
 #define NCMD	(sizeof(acmds)/sizeof(struct acrnctl_cmd))
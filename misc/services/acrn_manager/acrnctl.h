@@ -59,4 +59,7 @@ int continue_vm(const char *vmname);
 int resume_vm(const char *vmname, unsigned reason);
 int blkrescan_vm(const char *vmname, char *devargs);
 
+/* VM exit statistics, refreshed every interval seconds; iterations 0 runs forever */
+int top_vm(unsigned int interval, unsigned int iterations);
+
 #endif				/* _ACRNCTL_H_ */
@@ -0,0 +1,280 @@
+/**
+ * Copyright (C) 2026 Intel Corporation
+ * SPDX-License-Identifier: BSD-3-Clause
+ */
+
+/*
+ * acrnctl top: exits/s and VM exit handling latency per VM, from the
+ * hypervisor's always-on VM exit statistics.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include "types.h"
+#include "hsm_ioctl_defs.h"
+#include "acrnctl.h"
+
+#define HSM_DEV			"/dev/acrn_hsm"
+#define TOP_MAX_VMS		16
+#define TOP_MAX_VCPUS		64
+#define TOP_MAX_IO_SLOTS	512
+#define TOP_IO_LINES		8
+
+/* per VM sums over all its vCPUs */
+struct vm_sample {
+	int valid;
+	int nr_vcpus;
+	uint64_t tsc;
+	uint64_t tsc_khz;
+	struct acrn_exit_stat reasons[ACRN_EXIT_REASON_NUM];
+	struct acrn_io_exit_stat io[TOP_MAX_IO_SLOTS];
+};
+
+static const char *exit_reason_names[ACRN_EXIT_REASON_NUM] = {
+	[0x00] = "EXCEPTION",	[0x01] = "EXT_INTR",	[0x07] = "INTR_WIN",
+	[0x08] = "NMI_WIN",	[0x0A] = "CPUID",	[0x0C] = "HLT",
+	[0x10] = "RDTSC",	[0x12] = "VMCALL",	[0x1C] = "CR",
+	[0x1E] = "IO",		[0x1F] = "RDMSR",	[0x20] = "WRMSR",
+	[0x28] = "PAUSE",	[0x2C] = "APIC_ACCESS",	[0x2D] = "VEOI",
+	[0x30] = "EPT_VIOL",	[0x31] = "EPT_MISCONF",	[0x36] = "WBINVD",
+	[0x37] = "XSETBV",	[0x38] = "APIC_WRITE",
+};
+
+static const char *io_type_names[] = {
+	[ACRN_IO_STAT_HV_PIO] = "hv-pio",
+	[ACRN_IO_STAT_HV_MMIO] = "hv-mmio",
+	[ACRN_IO_STAT_DEFAULT] = "default",
+	[ACRN_IO_STAT_DM_PIO] = "dm-pio",
+	[ACRN_IO_STAT_DM_MMIO] = "dm-mmio",
+};
+
+static void stat_add(struct acrn_exit_stat *sum, const struct acrn_exit_stat *s)
+{
+	int i;
+
+	sum->count += s->count;
+	sum->cycles += s->cycles;
+	for (i = 0; i < ACRN_EXIT_HIST_BUCKETS; i++)
+		sum->hist[i] += s->hist[i];
+}
+
+static void stat_sub(struct acrn_exit_stat *d, const struct acrn_exit_stat *a,
+		const struct acrn_exit_stat *b)
+{
+	int i;
+
+	d->count = a->count - b->count;
+	d->cycles = a->cycles - b->cycles;
+	for (i = 0; i < ACRN_EXIT_HIST_BUCKETS; i++)
+		d->hist[i] = a->hist[i] - b->hist[i];
+}
+
+/* upper bound of the histogram bucket holding the given percentile, in cycles */
+static uint64_t stat_percentile(const struct acrn_exit_stat *s, unsigned int pct)
+{
+	uint64_t seen = 0, total = 0;
+	int i;
+
+	for (i = 0; i < ACRN_EXIT_HIST_BUCKETS; i++)
+		total += s->hist[i];
+	if (total == 0)
+		return 0;
+
+	for (i = 0; i < ACRN_EXIT_HIST_BUCKETS - 1; i++) {
+		seen += s->hist[i];
+		if (seen * 100 >= total * pct)
+			break;
+	}
+	return 1UL << (ACRN_EXIT_HIST_SHIFT + i);
+}
+
+static int sample_vm(int fd, uint16_t vmid, struct vm_sample *vs)
+{
+	struct acrn_vcpu_exit_stats *vcpu_stats;
+	struct acrn_vm_io_stats *io_stats;
+	uint32_t i;
+	int ret = 0;
+
+	vcpu_stats = calloc(1, sizeof(*vcpu_stats));
+	io_stats = calloc(1, sizeof(*io_stats));
+	if (!vcpu_stats || !io_stats) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	memset(vs, 0, sizeof(*vs));
+	for (vs->nr_vcpus = 0; vs->nr_vcpus < TOP_MAX_VCPUS; vs->nr_vcpus++) {
+		vcpu_stats->vmid = vmid;
+		vcpu_stats->vcpu_id = vs->nr_vcpus;
+		if (ioctl(fd, ACRN_IOCTL_GET_VCPU_EXIT_STATS, vcpu_stats) < 0)
+			break;
+
+		vs->tsc = vcpu_stats->tsc;
+		vs->tsc_khz = vcpu_stats->tsc_khz;
+		for (i = 0; i < ACRN_EXIT_REASON_NUM; i++)
+			stat_add(&vs->reasons[i], &vcpu_stats->reasons[i]);
+	}
+	vs->valid = (vs->nr_vcpus > 0);
+
+	io_stats->vmid = vmid;
+	io_stats->first = 0;
+	while (vs->valid && ioctl(fd, ACRN_IOCTL_GET_VM_IO_STATS, io_stats) == 0 &&
+			io_stats->nr != 0) {
+		for (i = 0; i < io_stats->nr; i++) {
+			if (io_stats->stats[i].slot < TOP_MAX_IO_SLOTS)
+				vs->io[io_stats->stats[i].slot] = io_stats->stats[i];
+		}
+		io_stats->first = io_stats->next;
+	}
+
+ out:
+	free(vcpu_stats);
+	free(io_stats);
+	return ret;
+}
+
+static double cycles_to_us(uint64_t cycles, uint64_t tsc_khz)
+{
+	return tsc_khz ? ((double)cycles * 1000.0 / (double)tsc_khz) : 0.0;
+}
+
+static void show_vm(uint16_t vmid, const struct vm_sample *cur, const struct vm_sample *prev)
+{
+	struct acrn_exit_stat d, sum;
+	double secs = (double)(cur->tsc - prev->tsc) / ((double)cur->tsc_khz * 1000.0);
+	uint64_t top_count = 0;
+	int i, top = -1;
+
+	memset(&sum, 0, sizeof(sum));
+	for (i = 0; i < ACRN_EXIT_REASON_NUM; i++) {
+		stat_sub(&d, &cur->reasons[i], &prev->reasons[i]);
+		stat_add(&sum, &d);
+		if (d.count > top_count) {
+			top_count = d.count;
+			top = i;
+		}
+	}
+
+	printf("%-4u %5d %12.0f %9.2f %9.2f  ", vmid, cur->nr_vcpus,
+		(secs > 0.0) ? (double)sum.count / secs : 0.0,
+		sum.count ? cycles_to_us(sum.cycles / sum.count, cur->tsc_khz) : 0.0,
+		cycles_to_us(stat_percentile(&sum, 99), cur->tsc_khz));
+	if (top >= 0)
+		printf("%s (%lu%%)\n", exit_reason_names[top] ? exit_reason_names[top] : "OTHER",
+			top_count * 100 / sum.count);
+	else
+		printf("-\n");
+}
+
+static void show_io(const struct vm_sample *cur, const struct vm_sample *prev, int nr_vms)
+{
+	struct acrn_exit_stat d;
+	struct {
+		int vm, slot;
+		uint64_t count;
+	} top[TOP_IO_LINES];
+	int vm, slot, i, j, n = 0;
+	double secs;
+
+	for (vm = 0; vm < nr_vms; vm++) {
+		if (!cur[vm].valid || !prev[vm].valid)
+			continue;
+		for (slot = 0; slot < TOP_MAX_IO_SLOTS; slot++) {
+			d.count = cur[vm].io[slot].stat.count - prev[vm].io[slot].stat.count;
+			if (d.count == 0)
+				continue;
+			/* insertion into the TOP_IO_LINES busiest handlers */
+			for (i = 0; (i < n) && (top[i].count >= d.count); i++)
+				;
+			if (i == TOP_IO_LINES)
+				continue;
+			if (n < TOP_IO_LINES)
+				n++;
+			for (j = n - 1; j > i; j--)
+				top[j] = top[j - 1];
+			top[i].vm = vm;
+			top[i].slot = slot;
+			top[i].count = d.count;
+		}
+	}
+
+	if (n == 0)
+		return;
+
+	printf("\n%-4s %-8s %-33s %12s %9s %9s\n", "VM", "HANDLER", "RANGE",
+		"EXITS/S", "AVG(us)", "P99(us)");
+	for (i = 0; i < n; i++) {
+		const struct acrn_io_exit_stat *c = &cur[top[i].vm].io[top[i].slot];
+		const struct acrn_io_exit_stat *p = &prev[top[i].vm].io[top[i].slot];
+		char range[40] = "-";
+
+		stat_sub(&d, &c->stat, &p->stat);
+		secs = (double)(cur[top[i].vm].tsc - prev[top[i].vm].tsc) /
+			((double)cur[top[i].vm].tsc_khz * 1000.0);
+		if (c->end > c->start)
+			snprintf(range, sizeof(range), "0x%lx-0x%lx", c->start, c->end - 1);
+		printf("%-4d %-8s %-33s %12.0f %9.2f %9.2f\n", top[i].vm,
+			(c->type < sizeof(io_type_names) / sizeof(io_type_names[0])) ?
+				io_type_names[c->type] : "?", range,
+			(secs > 0.0) ? (double)d.count / secs : 0.0,
+			cycles_to_us(d.cycles / d.count, cur[top[i].vm].tsc_khz),
+			cycles_to_us(stat_percentile(&d, 99), cur[top[i].vm].tsc_khz));
+	}
+}
+
+int top_vm(unsigned int interval, unsigned int iterations)
+{
+	struct vm_sample *cur, *prev, *tmp;
+	unsigned int n;
+	int fd, vm, ret = 0;
+
+	fd = open(HSM_DEV, O_RDWR);
+	if (fd < 0) {
+		printf("Failed to open %s: %s\n", HSM_DEV, strerror(errno));
+		return -1;
+	}
+
+	cur = calloc(TOP_MAX_VMS, sizeof(*cur));
+	prev = calloc(TOP_MAX_VMS, sizeof(*prev));
+	if (!cur || !prev) {
+		ret = -1;
+		goto out;
+	}
+
+	for (vm = 0; vm < TOP_MAX_VMS; vm++)
+		sample_vm(fd, vm, &prev[vm]);
+
+	for (n = 0; (iterations == 0) || (n < iterations); n++) {
+		sleep(interval);
+		for (vm = 0; vm < TOP_MAX_VMS; vm++)
+			sample_vm(fd, vm, &cur[vm]);
+
+		/* clear the screen, as top does */
+		printf("\033[H\033[2J");
+		printf("%-4s %5s %12s %9s %9s  %s\n", "VM", "VCPUS", "EXITS/S",
+			"AVG(us)", "P99(us)", "TOP EXIT");
+		for (vm = 0; vm < TOP_MAX_VMS; vm++) {
+			/* a VM created in between has no baseline yet */
+			if (cur[vm].valid && prev[vm].valid &&
+					(cur[vm].nr_vcpus == prev[vm].nr_vcpus))
+				show_vm(vm, &cur[vm], &prev[vm]);
+		}
+		show_io(cur, prev, TOP_MAX_VMS);
+		fflush(stdout);
+
+		tmp = prev;
+		prev = cur;
+		cur = tmp;
+	}
+
+ out:
+	free(cur);
+	free(prev);
+	close(fd);
+	return ret;
+}